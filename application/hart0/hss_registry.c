@@ -49,6 +49,10 @@
 # include "ddr_service.h"
 #endif
 
+#if IS_ENABLED(CONFIG_MEMTEST_PARALLEL)
+# include "hss_memtest.h"
+#endif
+
 #if IS_ENABLED(CONFIG_SERVICE_GOTO)
 # include "goto_service.h"
 #endif
@@ -89,6 +93,10 @@
 #  include "gpio_ui_service.h"
 #endif
 
+#if IS_ENABLED(CONFIG_SERVICE_TELEMETRY)
+#  include "telemetry_service.h"
+#endif
+
 #if IS_ENABLED(CONFIG_SERVICE_LOCKDOWN)
 #  include "lockdown_service.h"
 #endif
@@ -192,6 +200,11 @@ const struct IPI_Handler ipiRegistry[] = {
     { IPI_MSG_SCRUB,             HSS_Null_IPIHandler },
 #endif
     { IPI_MSG_DDR_TRAIN,         HSS_DDR_Train_IPIHandler },
+#if IS_ENABLED(CONFIG_MEMTEST_PARALLEL)
+    { IPI_MSG_MEMTEST,           HSS_MemTest_IPIHandler },
+#else
+    { IPI_MSG_MEMTEST,           HSS_Null_IPIHandler },
+#endif
 };
 const size_t spanOfIpiRegistry = ARRAY_SIZE(ipiRegistry);
 
@@ -259,6 +272,9 @@ struct StateMachine /*@null@*/ * const pGlobalStateMachines[] = {
 #endif
 #if IS_ENABLED(CONFIG_SERVICE_LOCKDOWN)
     &lockdown_service,
+#endif
+#if IS_ENABLED(CONFIG_SERVICE_TELEMETRY)
+    &telemetry_service,
 #endif
     &startup_service,
 };
@@ -21,14 +21,20 @@
 #include "hss_clock.h"
 #include "hss_debug.h"
 #include <assert.h>
+#include <string.h>
 
 #include "ssmb_ipi.h"
 
 #include "csr_helper.h"
 #include "profiling.h"
+#include "mpfs_reg_map.h"
 
 #include "hss_registry.h"
+#include "hss_trigger.h"
 #include "u54_state.h"
+#if IS_ENABLED(CONFIG_DEBUG_SAMPLER)
+#  include "hss_sampler.h"
+#endif
 
 /**
  * \brief Ensure that state is valid for given state machine
@@ -44,6 +50,69 @@ static inline bool IsValidState(struct StateMachine *pStateMachine, int state)
     return result;
 }
 
+#if IS_ENABLED(CONFIG_DEBUG_SM_HISTOGRAMS)
+static struct StateMachine_Histogram histogramPool[CONFIG_DEBUG_SM_HISTOGRAMS_POOL_SIZE];
+static size_t histogramPoolUsed = 0u;
+
+static inline unsigned int HistogramBin_(HSSTicks_t const delta)
+{
+    unsigned int bin = 0u;
+
+    if (delta) {
+        bin = 64u - (unsigned int)__builtin_clzll(delta);
+        if (bin >= SM_HISTOGRAM_NUM_BINS) {
+            bin = SM_HISTOGRAM_NUM_BINS - 1u;
+        }
+    }
+
+    return bin;
+}
+
+static void AllocateHistograms_(struct StateMachine * const pMachine)
+{
+    size_t const needed = 1u + pMachine->numStates;
+
+    if ((histogramPoolUsed + needed) <= ARRAY_SIZE(histogramPool)) {
+        pMachine->pHistograms = &histogramPool[histogramPoolUsed];
+        histogramPoolUsed += needed;
+    }
+}
+#endif
+
+/**
+ * \brief Account for the execution time of one state machine call
+ */
+static void RecordExecutionTime_(struct StateMachine * const pMachine, stateType_t const state,
+    HSSTicks_t const delta, const char * const pMachineName)
+{
+#if IS_ENABLED(CONFIG_DEBUG_SM_HISTOGRAMS)
+    if (unlikely(!pMachine->pHistograms)) {
+        AllocateHistograms_(pMachine);
+    }
+
+    if (likely(pMachine->pHistograms != NULL)) {
+        unsigned int const bin = HistogramBin_(delta);
+
+        pMachine->pHistograms[0].bins[bin]++;
+        if (IsValidState(pMachine, state)) {
+            pMachine->pHistograms[1 + state].bins[bin]++;
+        }
+    }
+#endif
+
+    if (pMachine->budget && (delta > pMachine->budget)) {
+        ++pMachine->budgetOverrunCount;
+        pMachine->budgetOverrunState = state;
+
+        if (IS_ENABLED(CONFIG_DEBUG_SM_BUDGET_WARNINGS)) {
+            mHSS_DEBUG_PRINTF(LOG_WARN, "%s :: [%s] took %" PRIu64 " ticks (budget %" PRIu64 ")\n",
+                pMachineName, pMachine->pStateDescs[state].pStateName, delta, pMachine->budget);
+        }
+    } else {
+        (void)pMachineName;
+    }
+}
+
 /**
  * \brief Run all registered state machines
  */
@@ -108,6 +177,9 @@ void RunStateMachine(struct StateMachine *const pCurrentMachine)
             pCurrentMachine->maxState = pCurrentMachine->prevState;
         }
 
+        RecordExecutionTime_(pCurrentMachine, currentState, pCurrentMachine->lastDeltaExecutionTime,
+            pMachineName);
+
         if (IS_ENABLED(CONFIG_DEBUG_LOG_STATE_TRANSITIONS)) {
             // debug print any state transitions...
             if (pCurrentMachine->debugFlag) {
@@ -137,13 +209,385 @@ void RunStateMachine(struct StateMachine *const pCurrentMachine)
     }
 }
 
+#if IS_ENABLED(CONFIG_SCHED_READY_MASK) || IS_ENABLED(CONFIG_SCHED_PRIORITY)
+/**
+ * \brief Determine if any of a sleeping state machine's wake sources has fired
+ *
+ * The pending IPI message types are only gathered on demand, per source hart,
+ * and then cached for the remainder of the pass in pIpiTypes[MAX_NUM_HARTS].
+ */
+static bool HasWakeEvent_(struct StateMachine const * const pMachine, HSSTicks_t const now,
+    uint32_t *pIpiTypes, bool *pIpiTypesValid)
+{
+    struct StateMachine_Wake const * const pWake = &(pMachine->wake);
+    bool result = false;
+
+    if ((pWake->sources & SM_WAKE_TIMER)
+        && ((now - pMachine->lastExecutionTime) > pWake->period)) {
+        result = true;
+    }
+
+    if (!result && (pWake->sources & SM_WAKE_POLL) && pWake->poll) {
+        result = pWake->poll();
+    }
+
+    if (!result && (pWake->sources & SM_WAKE_TRIGGER)) {
+        result = HSS_Trigger_IsWaiterReady(&(pWake->waiter));
+    }
+
+    if (!result && (pWake->sources & SM_WAKE_IPI)) {
+        uint32_t const ipiHarts = pWake->ipiHarts ? pWake->ipiHarts : mHSS_BITMASK_ALL_U54;
+        uint32_t ipiTypes = 0u;
+
+        if (!*pIpiTypesValid) {
+            for (unsigned int hartId = HSS_HART_U54_1; hartId < MAX_NUM_HARTS; hartId++) {
+                const union HSSHartBitmask hartBitmask = { .uint = (1u << hartId) };
+                pIpiTypes[hartId] = IPI_GetPendingMsgTypes(hartBitmask);
+            }
+            *pIpiTypesValid = true;
+        }
+
+        for (unsigned int hartId = HSS_HART_U54_1; hartId < MAX_NUM_HARTS; hartId++) {
+            if (ipiHarts & (1u << hartId)) {
+                ipiTypes |= pIpiTypes[hartId];
+            }
+        }
+
+        result = (ipiTypes & pWake->ipiTypes) ? true : false;
+    }
+
+    return result;
+}
+#endif
+
+#if IS_ENABLED(CONFIG_SCHED_READY_MASK)
+/**
+ * \brief Determine if a state machine needs to be dispatched this pass
+ */
+static bool IsReady_(struct StateMachine const * const pMachine, HSSTicks_t const now,
+    uint32_t *pIpiTypes, bool *pIpiTypesValid)
+{
+    struct StateMachine_Wake const * const pWake = &(pMachine->wake);
+    bool result = false;
+
+    if ((pWake->sources == SM_WAKE_NONE) || (pWake->sources & SM_WAKE_ALWAYS)) {
+        result = true;
+    } else if (pMachine->state != pMachine->prevState) {
+        result = true; // pending state transition, so onExit/onEntry need to run
+    } else if (pMachine->state != pWake->sleepState) {
+        result = true;
+    } else {
+        result = HasWakeEvent_(pMachine, now, pIpiTypes, pIpiTypesValid);
+    }
+
+    return result;
+}
+
+static uint64_t BuildReadyMask_(const size_t spanOfPStateMachines, struct StateMachine *const pStateMachines[])
+{
+    uint64_t readyMask = 0u;
+    uint32_t ipiTypes[MAX_NUM_HARTS] = { 0u };
+    bool ipiTypesValid = false;
+    HSSTicks_t const now = HSS_GetTime();
+
+    assert(spanOfPStateMachines <= 64u);
+
+    for (size_t i = 0u; i < spanOfPStateMachines; ++i) {
+        struct StateMachine_Wake * const pWake = &(pStateMachines[i]->wake);
+
+        if (unlikely((pWake->sources & SM_WAKE_TRIGGER) && !pWake->waiter.registered)) {
+            HSS_Trigger_Wait(&(pWake->waiter), pWake->events);
+        }
+
+        if (IsReady_(pStateMachines[i], now, ipiTypes, &ipiTypesValid)) {
+            readyMask |= (1llu << i);
+        }
+    }
+
+    return readyMask;
+}
+#endif
+
+#if IS_ENABLED(CONFIG_SCHED_IDLE_WFI)
+#  if IS_ENABLED(CONFIG_HSS_USE_IHC)
+#    error SCHED_IDLE_WFI cannot wake on IHC messages
+#  endif
+
+static uint64_t idleCount = 0u;
+static HSSTicks_t idleTime = 0u;
+static uint64_t idleTimerWakeCount = 0u;
+static uint64_t idleIpiWakeCount = 0u;
+static uint64_t idleExtWakeCount = 0u;
+static uint64_t idleOtherWakeCount = 0u;
+static HSSTicks_t wakeLatencyMin = 0u;
+static HSSTicks_t wakeLatencyMax = 0u;
+static HSSTicks_t wakeLatencyTotal = 0u;
+
+/**
+ * \brief Find the time at which the superloop next has work to do
+ *
+ * Only called when no machine is ready, so every machine is in its sleep state.
+ */
+static HSSTicks_t GetIdleDeadline_(const size_t spanOfPStateMachines,
+    struct StateMachine *const pStateMachines[], HSSTicks_t const now)
+{
+    HSSTicks_t deadline = now + (CONFIG_SCHED_IDLE_WFI_MAX_SLEEP_MS * ONE_MILLISEC);
+
+    for (size_t i = 0u; i < spanOfPStateMachines; ++i) {
+        struct StateMachine const * const pMachine = pStateMachines[i];
+        struct StateMachine_Wake const * const pWake = &(pMachine->wake);
+        HSSTicks_t expiry = deadline;
+
+        if (pWake->sources & SM_WAKE_TIMER) {
+            expiry = pMachine->lastExecutionTime + pWake->period + 1u;
+        }
+
+        if (pWake->sources & SM_WAKE_POLL) {
+            HSSTicks_t const pollExpiry = now + (CONFIG_SCHED_IDLE_WFI_POLL_INTERVAL_US * ONE_MILLISEC) / 1000u;
+            if (pollExpiry < expiry) { expiry = pollExpiry; }
+        }
+
+        if (expiry < deadline) {
+            deadline = expiry;
+        }
+    }
+
+    return deadline;
+}
+
+/**
+ * \brief Sleep the E51 in WFI until the deadline, an IPI or an external interrupt
+ *
+ * Interrupts are left globally disabled in mstatus, so a pending source in mie
+ * only terminates the WFI and no trap is taken. The MSIP doorbell is cleared at
+ * the start of each pass, so an IPI sent since the ready mask was built is not
+ * lost. While the sampling profiler is running on the E51, its samples may also
+ * end the WFI early.
+ */
+static void IdleUntil_(HSSTicks_t const deadline)
+{
+    HSSTicks_t const idleStart = HSS_GetTime();
+
+    if (deadline <= idleStart) {
+        return;
+    }
+
+#if IS_ENABLED(CONFIG_DEBUG_SAMPLER)
+    // the sampling profiler shares the E51 machine timer
+    HSSTicks_t const sampleDeadline = HSS_Sampler_GetE51Deadline();
+#else
+    HSSTicks_t const sampleDeadline = UINT64_MAX;
+#endif
+    mHSS_WriteRegU64(CLINT, MTIMECMP_E51_0, MIN(deadline, sampleDeadline));
+
+    unsigned long const prevMstatus = csr_read_clear(CSR_MSTATUS, MSTATUS_MIE);
+    unsigned long const prevMie = csr_read(CSR_MIE);
+    csr_write(CSR_MIE, MIP_MSIP | MIP_MTIP | MIP_MEIP);
+
+    wfi();
+
+    unsigned long const mip = csr_read(CSR_MIP);
+    csr_write(CSR_MIE, prevMie);
+    mHSS_WriteRegU64(CLINT, MTIMECMP_E51_0, sampleDeadline); // deassert MTIP, unless a sample is due
+    if (prevMstatus & MSTATUS_MIE) {
+        csr_set(CSR_MSTATUS, MSTATUS_MIE);
+    }
+
+    HSSTicks_t const wakeTime = HSS_GetTime();
+
+    ++idleCount;
+    idleTime += wakeTime - idleStart;
+
+    if (mip & MIP_MSIP) {
+        ++idleIpiWakeCount;
+    } else if (mip & MIP_MEIP) {
+        ++idleExtWakeCount;
+    } else if (wakeTime >= deadline) {
+        HSSTicks_t const latency = wakeTime - deadline;
+
+        if (!idleTimerWakeCount || (latency < wakeLatencyMin)) { wakeLatencyMin = latency; }
+        if (latency > wakeLatencyMax) { wakeLatencyMax = latency; }
+        wakeLatencyTotal += latency;
+        ++idleTimerWakeCount;
+    } else {
+        ++idleOtherWakeCount;
+    }
+}
+#endif
+
 static HSSTicks_t maxLoopTime = 0u;
 static uint64_t loopCount = 0u;
+static HSSTicks_t statsStartTime = 0u;
+static uint64_t statsStartLoopCount = 0u;
+static uint64_t dispatchCount = 0u;
+static HSSTicks_t bootCompleteTime = 0u;
+static uint64_t bootCompleteLoopCount = 0u;
+
+#if IS_ENABLED(CONFIG_SCHED_PRIORITY)
+static uint64_t extraDispatchCount = 0u;
+static uint64_t strideSkipCount = 0u;
+static uint64_t starvationRunCount = 0u;
+static uint64_t budgetExceededCount = 0u;
+
+/**
+ * \brief Determine if a low priority state machine gets its turn this pass
+ *
+ * Low priority machines run once every stride passes (staggered by their
+ * registry index), unless a state transition is pending or they have not
+ * run for CONFIG_SCHED_PRIORITY_STARVATION_LIMIT_MS.
+ */
+static bool IsStrideTurn_(struct StateMachine const * const pMachine, size_t const index)
+{
+    bool result = true;
+
+    if (SM_PRIORITY_IS_LOW(pMachine->priority)) {
+        uint64_t const stride = SM_PRIORITY_STRIDE(pMachine->priority);
+
+        if (pMachine->state != pMachine->prevState) {
+            result = true;
+        } else if (((loopCount + index) % stride) == 0u) {
+            result = true;
+        } else if (pMachine->lastExecutionTime && HSS_Timer_IsElapsed(pMachine->lastExecutionTime,
+            CONFIG_SCHED_PRIORITY_STARVATION_LIMIT_MS * ONE_MILLISEC)) {
+            ++starvationRunCount;
+            result = true;
+        } else {
+            ++strideSkipCount;
+            result = false;
+        }
+    }
+
+    return result;
+}
+
+/**
+ * \brief Determine if a high priority state machine has pending work
+ *
+ * A pending state transition, a busy state (in which each dispatch makes progress,
+ * such as copying the next boot sub-chunk), or a fired wake source (such as a queued
+ * IPI of a type it handles) counts. Merely being outside of its sleep state does
+ * not, as a machine polling for a hardware completion would otherwise soak up its
+ * extra dispatches on every pass.
+ */
+static bool HasPendingWork_(struct StateMachine const * const pMachine)
+{
+    uint32_t ipiTypes[MAX_NUM_HARTS] = { 0u };
+    bool ipiTypesValid = false;
+    bool result = false;
+
+    if (pMachine->state != pMachine->prevState) {
+        result = true;
+    } else if (pMachine->busyStates & SM_STATE_BIT(pMachine->state)) {
+        result = true;
+    } else if ((pMachine->wake.sources != SM_WAKE_NONE) && !(pMachine->wake.sources & SM_WAKE_ALWAYS)) {
+        result = HasWakeEvent_(pMachine, HSS_GetTime(), ipiTypes, &ipiTypesValid);
+    }
+
+    return result;
+}
+#endif
+
+static void DispatchStateMachine_(struct StateMachine * const pCurrentMachine, size_t const index,
+    HSSTicks_t const passStartTime)
+{
+#if IS_ENABLED(CONFIG_SCHED_PRIORITY)
+    if (!IsStrideTurn_(pCurrentMachine, index)) {
+        return;
+    }
+#else
+    (void)index;
+    (void)passStartTime;
+#endif
+
+    RunStateMachine(pCurrentMachine);
+    ++pCurrentMachine->dispatchCount;
+    ++dispatchCount;
+
+    if (pCurrentMachine->wake.waiter.pendingMask) {
+        // the handler has seen the notifications, so stop them waking it again
+        (void)HSS_Trigger_Consume(&(pCurrentMachine->wake.waiter));
+    }
+
+#if IS_ENABLED(CONFIG_SCHED_PRIORITY)
+    if (SM_PRIORITY_IS_HIGH(pCurrentMachine->priority)) {
+        unsigned int extraRuns = SM_PRIORITY_EXTRA_RUNS(pCurrentMachine->priority);
+
+        while (extraRuns && HasPendingWork_(pCurrentMachine)) {
+            // starvation protection: don't let repeated dispatches stretch the pass
+            // out beyond its budget, as everything else is waiting on it
+            if (HSS_Timer_IsElapsed(passStartTime, (CONFIG_SCHED_PRIORITY_PASS_BUDGET_US * ONE_MILLISEC) / 1000u)) {
+                ++budgetExceededCount;
+                break;
+            }
+
+            RunStateMachine(pCurrentMachine);
+            ++pCurrentMachine->dispatchCount;
+            ++dispatchCount;
+            ++extraDispatchCount;
+            --extraRuns;
+        }
+    }
+#endif
+}
+
+#if IS_ENABLED(CONFIG_SCHED_PRIORITY)
+/**
+ * \brief Get the machines that are dispatched first in each pass
+ */
+static uint64_t GetHighPriorityMask_(const size_t spanOfPStateMachines, struct StateMachine *const pStateMachines[])
+{
+    uint64_t highMask = 0u;
+
+    for (size_t i = 0u; i < spanOfPStateMachines; ++i) {
+        if (SM_PRIORITY_IS_HIGH(pStateMachines[i]->priority)) {
+            highMask |= (1llu << i);
+        }
+    }
+
+    return highMask;
+}
+#endif
+
+static void DumpSchedulerStats_(void)
+{
+    if (bootCompleteTime) {
+        mHSS_DEBUG_PRINTF(LOG_STATUS, "time-to-boot: %" PRIu64 " ms, %" PRIu64 " loops (%s dispatch)\n",
+            bootCompleteTime / TICKS_PER_MILLISEC, bootCompleteLoopCount,
+            IS_ENABLED(CONFIG_SCHED_PRIORITY) ? "priority" : "round-robin");
+    }
+
+#if IS_ENABLED(CONFIG_SCHED_PRIORITY)
+    mHSS_DEBUG_PRINTF(LOG_STATUS, "priority: %" PRIu64 " extra dispatches, %" PRIu64 " stride skips, %"
+        PRIu64 " starvation runs, %" PRIu64 " budget cut-offs\n",
+        extraDispatchCount, strideSkipCount, starvationRunCount, budgetExceededCount);
+#endif
+
+#if IS_ENABLED(CONFIG_SCHED_IDLE_WFI)
+    HSSTicks_t const elapsedTime = statsStartTime ? (HSS_GetTime() - statsStartTime) : 0u;
+
+    mHSS_DEBUG_PRINTF(LOG_STATUS, "idle: %" PRIu64 " sleeps, %" PRIu64 " of %" PRIu64 " ms asleep, wakes: %"
+        PRIu64 " timer / %" PRIu64 " ipi / %" PRIu64 " external / %" PRIu64 " other\n",
+        idleCount, idleTime / TICKS_PER_MILLISEC, elapsedTime / TICKS_PER_MILLISEC,
+        idleTimerWakeCount, idleIpiWakeCount, idleExtWakeCount, idleOtherWakeCount);
+
+    if (idleTimerWakeCount) {
+        mHSS_DEBUG_PRINTF(LOG_STATUS, "idle: timer wake latency min/avg/max %" PRIu64 "/%" PRIu64 "/%" PRIu64
+            " ticks\n", wakeLatencyMin, wakeLatencyTotal / idleTimerWakeCount, wakeLatencyMax);
+    }
+#endif
+}
+
 void RunStateMachines(const size_t spanOfPStateMachines, struct StateMachine *const pStateMachines[])
 {
     HSSTicks_t const startTicks = HSS_GetTickCount();
     HSSTicks_t endTicks;
 
+#if IS_ENABLED(CONFIG_SCHED_IDLE_WFI)
+    // clear the IPI doorbell before looking for work, so that any IPI sent from
+    // here on will terminate the WFI below instead of being lost
+    CLINT_Clear_MSIP(HSS_HART_E51);
+#endif
+
     if (!IS_ENABLED(CONFIG_SERVICE_IPI_POLL)) {
         // poll IPIs each iteration for new messages
         const union HSSHartBitmask hartBitmask = { .uint = mHSS_BITMASK_ALL_U54 };
@@ -165,17 +609,69 @@ void RunStateMachines(const size_t spanOfPStateMachines, struct StateMachine *co
         }
     }
 
+    HSSTicks_t const passStartTime = HSS_GetTime();
+
+    if (unlikely(!statsStartTime)) {
+        statsStartTime = passStartTime;
+    }
+
+#if IS_ENABLED(CONFIG_SCHED_READY_MASK)
+    {
+        uint64_t readyMask = BuildReadyMask_(spanOfPStateMachines, pStateMachines);
+
+#if IS_ENABLED(CONFIG_SCHED_IDLE_WFI)
+        if (!readyMask) {
+            IdleUntil_(GetIdleDeadline_(spanOfPStateMachines, pStateMachines, HSS_GetTime()));
+        }
+#endif
+
+#if IS_ENABLED(CONFIG_SCHED_PRIORITY)
+        uint64_t const highMask = GetHighPriorityMask_(spanOfPStateMachines, pStateMachines);
+#else
+        uint64_t const highMask = 0u;
+#endif
+
+        while (readyMask) {
+            uint64_t const nextMask = (readyMask & highMask) ? (readyMask & highMask) : readyMask;
+            size_t const i = (size_t)__builtin_ctzll(nextMask);
+            readyMask &= ~(1llu << i);
+
+            DispatchStateMachine_(pStateMachines[i], i, passStartTime);
+        }
+    }
+#else
     {
         size_t i = 0u;
 
+#  if IS_ENABLED(CONFIG_SCHED_PRIORITY)
+        // high priority machines first, then the rest in registry order
         for (i = 0; i < spanOfPStateMachines; ++i) {
-            struct StateMachine * const pCurrentMachine = pStateMachines[i];
+            if (SM_PRIORITY_IS_HIGH(pStateMachines[i]->priority)) {
+                DispatchStateMachine_(pStateMachines[i], i, passStartTime);
+            }
+        }
 
-            RunStateMachine(pCurrentMachine);
+        for (i = 0; i < spanOfPStateMachines; ++i) {
+            if (!SM_PRIORITY_IS_HIGH(pStateMachines[i]->priority)) {
+                DispatchStateMachine_(pStateMachines[i], i, passStartTime);
+            }
         }
+#  else
+        for (i = 0; i < spanOfPStateMachines; ++i) {
+            DispatchStateMachine_(pStateMachines[i], i, passStartTime);
+        }
+#  endif
     }
+#endif
 
     ++loopCount;
+
+    if (unlikely(!bootCompleteTime) && HSS_Trigger_IsNotified(EVENT_BOOT_COMPLETE)) {
+        bootCompleteTime = HSS_GetTime();
+        bootCompleteLoopCount = loopCount;
+        DumpSchedulerStats_();
+    }
+
     endTicks = HSS_GetTickCount();
     if (IS_ENABLED(CONFIG_DEBUG_LOOP_TIMES) || IS_ENABLED(CONFIG_DEBUG_IPI_STATS)) {
         HSSTicks_t const delta = endTicks - startTicks;
@@ -207,6 +703,7 @@ void RunStateMachines(const size_t spanOfPStateMachines, struct StateMachine *co
                         " took %" PRIu64 " tick%s (max %" PRIu64 " tick%s)\n", loopCount,
                         delta, delta == 1u ? "" : "s",
                         maxLoopTime, maxLoopTime == 1u ? "" : "s");
+                    DumpSchedulerStats_();
                 } else /* if (max_exceeded_flag) */ {
                     mHSS_DEBUG_PRINTF(LOG_WARN, "loop %" PRIu64
                         " took %" PRIu64 " tick%s (max %" PRIu64 " tick%s)\n", loopCount,
@@ -281,4 +778,139 @@ void DumpStateMachineStats(void)
             pGlobalStateMachines[i]->lastDeltaExecutionTime,
             pGlobalStateMachines[i]->state);
     }
+
+    uint64_t const passCount = loopCount - statsStartLoopCount;
+    HSSTicks_t const elapsedTime = statsStartTime ? (HSS_GetTime() - statsStartTime) : 0u;
+    uint64_t const loopsPerSec = elapsedTime ? ((passCount * TICKS_PER_SEC) / elapsedTime) : 0u;
+    uint64_t const dispatchesPerLoop = passCount ? ((dispatchCount * 100u) / passCount) : 0u;
+
+    mHSS_DEBUG_PRINTF(LOG_STATUS, " Superloop: %" PRIu64 " passes in %" PRIu64 " ms (%" PRIu64 " passes/sec),"
+        " %" PRIu64 ".%02" PRIu64 " dispatches/pass (%s)\n",
+        passCount, elapsedTime / TICKS_PER_MILLISEC, loopsPerSec,
+        dispatchesPerLoop / 100u, dispatchesPerLoop % 100u,
+        IS_ENABLED(CONFIG_SCHED_READY_MASK) ? "ready-mask" : "run-all");
+    DumpSchedulerStats_();
+    mHSS_DEBUG_PRINTF(LOG_STATUS, " State Machine Name:    Dispatches / Pct of Passes : Priority : Wake Sources\n");
+
+    for (size_t i = 0u; i < spanOfPGlobalStateMachines; i++) {
+        struct StateMachine const * const pMachine = pGlobalStateMachines[i];
+        uint32_t const sources = pMachine->wake.sources;
+        uint64_t const percentage = passCount ? ((pMachine->dispatchCount * 100u) / passCount) : 0u;
+
+        uint8_t const priority = pMachine->priority;
+        char priorityClass = 'N';
+        unsigned int priorityValue = 1u;
+
+        if (SM_PRIORITY_IS_LOW(priority)) {
+            priorityClass = 'L';
+            priorityValue = SM_PRIORITY_STRIDE(priority);
+        } else if (SM_PRIORITY_IS_HIGH(priority)) {
+            priorityClass = 'H';
+            priorityValue = 1u + SM_PRIORITY_EXTRA_RUNS(priority);
+        }
+
+        mHSS_DEBUG_PRINTF(LOG_STATUS, "%19s: % 17" PRIu64 " / % 14" PRIu64 " :    %c/% 3u : %s%s%s%s%s%s\n",
+            pMachine->pMachineName, pMachine->dispatchCount, percentage, priorityClass, priorityValue,
+            ((sources == SM_WAKE_NONE) || (sources & SM_WAKE_ALWAYS)) ? "always " : "",
+            (sources & SM_WAKE_IPI) ? "ipi " : "",
+            (sources & SM_WAKE_TRIGGER) ? "trigger " : "",
+            (sources & SM_WAKE_TIMER) ? "timer " : "",
+            (sources & SM_WAKE_POLL) ? "poll " : "",
+            (sources & SM_WAKE_TRANSITION) ? "transition" : "");
+    }
+
+    mHSS_DEBUG_PRINTF(LOG_STATUS, " State Machine Name:     Budget / Overruns : Last Overrun State\n");
+
+    for (size_t i = 0u; i < spanOfPGlobalStateMachines; i++) {
+        struct StateMachine const * const pMachine = pGlobalStateMachines[i];
+
+        if (pMachine->budget || pMachine->budgetOverrunCount) {
+            mHSS_DEBUG_PRINTF(LOG_STATUS, "%19s: % 10" PRIu64 " / % 8u : %s\n",
+                pMachine->pMachineName, pMachine->budget, pMachine->budgetOverrunCount,
+                pMachine->budgetOverrunCount ?
+                    pMachine->pStateDescs[pMachine->budgetOverrunState].pStateName : "-");
+        }
+    }
+
+#if IS_ENABLED(CONFIG_DEBUG_SM_HISTOGRAMS)
+    mHSS_DEBUG_PRINTF(LOG_STATUS, " Execution time histograms (bin N counts 2^(N-1) to 2^N-1 ticks):\n");
+
+    for (size_t i = 0u; i < spanOfPGlobalStateMachines; i++) {
+        struct StateMachine const * const pMachine = pGlobalStateMachines[i];
+
+        if (!pMachine->pHistograms) {
+            mHSS_DEBUG_PRINTF(LOG_STATUS, "%19s: not tracked\n", pMachine->pMachineName);
+            continue;
+        }
+
+        for (size_t j = 0u; j <= pMachine->numStates; j++) {
+            struct StateMachine_Histogram const * const pHistogram = &(pMachine->pHistograms[j]);
+            bool empty = true;
+
+            for (size_t bin = 0u; bin < SM_HISTOGRAM_NUM_BINS; bin++) {
+                if (pHistogram->bins[bin]) { empty = false; break; }
+            }
+
+            if (empty) { continue; }
+
+            if (j == 0u) {
+                mHSS_DEBUG_PRINTF(LOG_STATUS, "%19s:", pMachine->pMachineName);
+            } else {
+                mHSS_DEBUG_PRINTF(LOG_STATUS, "%19s:", pMachine->pStateDescs[j - 1u].pStateName);
+            }
+
+            for (size_t bin = 0u; bin < SM_HISTOGRAM_NUM_BINS; bin++) {
+                if (pHistogram->bins[bin]) {
+                    mHSS_DEBUG_PRINTF_EX(" %lu:%u", bin, pHistogram->bins[bin]);
+                }
+            }
+            mHSS_DEBUG_PRINTF_EX("\n");
+        }
+    }
+#endif
+}
+
+/**
+ * \brief Reset State Machine execution statistics
+ */
+void ResetStateMachineStats(void)
+{
+    for (size_t i = 0u; i < spanOfPGlobalStateMachines; i++) {
+        struct StateMachine * const pMachine = pGlobalStateMachines[i];
+
+        pMachine->maxExecutionTime = 0u;
+        pMachine->maxState = 0;
+        pMachine->lastDeltaExecutionTime = 0u;
+        pMachine->dispatchCount = 0u;
+        pMachine->budgetOverrunCount = 0u;
+        pMachine->budgetOverrunState = 0;
+
+        if (pMachine->pHistograms) {
+            memset(pMachine->pHistograms, 0, (1u + pMachine->numStates) * sizeof(*(pMachine->pHistograms)));
+        }
+    }
+
+    statsStartTime = HSS_GetTime();
+    statsStartLoopCount = loopCount;
+    dispatchCount = 0u;
+    maxLoopTime = 0u;
+
+#if IS_ENABLED(CONFIG_SCHED_PRIORITY)
+    extraDispatchCount = 0u;
+    strideSkipCount = 0u;
+    starvationRunCount = 0u;
+    budgetExceededCount = 0u;
+#endif
+
+#if IS_ENABLED(CONFIG_SCHED_IDLE_WFI)
+    idleCount = 0u;
+    idleTime = 0u;
+    idleTimerWakeCount = 0u;
+    idleIpiWakeCount = 0u;
+    idleExtWakeCount = 0u;
+    idleOtherWakeCount = 0u;
+    wakeLatencyMin = 0u;
+    wakeLatencyMax = 0u;
+    wakeLatencyTotal = 0u;
+#endif
 }
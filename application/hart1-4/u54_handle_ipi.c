@@ -65,6 +65,9 @@ static const struct IntentsArray
     { IPI_MSG_SCRUB },
 #endif
     { IPI_MSG_DDR_TRAIN },
+#if IS_ENABLED(CONFIG_MEMTEST_PARALLEL)
+    { IPI_MSG_MEMTEST },
+#endif
 };
 #endif
 
@@ -185,6 +185,9 @@ static uint32_t mode_register_masked_write_x5(uint32_t address);
 static uint32_t ddr_setup(void);
 static void init_ddrc(void);
 static uint8_t write_calibration_using_mtc(uint8_t num_of_lanes_to_calibrate);
+static void set_write_calibration_overrides(DDR_TYPE ddr_type);
+static uint8_t restore_write_calibration(DDR_TYPE ddr_type, uint8_t number_of_lanes);
+static void save_write_calibration(DDR_TYPE ddr_type, uint8_t number_of_lanes);
 /*static uint8_t mode_register_write(uint32_t MR_ADDR, uint32_t MR_DATA);*/
 static uint8_t MTC_test(uint8_t mask, uint64_t start_address, uint32_t size, MTC_PATTERN pattern, MTC_ADD_PATTERN add_pattern, uint32_t *error);
 #ifdef VREFDQ_CALIB
@@ -358,6 +361,7 @@ static uint32_t ddr_setup(void)
     static uint32_t dpc_vrgen_vs_value;
 #endif
     static uint32_t retry_count;
+    static uint8_t write_calibration_restored;
     static uint32_t write_latency;
     static uint32_t tip_cfg_params;
     static uint32_t dpc_bits;
@@ -416,6 +420,7 @@ static uint32_t ddr_setup(void)
             memfill((uint8_t *)&calib_data,0U,sizeof(calib_data));
             memfill((uint8_t *)&ddr_diag,0U,sizeof(ddr_diag));
             retry_count = 0U;
+            write_calibration_restored = 0U;
 #ifdef DEBUG_DDR_INIT
             (void)uprint32(g_debug_uart, "\n\r Start training. TIP_CFG_PARAMS:"\
                     , LIBERO_SETTING_TIP_CFG_PARAMS);
@@ -523,6 +528,15 @@ static uint32_t ddr_setup(void)
             delay(DELAY_CYCLES_2MS);
             retry_count++;
             ddr_diag.num_retrains = retry_count;
+            /*
+             * restored write calibration passed its own check, but training
+             * still failed, so don't offer it again on a later boot
+             */
+            if (write_calibration_restored != 0U)
+            {
+                ddr_invalidate_write_calibration();
+                write_calibration_restored = 0U;
+            }
 #ifdef DEBUG_DDR_INIT
             (void)uprint32(g_debug_uart, "\n\r\n\r DDR_TRAINING_FAIL: ",\
                         ddr_training_state);
@@ -1637,7 +1651,26 @@ static uint32_t ddr_setup(void)
 
             }
 #endif
-            ddr_training_state = DDR_TRAINING_WRITE_CALIBRATION;
+            ddr_training_state = DDR_TRAINING_RESTORE_WRITE_CALIBRATION;
+            break;
+
+        case DDR_TRAINING_RESTORE_WRITE_CALIBRATION:
+            /*
+             * If the application has kept the settings from a previous write
+             * calibration, try those first, and only sweep if they fail.
+             * Retrains always sweep.
+             */
+            number_of_lanes_to_calibrate = get_num_lanes();
+            if ((retry_count == 0U) && (restore_write_calibration(ddr_type,\
+                                        number_of_lanes_to_calibrate) == 0U))
+            {
+                write_calibration_restored = 1U;
+                ddr_training_state = DDR_SWEEP_CHECK;
+            }
+            else
+            {
+                ddr_training_state = DDR_TRAINING_WRITE_CALIBRATION;
+            }
             break;
 
         case DDR_TRAINING_WRITE_CALIBRATION:
@@ -1654,18 +1687,7 @@ static uint32_t ddr_setup(void)
             CFG_DDR_SGMII_PHY->expert_mode_en.expert_mode_en = 0x0000008U;
             if(error == 0U)
             {
-                if((ddr_type == DDR3)||(ddr_type == DDR3L)) /* Changing WPU and WPD */
-                {
-                    /* only run when ECC is on - sar121393 */
-                    if (LIBERO_SETTING_DDRPHY_MODE & DDRPHY_MODE_ECC_MASK)
-                    {
-                        CFG_DDR_SGMII_PHY->ovrt16.ovrt16 = 0x00000F80UL;
-                        CFG_DDR_SGMII_PHY->ovrt15.ovrt15 = 0x00000000UL;
-                        CFG_DDR_SGMII_PHY->ovrt14.ovrt14 = 0x00000000UL;
-                        CFG_DDR_SGMII_PHY->ovrt13.ovrt13 = 0x00000000UL;
-                        CFG_DDR_SGMII_PHY->ovrt12.ovrt12 = 0x00000000UL;
-                    }
-                }
+                set_write_calibration_overrides(ddr_type);
                 if (ddr_type == LPDDR4)
                 {
 #ifdef SWEEP_DQ_DELAY
@@ -1768,6 +1790,7 @@ static uint32_t ddr_setup(void)
             (void)uprint32(g_debug_uart, "\n\r\n\r wr calib result ",\
                     calib_data.write_cal.lane_calib_result);
 #endif
+                save_write_calibration(ddr_type, number_of_lanes_to_calibrate);
                 ddr_training_state = DDR_SWEEP_CHECK;
             }
             else if(error == MTC_TIMEOUT_ERROR)
@@ -3233,6 +3256,135 @@ static uint8_t \
     return (uint8_t)result;
 }
 
+/***************************************************************************//**
+ * set_write_calibration_overrides
+ *   IO overrides required before write calibration
+ *
+ * @param ddr_type
+ */
+static void set_write_calibration_overrides(DDR_TYPE ddr_type)
+{
+    if((ddr_type == DDR3)||(ddr_type == DDR3L)) /* Changing WPU and WPD */
+    {
+        /* only run when ECC is on - sar121393 */
+        if (LIBERO_SETTING_DDRPHY_MODE & DDRPHY_MODE_ECC_MASK)
+        {
+            CFG_DDR_SGMII_PHY->ovrt16.ovrt16 = 0x00000F80UL;
+            CFG_DDR_SGMII_PHY->ovrt15.ovrt15 = 0x00000000UL;
+            CFG_DDR_SGMII_PHY->ovrt14.ovrt14 = 0x00000000UL;
+            CFG_DDR_SGMII_PHY->ovrt13.ovrt13 = 0x00000000UL;
+            CFG_DDR_SGMII_PHY->ovrt12.ovrt12 = 0x00000000UL;
+        }
+    }
+}
+
+/***************************************************************************//**
+ * restore_write_calibration
+ *   Apply the write calibration settings returned by
+ *   ddr_restore_write_calibration(), and check them with a short MTC test on
+ *   each lane, rather than sweeping every calibration offset.
+ *
+ * @param ddr_type
+ * @param number_of_lanes
+ * @return 0 if the cached settings have been applied and passed
+ */
+static uint8_t restore_write_calibration(DDR_TYPE ddr_type, uint8_t number_of_lanes)
+{
+    mss_ddr_write_calibration_cache cache;
+    uint64_t start_address = 0x0000000000000000ULL;
+    uint32_t size = ONE_MB_MTC;
+    uint32_t default_write_latency;
+    uint32_t result = 1U;
+    uint8_t lane;
+
+    memfill((uint8_t *)&cache, 0U, sizeof(cache));
+    if ((ddr_restore_write_calibration(&cache) == 0U) ||\
+        (cache.num_lanes != number_of_lanes) || (number_of_lanes > MAX_LANES))
+    {
+        return (uint8_t)result;
+    }
+
+    CFG_DDR_SGMII_PHY->expert_mode_en.expert_mode_en = 0x0000008U;
+    set_write_calibration_overrides(ddr_type);
+
+    default_write_latency = DDRCFG->DFI.CFG_DFI_T_PHY_WRLAT.CFG_DFI_T_PHY_WRLAT;
+    DDRCFG->DFI.CFG_DFI_T_PHY_WRLAT.CFG_DFI_T_PHY_WRLAT = cache.write_latency;
+
+    if (ddr_type == LPDDR4)
+    {
+        CFG_DDR_SGMII_PHY->rpc220.rpc220 = cache.dq_load;
+        for(lane = 0U; lane < number_of_lanes; lane++)
+        {
+            load_dq(lane);
+        }
+        delay(DELAY_CYCLES_50_MICRO);
+    }
+
+    calib_data.write_cal.status_lower = 0U;
+    for(lane = 0U; lane < number_of_lanes; lane++)
+    {
+        calib_data.write_cal.lower[lane] = cache.lower[lane];
+        calib_data.write_cal.status_lower |= (0x01U<<lane);
+    }
+    set_write_calib(number_of_lanes);
+
+    result = 0U;
+    for(lane = 0U; lane < number_of_lanes; lane++)
+    {
+        uint8_t mask = (uint8_t)(1U<<lane);
+        uint32_t lane_result = 0U;
+
+        /* first MTC read flushes the MTC, as in write_calibration_using_mtc() */
+        lane_result = MTC_test(mask, start_address, size, MTC_COUNTING_PATTERN, MTC_ADD_SEQUENTIAL, &lane_result);
+        if(lane_result == 0U)
+        {
+            lane_result |= MTC_test(mask, start_address, size, MTC_PSEUDO_RANDOM, MTC_ADD_SEQUENTIAL, &lane_result);
+            lane_result |= MTC_test(mask, start_address, size, MTC_WALKING_ONE, MTC_ADD_SEQUENTIAL, &lane_result);
+        }
+        result |= lane_result;
+    }
+
+    if ((result != 0U) ||\
+        (calib_data.write_cal.lane_calib_result != cache.lane_calib_result))
+    {
+        /* fall back to a full write calibration from the default latency */
+        memfill((uint8_t *)&calib_data,0U,sizeof(calib_data));
+        DDRCFG->DFI.CFG_DFI_T_PHY_WRLAT.CFG_DFI_T_PHY_WRLAT = default_write_latency;
+        result = 1U;
+    }
+#ifdef DEBUG_DDR_INIT
+    (void)uprint32(g_debug_uart, "\n\r\n\r restored wr calib result ", result);
+#endif
+
+    return (uint8_t)result;
+}
+
+/***************************************************************************//**
+ * save_write_calibration
+ *   Pass the settings from a successful write calibration to
+ *   ddr_save_write_calibration()
+ *
+ * @param ddr_type
+ * @param number_of_lanes
+ */
+static void save_write_calibration(DDR_TYPE ddr_type, uint8_t number_of_lanes)
+{
+    mss_ddr_write_calibration_cache cache;
+    uint8_t lane;
+
+    memfill((uint8_t *)&cache, 0U, sizeof(cache));
+    cache.write_latency = DDRCFG->DFI.CFG_DFI_T_PHY_WRLAT.CFG_DFI_T_PHY_WRLAT;
+    cache.dq_load = (ddr_type == LPDDR4) ? CFG_DDR_SGMII_PHY->rpc220.rpc220 : 0U;
+    cache.lane_calib_result = calib_data.write_cal.lane_calib_result;
+    cache.num_lanes = number_of_lanes;
+    for(lane = 0U; (lane < number_of_lanes) && (lane < MAX_LANES); lane++)
+    {
+        cache.lower[lane] = calib_data.write_cal.lower[lane];
+    }
+
+    ddr_save_write_calibration(&cache);
+}
+
 
 /**
  * MODE register write
@@ -4442,6 +4594,24 @@ void setup_ddr_segments(SEG_SETUP option)
     SEG[0].u[7].raw = 0x01U;
 }
 
+/**
+ *  Application can create own functions to keep write calibration settings
+ */
+__attribute__((weak)) uint8_t ddr_restore_write_calibration(mss_ddr_write_calibration_cache *p_cache)
+{
+    (void)p_cache;
+    return 0U;
+}
+
+__attribute__((weak)) void ddr_save_write_calibration(const mss_ddr_write_calibration_cache *p_cache)
+{
+    (void)p_cache;
+}
+
+__attribute__((weak)) void ddr_invalidate_write_calibration(void)
+{
+}
+
 /**
  * Clear cache ways used buring boot.
  * These are the ways associated with the PDMA and the current hart being run
@@ -1066,6 +1066,7 @@ typedef enum DDR_TRAINING_SM_
     DDR_TRAINING_IP_SM_DQ_DQS,
     DDR_TRAINING_IP_SM_VERIFY,
     DDR_TRAINING_SET_FINAL_MODE,
+    DDR_TRAINING_RESTORE_WRITE_CALIBRATION, /*!< Try cached calibration */
     DDR_TRAINING_WRITE_CALIBRATION,
     DDR_TRAINING_WRITE_CALIBRATION_RETRY, /*!< Retry on calibration fail */
     DDR_SWEEP_CHECK,
@@ -1230,6 +1231,18 @@ typedef struct mss_ddr_calibration_{
     mss_ddr_vref mem_vref;
 } mss_ddr_calibration;
 
+/***************************************************************************//**
+  Write calibration settings, as passed to ddr_save_write_calibration() after a
+  successful write calibration, and returned by ddr_restore_write_calibration()
+ */
+typedef struct mss_ddr_write_calibration_cache_{
+    uint32_t    write_latency;      /* CFG_DFI_T_PHY_WRLAT */
+    uint32_t    dq_load;            /* rpc220, LPDDR4 only */
+    uint32_t    lane_calib_result;  /* expert_wrcalib */
+    uint32_t    lower[MAX_LANES];
+    uint32_t    num_lanes;
+} mss_ddr_write_calibration_cache;
+
 /***************************************************************************//**
   sweep index's
  */
@@ -1279,6 +1292,54 @@ uint8_t MSS_DDR_training(uint8_t ddr_type);
  */
 uint32_t ddr_state_machine(DDR_SS_COMMAND command);
 
+/***************************************************************************//**
+  The ddr_restore_write_calibration() function is called before write
+  calibration. Application can create own function to return the settings from
+  a previous successful write calibration, e.g. from non-volatile storage.
+
+  If it returns non-zero, the settings are applied and checked using a short
+  MTC test. If the check fails, the full write calibration sweep is run.
+
+  @return
+    non-zero if p_cache has been filled in
+
+  Example:
+  @code
+
+    uint8_t ddr_restore_write_calibration(mss_ddr_write_calibration_cache *p_cache)
+    {
+        return read_from_nvm(p_cache, sizeof(*p_cache));
+    }
+
+  @endcode
+
+ */
+uint8_t ddr_restore_write_calibration(mss_ddr_write_calibration_cache *p_cache);
+
+/***************************************************************************//**
+  The ddr_save_write_calibration() function is called after a full write
+  calibration sweep has succeeded. Application can create own function to store
+  the settings for ddr_restore_write_calibration() to return on a later boot.
+
+  @return
+    none
+
+ */
+void ddr_save_write_calibration(const mss_ddr_write_calibration_cache *p_cache);
+
+/***************************************************************************//**
+  The ddr_invalidate_write_calibration() function is called if training fails
+  after settings returned by ddr_restore_write_calibration() have passed their
+  check. Application can create own function to discard the stored settings, so
+  that they are not returned again. The retrain runs a full write calibration
+  sweep.
+
+  @return
+    none
+
+ */
+void ddr_invalidate_write_calibration(void);
+
 /***************************************************************************//**
   The setup_ddr_segments() sets up seg regs
 
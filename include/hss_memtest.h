@@ -41,6 +41,24 @@ bool HSS_MemTestDDRFast(void);
 bool HSS_MemTestDDRFull(void);
 bool HSS_MemTestDDR_Ex(volatile uint64_t *baseAddr, size_t numBytes);
 
+#include "hss_memtest_march.h"
+
+/**
+ * Runs a March or walking ones burst test over each background in patternMask (a bitmask of
+ * indices into HSS_MemTest_Patterns[]), reporting throughput and failing address and bit
+ * statistics
+ */
+bool HSS_MemTestMarch(enum HSS_MemTest_Algorithm algorithm, uint32_t patternMask,
+    volatile uint64_t *baseAddr, size_t numBytes);
+
+#if IS_ENABLED(CONFIG_MEMTEST_PARALLEL)
+#  include "ssmb_ipi.h"
+
+bool HSS_MemTestDDRParallel(volatile uint64_t *baseAddr, size_t numBytes);
+enum IPIStatusCode HSS_MemTest_IPIHandler(TxId_t transaction_id, enum HSSHartId source,
+    uint32_t immediate_arg, void *p_extended_buffer_in_ddr, void *p_ancilliary_buffer_in_ddr);
+#endif
+
 #ifdef __cplusplus
 }
 #endif
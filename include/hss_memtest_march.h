@@ -0,0 +1,79 @@
+#ifndef HSS_MEMTEST_MARCH_H
+#define HSS_MEMTEST_MARCH_H
+
+/*******************************************************************************
+ * Copyright 2019-2025 Microchip FPGA Embedded Systems Solutions.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * MPFS HSS Embedded Software
+ *
+ */
+
+/**
+ * \file March Memory Test Engine
+ * \brief March C- / March SS and walking ones burst memory test engine
+ *
+ * The engine depends only on hss_types.h, so that it can be built on a host. All
+ * memory accesses go through mMEMTEST_READ() and mMEMTEST_WRITE(), which a host
+ * build can define to simulate a faulty memory.
+ */
+
+#include "hss_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+enum HSS_MemTest_Algorithm {
+    MEMTEST_MARCH_C_MINUS,
+    MEMTEST_MARCH_SS,
+    MEMTEST_WALKING_ONES_BURST,
+    MEMTEST_NUM_ALGORITHMS
+};
+
+struct HSS_MemTest_Pattern {
+    char const * const name;
+    uint64_t const background;
+};
+
+extern const struct HSS_MemTest_Pattern HSS_MemTest_Patterns[];
+extern const size_t HSS_MemTest_NumPatterns;
+
+struct HSS_MemTest_Stats {
+    size_t errorCount;
+    uintptr_t firstErrorAddr;
+    uint64_t firstErrorValue;
+    uint64_t firstErrorExpected;
+    uintptr_t lowestErrorAddr;
+    uintptr_t highestErrorAddr;
+    uint64_t failingBits;           // OR of all failing bits
+    uint32_t bitErrorCount[64];     // number of errors per bit position
+    uint64_t bytesAccessed;         // reads plus writes
+    bool aborted;
+};
+
+/**
+ * Progress callback, called every so many words with the work done so far out of
+ * the total, in words accessed. Returning true aborts the test.
+ */
+typedef bool (*HSS_MemTest_PollFn_t)(void *pContext, size_t wordsDone, size_t wordsTotal);
+
+char const *HSS_MemTest_GetAlgorithmName(enum HSS_MemTest_Algorithm algorithm);
+
+void HSS_MemTest_ResetStats(struct HSS_MemTest_Stats *pStats);
+
+/**
+ * Runs a test over numWords 64-bit words from baseAddr, accumulating into pStats.
+ * The background is only used by the March tests. Returns true if no errors were
+ * found and the test was not aborted.
+ */
+bool HSS_MemTest_Run(enum HSS_MemTest_Algorithm algorithm, uint64_t background,
+    volatile uint64_t *baseAddr, size_t numWords, struct HSS_MemTest_Stats *pStats,
+    HSS_MemTest_PollFn_t pPollFn, void *pContext);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
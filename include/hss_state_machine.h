@@ -40,6 +40,7 @@ extern "C" {
 #endif
 
 #include "hss_clock.h"
+#include "hss_trigger.h"
 
 struct StateMachine;
 
@@ -59,6 +60,89 @@ struct StateDesc {
     void (*state_handler)(struct StateMachine *pMyMachine);
 };
 
+/**
+ * \brief State Machine Wake Sources
+ *
+ * With CONFIG_SCHED_READY_MASK enabled, a state machine may declare what it is
+ * waiting on while it sits in its sleep state, and the superloop will only
+ * dispatch it when one of those sources is pending. A machine that declares no
+ * wake sources (or SM_WAKE_ALWAYS) is dispatched on every pass, as before.
+ *
+ * Regardless of the declared sources, a machine is always dispatched while it
+ * is outside its sleep state, or when a state transition is pending.
+ *
+ * With CONFIG_SCHED_IDLE_WFI enabled, the E51 sleeps in WFI when no machine is
+ * ready, until the nearest timer wake, an IPI, or an external interrupt. Poll
+ * callbacks cannot raise an interrupt, so they are re-evaluated every
+ * CONFIG_SCHED_IDLE_WFI_POLL_INTERVAL_US while idle.
+ */
+#define SM_WAKE_NONE                 (0u)
+#define SM_WAKE_ALWAYS               (1u << 0)
+#define SM_WAKE_IPI                  (1u << 1)
+#define SM_WAKE_TRIGGER              (1u << 2)
+#define SM_WAKE_TIMER                (1u << 3)
+#define SM_WAKE_TRANSITION           (1u << 4) //!< sleep state is only left by an external state change
+#define SM_WAKE_POLL                 (1u << 5) //!< woken when the poll callback returns true
+
+#define SM_WAKE_IPI_TYPE(msgType)    (1u << (unsigned int)(msgType))
+#define SM_WAKE_IPI_HART(hartId)     (1u << (unsigned int)(hartId))
+#define SM_WAKE_EVENT(event)         HSS_TRIGGER_EVENT(event)
+
+struct StateMachine_Wake {
+    uint32_t sources;                //!< bitmask of SM_WAKE_xxx
+    stateType_t sleepState;          //!< state in which dispatch is gated by the wake sources
+    uint32_t ipiTypes;               //!< bitmask of SM_WAKE_IPI_TYPE(enum IPIMessagesEnum)
+    uint32_t ipiHarts;               //!< bitmask of SM_WAKE_IPI_HART(enum HSSHartId) senders (0 => any U54)
+    uint64_t events;                 //!< bitmask of SM_WAKE_EVENT(enum HSS_Event)
+    HSSTicks_t period;               //!< timer wake period, in HSS_GetTime() ticks
+    bool (*poll)(void);              //!< cheap readiness check for SM_WAKE_POLL (e.g. UART RX)
+    struct HSS_Trigger_Waiter waiter; //!< registered with the trigger subsystem for SM_WAKE_TRIGGER
+};
+
+/**
+ * \brief State Machine Priorities
+ *
+ * With CONFIG_SCHED_PRIORITY enabled, the priority field selects how often a
+ * state machine is dispatched:
+ *  - SM_PRIORITY_NORMAL: once per superloop pass (the default)
+ *  - SM_PRIORITY_HIGH(n): first in each pass, and up to n additional times per pass
+ *    while it has pending work
+ *  - SM_PRIORITY_LOW(n): once every n passes
+ *
+ * A high priority machine has pending work when a state transition is pending, when
+ * one of its wake sources has fired, or while it is in one of its busyStates, in which
+ * each dispatch makes progress on its own (e.g. copying the next boot sub-chunk).
+ *
+ * Without CONFIG_SCHED_PRIORITY, every machine is treated as SM_PRIORITY_NORMAL.
+ */
+#define SM_PRIORITY_LOW_FLAG         (0x80u)
+#define SM_PRIORITY_VALUE_MASK       (0x7Fu)
+
+#define SM_PRIORITY_NORMAL           ((uint8_t)0u)
+#define SM_PRIORITY_HIGH(extraRuns)  ((uint8_t)((extraRuns) & SM_PRIORITY_VALUE_MASK))
+#define SM_PRIORITY_LOW(stride)      ((uint8_t)(SM_PRIORITY_LOW_FLAG | ((stride) & SM_PRIORITY_VALUE_MASK)))
+#define SM_PRIORITY_TOP              SM_PRIORITY_HIGH(3u)
+
+#define SM_PRIORITY_IS_LOW(p)        (((p) & SM_PRIORITY_LOW_FLAG) && ((p) & SM_PRIORITY_VALUE_MASK))
+#define SM_PRIORITY_IS_HIGH(p)       (!((p) & SM_PRIORITY_LOW_FLAG) && ((p) & SM_PRIORITY_VALUE_MASK))
+#define SM_PRIORITY_STRIDE(p)        ((unsigned int)((p) & SM_PRIORITY_VALUE_MASK))
+#define SM_PRIORITY_EXTRA_RUNS(p)    ((unsigned int)((p) & SM_PRIORITY_VALUE_MASK))
+
+#define SM_STATE_BIT(state)          (1llu << (unsigned int)(state))
+
+/**
+ * \brief State Machine Execution Time Histogram
+ *
+ * Bin 0 counts calls which took less than one tick, and bin N (N > 0) counts
+ * calls which took between 2^(N-1) and 2^N - 1 ticks. The last bin also
+ * includes everything longer.
+ */
+#define SM_HISTOGRAM_NUM_BINS        (16u)
+
+struct StateMachine_Histogram {
+    uint32_t bins[SM_HISTOGRAM_NUM_BINS];
+};
+
 /**
  * \brief StateMachine Structure
  *
@@ -81,7 +165,14 @@ struct StateMachine {
     struct StateDesc const * const pStateDescs;
     bool debugFlag;
     uint8_t priority;
+    uint64_t busyStates;                              //!< bitmask of SM_STATE_BIT(state), see SM_PRIORITY_HIGH
     void *pInstanceData;
+    struct StateMachine_Wake wake;
+    uint64_t dispatchCount;
+    HSSTicks_t budget;                                //!< per-call time budget, in HSS_GetTime() ticks (0 => none)
+    uint32_t budgetOverrunCount;
+    stateType_t budgetOverrunState;
+    struct StateMachine_Histogram *pHistograms;       //!< [0] whole machine, [1 + state] per state
 };
 
 #define SM_INVALID_STATE ((stateType_t)-1)
@@ -113,4 +204,5 @@ uint64_t GetStateMachinesExecutionCount(void);
 void RunInitFunctions(const size_t spanOfInitFunctions, const struct InitFunction initFunctions[]);
 
 void DumpStateMachineStats(void);
+void ResetStateMachineStats(void);
 #endif
@@ -22,10 +22,36 @@ enum HSS_Event {
     EVENT_BOOT_COMPLETE,
     EVENT_HART_STATE_CHANGED,
     EVENT_HEALTHMON,
+    EVENT_NUM_EVENTS
+};
+
+#define HSS_TRIGGER_EVENT(event) (1llu << (unsigned int)(event))
+
+/**
+ * \brief Trigger Waiter
+ *
+ * Events are held as bits in a single 64-bit event word. Most events latch
+ * until cleared, but some (such as EVENT_HART_STATE_CHANGED) are pulses that
+ * are never visible in the event word. A registered waiter accumulates every
+ * notification of an event in its mask, latched or pulsed, in pendingMask
+ * until consumed.
+ */
+struct HSS_Trigger_Waiter {
+    uint64_t eventMask;                      //!< events of interest
+    volatile uint64_t pendingMask;           //!< events notified since last consumed
+    struct HSS_Trigger_Waiter *pNext;
+    bool registered;
 };
 
 void HSS_Trigger_Notify(enum HSS_Event event);
 bool HSS_Trigger_IsNotified(enum HSS_Event event);
 void HSS_Trigger_Clear(enum HSS_Event event);
 
+uint64_t HSS_Trigger_GetEvents(void);
+uint64_t HSS_Trigger_GetFirstNotifyTime(enum HSS_Event event);
+void HSS_Trigger_Wait(struct HSS_Trigger_Waiter *pWaiter, uint64_t eventMask);
+bool HSS_Trigger_IsWaiterReady(struct HSS_Trigger_Waiter const *pWaiter);
+uint64_t HSS_Trigger_Consume(struct HSS_Trigger_Waiter *pWaiter);
+void HSS_Trigger_DumpTimeline(void);
+
 #endif
@@ -57,8 +57,11 @@ extern "C" {
 
 #define mHSS_BOOT_MAGIC		(0xB007C0DEu)
 #define mHSS_COMPRESSED_MAGIC	(0xC08B8355u)
+#define mHSS_DELTA_MAGIC	(0xDE17A0C5u)
+#define mHSS_MERKLE_MAGIC	(0x7EE5EAF5u)
 
 #define mHSS_BOOT_VERSION       1u
+#define mHSS_BOOT_VERSION_MERKLE 2u
 
 #ifndef CONFIG_OPENSBI
 #  ifndef MIN
@@ -200,6 +203,39 @@ struct HSS_BootImage {
 };
 
 
+/**
+ * \brief Merkle Table Structure
+ *
+ * A boot image of version mHSS_BOOT_VERSION_MERKLE has this table immediately after
+ * the HSS_BootImage header, ahead of the chunk table. It holds the root of a
+ * hash tree over the chunks, and locates the leaf table at the end of the header region,
+ * which has a SHA-384 hash (leaf) per chunk, in chunk table order.
+ *
+ * For these images, the signature only covers the start of the image up to the leaf
+ * table (i.e. the header, this table including the root, and the chunk and ZI chunk
+ * tables), rather than the entire image. The leaves are checked against the root, and
+ * each chunk can then be checked against its leaf as it is copied into place, so that
+ * the whole image does not have to be hashed before any hart can boot.
+ *
+ * leaf = SHA384(MERKLE_LEAF_PREFIX || chunk data)
+ * node = SHA384(MERKLE_NODE_PREFIX || left || right)
+ *
+ * Leaves are paired in order at each level of the tree, and a node left over at the
+ * end of a level is carried up to the next level unchanged.
+ */
+#define MERKLE_HASH_LEN         (48u)
+#define MERKLE_LEAF_PREFIX      (0x00u)
+#define MERKLE_NODE_PREFIX      (0x01u)
+
+struct HSS_MerkleTable {
+    uint32_t magic;
+    uint32_t reserved;
+    size_t numLeaves;       // one per chunk, not counting the sentinel
+    size_t leafTableOffset; // from the start of the boot image; also the end of the signed region
+    uint8_t root[MERKLE_HASH_LEN];
+};
+
+
 /**
  * \brief Compressed Image Structure
  *
@@ -221,6 +257,40 @@ struct HSS_CompressedImage {
 #endif
 };
 
+/**
+ * \brief Delta Image Structure
+ *
+ * A delta image patches one boot image (the base) into another. It holds a table of
+ * records, each of which either copies a range of the base image (e.g. a chunk that
+ * has moved) or a range of the delta image itself into the new image. Anything not
+ * covered by a record is unchanged from the base image. Records are applied in order.
+ */
+#define DELTA_RECORD_COPY_BASE  (0u)
+#define DELTA_RECORD_COPY_DELTA (1u)
+
+struct HSS_DeltaRecord {
+    uint32_t type;
+    uint32_t reserved;
+    size_t dstOffset;       // offset in the new image
+    size_t srcOffset;       // offset in the base image, or in the delta image
+    size_t size;
+};
+
+struct HSS_DeltaImage {
+    uint32_t magic;
+    uint32_t version;
+    size_t headerLength;
+    uint32_t headerCrc;
+    uint32_t bodyCrc;       // everything after the header
+    size_t deltaImageLength;
+    uint32_t baseImageCrc;
+    uint32_t newImageCrc;
+    size_t baseImageLength;
+    size_t newImageLength;
+    size_t recordTableOffset;
+    size_t numRecords;
+};
+
 struct HSS_Storage;
 typedef bool (* HSS_GetBootImageFnPtr_t)(struct HSS_Storage *pStorage, struct HSS_BootImage **ppBootImage);
 struct HSS_Storage {
@@ -234,6 +304,7 @@ struct HSS_Storage {
 };
 
 #define mHSS_COMPRESSED_VERSION_DEFLATE  1u
+#define mHSS_DELTA_VERSION               1u
 
 
 #ifdef __cplusplus
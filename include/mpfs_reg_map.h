@@ -51,6 +51,7 @@ extern "C" {
 #define CLINT_MSIP_U54_2_OFFSET                 (0x0008u)
 #define CLINT_MSIP_U54_3_OFFSET                 (0x000Cu)
 #define CLINT_MSIP_U54_4_OFFSET                 (0x0010u)
+#define CLINT_MTIMECMP_E51_0_OFFSET             (0x4000u)
 #define CLINT_MTIME_OFFSET                      (0xBFF8u)
 
 #define L2_CACHE_CTRL_BASE_ADDR                 (0x02010000u)
@@ -37,6 +37,7 @@ extern "C" {
 int uart_putstring(int hartid, char *p);
 ssize_t uart_getline(char **pBuffer, size_t *pBufLen);
 bool uart_getchar(uint8_t *pbuf, int32_t timeout_sec, bool do_sec_tick);
+bool uart_rx_ready(void);
 void uart_putc(int hartid, const char ch);
 
 void *HSS_UART_GetInstance(int hartid);
@@ -50,6 +50,7 @@
 #include "hss_state_machine.h"
 #include "hss_debug.h"
 #include "hss_perfctr.h"
+#include "hss_timeline.h"
 
 #include <string.h>
 #include <assert.h>
@@ -81,6 +82,10 @@ static bool tryBootFunction_(struct HSS_Storage *pStorage, HSS_GetBootImageFnPtr
 
 static bool getBootImageFromQSPI_(struct HSS_Storage *pStorage, struct HSS_BootImage **ppBootImage);
 static bool getBootImageFromMMC_(struct HSS_Storage *pStorage, struct HSS_BootImage **ppBootImage);
+#if IS_ENABLED(CONFIG_SERVICE_BOOT) && IS_ENABLED(CONFIG_SERVICE_MMC) && IS_ENABLED(CONFIG_SERVICE_BOOT_MMC_USE_GPT)
+static bool getMMCBootPartitionLBAOffset_(struct HSS_Storage *pStorage, uint32_t blockSize, size_t *pSrcLBAOffset,
+    size_t *pLBACount);
+#endif
 static bool getBootImageFromSpiFlash_(struct HSS_Storage *pStorage, struct HSS_BootImage **ppBootImage);
 static bool getBootImageFromPayload_(struct HSS_Storage *pStorage, struct HSS_BootImage **ppBootImage);
 
@@ -171,6 +176,39 @@ struct HSS_Storage *HSS_BootGetActiveStorage(void)
     return pResult;
 }
 
+//
+// the boot image is at the start of storage, except on MMC, where it may instead be
+// in a GPT partition... in which case, as at boot, offset 0 is the fallback
+//
+// *pImageSpace is set to the size of that partition, or to 0 if the image may extend
+// to the end of storage
+//
+size_t HSS_BootGetImageOffset(struct HSS_Storage *pStorage, size_t *pImageSpace);
+size_t HSS_BootGetImageOffset(struct HSS_Storage *pStorage, size_t *pImageSpace)
+{
+    size_t result = 0u;
+
+    assert(pImageSpace);
+    *pImageSpace = 0u;
+
+#if IS_ENABLED(CONFIG_SERVICE_BOOT) && IS_ENABLED(CONFIG_SERVICE_MMC) && IS_ENABLED(CONFIG_SERVICE_BOOT_MMC_USE_GPT)
+    if (pStorage == &mmcStorage_) {
+        uint32_t blockSize, eraseSize, blockCount;
+        size_t srcLBAOffset = 0u, lbaCount = 0u;
+
+        pStorage->getInfo(&blockSize, &eraseSize, &blockCount);
+        if (getMMCBootPartitionLBAOffset_(pStorage, blockSize, &srcLBAOffset, &lbaCount)) {
+            result = srcLBAOffset * blockSize;
+            *pImageSpace = lbaCount * blockSize;
+        }
+    }
+#else
+    (void)pStorage;
+#endif
+
+    return result;
+}
+
 void HSS_BootListStorageProviders(void)
 {
     for (uint32_t i = 0; i < ARRAY_SIZE(pStorages); i++) {
@@ -208,7 +246,11 @@ bool HSS_BootInit(void)
     HSS_PerfCtr_Allocate(&perf_ctr_index, "Boot Image Init");
 
     if (pDefaultStorage) {
-        if (pDefaultStorage->init) { result = pDefaultStorage->init(); }
+        if (pDefaultStorage->init) {
+            HSS_Timeline_Begin(TIMELINE_STORAGE_INIT, HSS_HART_E51);
+            result = pDefaultStorage->init();
+            HSS_Timeline_End(TIMELINE_STORAGE_INIT, HSS_HART_E51);
+        }
         if (result) {
             result = tryBootFunction_(pDefaultStorage, pDefaultStorage->getBootImage);
         }
@@ -217,7 +259,9 @@ bool HSS_BootInit(void)
             mHSS_DEBUG_PRINTF(LOG_NORMAL, "Trying to get boot image via %s ...\n", pStorages[i]->name);
 
             if (pStorages[i]->init) {
+                HSS_Timeline_Begin(TIMELINE_STORAGE_INIT, HSS_HART_E51);
                 result = pStorages[i]->init();
+                HSS_Timeline_End(TIMELINE_STORAGE_INIT, HSS_HART_E51);
             } else {
                 result = true;
             }
@@ -261,7 +305,14 @@ bool tryBootFunction_(struct HSS_Storage *pStorage, HSS_GetBootImageFnPtr_t cons
         void* const pInput = (void*)pBootImage;
         void * const pOutputInDDR = (void *)(CONFIG_SERVICE_BOOT_DDR_TARGET_ADDR);
 
+        static int perf_ctr_index = PERF_CTR_UNINITIALIZED;
+        HSS_PerfCtr_Allocate(&perf_ctr_index, "Boot Image Decompress");
+        HSS_PerfCtr_Start(perf_ctr_index);
+        HSS_Timeline_Begin(TIMELINE_DECOMPRESS, HSS_HART_E51);
+
         int outputSize = HSS_Decompress(pInput, pOutputInDDR);
+        HSS_PerfCtr_Lap(perf_ctr_index);
+        HSS_Timeline_End(TIMELINE_DECOMPRESS, HSS_HART_E51);
         mHSS_DEBUG_PRINTF(LOG_NORMAL, "decompressed %d bytes ...\n", outputSize);
 
         if (outputSize) {
@@ -316,6 +367,54 @@ static bool copyBootImageToDDR_(struct HSS_BootImage *pBootImage, char *pDest,
 }
 #endif
 
+#if IS_ENABLED(CONFIG_SERVICE_BOOT) && IS_ENABLED(CONFIG_SERVICE_MMC) && IS_ENABLED(CONFIG_SERVICE_BOOT_MMC_USE_GPT)
+static bool getMMCBootPartitionLBAOffset_(struct HSS_Storage *pStorage, uint32_t blockSize, size_t *pSrcLBAOffset,
+    size_t *pLBACount)
+{
+    bool result = false;
+    HSS_GPT_t gpt;
+
+    HSS_Timeline_Begin(TIMELINE_GPT, HSS_HART_E51);
+    gpt.lbaSize = blockSize;
+    GPT_Init(&gpt, pStorage);
+    result = GPT_ReadHeader(&gpt);
+
+    if (result) {
+        size_t srcIndex = 0u;
+
+        if (GPT_GetBootPartitionIndex(&gpt, &srcIndex)) {
+            mHSS_DEBUG_PRINTF(LOG_WARN, "Using manually set partition index\n");
+        } else {
+            result = GPT_FindBootSectorIndex(&gpt, &srcIndex, NULL);
+
+            if (!result) {
+                mHSS_DEBUG_PRINTF(LOG_ERROR, "GPT_FindBootSectorIndex() failed\n");
+            } else {
+                mHSS_DEBUG_PRINTF(LOG_NORMAL, "Boot Partition found at index %lu\n",
+                    srcIndex);
+            }
+        }
+
+        if (result) {
+            result = GPT_PartitionIdToLBAOffset(&gpt, srcIndex, pSrcLBAOffset);
+        }
+
+        if (result && pLBACount) {
+            HSS_GPT_PartitionEntry_t const *pGptPartitionEntry = NULL;
+
+            result = GPT_ReadPartitionEntryByIndex(&gpt, srcIndex, &pGptPartitionEntry)
+                && (pGptPartitionEntry->lastLBA >= pGptPartitionEntry->firstLBA);
+            if (result) {
+                *pLBACount = (size_t)(pGptPartitionEntry->lastLBA - pGptPartitionEntry->firstLBA + 1u);
+            }
+        }
+    }
+    HSS_Timeline_End(TIMELINE_GPT, HSS_HART_E51);
+
+    return result;
+}
+#endif
+
 static bool getBootImageFromMMC_(struct HSS_Storage *pStorage, struct HSS_BootImage **ppBootImage)
 {
     bool result = false;
@@ -334,34 +433,7 @@ static bool getBootImageFromMMC_(struct HSS_Storage *pStorage, struct HSS_BootIm
     pStorage->getInfo(&blockSize, &eraseSize, &blockCount);
 
 # if (IS_ENABLED(CONFIG_SERVICE_BOOT_MMC_USE_GPT))
-    {
-        HSS_GPT_t gpt;
-
-        gpt.lbaSize = blockSize;
-        GPT_Init(&gpt, pStorage);
-        result = GPT_ReadHeader(&gpt);
-
-        if (result) {
-            size_t srcIndex = 0u;
-
-            if (GPT_GetBootPartitionIndex(&gpt, &srcIndex)) {
-                mHSS_DEBUG_PRINTF(LOG_WARN, "Using manually set partition index\n");
-            } else {
-                result = GPT_FindBootSectorIndex(&gpt, &srcIndex, NULL);
-
-                if (!result) {
-                    mHSS_DEBUG_PRINTF(LOG_ERROR, "GPT_FindBootSectorIndex() failed\n");
-                } else {
-                    mHSS_DEBUG_PRINTF(LOG_NORMAL, "Boot Partition found at index %lu\n",
-                        srcIndex);
-                }
-            }
-
-            if (result) {
-                result = GPT_PartitionIdToLBAOffset(&gpt, srcIndex, &srcLBAOffset);
-            }
-        }
-    }
+    result = getMMCBootPartitionLBAOffset_(pStorage, blockSize, &srcLBAOffset, NULL);
 
     if (!result) {
         mHSS_DEBUG_PRINTF(LOG_WARN, "GPT_PartitionIdToLBAOffset() failed - using offset %lu\n", srcLBAOffset);
@@ -389,6 +461,7 @@ static bool getBootImageFromMMC_(struct HSS_Storage *pStorage, struct HSS_BootIm
             } else {
                 int perf_ctr_index = PERF_CTR_UNINITIALIZED;
                 HSS_PerfCtr_Allocate(&perf_ctr_index, "Boot Image MMC Copy");
+                HSS_Timeline_Begin(TIMELINE_IMAGE_COPY, HSS_HART_E51);
 
                 result = copyBootImageToDDR_(&bootImage,
                     (char *)(CONFIG_SERVICE_BOOT_DDR_TARGET_ADDR), srcLBAOffset * blockSize,
@@ -396,6 +469,7 @@ static bool getBootImageFromMMC_(struct HSS_Storage *pStorage, struct HSS_BootIm
                 *ppBootImage = (struct HSS_BootImage *)(CONFIG_SERVICE_BOOT_DDR_TARGET_ADDR);
 
                 HSS_PerfCtr_Lap(perf_ctr_index);
+                HSS_Timeline_End(TIMELINE_IMAGE_COPY, HSS_HART_E51);
 
                 if (!result) {
                      mHSS_DEBUG_PRINTF(LOG_ERROR, "copyBootImageToDDR_() failed\n");
@@ -480,6 +554,7 @@ static bool getBootImageFromQSPI_(struct HSS_Storage *pStorage, struct HSS_BootI
         } else {
             int perf_ctr_index = PERF_CTR_UNINITIALIZED;
             HSS_PerfCtr_Allocate(&perf_ctr_index, "Boot Image QSPI Copy");
+            HSS_Timeline_Begin(TIMELINE_IMAGE_COPY, HSS_HART_E51);
 
             result = copyBootImageToDDR_(&bootImage,
                 (char *)(CONFIG_SERVICE_BOOT_DDR_TARGET_ADDR), srcLBAOffset * blockSize,
@@ -487,6 +562,7 @@ static bool getBootImageFromQSPI_(struct HSS_Storage *pStorage, struct HSS_BootI
             *ppBootImage = (struct HSS_BootImage *)(CONFIG_SERVICE_BOOT_DDR_TARGET_ADDR);
 
             HSS_PerfCtr_Lap(perf_ctr_index);
+            HSS_Timeline_End(TIMELINE_IMAGE_COPY, HSS_HART_E51);
 
             if (!result) {
                  mHSS_DEBUG_PRINTF(LOG_ERROR, "copyBootImageToDDR_() failed\n");
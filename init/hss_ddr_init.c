@@ -17,6 +17,7 @@
 
 #include "hss_debug.h"
 #include "hss_perfctr.h"
+#include "hss_timeline.h"
 #include "hss_clock.h"
 #include "hss_progress.h"
 
@@ -30,6 +31,11 @@
 
 #include "hss_init.h"
 
+#if IS_ENABLED(CONFIG_DDR_TRAINING_CACHE)
+#  include "hss_crc32.h"
+#  include "mss_sys_services.h"
+#endif
+
 /*!
  * \brief DDR Training
  *
@@ -165,6 +171,139 @@ bool HSS_DDRPrintL2CacheWayMasks(void)
     return true;
 }
 
+#if IS_ENABLED(CONFIG_DDR_TRAINING_CACHE)
+/*!
+ * \brief DDR Write Calibration Cache
+ *
+ * The write calibration sweep is the longest software-driven part of DDR training.
+ * After a full sweep succeeds, its results are kept in an sNVM page, with a CRC, so
+ * that later boots can restore them and verify them with a short MTC test, instead
+ * of sweeping again. If verification fails, the full sweep is run and the page is
+ * updated. If training fails after the cached results have passed verification, the
+ * page is invalidated, so that it is not offered again. The page is only rewritten
+ * when the results of a full sweep differ from those it holds, to limit sNVM wear.
+ */
+
+#define DDR_CACHE_MAGIC   0x43524444u   // "DDRC"
+#define DDR_CACHE_VERSION 1u
+#define SNVM_PAGE_SIZE    252u          // non-authenticated plaintext
+
+struct DDR_TrainingCache {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t size;
+    uint32_t ddrphyMode;                // cache is invalid if the DDR configuration changes
+    uint32_t fullTrainingMillisecs;     // for reporting the time saved
+    mss_ddr_write_calibration_cache calibration;
+    uint32_t crc;                       // CRC32 of all preceding fields
+};
+
+_Static_assert(sizeof(struct DDR_TrainingCache) <= SNVM_PAGE_SIZE, "DDR training cache must fit in an sNVM page");
+
+static union {
+    struct DDR_TrainingCache record;
+    uint8_t page[SNVM_PAGE_SIZE];
+} ddrCache;
+
+static struct {
+    bool restored;  // cached settings were offered to the training state machine
+    bool saved;     // a full write calibration ran
+    bool valid;     // the sNVM page holds a valid record, ddrCache.record.calibration
+} ddrCacheStatus;
+
+static mss_ddr_write_calibration_cache storedCalibration;
+
+static bool ddr_cache_write_(void)
+{
+    bool result = true;
+
+    MSS_SYS_select_service_mode(MSS_SYS_SERVICE_POLLING_MODE, NULL);
+    if (MSS_SYS_SUCCESS != MSS_SYS_secure_nvm_write(MSS_SYS_SNVM_NON_AUTHEN_TEXT_REQUEST_CMD,
+            CONFIG_DDR_TRAINING_CACHE_SNVM_MODULE, ddrCache.page, NULL, 0u)) {
+        mHSS_DEBUG_PRINTF(LOG_ERROR, "Couldn't write DDR training cache to sNVM\n");
+        result = false;
+    }
+
+    return result;
+}
+
+static uint32_t ddr_cache_crc_(struct DDR_TrainingCache const * const pRecord)
+{
+    return CRC32_calculate((uint8_t const *)pRecord, offsetof(struct DDR_TrainingCache, crc));
+}
+
+uint8_t ddr_restore_write_calibration(mss_ddr_write_calibration_cache *p_cache)
+{
+    uint8_t result = 0u;
+    uint8_t admin[4];
+
+    MSS_SYS_select_service_mode(MSS_SYS_SERVICE_POLLING_MODE, NULL);
+    if (MSS_SYS_SUCCESS != MSS_SYS_secure_nvm_read(CONFIG_DDR_TRAINING_CACHE_SNVM_MODULE, NULL,
+            admin, ddrCache.page, SNVM_PAGE_SIZE, 0u)) {
+        mHSS_DEBUG_PRINTF(LOG_WARN, "Couldn't read DDR training cache from sNVM\n");
+    } else if ((ddrCache.record.magic == DDR_CACHE_MAGIC)
+            && (ddrCache.record.version == DDR_CACHE_VERSION)
+            && (ddrCache.record.size == sizeof(ddrCache.record))
+            && (ddrCache.record.ddrphyMode == LIBERO_SETTING_DDRPHY_MODE)
+            && (ddrCache.record.crc == ddr_cache_crc_(&ddrCache.record))) {
+        *p_cache = ddrCache.record.calibration;
+        storedCalibration = ddrCache.record.calibration;
+        ddrCacheStatus.restored = true;
+        ddrCacheStatus.valid = true;
+        result = 1u;
+    }
+
+    return result;
+}
+
+void ddr_invalidate_write_calibration(void)
+{
+    mHSS_DEBUG_PRINTF(LOG_WARN, "DDR training failed with cached write calibration, discarding it\n");
+
+    memset(ddrCache.page, 0, sizeof(ddrCache.page));
+    ddrCacheStatus.valid = !ddr_cache_write_();
+}
+
+void ddr_save_write_calibration(const mss_ddr_write_calibration_cache *p_cache)
+{
+    // written to sNVM once training has completed, and its duration is known
+    ddrCache.record.calibration = *p_cache;
+    ddrCacheStatus.saved = true;
+}
+
+static void ddr_cache_update_(HSSTicks_t trainingTime)
+{
+    uint32_t const millisecs = (uint32_t)(trainingTime / TICKS_PER_MILLISEC);
+
+    if (ddrCacheStatus.saved && ddrCacheStatus.restored) {
+        mHSS_DEBUG_PRINTF(LOG_WARN, "Cached DDR write calibration was not used\n");
+    }
+
+    if (ddrCacheStatus.saved && ddrCacheStatus.valid
+            && !memcmp(&storedCalibration, &ddrCache.record.calibration, sizeof(storedCalibration))) {
+        mHSS_DEBUG_PRINTF(LOG_NORMAL, "DDR write calibration unchanged, not rewriting sNVM\n");
+    } else if (ddrCacheStatus.saved) {
+        ddrCache.record.magic = DDR_CACHE_MAGIC;
+        ddrCache.record.version = DDR_CACHE_VERSION;
+        ddrCache.record.size = sizeof(ddrCache.record);
+        ddrCache.record.ddrphyMode = LIBERO_SETTING_DDRPHY_MODE;
+        ddrCache.record.fullTrainingMillisecs = millisecs;
+        ddrCache.record.crc = ddr_cache_crc_(&ddrCache.record);
+
+        if (ddr_cache_write_()) {
+            mHSS_DEBUG_PRINTF(LOG_NORMAL, "DDR write calibration saved to sNVM module %d\n",
+                CONFIG_DDR_TRAINING_CACHE_SNVM_MODULE);
+        }
+    } else if (ddrCacheStatus.restored) {
+        uint32_t const fullMillisecs = ddrCache.record.fullTrainingMillisecs;
+
+        mHSS_DEBUG_PRINTF(LOG_STATUS, "DDR training used cached write calibration: %u ms, vs %u ms"
+            " for full training (%u ms saved)\n", millisecs, fullMillisecs,
+            (fullMillisecs > millisecs) ? (fullMillisecs - millisecs) : 0u);
+    }
+}
+#endif
+
 /*!
  * \brief Hook for DDR Setup
  */
@@ -182,11 +321,16 @@ bool HSS_DDRInit(void)
         mHSS_DEBUG_PRINTF_EX("\n");
         int perf_ctr_index = PERF_CTR_UNINITIALIZED;
         HSS_PerfCtr_Allocate(&perf_ctr_index, "DDR Init");
+        HSS_Timeline_Begin(TIMELINE_DDR_TRAINING, HSS_HART_E51);
 
 #    define CURSOR_UP "\033[A"
         HSS_ShowProgress(TYPICAL_DDR_TRAINING_ITERATIONS, TYPICAL_DDR_TRAINING_ITERATIONS);
+        HSSTicks_t const startTime = HSS_GetTime();
         uint8_t retval = mss_nwc_init_ddr();
+        HSSTicks_t const trainingTime = HSS_GetTime() - startTime;
+        (void)trainingTime;
         HSS_ShowProgress(TYPICAL_DDR_TRAINING_ITERATIONS, 0u);
+        HSS_Timeline_End(TIMELINE_DDR_TRAINING, HSS_HART_E51);
 
         if (retval != 0) {
             mHSS_DEBUG_PRINTF_EX(CURSOR_UP "%s Failed\n", ddr_training_prefix);
@@ -202,6 +346,9 @@ bool HSS_DDRInit(void)
             mHSS_DEBUG_PRINTF_EX(" ( %lu ms)", millisecs);
 #endif
             mHSS_DEBUG_PRINTF_EX("\n");
+#if IS_ENABLED(CONFIG_DDR_TRAINING_CACHE)
+            ddr_cache_update_(trainingTime);
+#endif
         }
         HSS_PerfCtr_Lap(perf_ctr_index);
     }
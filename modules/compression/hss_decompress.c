@@ -67,10 +67,27 @@ int HSS_Decompress(const void* pInputBuffer, void* pOutputBuffer)
 
             mHSS_DEBUG_PRINTF(LOG_NORMAL, "Decompressing from %p to %p\n", pByteOffset, pOutputBuffer);
 
-            size_t decompressedOutputSize = (size_t)compressedImageHdr.originalImageLen;
-            result = mz_uncompress(
-                (void *)pOutputBuffer, &decompressedOutputSize,
-                (const void *)pByteOffset, (int)compressedImageHdr.compressedImageLen);
+            //
+            // the output buffer holds the whole image, so there is no need for a separate
+            // dictionary, or for mz_uncompress()'s heap-allocated inflate state
+            //
+            static tinfl_decompressor decompressor;
+            size_t inputSize = compressedImageHdr.compressedImageLen;
+            size_t outputSize = compressedImageHdr.originalImageLen;
+
+            tinfl_init(&decompressor);
+            tinfl_status status = tinfl_decompress(&decompressor, pByteOffset, &inputSize,
+                (mz_uint8 *)pOutputBuffer, (mz_uint8 *)pOutputBuffer, &outputSize,
+                TINFL_FLAG_PARSE_ZLIB_HEADER | TINFL_FLAG_USING_NON_WRAPPING_OUTPUT_BUF);
+
+            if (status != TINFL_STATUS_DONE) {
+                mHSS_DEBUG_PRINTF(LOG_ERROR, "Decompression failed (%d)\n", (int)status);
+            } else if (outputSize != compressedImageHdr.originalImageLen) {
+                mHSS_DEBUG_PRINTF(LOG_ERROR, "Decompressed %lu bytes, expected %lu\n",
+                    outputSize, compressedImageHdr.originalImageLen);
+            } else {
+                result = (int)outputSize;
+            }
         }
     }
 
@@ -0,0 +1,309 @@
+/******************************************************************************************
+ *
+ * MPFS HSS Embedded Software
+ *
+ * Copyright 2019-2025 Microchip FPGA Embedded Systems Solutions.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/*\!
+ *\file Image Signing Crypto
+ *\brief Image Signing Crypto - back end selection and background verification
+ *
+ * A verification is split into two stages: the SHA-384 digest of the image, and the
+ * ECDSA P-384 verification of the signature over that digest. The digest stage is the
+ * expensive one for a large image, so it is run in the background, and advanced each
+ * time HSS_Crypto_Verify_Poll() is called...
+ *
+ * With User Crypto, the hash engine fetches the image by DMA, and polling just checks
+ * whether it has finished. With libecc, the E51 does the work, so each poll hashes one
+ * slice of the image, to keep the superloop moving.
+ */
+
+#include "config.h"
+#include "hss_types.h"
+#include "hss_clock.h"
+#include "hss_debug.h"
+#include "hss_timeline.h"
+
+#include "hss_crypto.h"
+#include "hss_crypto_backends.h"
+
+#include <assert.h>
+#include <string.h>
+
+#define LIBECC_DIGEST_SLICE_SIZE (32u * 1024u)
+
+enum CryptoBackend {
+    CRYPTO_BACKEND_USER_CRYPTO,
+    CRYPTO_BACKEND_LIBECC,
+    CRYPTO_BACKEND_NUM
+};
+
+static char const * const backendNames[] = {
+    [ CRYPTO_BACKEND_USER_CRYPTO ] = "User Crypto",
+    [ CRYPTO_BACKEND_LIBECC ]      = "libecc",
+};
+
+static struct {
+    enum HSSCryptoVerifyStatus status;
+    enum CryptoBackend backend;
+    bool digestDone;
+    bool recordTimeline;
+    uint8_t const *pData;
+    size_t dataLen;
+    size_t offset;
+    HSSTicks_t startTime;
+    HSSTicks_t digestTicks;
+    HSSTicks_t verifyTicks;
+    uint8_t sig[ECDSA_P384_SIG_LEN] __attribute__((aligned(8)));
+} verify = { .status = HSS_CRYPTO_VERIFY_IDLE };
+
+static bool backend_is_present_(enum CryptoBackend backend)
+{
+    bool result = false;
+
+    switch (backend) {
+    case CRYPTO_BACKEND_USER_CRYPTO:
+#if IS_ENABLED(CONFIG_CRYPTO_USER_CRYPTO)
+        result = HSS_Crypto_Cal_IsPresent();
+#endif
+        break;
+
+    case CRYPTO_BACKEND_LIBECC:
+        result = IS_ENABLED(CONFIG_CRYPTO_LIBECC);
+        break;
+
+    default:
+        break;
+    }
+
+    return result;
+}
+
+static bool verify_start_(enum CryptoBackend backend, const size_t siglen, uint8_t sigBuffer[siglen],
+    const size_t dataBufSize, uint8_t dataBuf[dataBufSize], bool recordTimeline)
+{
+    bool result = false;
+
+    assert(siglen == ECDSA_P384_SIG_LEN);
+    memcpy(verify.sig, sigBuffer, ECDSA_P384_SIG_LEN);
+
+    verify.backend = backend;
+    verify.digestDone = false;
+    verify.recordTimeline = recordTimeline;
+    verify.pData = dataBuf;
+    verify.dataLen = dataBufSize;
+    verify.offset = 0u;
+    verify.digestTicks = 0u;
+    verify.verifyTicks = 0u;
+    verify.startTime = HSS_GetTime();
+
+    switch (backend) {
+    case CRYPTO_BACKEND_USER_CRYPTO:
+#if IS_ENABLED(CONFIG_CRYPTO_USER_CRYPTO)
+        result = HSS_Crypto_Cal_Digest_Start(dataBufSize, dataBuf);
+#endif
+        break;
+
+    case CRYPTO_BACKEND_LIBECC:
+#if IS_ENABLED(CONFIG_CRYPTO_LIBECC)
+        result = HSS_Crypto_LibEcc_Verify_Init(ARRAY_SIZE(verify.sig), verify.sig);
+#endif
+        break;
+
+    default:
+        break;
+    }
+
+    if (result) {
+        verify.status = HSS_CRYPTO_VERIFY_BUSY;
+        if (verify.recordTimeline) {
+            HSS_Timeline_Begin(TIMELINE_IMAGE_DIGEST, HSS_HART_E51);
+        }
+    }
+
+    return result;
+}
+
+static enum HSSCryptoVerifyStatus digest_poll_(void)
+{
+    enum HSSCryptoVerifyStatus result = HSS_CRYPTO_VERIFY_FAILED;
+
+    switch (verify.backend) {
+    case CRYPTO_BACKEND_USER_CRYPTO:
+#if IS_ENABLED(CONFIG_CRYPTO_USER_CRYPTO)
+        result = HSS_Crypto_Cal_Digest_Poll();
+#endif
+        break;
+
+    case CRYPTO_BACKEND_LIBECC:
+#if IS_ENABLED(CONFIG_CRYPTO_LIBECC)
+        {
+            size_t const sliceLen = MIN(verify.dataLen - verify.offset, (size_t)LIBECC_DIGEST_SLICE_SIZE);
+
+            if (!HSS_Crypto_LibEcc_Verify_Update(sliceLen, verify.pData + verify.offset)) {
+                result = HSS_CRYPTO_VERIFY_FAILED;
+            } else {
+                verify.offset += sliceLen;
+                result = (verify.offset < verify.dataLen) ? HSS_CRYPTO_VERIFY_BUSY : HSS_CRYPTO_VERIFY_PASSED;
+            }
+        }
+#endif
+        break;
+
+    default:
+        break;
+    }
+
+    return result;
+}
+
+static bool verify_digest_(void)
+{
+    bool result = false;
+
+    switch (verify.backend) {
+    case CRYPTO_BACKEND_USER_CRYPTO:
+#if IS_ENABLED(CONFIG_CRYPTO_USER_CRYPTO)
+        result = HSS_Crypto_Cal_Verify_Digest(ARRAY_SIZE(verify.sig), verify.sig);
+#endif
+        break;
+
+    case CRYPTO_BACKEND_LIBECC:
+#if IS_ENABLED(CONFIG_CRYPTO_LIBECC)
+        result = HSS_Crypto_LibEcc_Verify_Finalize();
+#endif
+        break;
+
+    default:
+        break;
+    }
+
+    return result;
+}
+
+enum HSSCryptoVerifyStatus HSS_Crypto_Verify_Poll(void)
+{
+    if (verify.status == HSS_CRYPTO_VERIFY_BUSY) {
+        if (!verify.digestDone) {
+            enum HSSCryptoVerifyStatus const digestStatus = digest_poll_();
+
+            if (digestStatus != HSS_CRYPTO_VERIFY_BUSY) {
+                verify.digestDone = true;
+                verify.digestTicks = HSS_GetTime() - verify.startTime;
+
+                if (verify.recordTimeline) {
+                    HSS_Timeline_End(TIMELINE_IMAGE_DIGEST, HSS_HART_E51);
+                }
+
+                if (digestStatus == HSS_CRYPTO_VERIFY_FAILED) {
+                    verify.status = HSS_CRYPTO_VERIFY_FAILED;
+                }
+            }
+        } else {
+            // the ECDSA step is short compared to the digest, so is done in one go
+            HSSTicks_t const verifyStartTime = HSS_GetTime();
+
+            if (verify.recordTimeline) {
+                HSS_Timeline_Begin(TIMELINE_SIGNATURE_VERIFY, HSS_HART_E51);
+            }
+
+            verify.status = verify_digest_() ? HSS_CRYPTO_VERIFY_PASSED : HSS_CRYPTO_VERIFY_FAILED;
+            verify.verifyTicks = HSS_GetTime() - verifyStartTime;
+
+            if (verify.recordTimeline) {
+                HSS_Timeline_End(TIMELINE_SIGNATURE_VERIFY, HSS_HART_E51);
+
+                mHSS_DEBUG_PRINTF(LOG_STATUS, "%s: digest of %zu bytes in %" PRIu64 " ms,"
+                    " ECDSA verify in %" PRIu64 " ms\n", backendNames[verify.backend], verify.dataLen,
+                    verify.digestTicks / TICKS_PER_MILLISEC, verify.verifyTicks / TICKS_PER_MILLISEC);
+            }
+        }
+    }
+
+    return verify.status;
+}
+
+bool HSS_Crypto_Verify_Start_ECDSA_P384(const size_t siglen, uint8_t sigBuffer[siglen],
+    const size_t dataBufSize, uint8_t dataBuf[dataBufSize])
+{
+    bool result = false;
+
+    while (HSS_Crypto_Verify_Poll() == HSS_CRYPTO_VERIFY_BUSY) { ; }
+
+    for (enum CryptoBackend backend = 0u; !result && (backend < CRYPTO_BACKEND_NUM); backend++) {
+        if (backend_is_present_(backend)) {
+            result = verify_start_(backend, siglen, sigBuffer, dataBufSize, dataBuf, true);
+        }
+    }
+
+    if (!result) {
+        mHSS_DEBUG_PRINTF(LOG_ERROR, "unable to start signature verification\n");
+        verify.status = HSS_CRYPTO_VERIFY_FAILED;
+    }
+
+    return result;
+}
+
+bool HSS_Crypto_Verify_ECDSA_P384(const size_t siglen, uint8_t sigBuffer[siglen],
+    const size_t dataBufSize, uint8_t dataBuf[dataBufSize])
+{
+    enum HSSCryptoVerifyStatus status = HSS_CRYPTO_VERIFY_FAILED;
+
+    if (HSS_Crypto_Verify_Start_ECDSA_P384(siglen, sigBuffer, dataBufSize, dataBuf)) {
+        do {
+            status = HSS_Crypto_Verify_Poll();
+        } while (status == HSS_CRYPTO_VERIFY_BUSY);
+    }
+
+    return (status == HSS_CRYPTO_VERIFY_PASSED);
+}
+
+void HSS_Crypto_Benchmark_ECDSA_P384(const size_t siglen, uint8_t sigBuffer[siglen],
+    const size_t dataBufSize, uint8_t dataBuf[dataBufSize])
+{
+    while (HSS_Crypto_Verify_Poll() == HSS_CRYPTO_VERIFY_BUSY) { ; }
+
+    for (enum CryptoBackend backend = 0u; backend < CRYPTO_BACKEND_NUM; backend++) {
+        if (!backend_is_present_(backend)) {
+            mHSS_DEBUG_PRINTF(LOG_NORMAL, "%-11s: not available\n", backendNames[backend]);
+        } else if (!verify_start_(backend, siglen, sigBuffer, dataBufSize, dataBuf, false)) {
+            mHSS_DEBUG_PRINTF(LOG_ERROR, "%-11s: failed to start\n", backendNames[backend]);
+        } else {
+            enum HSSCryptoVerifyStatus status;
+
+            do {
+                status = HSS_Crypto_Verify_Poll();
+            } while (status == HSS_CRYPTO_VERIFY_BUSY);
+
+            mHSS_DEBUG_PRINTF(LOG_NORMAL, "%-11s: digest %zu bytes in %" PRIu64 " ticks (%" PRIu64
+                " bytes/s), verify in %" PRIu64 " ticks, %s\n", backendNames[backend], dataBufSize,
+                verify.digestTicks,
+                verify.digestTicks ? ((dataBufSize * TICKS_PER_SEC) / verify.digestTicks) : 0u,
+                verify.verifyTicks, (status == HSS_CRYPTO_VERIFY_PASSED) ? "passed" : "FAILED");
+        }
+    }
+
+    // a benchmark run is not a boot-time verification, so don't report its result
+    verify.status = HSS_CRYPTO_VERIFY_IDLE;
+}
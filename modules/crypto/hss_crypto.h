@@ -33,8 +33,47 @@
 extern "C" {
 #endif
 
+enum HSSCryptoVerifyStatus {
+    HSS_CRYPTO_VERIFY_IDLE,
+    HSS_CRYPTO_VERIFY_BUSY,
+    HSS_CRYPTO_VERIFY_PASSED,
+    HSS_CRYPTO_VERIFY_FAILED,
+};
+
+/**
+ * Starts an ECDSA P-384 verification of dataBuf in the background, using the User
+ * Crypto hash engine (via DMA) if it is present, and libecc otherwise. The signature is
+ * copied, but dataBuf must not change until the verification completes. If a previous
+ * verification is still in progress, it is run to completion first.
+ */
+bool HSS_Crypto_Verify_Start_ECDSA_P384(const size_t siglen, uint8_t sigBuffer[siglen], const size_t dataBufSize, uint8_t dataBuf[dataBufSize]);
+
+/**
+ * Advances a background verification, and returns its status. This is intended to be
+ * called from a state machine, once per superloop iteration.
+ */
+enum HSSCryptoVerifyStatus HSS_Crypto_Verify_Poll(void);
+
 bool HSS_Crypto_Verify_ECDSA_P384(const size_t siglen, uint8_t sigBuffer[siglen], const size_t dataBufSize, uint8_t dataBuf[dataBufSize]);
 
+/**
+ * Runs the digest and verify stages over dataBuf with each of the available crypto
+ * back ends in turn, and displays the time taken by each stage.
+ */
+void HSS_Crypto_Benchmark_ECDSA_P384(const size_t siglen, uint8_t sigBuffer[siglen], const size_t dataBufSize, uint8_t dataBuf[dataBufSize]);
+
+/**
+ * SHA-384, for hashing several buffers (e.g. one per boot machine) incrementally and
+ * independently of a verification. The context is opaque, and sized for libecc's.
+ */
+struct HSSCryptoSHA384Context {
+    uint64_t opaque[28];
+};
+
+void HSS_Crypto_SHA384_Init(struct HSSCryptoSHA384Context *pCtx);
+void HSS_Crypto_SHA384_Update(struct HSSCryptoSHA384Context *pCtx, const size_t len, uint8_t const data[len]);
+void HSS_Crypto_SHA384_Final(struct HSSCryptoSHA384Context *pCtx, uint8_t digest[48]);
+
 #if defined (__cplusplus)
 }
 #endif
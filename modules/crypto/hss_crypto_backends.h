@@ -0,0 +1,48 @@
+#ifndef HSS_CRYPTO_BACKENDS_H
+#define HSS_CRYPTO_BACKENDS_H
+
+/*******************************************************************************
+ * Copyright 2019-2025 Microchip FPGA Embedded Systems Solutions.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * MPFS HSS Embedded Software
+ *
+ */
+
+/*!
+ * \file  Image Signing Crypto Back Ends
+ * \brief Interfaces between hss_crypto.c and the libecc and User Crypto back ends
+ */
+
+#if defined (__cplusplus)
+extern "C" {
+#endif
+
+#include "hss_crypto.h"
+
+#define ECDSA_P384_SIG_LEN      ((384u/8)*2)
+#define SHA384_DIGEST_LEN       (384u/8)
+
+//
+// libecc: the digest is streamed through libecc on the E51, a slice at a time, and the
+// ECDSA verification is done in software when the digest is finalized
+//
+bool HSS_Crypto_LibEcc_Verify_Init(const size_t siglen, uint8_t const sigBuffer[siglen]);
+bool HSS_Crypto_LibEcc_Verify_Update(const size_t len, uint8_t const data[len]);
+bool HSS_Crypto_LibEcc_Verify_Finalize(void);
+
+//
+// User Crypto: the digest is computed by the hash engine of the User Crypto processor,
+// which fetches the image by DMA, and the ECDSA verification is done by its PK engine
+//
+bool HSS_Crypto_Cal_IsPresent(void);
+bool HSS_Crypto_Cal_Digest_Start(const size_t len, uint8_t const data[len]);
+enum HSSCryptoVerifyStatus HSS_Crypto_Cal_Digest_Poll(void);
+bool HSS_Crypto_Cal_Verify_Digest(const size_t siglen, uint8_t const sigBuffer[siglen]);
+
+#if defined (__cplusplus)
+}
+#endif
+
+#endif
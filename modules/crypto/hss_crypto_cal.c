@@ -26,8 +26,8 @@
  */
 
 /*\!
- *\file Decompression Wrapper
- *\brief Decompression Wrapper
+ *\file Image Signing Crypto - User Crypto
+ *\brief Image Signing Crypto - User Crypto
  */
 
 #include "config.h"
@@ -35,6 +35,8 @@
 #include "hss_debug.h"
 
 #include "hss_crypto.h"
+#include "hss_crypto_backends.h"
+#include "ddr_service.h"
 
 #include <assert.h>
 #include <string.h>
@@ -49,9 +51,14 @@
 #include "pkx.h"
 #include "utils.h"
 
-static void crypto_init_(void)
+//
+// The User Crypto processor is only present on the S (security) variants of the device,
+// so whether it can be used is decided here, at run time, by whether the CAL comes up
+//
+static bool crypto_init_(void)
 {
     static bool initialized = false;
+    static bool present = false;
 
     if (!initialized) {
         (void)mss_config_clk_rst(MSS_PERIPH_CRYPTO, (uint8_t) 0, PERIPHERAL_ON);
@@ -63,9 +70,14 @@ static void crypto_init_(void)
         ATHENAREG->ATHENA_CR = SYSREG_ATHENACR_RESET | SYSREG_ATHENACR_RINGOSCON;
         ATHENAREG->ATHENA_CR = SYSREG_ATHENACR_RINGOSCON;
         SATR retval = CALIni();
-        assert(retval == SATR_SUCCESS);
+        present = (retval == SATR_SUCCESS);
+        if (!present) {
+            mHSS_DEBUG_PRINTF(LOG_WARN, "User Crypto not available (CALIni returned %u)\n", retval);
+        }
         initialized = true;
     }
+
+    return present;
 }
 
 // Required constants
@@ -107,12 +119,90 @@ const SATUINT32_t P384_npc[] = {
     0x00000001
 };
 
-bool HSS_Crypto_Verify_ECDSA_P384(const size_t siglen, uint8_t sigBuffer[siglen], const size_t dataBufSize, uint8_t dataBuf[dataBufSize])
+#define PARAM_WORD_SIZE     12
+#define PUB_KEY_X_OFFSET    24
+
+static SATUINT32_t digest_[PARAM_WORD_SIZE];
+
+bool HSS_Crypto_Cal_IsPresent(void)
+{
+    return crypto_init_();
+}
+
+//
+// The DMA engine of the User Crypto processor only has a 32-bit view of memory, so
+// images in the 64-bit DDR window are accessed through the 32-bit alias of the same DDR
+//
+static bool cal_dma_address_(uint8_t const *pData, size_t len, uintptr_t *pAddr)
+{
+    bool result = false;
+    uintptr_t const addr = (uintptr_t)pData;
+
+    if ((addr >= HSS_DDRHi_GetStart()) && ((addr - HSS_DDRHi_GetStart() + len) <= HSS_DDR_GetSize())) {
+        *pAddr = HSS_DDR_GetStart() + (addr - HSS_DDRHi_GetStart());
+        result = true;
+    } else if ((addr + len) <= UINT32_MAX) {
+        *pAddr = addr;
+        result = true;
+    }
+
+    return result;
+}
+
+bool HSS_Crypto_Cal_Digest_Start(const size_t len, uint8_t const data[len])
+{
+    bool result = false;
+    uintptr_t dmaAddr;
+
+    if (!crypto_init_()) {
+        ;
+    } else if ((len > UINT32_MAX) || !cal_dma_address_(data, len, &dmaAddr)) {
+        mHSS_DEBUG_PRINTF(LOG_WARN, "image at %p (%zu bytes) is not reachable by User Crypto DMA\n",
+            data, len);
+    } else {
+        SATR retval = CALHashDMA(SATHASHTYPE_SHA384, (void *)dmaAddr, (SATUINT32_t)len,
+            digest_, X52CCR_DEFAULT);
+
+        if (retval != SATR_SUCCESS) {
+            mHSS_DEBUG_PRINTF(LOG_ERROR, "CALHashDMA returned %u\n", retval);
+        } else {
+            result = true;
+        }
+    }
+
+    return result;
+}
+
+enum HSSCryptoVerifyStatus HSS_Crypto_Cal_Digest_Poll(void)
+{
+    enum HSSCryptoVerifyStatus result;
+
+    SATR retval = CALPKTrfRes(SAT_FALSE);
+
+    switch (retval) {
+    case SATR_BUSY:
+        result = HSS_CRYPTO_VERIFY_BUSY;
+        break;
+
+    case SATR_SUCCESS:
+        result = HSS_CRYPTO_VERIFY_PASSED;
+        break;
+
+    default:
+        mHSS_DEBUG_PRINTF(LOG_ERROR, "SHA-384 digest failed (%u)\n", retval);
+        result = HSS_CRYPTO_VERIFY_FAILED;
+        break;
+    }
+
+    return result;
+}
+
+bool HSS_Crypto_Cal_Verify_Digest(const size_t siglen, uint8_t const sigBuffer[siglen])
 {
     bool result = false;
     SATR retval;
 
-    crypto_init_();
+    assert(siglen == ECDSA_P384_SIG_LEN);
 
     //
     // X5.09 ASN.1 DER keys are of the format
@@ -150,73 +240,73 @@ bool HSS_Crypto_Verify_ECDSA_P384(const size_t siglen, uint8_t sigBuffer[siglen]
 
     if (strncmp(x509_asn1_ec_der_p384_root, SECP384R1_ECDSA_public_key, ARRAY_SIZE(x509_asn1_ec_der_p384_root))) {
         mHSS_DEBUG_PRINTF(LOG_ERROR, "invalid signing certificate type\n");
-        result = false;
+        return result;
+    }
+
+    /* signature is composed of (r, s), and is copied as it is adjusted in place */
+    SATUINT32_t sigR[PARAM_WORD_SIZE], sigS[PARAM_WORD_SIZE];
+    memcpy(sigR, &sigBuffer[0], sizeof(sigR));
+    memcpy(sigS, &sigBuffer[SHA384_DIGEST_LEN], sizeof(sigS));
+
+    /* public key, after 24-byte header, is composed of (x, y), and is copied for the same reason */
+    SATUINT32_t pubKeyX[PARAM_WORD_SIZE], pubKeyY[PARAM_WORD_SIZE];
+    memcpy(pubKeyX, &SECP384R1_ECDSA_public_key[PUB_KEY_X_OFFSET], sizeof(pubKeyX));
+    memcpy(pubKeyY, &SECP384R1_ECDSA_public_key[PUB_KEY_X_OFFSET + SHA384_DIGEST_LEN], sizeof(pubKeyY));
+
+    /* adjust endian of Public Key X & Y components */
+    CALWordReverse(pubKeyX, PARAM_WORD_SIZE);
+    CALByteReverseWord(pubKeyX, PARAM_WORD_SIZE);
+    CALWordReverse(pubKeyY, PARAM_WORD_SIZE);
+    CALByteReverseWord(pubKeyY, PARAM_WORD_SIZE);
+
+    /* adjust endian of Signature R and S components */
+    CALWordReverse(sigR, PARAM_WORD_SIZE);
+    CALByteReverseWord(sigR, PARAM_WORD_SIZE);
+    CALWordReverse(sigS, PARAM_WORD_SIZE);
+    CALByteReverseWord(sigS, PARAM_WORD_SIZE);
+
+    /* the digest is a big-endian byte string too, so is adjusted in the same way */
+    CALWordReverse(digest_, PARAM_WORD_SIZE);
+    CALByteReverseWord(digest_, PARAM_WORD_SIZE);
+
+    retval = CALECPtValidate(pubKeyX, pubKeyY, P384_b, P384_MOD, SAT_NULL,
+                    PARAM_WORD_SIZE);
+
+    if (retval == SATR_SUCCESS) {
+        retval = CALPKTrfRes(SAT_TRUE);
+        switch (retval) {
+        case SATR_SUCCESS:
+            break;
+        case SATR_VALPARMX:
+            mHSS_DEBUG_PRINTF(LOG_NORMAL, "X parameter not in range \n");
+            break;
+        case SATR_VALPARMY:
+            mHSS_DEBUG_PRINTF(LOG_ERROR, "Y parameter not in range\n");
+            break;
+        case SATR_VALPARMB:
+            mHSS_DEBUG_PRINTF(LOG_ERROR, "B parameter greater than modulus\n");
+            break;
+        case SATR_VALIDATEFAIL:
+            mHSS_DEBUG_PRINTF(LOG_ERROR, "public key is not on the curve\n");
+            break;
+        }
     } else {
-#define SHA384_DIGEST_SIZE  48
-#define PARAM_WORD_SIZE     12
-#define PUB_KEY_X_OFFSET    24
-	    /* signature is composed of (r, s) */
-	uint32_t *sigR = (uint32_t *)&sigBuffer[0];
-	uint32_t *sigS = (uint32_t *)&sigBuffer[SHA384_DIGEST_SIZE];
-
-	/* public key, after 24-byte header, is composed of (x, y) */
-	uint32_t *pubKeyX = (uint32_t *)&(SECP384R1_ECDSA_public_key[PUB_KEY_X_OFFSET]);
-	uint32_t *pubKeyY = (uint32_t *)&(SECP384R1_ECDSA_public_key[PUB_KEY_X_OFFSET +
-				SHA384_DIGEST_SIZE]);
-
-	/* adjust endian of Public Key X & Y components */
-	CALWordReverse(pubKeyX, PARAM_WORD_SIZE);
-	CALByteReverseWord(pubKeyX, PARAM_WORD_SIZE);
-	CALWordReverse(pubKeyY, PARAM_WORD_SIZE);
-	CALByteReverseWord(pubKeyY, PARAM_WORD_SIZE);
-
-	/* adjust endian of Signature R and S components */
-	CALWordReverse(sigR, PARAM_WORD_SIZE);
-	CALByteReverseWord(sigR, PARAM_WORD_SIZE);
-	CALWordReverse(sigS, PARAM_WORD_SIZE);
-	CALByteReverseWord(sigS, PARAM_WORD_SIZE);
-
-	retval = CALECPtValidate(pubKeyX, pubKeyY, P384_b, P384_MOD, SAT_NULL,
-					PARAM_WORD_SIZE);
-
-	if (retval == SATR_SUCCESS) {
-		retval = CALPKTrfRes(SAT_TRUE);
-		switch (retval) {
-		case SATR_SUCCESS:
-			break;
-		case SATR_VALPARMX:
-			mHSS_DEBUG_PRINTF(LOG_NORMAL, "X parameter not in range \n");
-			break;
-		case SATR_VALPARMY:
-			mHSS_DEBUG_PRINTF(LOG_ERROR, "Y parameter not in range\n");
-			break;
-		case SATR_VALPARMB:
-			mHSS_DEBUG_PRINTF(LOG_ERROR, "B parameter greater than modulus\n");
-			break;
-		case SATR_VALIDATEFAIL:
-			mHSS_DEBUG_PRINTF(LOG_ERROR, "public key is not on the curve\n");
-			break;
-		}
-	} else {
-		mHSS_DEBUG_PRINTF(LOG_ERROR, "public key validation fail \r\n");
-	}
-
-	if (retval != SATR_SUCCESS) {
-		return result;
-	}
-
-	retval = CALECDSAVerifyHash((uint32_t *)&dataBuf[0], SATHASHTYPE_SHA384,
-			dataBufSize, P384_Gx, P384_Gy, pubKeyX, pubKeyY, sigR, sigS,
-			P384_b, P384_MOD, SAT_NULL, P384_n, P384_npc, PARAM_WORD_SIZE,
-			0, SAT_FALSE, X52CCR_DEFAULT);
-
-	if (retval == SATR_SUCCESS) {
-		retval = CALPKTrfRes(SAT_TRUE);
-		if (retval == SATR_SUCCESS) {
-			result = true;
-		}
-	}
+        mHSS_DEBUG_PRINTF(LOG_ERROR, "public key validation fail \r\n");
     }
-    
+
+    if (retval != SATR_SUCCESS) {
+        return result;
+    }
+
+    retval = CALECDSAVerify(digest_, P384_Gx, P384_Gy, pubKeyX, pubKeyY, sigR, sigS,
+            P384_b, P384_MOD, SAT_NULL, P384_n, P384_npc, PARAM_WORD_SIZE, 0);
+
+    if (retval == SATR_SUCCESS) {
+        retval = CALPKTrfRes(SAT_TRUE);
+        if (retval == SATR_SUCCESS) {
+            result = true;
+        }
+    }
+
     return result;
 }
@@ -36,6 +36,7 @@
 #include "hss_debug.h"
 
 #include "hss_crypto.h"
+#include "hss_crypto_backends.h"
 
 #include <string.h>
 #include <assert.h>
@@ -46,9 +47,15 @@
 #include "libsig.h"
 #pragma GCC diagnostic pop
 
-#define ECDSA_P384_SIG_LEN ((384u/8)*2)
-bool HSS_Crypto_Verify_ECDSA_P384(const size_t siglen, uint8_t sigBuffer[siglen],
-    const size_t dataBufSize, uint8_t dataBuf[dataBufSize])
+//
+// libecc's verification context keeps a pointer to the public key, which in turn points
+// at the curve parameters, so these must outlive HSS_Crypto_LibEcc_Verify_Init()
+//
+static ec_pub_key pub_key;
+static ec_params params;
+static struct ec_verify_context verify_ctx;
+
+bool HSS_Crypto_LibEcc_Verify_Init(const size_t siglen, uint8_t const sigBuffer[siglen])
 {
     bool result = false;
 
@@ -99,8 +106,6 @@ bool HSS_Crypto_Verify_ECDSA_P384(const size_t siglen, uint8_t sigBuffer[siglen]
         uint8_t const curve_name[] = "SECP384R1";
         const ec_str_params *p_str_params = ec_get_curve_params_by_name(&curve_name[0], ARRAY_SIZE(curve_name));
 
-        ec_pub_key pub_key;
-        ec_params params;
         uint8_t u8siglen;
 
         import_params(&params, p_str_params);
@@ -127,10 +132,13 @@ bool HSS_Crypto_Verify_ECDSA_P384(const size_t siglen, uint8_t sigBuffer[siglen]
                     mHSS_DEBUG_PRINTF(LOG_ERROR, "ec_pub_key_import_from_aff_buf returned %d\n", retval);
                     result = false;
                 } else {
-                    int libecc_result = ec_verify(sigBuffer, u8siglen, &pub_key, dataBuf, dataBufSize,
+                    retval = ec_verify_init(&verify_ctx, &pub_key, sigBuffer, u8siglen,
                         ECDSA, SHA384, aDataBuf, aDataBufSize);
 
-                    result = (libecc_result == 0) ? true : false;
+                    if (retval) {
+                        mHSS_DEBUG_PRINTF(LOG_ERROR, "ec_verify_init returned %d\n", retval);
+                    }
+                    result = (retval == 0) ? true : false;
                 }
             }
         }
@@ -138,3 +146,42 @@ bool HSS_Crypto_Verify_ECDSA_P384(const size_t siglen, uint8_t sigBuffer[siglen]
 
     return result;
 }
+
+bool HSS_Crypto_LibEcc_Verify_Update(const size_t len, uint8_t const data[len])
+{
+    assert(len <= UINT32_MAX);
+
+    int libecc_result = ec_verify_update(&verify_ctx, data, (uint32_t)len);
+
+    return (libecc_result == 0) ? true : false;
+}
+
+bool HSS_Crypto_LibEcc_Verify_Finalize(void)
+{
+    int libecc_result = ec_verify_finalize(&verify_ctx);
+
+    return (libecc_result == 0) ? true : false;
+}
+
+_Static_assert(sizeof(struct HSSCryptoSHA384Context) >= sizeof(sha384_context),
+    "HSSCryptoSHA384Context is too small for sha384_context");
+_Static_assert(SHA384_DIGEST_SIZE == SHA384_DIGEST_LEN, "unexpected SHA384 digest size");
+
+void HSS_Crypto_SHA384_Init(struct HSSCryptoSHA384Context *pCtx)
+{
+    assert(pCtx);
+    sha384_init((sha384_context *)pCtx);
+}
+
+void HSS_Crypto_SHA384_Update(struct HSSCryptoSHA384Context *pCtx, const size_t len, uint8_t const data[len])
+{
+    assert(pCtx);
+    assert(len <= UINT32_MAX);
+    sha384_update((sha384_context *)pCtx, data, (uint32_t)len);
+}
+
+void HSS_Crypto_SHA384_Final(struct HSSCryptoSHA384Context *pCtx, uint8_t digest[SHA384_DIGEST_LEN])
+{
+    assert(pCtx);
+    sha384_final((sha384_context *)pCtx, digest);
+}
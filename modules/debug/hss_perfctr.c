@@ -21,6 +21,73 @@
 #include <assert.h>
 #include <stdio.h>
 
+#if IS_ENABLED(CONFIG_DEBUG_PERF_CTRS_HPM)
+#  include "csr_helper.h"
+
+//
+// Each region also captures mcycle, minstret and the two programmable hardware performance
+// monitor counters (mhpmcounter3 and mhpmcounter4) that the E51 and U54s implement.
+// These counters are per-hart, so a region must be started and lapped on the same hart.
+//
+struct PerfCtr_HpmSample {
+    uint64_t cycles;
+    uint64_t instret;
+    uint64_t event[2];
+};
+
+//
+// E51/U54 mhpmevent selectors are an event class in bits [7:0], and a mask of events within
+// that class in the bits above. Masked events in the same class are counted together.
+//
+static const struct {
+    uint64_t selector;
+    char const * const pName;
+} hpmEventNames[] = {
+    { 0x0102u, "I$ miss" },
+    { 0x0202u, "D$ miss" },
+    { 0x0402u, "D$ writeback" },
+    { 0x0802u, "ITLB miss" },
+    { 0x1002u, "DTLB miss" },
+    { 0x1802u, "TLB miss" },
+    { 0x2002u, "UTLB miss" },
+    { 0x2001u, "branch mispredict" },
+    { 0x4001u, "target mispredict" },
+    { 0x6001u, "mispredict" },
+    { 0x0101u, "load-use interlock" },
+    { 0x0201u, "long-latency interlock" },
+    { 0x4000u, "cond branch" },
+};
+
+static char const *perfctr_hpm_event_name_(uint64_t selector)
+{
+    char const *pResult = "event";
+
+    for (size_t i = 0u; i < ARRAY_SIZE(hpmEventNames); i++) {
+        if (hpmEventNames[i].selector == selector) {
+            pResult = hpmEventNames[i].pName;
+            break;
+        }
+    }
+
+    return pResult;
+}
+
+static void perfctr_hpm_setup_(void)
+{
+    // writing the same selectors again is harmless, so no need to track which harts are set up
+    csr_write(mhpmevent3, CONFIG_DEBUG_PERF_CTRS_HPM_EVENT3);
+    csr_write(mhpmevent4, CONFIG_DEBUG_PERF_CTRS_HPM_EVENT4);
+}
+
+static void perfctr_hpm_read_(struct PerfCtr_HpmSample *pSample)
+{
+    pSample->cycles = csr_read(mcycle);
+    pSample->instret = csr_read(minstret);
+    pSample->event[0] = csr_read(mhpmcounter3);
+    pSample->event[1] = csr_read(mhpmcounter4);
+}
+#endif
+
 #if IS_ENABLED(CONFIG_DEBUG_PERF_CTRS)
 struct {
     int index;
@@ -28,6 +95,10 @@ struct {
     bool isAllocated;
     HSSTicks_t startTime;
     HSSTicks_t lapTime;
+#  if IS_ENABLED(CONFIG_DEBUG_PERF_CTRS_HPM)
+    struct PerfCtr_HpmSample hpmStart;
+    struct PerfCtr_HpmSample hpmLap;
+#  endif
 } perfCtrs[CONFIG_DEBUG_PERF_CTRS_NUM];
 #endif
 
@@ -52,6 +123,10 @@ bool HSS_PerfCtr_Allocate(int *pIdx, char const * pName)
                 perfCtrs[index].pName = pName;
                 result = true;
                 perfCtrs[index].startTime = HSS_GetTime();
+#  if IS_ENABLED(CONFIG_DEBUG_PERF_CTRS_HPM)
+                perfctr_hpm_setup_();
+                perfctr_hpm_read_(&perfCtrs[index].hpmStart);
+#  endif
                 *pIdx = index;
                 break;
             }
@@ -87,6 +162,10 @@ void HSS_PerfCtr_Start(int index)
         assert(index < ARRAY_SIZE(perfCtrs));
         if (index >= 0) {
             perfCtrs[index].startTime = HSS_GetTime();
+#  if IS_ENABLED(CONFIG_DEBUG_PERF_CTRS_HPM)
+            perfctr_hpm_setup_();
+            perfctr_hpm_read_(&perfCtrs[index].hpmStart);
+#  endif
         }
 #endif
     }
@@ -99,6 +178,9 @@ void HSS_PerfCtr_Lap(int index)
         assert(index < ARRAY_SIZE(perfCtrs));
         if (index >= 0) {
             perfCtrs[index].lapTime = HSS_GetTime();
+#  if IS_ENABLED(CONFIG_DEBUG_PERF_CTRS_HPM)
+            perfctr_hpm_read_(&perfCtrs[index].hpmLap);
+#  endif
         }
 #endif
     }
@@ -121,6 +203,40 @@ HSSTicks_t HSS_PerfCtr_GetTime(int index)
     return result;
 }
 
+#if IS_ENABLED(CONFIG_DEBUG_PERF_CTRS_HPM)
+static void perfctr_hpm_dump_(int index)
+{
+    struct PerfCtr_HpmSample const * const pStart = &perfCtrs[index].hpmStart;
+    struct PerfCtr_HpmSample const * const pLap = &perfCtrs[index].hpmLap;
+
+    uint64_t const cycles = pLap->cycles - pStart->cycles;
+    uint64_t const instret = pLap->instret - pStart->instret;
+
+    if (!cycles || !instret) {
+        return; // not lapped yet
+    }
+
+    // IPC to two decimal places, and event rates as misses per thousand instructions (MPKI)
+    uint64_t const ipc100 = (instret * 100u) / cycles;
+    mHSS_DEBUG_PRINTF_EX("%24s %" PRIu64 " cycles, %" PRIu64 " instret, IPC %" PRIu64 ".%02" PRIu64,
+        "", cycles, instret, ipc100 / 100u, ipc100 % 100u);
+
+    static const uint64_t selectors[] = {
+        CONFIG_DEBUG_PERF_CTRS_HPM_EVENT3, CONFIG_DEBUG_PERF_CTRS_HPM_EVENT4
+    };
+    _Static_assert(ARRAY_SIZE(selectors) == ARRAY_SIZE(pLap->event), "HPM event selectors mismatch");
+
+    for (size_t event = 0u; event < ARRAY_SIZE(pLap->event); event++) {
+        uint64_t const count = pLap->event[event] - pStart->event[event];
+        uint64_t const mpki1000 = (count * 1000000u) / instret;
+
+        mHSS_DEBUG_PRINTF_EX(", %s %" PRIu64 " (%" PRIu64 ".%03" PRIu64 " PKI)", perfctr_hpm_event_name_(selectors[event]),
+            count, mpki1000 / 1000u, mpki1000 % 1000u);
+    }
+    mHSS_DEBUG_PRINTF_EX("\n");
+}
+#endif
+
 void HSS_PerfCtr_DumpAll(void)
 {
 #if IS_ENABLED(CONFIG_DEBUG_PERF_CTRS)
@@ -131,6 +247,9 @@ void HSS_PerfCtr_DumpAll(void)
 
             mHSS_DEBUG_PRINTF(LOG_NORMAL, "% 8lu ms (% 8lu ticks) - %s\n",
                 millisecs, ticks, perfCtrs[i].pName ? perfCtrs[i].pName : "(null)");
+#  if IS_ENABLED(CONFIG_DEBUG_PERF_CTRS_HPM)
+            perfctr_hpm_dump_(i);
+#  endif
         }
     }
 #endif
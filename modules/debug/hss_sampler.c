@@ -0,0 +1,202 @@
+/*******************************************************************************
+ * Copyright 2019-2025 Microchip FPGA Embedded Systems Solutions.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * MPFS HSS Embedded Software
+ *
+ */
+
+/**
+ * \file Sampling Profiler
+ * \brief Timer interrupt driven statistical sampling profiler
+ *
+ * Unlike the instrumentation profiler, this needs no special build. On the E51,
+ * the sampler owns the E51 machine timer while active, and records mepc (and
+ * optionally ra) at CONFIG_DEBUG_SAMPLER_RATE_HZ. The E51 otherwise runs with
+ * interrupts globally disabled, but other code (e.g. USB) enables PLIC sources
+ * in mie, so mie is saved and limited to the machine timer while sampling, and
+ * restored when sampling stops.
+ *
+ * The U54 machine timers belong to OpenSBI (and the OS running above it), so
+ * on the U54s a sample is instead taken on each machine timer trap, at whatever
+ * rate the OS programs its timer.
+ *
+ * Samples are recorded raw, and symbolised and histogrammed on the host by
+ * tools/profiling/gen-sample-report.py.
+ */
+
+#include "config.h"
+#include "hss_types.h"
+#include "hss_debug.h"
+#include "hss_clock.h"
+#include "csr_helper.h"
+#include "mpfs_reg_map.h"
+
+#include "hss_sampler.h"
+
+#include <assert.h>
+
+#define NO_INSTRUMENT __attribute__((no_instrument_function))
+
+#define SAMPLER_PERIOD         ((HSSTicks_t)(TICKS_PER_SEC / CONFIG_DEBUG_SAMPLER_RATE_HZ))
+#define SAMPLER_MCAUSE_M_TIMER (((uintptr_t)1u << (__riscv_xlen - 1)) | IRQ_M_TIMER)
+#define SAMPLER_ALL_HARTS      ((1u << MAX_NUM_HARTS) - 1u)
+
+static struct {
+    uintptr_t pc;
+#if IS_ENABLED(CONFIG_DEBUG_SAMPLER_RECORD_RA)
+    uintptr_t ra;
+#endif
+} samples[CONFIG_DEBUG_SAMPLER_NUM_SAMPLES];
+static uint8_t sampleHart[CONFIG_DEBUG_SAMPLER_NUM_SAMPLES];
+
+static size_t sampleCount = 0u;             // includes samples dropped once the buffer is full
+static uint64_t hartSampleCount[MAX_NUM_HARTS] = { 0u };
+static uint32_t activeHartMask = 0u;
+static HSSTicks_t e51Deadline = UINT64_MAX;
+static HSSTicks_t startTime = 0u;
+static HSSTicks_t stopTime = 0u;
+static uintptr_t e51SavedMie = 0u;
+
+static void NO_INSTRUMENT sampler_record_(enum HSSHartId hartId, uintptr_t pc, uintptr_t ra)
+{
+    size_t const index = __atomic_fetch_add(&sampleCount, 1u, __ATOMIC_RELAXED);
+
+    if (index < ARRAY_SIZE(samples)) {
+        samples[index].pc = pc;
+#if IS_ENABLED(CONFIG_DEBUG_SAMPLER_RECORD_RA)
+        samples[index].ra = ra;
+#else
+        (void)ra;
+#endif
+        sampleHart[index] = (uint8_t)hartId;
+    }
+
+    // only ever written by hartId itself
+    hartSampleCount[hartId]++;
+}
+
+static void NO_INSTRUMENT sampler_e51_arm_(HSSTicks_t deadline)
+{
+    e51Deadline = deadline;
+    mHSS_WriteRegU64(CLINT, MTIMECMP_E51_0, deadline);
+}
+
+void HSS_Sampler_Start(uint32_t hartMask)
+{
+    HSS_Sampler_Stop();
+
+    __atomic_store_n(&sampleCount, 0u, __ATOMIC_RELAXED);
+    for (size_t i = 0u; i < ARRAY_SIZE(hartSampleCount); i++) {
+        hartSampleCount[i] = 0u;
+    }
+
+    startTime = HSS_GetTime();
+    stopTime = 0u;
+    __atomic_store_n(&activeHartMask, hartMask & SAMPLER_ALL_HARTS, __ATOMIC_RELEASE);
+
+    if (hartMask & (1u << HSS_HART_E51)) {
+        sampler_e51_arm_(startTime + SAMPLER_PERIOD);
+        e51SavedMie = csr_read(CSR_MIE);
+        csr_write(CSR_MIE, MIP_MTIP);
+        csr_set(CSR_MSTATUS, MSTATUS_MIE);
+    }
+
+    mHSS_DEBUG_PRINTF(LOG_NORMAL, "Sampling harts 0x%x", activeHartMask);
+    if (hartMask & (1u << HSS_HART_E51)) {
+        mHSS_DEBUG_PRINTF_EX(" (E51 at %u Hz)", CONFIG_DEBUG_SAMPLER_RATE_HZ);
+    }
+    mHSS_DEBUG_PRINTF_EX("\n");
+}
+
+void HSS_Sampler_Stop(void)
+{
+    uint32_t const prevMask = __atomic_exchange_n(&activeHartMask, 0u, __ATOMIC_ACQ_REL);
+
+    if (prevMask & (1u << HSS_HART_E51)) {
+        csr_clear(CSR_MSTATUS, MSTATUS_MIE);
+        csr_write(CSR_MIE, e51SavedMie);
+        sampler_e51_arm_(UINT64_MAX);
+    }
+
+    if (prevMask) {
+        stopTime = HSS_GetTime();
+    }
+}
+
+HSSTicks_t NO_INSTRUMENT HSS_Sampler_GetE51Deadline(void)
+{
+    return e51Deadline;
+}
+
+bool NO_INSTRUMENT HSS_Sampler_HandleE51Trap(uintptr_t mepc, uintptr_t ra)
+{
+    bool result = false;
+    uintptr_t const mcause = csr_read(CSR_MCAUSE);
+
+    if (mcause == SAMPLER_MCAUSE_M_TIMER) {
+        result = true;
+
+        if (__atomic_load_n(&activeHartMask, __ATOMIC_RELAXED) & (1u << HSS_HART_E51)) {
+            sampler_record_(HSS_HART_E51, mepc, ra);
+
+            // if sampling was held off (e.g. by a masked section), don't try to catch up
+            // with a burst of samples
+            HSSTicks_t const now = HSS_GetTime();
+            HSSTicks_t next = e51Deadline + SAMPLER_PERIOD;
+            if (next <= now) {
+                next = now + SAMPLER_PERIOD;
+            }
+            sampler_e51_arm_(next);
+        } else {
+            csr_clear(CSR_MIE, MIP_MTIP);
+            sampler_e51_arm_(UINT64_MAX);
+        }
+    } else if (mcause & ((uintptr_t)1u << (__riscv_xlen - 1))) {
+        // any other interrupt is unexpected, so mask it and carry on; only
+        // exceptions are left to hang
+        csr_clear(CSR_MIE, (uintptr_t)1u << (mcause & (__riscv_xlen - 1)));
+        result = true;
+    }
+
+    return result;
+}
+
+void NO_INSTRUMENT HSS_Sampler_HandleU54Trap(uintptr_t mcause, uintptr_t mepc, uintptr_t ra)
+{
+    enum HSSHartId const hartId = current_hartid();
+
+    if ((mcause == SAMPLER_MCAUSE_M_TIMER) && (hartId < MAX_NUM_HARTS)
+        && (__atomic_load_n(&activeHartMask, __ATOMIC_RELAXED) & (1u << hartId))) {
+        sampler_record_(hartId, mepc, ra);
+    }
+}
+
+void HSS_Sampler_DumpAll(void)
+{
+    size_t const count = __atomic_load_n(&sampleCount, __ATOMIC_ACQUIRE);
+    size_t const recorded = MIN(count, ARRAY_SIZE(samples));
+    HSSTicks_t const duration = (stopTime ? stopTime : HSS_GetTime()) - startTime;
+
+    mHSS_DEBUG_PRINTF_EX("# Sampling Profiler Dump\n"
+        "# %lu samples recorded, %lu dropped, over %" PRIu64 " ms, E51 at %u Hz%s\n",
+        recorded, count - recorded, duration / TICKS_PER_MILLISEC, CONFIG_DEBUG_SAMPLER_RATE_HZ,
+        __atomic_load_n(&activeHartMask, __ATOMIC_RELAXED) ? " (still running)" : "");
+
+    for (size_t hart = 0u; hart < ARRAY_SIZE(hartSampleCount); hart++) {
+        if (hartSampleCount[hart]) {
+            mHSS_DEBUG_PRINTF_EX("# hart %lu: %" PRIu64 " samples\n", hart, hartSampleCount[hart]);
+        }
+    }
+
+    mHSS_DEBUG_PRINTF_EX("# S, Hart, PC, RA\n");
+    for (size_t i = 0u; i < recorded; i++) {
+#if IS_ENABLED(CONFIG_DEBUG_SAMPLER_RECORD_RA)
+        uintptr_t const ra = samples[i].ra;
+#else
+        uintptr_t const ra = 0u;
+#endif
+        mHSS_DEBUG_PRINTF_EX("S, %u, 0x%lx, 0x%lx\n", sampleHart[i], samples[i].pc, ra);
+    }
+}
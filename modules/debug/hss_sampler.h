@@ -0,0 +1,40 @@
+#ifndef HSS_SAMPLER_H
+#define HSS_SAMPLER_H
+
+/*******************************************************************************
+ * Copyright 2019-2025 Microchip FPGA Embedded Systems Solutions.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * MPFS HSS Embedded Software
+ *
+ */
+
+/**
+ * \file Sampling Profiler
+ * \brief Timer interrupt driven statistical sampling profiler
+ */
+
+#include "config.h"
+#include "hss_types.h"
+#include "hss_clock.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void HSS_Sampler_Start(uint32_t hartMask);
+void HSS_Sampler_Stop(void);
+void HSS_Sampler_DumpAll(void);
+
+HSSTicks_t HSS_Sampler_GetE51Deadline(void);
+
+// called from the trap handlers in application/crt.S
+bool HSS_Sampler_HandleE51Trap(uintptr_t mepc, uintptr_t ra);
+void HSS_Sampler_HandleU54Trap(uintptr_t mcause, uintptr_t mepc, uintptr_t ra);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,159 @@
+/*******************************************************************************
+ * Copyright 2019-2025 Microchip FPGA Embedded Systems Solutions.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * MPFS HSS Embedded Software
+ *
+ */
+
+/**
+ * \file Boot Timeline
+ * \brief Boot phase timeline recorder
+ *
+ * Records the begin and end of each boot phase into a fixed-size buffer. Each
+ * event has both an mcycle timestamp, for resolution, and an mtime timestamp,
+ * which is common to all harts. tools/profiling/gen-boot-trace.py converts the
+ * dump into Chrome trace_event JSON, for viewing in Perfetto or chrome://tracing.
+ */
+
+#include "config.h"
+#include "hss_types.h"
+#include "hss_debug.h"
+#include "hss_clock.h"
+#include "csr_helper.h"
+
+#include "hss_timeline.h"
+
+#include <assert.h>
+
+#if IS_ENABLED(CONFIG_DEBUG_BOOT_TIMELINE)
+enum {
+    TIMELINE_BEGIN = 'B',
+    TIMELINE_END = 'E',
+};
+
+static struct HSS_Timeline_Event {
+    uint64_t cycles;
+    uint32_t time;      // low 32 bits of mtime, i.e. wraps after ~71 minutes
+    uint8_t phase;
+    uint8_t hartId;     // hart the phase applies to, e.g. the target of a chunk download
+    uint8_t type;
+    uint8_t reserved;
+} timeline[CONFIG_DEBUG_BOOT_TIMELINE_NUM_EVENTS];
+
+_Static_assert(sizeof(struct HSS_Timeline_Event) == 16u, "Timeline events should be compact");
+
+static size_t eventCount = 0u;
+#endif
+
+static char const * const phaseNames[] = {
+    [ TIMELINE_DDR_TRAINING ]     = "DDR training",
+    [ TIMELINE_STORAGE_INIT ]     = "Storage init",
+    [ TIMELINE_GPT ]              = "GPT",
+    [ TIMELINE_IMAGE_COPY ]       = "Image copy",
+    [ TIMELINE_DECOMPRESS ]       = "Decompress",
+    [ TIMELINE_IMAGE_DIGEST ]     = "Image digest",
+    [ TIMELINE_SIGNATURE_VERIFY ] = "Signature verify",
+    [ TIMELINE_PMP_SETUP ]        = "PMP setup",
+    [ TIMELINE_CHUNK_DOWNLOAD ]   = "Chunk download",
+    [ TIMELINE_OPENSBI_INIT ]     = "OpenSBI init",
+};
+
+_Static_assert(ARRAY_SIZE(phaseNames) == TIMELINE_NUM_PHASES, "Missing timeline phase names");
+
+#if IS_ENABLED(CONFIG_DEBUG_BOOT_TIMELINE)
+static void timeline_record_(enum HSS_Timeline_Phase phase, enum HSSHartId hartId, uint8_t type)
+{
+    assert(phase < TIMELINE_NUM_PHASES);
+
+    size_t const index = __atomic_fetch_add(&eventCount, 1u, __ATOMIC_RELAXED);
+
+    if (index < ARRAY_SIZE(timeline)) {
+        timeline[index].cycles = CSR_GetTickCount();
+        timeline[index].time = (uint32_t)HSS_GetTime();
+        timeline[index].phase = (uint8_t)phase;
+        timeline[index].hartId = (uint8_t)hartId;
+        timeline[index].type = type;
+    }
+}
+#endif
+
+void HSS_Timeline_Begin(enum HSS_Timeline_Phase phase, enum HSSHartId hartId)
+{
+#if IS_ENABLED(CONFIG_DEBUG_BOOT_TIMELINE)
+    timeline_record_(phase, hartId, TIMELINE_BEGIN);
+#else
+    (void)phase;
+    (void)hartId;
+#endif
+}
+
+void HSS_Timeline_End(enum HSS_Timeline_Phase phase, enum HSSHartId hartId)
+{
+#if IS_ENABLED(CONFIG_DEBUG_BOOT_TIMELINE)
+    timeline_record_(phase, hartId, TIMELINE_END);
+#else
+    (void)phase;
+    (void)hartId;
+#endif
+}
+
+void HSS_Timeline_Dump(void)
+{
+#if IS_ENABLED(CONFIG_DEBUG_BOOT_TIMELINE)
+    size_t const count = __atomic_load_n(&eventCount, __ATOMIC_ACQUIRE);
+    size_t const recorded = MIN(count, ARRAY_SIZE(timeline));
+
+    mHSS_DEBUG_PRINTF_EX("# Boot Timeline Dump\n"
+        "# %lu events recorded, %lu dropped, %lu ticks per second\n"
+        "# T, Type, Phase, Hart, Mtime, Mcycle\n",
+        recorded, count - recorded, (size_t)TICKS_PER_SEC);
+
+    for (size_t i = 0u; i < recorded; i++) {
+        mHSS_DEBUG_PRINTF_EX("T, %c, %s, %u, %u, %" PRIu64 "\n", timeline[i].type,
+            phaseNames[timeline[i].phase], timeline[i].hartId, timeline[i].time,
+            timeline[i].cycles);
+    }
+#endif
+}
+
+uint32_t HSS_Timeline_GetPhaseTicks(enum HSS_Timeline_Phase phase)
+{
+    uint32_t result = 0u;
+
+#if IS_ENABLED(CONFIG_DEBUG_BOOT_TIMELINE)
+    size_t const recorded = MIN(__atomic_load_n(&eventCount, __ATOMIC_ACQUIRE), ARRAY_SIZE(timeline));
+    bool begun = false, ended = false;
+    uint32_t firstBegin = 0u, lastEnd = 0u;
+
+    for (size_t i = 0u; i < recorded; i++) {
+        if (timeline[i].phase != phase) {
+            continue;
+        }
+
+        if ((timeline[i].type == TIMELINE_BEGIN) && !begun) {
+            firstBegin = timeline[i].time;
+            begun = true;
+        } else if ((timeline[i].type == TIMELINE_END) && begun) {
+            lastEnd = timeline[i].time;
+            ended = true;
+        }
+    }
+
+    if (ended) {
+        result = lastEnd - firstBegin;
+    }
+#else
+    (void)phase;
+#endif
+
+    return result;
+}
+
+char const *HSS_Timeline_GetPhaseName(enum HSS_Timeline_Phase phase)
+{
+    assert(phase < TIMELINE_NUM_PHASES);
+
+    return phaseNames[phase];
+}
@@ -0,0 +1,54 @@
+#ifndef HSS_TIMELINE_H
+#define HSS_TIMELINE_H
+
+/*******************************************************************************
+ * Copyright 2019-2025 Microchip FPGA Embedded Systems Solutions.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * MPFS HSS Embedded Software
+ *
+ */
+
+/**
+ * \file Boot Timeline
+ * \brief Boot phase timeline recorder
+ */
+
+#include "config.h"
+#include "hss_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+enum HSS_Timeline_Phase {
+    TIMELINE_DDR_TRAINING,
+    TIMELINE_STORAGE_INIT,
+    TIMELINE_GPT,
+    TIMELINE_IMAGE_COPY,
+    TIMELINE_DECOMPRESS,
+    TIMELINE_IMAGE_DIGEST,
+    TIMELINE_SIGNATURE_VERIFY,
+    TIMELINE_PMP_SETUP,
+    TIMELINE_CHUNK_DOWNLOAD,
+    TIMELINE_OPENSBI_INIT,
+    TIMELINE_NUM_PHASES
+};
+
+void HSS_Timeline_Begin(enum HSS_Timeline_Phase phase, enum HSSHartId hartId);
+void HSS_Timeline_End(enum HSS_Timeline_Phase phase, enum HSSHartId hartId);
+void HSS_Timeline_Dump(void);
+
+/**
+ * Returns the mtime ticks from the first begin to the last end of a phase, across all
+ * harts, or zero if the phase has not been recorded as ending.
+ */
+uint32_t HSS_Timeline_GetPhaseTicks(enum HSS_Timeline_Phase phase);
+char const *HSS_Timeline_GetPhaseName(enum HSS_Timeline_Phase phase);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -10,83 +10,254 @@
 /**
  * \file Code Profiling
  * \brief Code Profiling
+ *
+ * Each profiled hart has its own function table, call graph edge table and
+ * shadow call stack, so the hooks never need to lock. Functions and edges
+ * are found by open-addressing hashes on their addresses. The shadow stack
+ * gives inclusive and self (exclusive) time per function, and per
+ * caller->callee edge.
  */
 
 #include "config.h"
 #include "hss_types.h"
 #include "csr_helper.h"
+#include "profiling.h"
 
 #include <assert.h>
 
+#define NO_INSTRUMENT __attribute__((no_instrument_function))
+
+#if IS_ENABLED(CONFIG_DEBUG_PROFILING_U54)
+#  define PROFILE_NUM_HARTS MAX_NUM_HARTS
+#else
+#  define PROFILE_NUM_HARTS 1u
+#endif
+
+#define PROFILE_NO_NODE ((uint16_t)0xFFFFu)
+
+_Static_assert(CONFIG_DEBUG_PROFILING_MAX_NUM_FUNCTIONS < PROFILE_NO_NODE, "Too many profiled functions");
+
 struct ProfileNode {
     void *pFunc;
+    uint64_t callCount;
+    uint64_t inclusiveTime;
+    uint64_t selfTime;
+    uint32_t activeDepth; // for recursion, only the outermost call adds to inclusiveTime
+};
+
+struct ProfileEdge {
+    uint16_t caller;
+    uint16_t callee;
+    uint32_t callCount;
+    uint64_t inclusiveTime;
+};
+
+struct ProfileFrame {
+    uint16_t node;
+    uint16_t edge;
     uint64_t entryTime;
-    uint64_t timeCount;
-} profileStats[CONFIG_DEBUG_PROFILING_MAX_NUM_FUNCTIONS] = { 0 };
-size_t allocationCount = 0u;
+    uint64_t childTime;
+};
+
+static struct ProfileHart {
+    struct ProfileNode nodes[CONFIG_DEBUG_PROFILING_MAX_NUM_FUNCTIONS];
+    struct ProfileEdge edges[CONFIG_DEBUG_PROFILING_MAX_NUM_EDGES];
+    struct ProfileFrame stack[CONFIG_DEBUG_PROFILING_MAX_DEPTH];
+    size_t depth;
+    size_t nodeCount;
+    size_t edgeCount;
+    uint64_t droppedCalls;  // table full or stack too deep
+    uint64_t unmatchedExits;
+} profileStats[PROFILE_NUM_HARTS] = { 0 };
 
-void __attribute__((no_instrument_function)) __cyg_profile_func_enter (void *pFunc, void *pCaller)
+static inline size_t NO_INSTRUMENT hash_(uint64_t key, size_t size)
 {
-    enum HSSHartId const myHartId = current_hartid();
-    (void) pCaller;
+    return (size_t)((key * 0x9E3779B97F4A7C15llu) >> 32) % size;
+}
 
-    if (myHartId != 0) { return; }
+static uint16_t NO_INSTRUMENT find_node_(struct ProfileHart * const pHart, void *pFunc)
+{
+    size_t const size = ARRAY_SIZE(pHart->nodes);
+    size_t index = hash_((uintptr_t)pFunc >> 1, size); // functions are at least 2-byte aligned
+    uint16_t result = PROFILE_NO_NODE;
 
-    assert(pFunc != NULL);
-    struct ProfileNode *pProfileNode = NULL;
+    for (size_t probe = 0u; probe < size; probe++) {
+        struct ProfileNode * const pNode = &(pHart->nodes[index]);
 
-    size_t i;
-    for (i = 0u; i < allocationCount; i++) {
-        if (profileStats[i].pFunc == pFunc) {
-            pProfileNode = &(profileStats[i]);
+        if (pNode->pFunc == pFunc) {
+            result = (uint16_t)index;
+            break;
+        } else if (!pNode->pFunc) {
+            // keep at least one slot free so that misses terminate quickly
+            if (pHart->nodeCount < (size - 1u)) {
+                pNode->pFunc = pFunc;
+                pHart->nodeCount++;
+                result = (uint16_t)index;
+            }
             break;
         }
+
+        index = (index + 1u) % size;
     }
 
-    if (!pProfileNode) {
-        if (allocationCount < ARRAY_SIZE(profileStats)) {
-            pProfileNode = &(profileStats[allocationCount]);
-            allocationCount++;
-            pProfileNode->pFunc = pFunc;
-            pProfileNode->timeCount = 0lu;
+    return result;
+}
+
+static uint16_t NO_INSTRUMENT find_edge_(struct ProfileHart * const pHart, uint16_t caller, uint16_t callee)
+{
+    size_t const size = ARRAY_SIZE(pHart->edges);
+    size_t index = hash_(((uint64_t)caller << 16) | callee, size);
+    uint16_t result = PROFILE_NO_NODE;
+
+    for (size_t probe = 0u; probe < size; probe++) {
+        struct ProfileEdge * const pEdge = &(pHart->edges[index]);
+
+        if (pEdge->callCount && (pEdge->caller == caller) && (pEdge->callee == callee)) {
+            result = (uint16_t)index;
+            break;
+        } else if (!pEdge->callCount) {
+            if (pHart->edgeCount < (size - 1u)) {
+                pEdge->caller = caller;
+                pEdge->callee = callee;
+                pHart->edgeCount++;
+                result = (uint16_t)index;
+            }
+            break;
         }
+
+        index = (index + 1u) % size;
     }
 
-    if (pProfileNode) {
-        pProfileNode->entryTime = CSR_GetTickCount();
+    return result;
+}
+
+void NO_INSTRUMENT __cyg_profile_func_enter (void *pFunc, void *pCaller)
+{
+    enum HSSHartId const myHartId = current_hartid();
+    (void) pCaller;
+
+    if (myHartId >= PROFILE_NUM_HARTS) { return; }
+
+    assert(pFunc != NULL);
+    struct ProfileHart * const pHart = &(profileStats[myHartId]);
+
+    if (pHart->depth >= ARRAY_SIZE(pHart->stack)) {
+        pHart->droppedCalls++;
+        pHart->depth++; // keep track of depth, so that the matching exit can be ignored
+        return;
+    }
+
+    uint16_t const node = find_node_(pHart, pFunc);
+    uint16_t edge = PROFILE_NO_NODE;
+
+    if (node != PROFILE_NO_NODE) {
+        pHart->nodes[node].callCount++;
+        pHart->nodes[node].activeDepth++;
+
+        if (pHart->depth && (pHart->stack[pHart->depth - 1u].node != PROFILE_NO_NODE)) {
+            edge = find_edge_(pHart, pHart->stack[pHart->depth - 1u].node, node);
+            if (edge != PROFILE_NO_NODE) {
+                pHart->edges[edge].callCount++;
+            }
+        }
+    } else {
+        pHart->droppedCalls++;
     }
 
-    return;
+    struct ProfileFrame * const pFrame = &(pHart->stack[pHart->depth]);
+    pFrame->node = node;
+    pFrame->edge = edge;
+    pFrame->childTime = 0u;
+    pHart->depth++;
+
+    // take the entry time last, so that the time spent in this hook is not charged to pFunc
+    pFrame->entryTime = CSR_GetTickCount();
 }
 
-void __attribute__((no_instrument_function)) __cyg_profile_func_exit (void *pFunc, void *pCaller)
+void NO_INSTRUMENT __cyg_profile_func_exit (void *pFunc, void *pCaller)
 {
+    uint64_t const now = CSR_GetTickCount();
     enum HSSHartId const myHartId = current_hartid();
     (void) pCaller;
 
     assert(pFunc != NULL);
 
-    if (myHartId != 0) { return; }
+    if (myHartId >= PROFILE_NUM_HARTS) { return; }
 
-    size_t i;
-    for (i = 0u; i < allocationCount; i++) {
-        if (profileStats[i].pFunc == pFunc) {
-            profileStats[i].timeCount += (CSR_GetTickCount() - profileStats[i].entryTime);
-            break;
+    struct ProfileHart * const pHart = &(profileStats[myHartId]);
+
+    if (!pHart->depth) {
+        pHart->unmatchedExits++;
+        return;
+    }
+
+    pHart->depth--;
+    if (pHart->depth >= ARRAY_SIZE(pHart->stack)) {
+        return; // entry was not recorded
+    }
+
+    struct ProfileFrame * const pFrame = &(pHart->stack[pHart->depth]);
+    uint64_t const elapsed = now - pFrame->entryTime;
+
+    if (pFrame->node != PROFILE_NO_NODE) {
+        struct ProfileNode * const pNode = &(pHart->nodes[pFrame->node]);
+
+        if (pNode->pFunc != pFunc) {
+            pHart->unmatchedExits++;
         }
+
+        pNode->activeDepth--;
+        if (!pNode->activeDepth) {
+            pNode->inclusiveTime += elapsed;
+        }
+        pNode->selfTime += (elapsed > pFrame->childTime) ? (elapsed - pFrame->childTime) : 0u;
+    }
+
+    if (pFrame->edge != PROFILE_NO_NODE) {
+        pHart->edges[pFrame->edge].inclusiveTime += elapsed;
     }
 
-    return;
+    if (pHart->depth) {
+        pHart->stack[pHart->depth - 1u].childTime += elapsed;
+    }
 }
 
 
-void __attribute__((no_instrument_function)) HSS_Profile_DumpAll(void);
-void __attribute__((no_instrument_function)) HSS_Profile_DumpAll(void)
+void NO_INSTRUMENT HSS_Profile_DumpAll(void)
 {
-    mHSS_DEBUG_PRINTF_EX("# Profile Information Dump\n# FuncPtr, TickCount\n");
-    size_t i;
-    for (i = 0u; i < allocationCount; i++) {
-        mHSS_DEBUG_PRINTF_EX("%p, %lu\n", profileStats[i].pFunc, profileStats[i].timeCount);
+    mHSS_DEBUG_PRINTF_EX("# Profile Information Dump\n"
+        "# F, Hart, FuncPtr, Calls, InclusiveTicks, SelfTicks\n"
+        "# E, Hart, CallerPtr, CalleePtr, Calls, InclusiveTicks\n");
+
+    for (size_t hart = 0u; hart < ARRAY_SIZE(profileStats); hart++) {
+        struct ProfileHart const * const pHart = &(profileStats[hart]);
+
+        if (!pHart->nodeCount) {
+            continue;
+        }
+
+        mHSS_DEBUG_PRINTF_EX("# hart %lu: %lu functions, %lu edges, %" PRIu64 " dropped calls, "
+            "%" PRIu64 " unmatched exits\n", hart, pHart->nodeCount, pHart->edgeCount,
+            pHart->droppedCalls, pHart->unmatchedExits);
+
+        for (size_t i = 0u; i < ARRAY_SIZE(pHart->nodes); i++) {
+            struct ProfileNode const * const pNode = &(pHart->nodes[i]);
+
+            if (pNode->pFunc) {
+                mHSS_DEBUG_PRINTF_EX("F, %lu, %p, %" PRIu64 ", %" PRIu64 ", %" PRIu64 "\n", hart,
+                    pNode->pFunc, pNode->callCount, pNode->inclusiveTime, pNode->selfTime);
+            }
+        }
+
+        for (size_t i = 0u; i < ARRAY_SIZE(pHart->edges); i++) {
+            struct ProfileEdge const * const pEdge = &(pHart->edges[i]);
+
+            if (pEdge->callCount) {
+                mHSS_DEBUG_PRINTF_EX("E, %lu, %p, %p, %u, %" PRIu64 "\n", hart,
+                    pHart->nodes[pEdge->caller].pFunc, pHart->nodes[pEdge->callee].pFunc,
+                    pEdge->callCount, pEdge->inclusiveTime);
+            }
+        }
     }
 }
 
@@ -30,6 +30,20 @@
 #include "uart_helper.h"
 
 #include "hss_perfctr.h"
+#include "hss_clock.h"
+#include "hss_memtest_march.h"
+
+#if IS_ENABLED(CONFIG_MEMTEST_PARALLEL)
+#  include "csr_helper.h"
+#  include "ssmb_ipi.h"
+#  include "u54_state.h"
+#endif
+
+// Only poll the UART and update the progress bar every so many words, as doing so
+// for every word dominates the run time of the test
+#define MEMTEST_POLL_INTERVAL_WORDS (64u * 1024u)
+#define mMEMTEST_SHOULD_POLL(offset) (((offset) & (MEMTEST_POLL_INTERVAL_WORDS - 1u)) == 0u)
+#define MEMTEST_PROGRESS_INTERVAL (TICKS_PER_SEC / 4u)
 
 // Walking Ones test of the Data Bus wiring
 static uint64_t HSS_MemTestDataBus(volatile uint64_t *address)
@@ -152,10 +166,12 @@ static uint64_t *HSS_MemTestDevice(volatile uint64_t *baseAddr, size_t numBytes)
 
     for (pattern = 1u, offset = 0u; offset < numWords; pattern++, offset++) {
         baseAddr[offset] = pattern;
-        HSS_ShowProgress(numWords, numWords - offset);
+        if (mMEMTEST_SHOULD_POLL(offset)) {
+            HSS_ShowProgress(numWords, numWords - offset);
 
-        if (check_if_interrupted()) {
-            goto do_return;
+            if (check_if_interrupted()) {
+                goto do_return;
+            }
         }
     }
     HSS_ShowProgress(numWords, 0u); // clear progress indicator
@@ -178,10 +194,12 @@ static uint64_t *HSS_MemTestDevice(volatile uint64_t *baseAddr, size_t numBytes)
             baseAddr[offset] = antiPattern;
         }
 
-        HSS_ShowProgress(numWords, numWords - offset);
+        if (mMEMTEST_SHOULD_POLL(offset)) {
+            HSS_ShowProgress(numWords, numWords - offset);
 
-        if (check_if_interrupted()) {
-            goto do_return;
+            if (check_if_interrupted()) {
+                goto do_return;
+            }
         }
     }
     HSS_ShowProgress(numWords, 0u); // clear progress indicator
@@ -197,10 +215,12 @@ static uint64_t *HSS_MemTestDevice(volatile uint64_t *baseAddr, size_t numBytes)
                 break;
             }
 
-            HSS_ShowProgress(numWords, numWords - offset);
+            if (mMEMTEST_SHOULD_POLL(offset)) {
+                HSS_ShowProgress(numWords, numWords - offset);
 
-            if (check_if_interrupted()) {
-                goto do_return;
+                if (check_if_interrupted()) {
+                    goto do_return;
+                }
             }
         }
     }
@@ -255,7 +275,11 @@ bool HSS_MemTestDDRFull(void)
     bool result = HSS_MemTestDDRFast();
 
     if (result) {
+#if IS_ENABLED(CONFIG_MEMTEST_PARALLEL)
+        if (!HSS_MemTestDDRParallel((uint64_t *)HSS_DDR_GetStart(), HSS_DDR_GetSize())) {
+#else
         if (HSS_MemTestDevice((uint64_t *)HSS_DDR_GetStart(), HSS_DDR_GetSize()) != NULL) {
+#endif
             //mHSS_FANCY_PRINTF(LOG_ERROR, "FAILED!\n");
             result = false;
         }
@@ -281,3 +305,371 @@ bool HSS_MemTestDDR_Ex(volatile uint64_t *baseAddr, size_t numBytes)
 
     return result;
 }
+
+#if IS_ENABLED(CONFIG_MEMTEST_PARALLEL)
+//
+// Parallel device test
+//
+// The memory under test is split into one contiguous slice per idle U54. Each U54
+// runs the same seed / invert / verify passes as HSS_MemTestDevice() over its own
+// slice, while the E51 polls for Ctrl-C and aggregates progress and results.
+//
+// The U54s are only borrowed while they are idle, i.e. before they have been booted.
+//
+
+#define MEMTEST_NUM_PASSES        3u
+#define MEMTEST_STALL_TIMEOUT     (5u * TICKS_PER_SEC)  // without progress, a U54 is given up on
+#define MEMTEST_ABORT_GRACE       (TICKS_PER_SEC)       // for U54s to notice an abort
+
+static struct MemTestSlice {
+    volatile uint64_t *baseAddr;
+    size_t numWords;
+    uint64_t firstPattern;
+
+    size_t wordsDone;               // across all passes, written only by the U54
+    size_t errorCount;
+    uintptr_t firstErrorAddr;
+    uint64_t firstErrorValue;
+    uint64_t firstErrorExpected;
+    HSSTicks_t elapsed;
+    bool active;
+    bool complete;
+
+    size_t lastWordsDone;           // written only by the E51, to detect a stalled U54
+    HSSTicks_t lastProgressTime;
+    bool timedOut;
+} memTestSlices[HSS_HART_NUM_PEERS];
+
+static bool memTestAbort = false;
+
+static void memtest_slice_error_(struct MemTestSlice * const pSlice, size_t offset,
+    uint64_t value, uint64_t expected)
+{
+    if (!pSlice->errorCount) {
+        pSlice->firstErrorAddr = (uintptr_t)(pSlice->baseAddr + offset);
+        pSlice->firstErrorValue = value;
+        pSlice->firstErrorExpected = expected;
+    }
+    __atomic_store_n(&pSlice->errorCount, pSlice->errorCount + 1u, __ATOMIC_RELEASE);
+}
+
+static bool memtest_slice_poll_(struct MemTestSlice * const pSlice, size_t wordsDone)
+{
+    __atomic_store_n(&pSlice->wordsDone, wordsDone, __ATOMIC_RELAXED);
+    return __atomic_load_n(&memTestAbort, __ATOMIC_RELAXED);
+}
+
+static void memtest_slice_run_(struct MemTestSlice * const pSlice)
+{
+    volatile uint64_t * const baseAddr = pSlice->baseAddr;
+    size_t const numWords = pSlice->numWords;
+    size_t offset;
+    uint64_t pattern;
+
+    // write pattern to every cell
+    for (pattern = pSlice->firstPattern, offset = 0u; offset < numWords; pattern++, offset++) {
+        baseAddr[offset] = pattern;
+
+        if (mMEMTEST_SHOULD_POLL(offset) && memtest_slice_poll_(pSlice, offset)) {
+            return;
+        }
+    }
+
+    // check each location, and invert the pattern
+    for (pattern = pSlice->firstPattern, offset = 0u; offset < numWords; pattern++, offset++) {
+        uint64_t const value = baseAddr[offset];
+
+        if (value != pattern) {
+            memtest_slice_error_(pSlice, offset, value, pattern);
+        }
+        baseAddr[offset] = ~pattern;
+
+        if (mMEMTEST_SHOULD_POLL(offset) && memtest_slice_poll_(pSlice, numWords + offset)) {
+            return;
+        }
+    }
+
+    // check each location for the inverted pattern
+    for (pattern = pSlice->firstPattern, offset = 0u; offset < numWords; pattern++, offset++) {
+        uint64_t const value = baseAddr[offset];
+
+        if (value != ~pattern) {
+            memtest_slice_error_(pSlice, offset, value, ~pattern);
+        }
+
+        if (mMEMTEST_SHOULD_POLL(offset) && memtest_slice_poll_(pSlice, (2u * numWords) + offset)) {
+            return;
+        }
+    }
+
+    __atomic_store_n(&pSlice->wordsDone, MEMTEST_NUM_PASSES * numWords, __ATOMIC_RELAXED);
+}
+
+enum IPIStatusCode HSS_MemTest_IPIHandler(TxId_t transaction_id, enum HSSHartId source,
+    uint32_t immediate_arg, void *p_extended_buffer_in_ddr, void *p_ancilliary_buffer_in_ddr)
+{
+    (void)transaction_id;
+    (void)source;
+    (void)immediate_arg;
+    (void)p_extended_buffer_in_ddr;
+    (void)p_ancilliary_buffer_in_ddr;
+
+    enum HSSHartId const myHartId = current_hartid();
+
+    if ((myHartId > HSS_HART_E51) && (myHartId < HSS_HART_NUM_PEERS)) {
+        struct MemTestSlice * const pSlice = &memTestSlices[myHartId];
+
+        if (__atomic_load_n(&pSlice->active, __ATOMIC_ACQUIRE)) {
+            HSSTicks_t const startTime = HSS_GetTime();
+            memtest_slice_run_(pSlice);
+            pSlice->elapsed = HSS_GetTime() - startTime;
+
+            __atomic_store_n(&pSlice->complete, true, __ATOMIC_RELEASE);
+        }
+    }
+
+    return IPI_IDLE;
+}
+
+bool HSS_MemTestDDRParallel(volatile uint64_t *baseAddr, size_t numBytes)
+{
+    bool result = true;
+    size_t const numWords = numBytes / sizeof(uint64_t);
+    uint32_t numHarts = 0u;
+
+    // only borrow U54s that haven't been booted
+    for (enum HSSHartId hartId = HSS_HART_U54_1; hartId < HSS_HART_NUM_PEERS; hartId++) {
+        memTestSlices[hartId].active = (HSS_U54_GetState_Ex(hartId) == HSS_State_Idle);
+        if (memTestSlices[hartId].active) {
+            numHarts++;
+        }
+    }
+
+    if (!numHarts) {
+        mHSS_FANCY_PRINTF(LOG_WARN, "No idle U54s, testing on the E51 alone\n");
+        return (HSS_MemTestDevice(baseAddr, numBytes) == NULL);
+    }
+
+    mHSS_FANCY_PRINTF(LOG_NORMAL, "Testing %lu MiB across %u U54s\n",
+        numBytes / mMiB_IN_BYTES, numHarts);
+
+    __atomic_store_n(&memTestAbort, false, __ATOMIC_RELAXED);
+
+    // partition into contiguous slices, the last active hart taking any remainder
+    size_t const wordsPerHart = numWords / numHarts;
+    size_t firstWord = 0u;
+    uint32_t hartIndex = 0u;
+
+    for (enum HSSHartId hartId = HSS_HART_U54_1; hartId < HSS_HART_NUM_PEERS; hartId++) {
+        struct MemTestSlice * const pSlice = &memTestSlices[hartId];
+
+        if (pSlice->active) {
+            hartIndex++;
+            pSlice->baseAddr = baseAddr + firstWord;
+            pSlice->numWords = (hartIndex == numHarts) ? (numWords - firstWord) : wordsPerHart;
+            pSlice->firstPattern = firstWord + 1u;  // same patterns as HSS_MemTestDevice()
+            pSlice->wordsDone = 0u;
+            pSlice->errorCount = 0u;
+            pSlice->elapsed = 0u;
+            pSlice->complete = false;
+            pSlice->lastWordsDone = 0u;
+            pSlice->timedOut = false;
+            firstWord += pSlice->numWords;
+        }
+    }
+
+    __sync_synchronize();
+
+    for (enum HSSHartId hartId = HSS_HART_U54_1; hartId < HSS_HART_NUM_PEERS; hartId++) {
+        if (memTestSlices[hartId].active
+                && !IPI_Send(hartId, IPI_MSG_MEMTEST, 0u, 0u, NULL, NULL)) {
+            mHSS_FANCY_PRINTF(LOG_ERROR, "u54_%d: failed to start memory test\n", hartId);
+            __atomic_store_n(&memTestSlices[hartId].active, false, __ATOMIC_RELEASE);
+            result = false;
+        }
+    }
+
+    // aggregate progress, throttled to a few updates per second, and give up on any
+    // U54 which stops making progress, or which has not stopped shortly after an abort
+    HSSTicks_t const startTime = HSS_GetTime();
+    HSSTicks_t nextUpdate = startTime;
+    HSSTicks_t abortTime = 0u;
+    bool aborted = false;
+    size_t const totalWords = MEMTEST_NUM_PASSES * numWords;
+    bool allComplete;
+
+    for (enum HSSHartId hartId = HSS_HART_U54_1; hartId < HSS_HART_NUM_PEERS; hartId++) {
+        memTestSlices[hartId].lastProgressTime = startTime;
+    }
+
+    do {
+        size_t wordsDone = 0u;
+        allComplete = true;
+
+        for (enum HSSHartId hartId = HSS_HART_U54_1; hartId < HSS_HART_NUM_PEERS; hartId++) {
+            struct MemTestSlice * const pSlice = &memTestSlices[hartId];
+
+            if (pSlice->active && !pSlice->timedOut
+                    && !__atomic_load_n(&pSlice->complete, __ATOMIC_ACQUIRE)) {
+                size_t const sliceWordsDone = __atomic_load_n(&pSlice->wordsDone, __ATOMIC_RELAXED);
+
+                if (sliceWordsDone != pSlice->lastWordsDone) {
+                    pSlice->lastWordsDone = sliceWordsDone;
+                    pSlice->lastProgressTime = HSS_GetTime();
+                }
+
+                if (HSS_Timer_IsElapsed(pSlice->lastProgressTime, MEMTEST_STALL_TIMEOUT)
+                        || (aborted && HSS_Timer_IsElapsed(abortTime, MEMTEST_ABORT_GRACE))) {
+                    mHSS_FANCY_PRINTF(LOG_ERROR, "u54_%d: not responding, giving up\n", hartId);
+                    pSlice->timedOut = true;
+                    result = false;
+
+                    if (!aborted) {
+                        aborted = true;
+                        abortTime = HSS_GetTime();
+                        __atomic_store_n(&memTestAbort, true, __ATOMIC_RELAXED);
+                    }
+                } else {
+                    allComplete = false;
+                }
+            }
+
+            if (pSlice->active) {
+                wordsDone += __atomic_load_n(&pSlice->wordsDone, __ATOMIC_RELAXED);
+            }
+        }
+
+        if (HSS_Timer_IsElapsed(nextUpdate, 0u)) {
+            HSS_ShowProgress(totalWords, totalWords - wordsDone);
+            nextUpdate = HSS_GetTime() + MEMTEST_PROGRESS_INTERVAL;
+
+            if (!aborted && check_if_interrupted()) {
+                mHSS_FANCY_PRINTF(LOG_WARN, "Aborting...\n");
+                aborted = true;
+                abortTime = HSS_GetTime();
+                __atomic_store_n(&memTestAbort, true, __ATOMIC_RELAXED);
+                result = false;
+            }
+        }
+    } while (!allComplete);
+
+    HSSTicks_t const elapsed = HSS_GetTime() - startTime;
+    HSS_ShowProgress(totalWords, 0u); // clear progress indicator
+
+    size_t totalErrors = 0u;
+    for (enum HSSHartId hartId = HSS_HART_U54_1; hartId < HSS_HART_NUM_PEERS; hartId++) {
+        struct MemTestSlice const * const pSlice = &memTestSlices[hartId];
+
+        if (pSlice->timedOut) {
+            mHSS_FANCY_PRINTF(LOG_ERROR, "u54_%d: 0x%lx-0x%lx, FAILED (did not finish)\n", hartId,
+                (uintptr_t)pSlice->baseAddr, (uintptr_t)(pSlice->baseAddr + pSlice->numWords) - 1u);
+        } else if (pSlice->active) {
+            mHSS_FANCY_PRINTF(LOG_NORMAL,
+                "u54_%d: 0x%lx-0x%lx, %lu errors, %lu ms\n", hartId,
+                (uintptr_t)pSlice->baseAddr, (uintptr_t)(pSlice->baseAddr + pSlice->numWords) - 1u,
+                pSlice->errorCount, (size_t)(pSlice->elapsed / TICKS_PER_MILLISEC));
+            if (pSlice->errorCount) {
+                mHSS_FANCY_PRINTF(LOG_ERROR, "u54_%d: first error:\n", hartId);
+                log_error_((int)pSlice->errorCount, (void *)pSlice->firstErrorAddr, pSlice->firstErrorValue,
+                    pSlice->firstErrorExpected);
+            }
+            totalErrors += pSlice->errorCount;
+        }
+    }
+
+    if (totalErrors) {
+        result = false;
+    }
+
+    mHSS_FANCY_PRINTF(LOG_NORMAL, "%lu errors in %lu ms (%lu MiB/s per pass)\n", totalErrors,
+        (size_t)(elapsed / TICKS_PER_MILLISEC),
+        elapsed ? (size_t)(((numBytes / mMiB_IN_BYTES) * MEMTEST_NUM_PASSES * TICKS_PER_SEC) / elapsed) : 0u);
+
+    return result;
+}
+#endif
+
+//
+// March / walking ones burst tests
+//
+
+struct MemTestProgress {
+    HSSTicks_t nextUpdate;
+};
+
+static bool memtest_poll_(void *pContext, size_t wordsDone, size_t wordsTotal)
+{
+    struct MemTestProgress * const pProgress = (struct MemTestProgress *)pContext;
+    bool result = false;
+
+    if (HSS_Timer_IsElapsed(pProgress->nextUpdate, 0u)) {
+        HSS_ShowProgress(wordsTotal, wordsTotal - wordsDone);
+        pProgress->nextUpdate = HSS_GetTime() + MEMTEST_PROGRESS_INTERVAL;
+
+        result = check_if_interrupted();
+    }
+
+    return result;
+}
+
+static void memtest_report_(struct HSS_MemTest_Stats const * const pStats, HSSTicks_t elapsed)
+{
+    mHSS_FANCY_PRINTF(LOG_NORMAL, "%lu errors, %" PRIu64 " MiB accessed in %" PRIu64 " ms (%" PRIu64 " MB/s)%s\n",
+        pStats->errorCount, pStats->bytesAccessed / mMiB_IN_BYTES, elapsed / TICKS_PER_MILLISEC,
+        elapsed ? ((pStats->bytesAccessed * TICKS_PER_SEC) / elapsed) / 1000000u : 0u,
+        pStats->aborted ? " (aborted)" : "");
+
+    if (pStats->errorCount) {
+        log_error_(1, (void *)pStats->firstErrorAddr, pStats->firstErrorValue, pStats->firstErrorExpected);
+        mHSS_FANCY_PRINTF(LOG_ERROR, "Failing addresses 0x%lx-0x%lx, failing bits 0x%016" PRIx64 "\n",
+            pStats->lowestErrorAddr, pStats->highestErrorAddr, pStats->failingBits);
+
+        for (size_t bit = 0u; bit < ARRAY_SIZE(pStats->bitErrorCount); bit++) {
+            if (pStats->bitErrorCount[bit]) {
+                mHSS_FANCY_PRINTF(LOG_ERROR, "  bit %2lu: %u errors\n",
+                    bit, pStats->bitErrorCount[bit]);
+            }
+        }
+    }
+}
+
+bool HSS_MemTestMarch(enum HSS_MemTest_Algorithm algorithm, uint32_t patternMask,
+    volatile uint64_t *baseAddr, size_t numBytes)
+{
+    struct HSS_MemTest_Stats stats;
+    struct MemTestProgress progress = { .nextUpdate = HSS_GetTime() };
+    size_t const numWords = numBytes / sizeof(uint64_t);
+
+    HSS_MemTest_ResetStats(&stats);
+
+    // the walking ones burst test doesn't use a data background
+    if (algorithm == MEMTEST_WALKING_ONES_BURST) {
+        patternMask = 1u;
+    }
+
+    HSSTicks_t const startTime = HSS_GetTime();
+
+    for (size_t i = 0u; (i < HSS_MemTest_NumPatterns) && !stats.aborted; i++) {
+        if (patternMask & (1u << i)) {
+            if (algorithm == MEMTEST_WALKING_ONES_BURST) {
+                mHSS_FANCY_PRINTF(LOG_NORMAL, "%s: 0x%lx-0x%lx\n", HSS_MemTest_GetAlgorithmName(algorithm),
+                    (uintptr_t)baseAddr, (uintptr_t)(baseAddr + numWords) - 1u);
+            } else {
+                mHSS_FANCY_PRINTF(LOG_NORMAL, "%s: 0x%lx-0x%lx, %s background (0x%016" PRIx64 ")\n",
+                    HSS_MemTest_GetAlgorithmName(algorithm), (uintptr_t)baseAddr,
+                    (uintptr_t)(baseAddr + numWords) - 1u, HSS_MemTest_Patterns[i].name,
+                    HSS_MemTest_Patterns[i].background);
+            }
+
+            (void)HSS_MemTest_Run(algorithm, HSS_MemTest_Patterns[i].background, baseAddr, numWords,
+                &stats, memtest_poll_, &progress);
+            HSS_ShowProgress(numWords, 0u); // clear progress indicator
+        }
+    }
+
+    memtest_report_(&stats, HSS_GetTime() - startTime);
+
+    clear_bootup_cache_ways();
+
+    return !stats.errorCount && !stats.aborted;
+}
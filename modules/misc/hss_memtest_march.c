@@ -0,0 +1,295 @@
+/*******************************************************************************
+ * Copyright 2019-2025 Microchip FPGA Embedded Systems Solutions.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * MPFS HSS Embedded Software
+ *
+ */
+
+/**
+ * \file March Memory Test Engine
+ * \brief March C- / March SS and walking ones burst memory test engine
+ *
+ * March tests walk the memory in ascending or descending address order, applying
+ * the same short sequence of reads and writes to each word before moving on. The
+ * sequences are chosen to detect stuck-at, transition, address decoder and
+ * coupling faults. See
+ *   van de Goor, A.J. "Testing Semiconductor Memories: Theory and Practice", 1991
+ *   Hamdioui, S. et al. "March SS: A Test for All Static Simple RAM Faults", 2002
+ *
+ * "0" and "1" in a March element are the data background and its inverse. Running
+ * the tests over each of the backgrounds in HSS_MemTest_Patterns[] extends them to
+ * intra-word coupling faults.
+ *
+ * The walking ones burst test writes a whole cache line at a time with eight
+ * back-to-back 64-bit stores, so that the DDR controller sees full bursts, and
+ * walks a single set bit (and then a single clear bit) across the data bus.
+ */
+
+#include "hss_memtest_march.h"
+
+#ifndef mMEMTEST_READ
+#  define mMEMTEST_READ(pAddr) (*(pAddr))
+#endif
+#ifndef mMEMTEST_WRITE
+#  define mMEMTEST_WRITE(pAddr, value) (*(pAddr) = (value))
+#endif
+
+#define MEMTEST_POLL_INTERVAL_WORDS (64u * 1024u)
+#define MEMTEST_CACHE_LINE_WORDS    (64u / sizeof(uint64_t))
+#define MEMTEST_MAX_OPS             5u
+
+enum MarchOp {
+    OP_NONE = 0,
+    OP_R0,
+    OP_R1,
+    OP_W0,
+    OP_W1,
+};
+
+enum MarchDirection {
+    DIR_UP,     // also used for "either direction"
+    DIR_DOWN,
+};
+
+struct MarchElement {
+    enum MarchDirection direction;
+    uint8_t ops[MEMTEST_MAX_OPS];
+};
+
+// March C-: {any(w0); up(r0,w1); up(r1,w0); down(r0,w1); down(r1,w0); any(r0)}
+static const struct MarchElement marchCMinus[] = {
+    { DIR_UP,   { OP_W0 } },
+    { DIR_UP,   { OP_R0, OP_W1 } },
+    { DIR_UP,   { OP_R1, OP_W0 } },
+    { DIR_DOWN, { OP_R0, OP_W1 } },
+    { DIR_DOWN, { OP_R1, OP_W0 } },
+    { DIR_UP,   { OP_R0 } },
+};
+
+// March SS: {any(w0); up(r0,r0,w0,r0,w1); up(r1,r1,w1,r1,w0);
+//            down(r0,r0,w0,r0,w1); down(r1,r1,w1,r1,w0); any(r0)}
+static const struct MarchElement marchSS[] = {
+    { DIR_UP,   { OP_W0 } },
+    { DIR_UP,   { OP_R0, OP_R0, OP_W0, OP_R0, OP_W1 } },
+    { DIR_UP,   { OP_R1, OP_R1, OP_W1, OP_R1, OP_W0 } },
+    { DIR_DOWN, { OP_R0, OP_R0, OP_W0, OP_R0, OP_W1 } },
+    { DIR_DOWN, { OP_R1, OP_R1, OP_W1, OP_R1, OP_W0 } },
+    { DIR_UP,   { OP_R0 } },
+};
+
+// data backgrounds, one per power-of-two run length, covering intra-word coupling
+const struct HSS_MemTest_Pattern HSS_MemTest_Patterns[] = {
+    { "SOLID",   0x0000000000000000llu },
+    { "CHECKER", 0xAAAAAAAAAAAAAAAAllu },
+    { "PAIRS",   0xCCCCCCCCCCCCCCCCllu },
+    { "NIBBLES", 0xF0F0F0F0F0F0F0F0llu },
+    { "BYTES",   0xFF00FF00FF00FF00llu },
+    { "HALVES",  0xFFFF0000FFFF0000llu },
+    { "WORDS",   0xFFFFFFFF00000000llu },
+};
+const size_t HSS_MemTest_NumPatterns = sizeof(HSS_MemTest_Patterns) / sizeof(HSS_MemTest_Patterns[0]);
+
+static char const * const algorithmNames[] = {
+    [ MEMTEST_MARCH_C_MINUS ]      = "March C-",
+    [ MEMTEST_MARCH_SS ]           = "March SS",
+    [ MEMTEST_WALKING_ONES_BURST ] = "Walking ones burst",
+};
+
+char const *HSS_MemTest_GetAlgorithmName(enum HSS_MemTest_Algorithm algorithm)
+{
+    return (algorithm < MEMTEST_NUM_ALGORITHMS) ? algorithmNames[algorithm] : "unknown";
+}
+
+void HSS_MemTest_ResetStats(struct HSS_MemTest_Stats *pStats)
+{
+    *pStats = (struct HSS_MemTest_Stats) { .lowestErrorAddr = UINTPTR_MAX };
+}
+
+static void record_error_(struct HSS_MemTest_Stats *pStats, volatile uint64_t *pAddr,
+    uint64_t value, uint64_t expected)
+{
+    uintptr_t const addr = (uintptr_t)pAddr;
+    uint64_t diff = value ^ expected;
+
+    if (!pStats->errorCount) {
+        pStats->firstErrorAddr = addr;
+        pStats->firstErrorValue = value;
+        pStats->firstErrorExpected = expected;
+    }
+    pStats->errorCount++;
+
+    if (addr < pStats->lowestErrorAddr) {
+        pStats->lowestErrorAddr = addr;
+    }
+    if (addr > pStats->highestErrorAddr) {
+        pStats->highestErrorAddr = addr;
+    }
+
+    pStats->failingBits |= diff;
+    while (diff) {
+        pStats->bitErrorCount[__builtin_ctzll(diff)]++;
+        diff &= diff - 1u;
+    }
+}
+
+static bool poll_(HSS_MemTest_PollFn_t pPollFn, void *pContext, size_t wordsDone, size_t wordsTotal)
+{
+    return pPollFn && pPollFn(pContext, wordsDone, wordsTotal);
+}
+
+static bool run_march_(struct MarchElement const * const pElements, size_t numElements,
+    uint64_t background, volatile uint64_t *baseAddr, size_t numWords,
+    struct HSS_MemTest_Stats *pStats, HSS_MemTest_PollFn_t pPollFn, void *pContext)
+{
+    size_t const wordsTotal = numElements * numWords;
+    uint64_t const data[2] = { background, ~background };
+
+    for (size_t element = 0u; element < numElements; element++) {
+        struct MarchElement const * const pElement = &pElements[element];
+        size_t numOps = 0u;
+
+        while ((numOps < MEMTEST_MAX_OPS) && (pElement->ops[numOps] != OP_NONE)) {
+            numOps++;
+        }
+
+        for (size_t i = 0u; i < numWords; i++) {
+            size_t const offset = (pElement->direction == DIR_UP) ? i : (numWords - 1u - i);
+            volatile uint64_t * const pAddr = baseAddr + offset;
+
+            for (size_t op = 0u; op < numOps; op++) {
+                uint64_t value;
+
+                switch (pElement->ops[op]) {
+                case OP_R0:
+                    __attribute__((fallthrough)); /* deliberately fallthrough */
+                case OP_R1:
+                    value = mMEMTEST_READ(pAddr);
+                    if (value != data[pElement->ops[op] == OP_R1]) {
+                        record_error_(pStats, pAddr, value, data[pElement->ops[op] == OP_R1]);
+                    }
+                    break;
+
+                case OP_W0:
+                    mMEMTEST_WRITE(pAddr, data[0]);
+                    break;
+
+                case OP_W1:
+                    mMEMTEST_WRITE(pAddr, data[1]);
+                    break;
+
+                case OP_NONE:
+                    __attribute__((fallthrough)); /* deliberately fallthrough */
+                default:
+                    break;
+                }
+            }
+
+            if (((i & (MEMTEST_POLL_INTERVAL_WORDS - 1u)) == 0u)
+                    && poll_(pPollFn, pContext, (element * numWords) + i, wordsTotal)) {
+                pStats->aborted = true;
+                return false;
+            }
+        }
+
+        pStats->bytesAccessed += (uint64_t)numOps * numWords * sizeof(uint64_t);
+    }
+
+    return true;
+}
+
+static inline uint64_t walking_bit_(size_t line, size_t word, bool invert)
+{
+    uint64_t const pattern = (uint64_t)1u << ((line + word) & 63u);
+    return invert ? ~pattern : pattern;
+}
+
+static bool run_walking_burst_(volatile uint64_t *baseAddr, size_t numWords,
+    struct HSS_MemTest_Stats *pStats, HSS_MemTest_PollFn_t pPollFn, void *pContext)
+{
+    size_t const numLines = numWords / MEMTEST_CACHE_LINE_WORDS;
+    size_t const wordsTotal = 4u * numLines * MEMTEST_CACHE_LINE_WORDS;
+    size_t wordsDone = 0u;
+
+    for (size_t pass = 0u; pass < 2u; pass++) {
+        bool const invert = (pass != 0u);
+
+        // write a full cache line at a time
+        for (size_t line = 0u; line < numLines; line++) {
+            volatile uint64_t * const pLine = baseAddr + (line * MEMTEST_CACHE_LINE_WORDS);
+
+            mMEMTEST_WRITE(&pLine[0], walking_bit_(line, 0u, invert));
+            mMEMTEST_WRITE(&pLine[1], walking_bit_(line, 1u, invert));
+            mMEMTEST_WRITE(&pLine[2], walking_bit_(line, 2u, invert));
+            mMEMTEST_WRITE(&pLine[3], walking_bit_(line, 3u, invert));
+            mMEMTEST_WRITE(&pLine[4], walking_bit_(line, 4u, invert));
+            mMEMTEST_WRITE(&pLine[5], walking_bit_(line, 5u, invert));
+            mMEMTEST_WRITE(&pLine[6], walking_bit_(line, 6u, invert));
+            mMEMTEST_WRITE(&pLine[7], walking_bit_(line, 7u, invert));
+
+            wordsDone += MEMTEST_CACHE_LINE_WORDS;
+            if (((line & ((MEMTEST_POLL_INTERVAL_WORDS / MEMTEST_CACHE_LINE_WORDS) - 1u)) == 0u)
+                    && poll_(pPollFn, pContext, wordsDone, wordsTotal)) {
+                pStats->aborted = true;
+                return false;
+            }
+        }
+
+        // only verify once everything has been written, so each line has to retain its data
+        for (size_t line = 0u; line < numLines; line++) {
+            volatile uint64_t * const pLine = baseAddr + (line * MEMTEST_CACHE_LINE_WORDS);
+
+            for (size_t word = 0u; word < MEMTEST_CACHE_LINE_WORDS; word++) {
+                uint64_t const expected = walking_bit_(line, word, invert);
+                uint64_t const value = mMEMTEST_READ(&pLine[word]);
+
+                if (value != expected) {
+                    record_error_(pStats, &pLine[word], value, expected);
+                }
+            }
+
+            wordsDone += MEMTEST_CACHE_LINE_WORDS;
+            if (((line & ((MEMTEST_POLL_INTERVAL_WORDS / MEMTEST_CACHE_LINE_WORDS) - 1u)) == 0u)
+                    && poll_(pPollFn, pContext, wordsDone, wordsTotal)) {
+                pStats->aborted = true;
+                return false;
+            }
+        }
+
+        pStats->bytesAccessed += 2u * numLines * MEMTEST_CACHE_LINE_WORDS * sizeof(uint64_t);
+    }
+
+    return true;
+}
+
+bool HSS_MemTest_Run(enum HSS_MemTest_Algorithm algorithm, uint64_t background,
+    volatile uint64_t *baseAddr, size_t numWords, struct HSS_MemTest_Stats *pStats,
+    HSS_MemTest_PollFn_t pPollFn, void *pContext)
+{
+    size_t const errorsBefore = pStats->errorCount;
+    bool result = false;
+
+    switch (algorithm) {
+    case MEMTEST_MARCH_C_MINUS:
+        result = run_march_(marchCMinus, sizeof(marchCMinus) / sizeof(marchCMinus[0]), background,
+            baseAddr, numWords, pStats, pPollFn, pContext);
+        break;
+
+    case MEMTEST_MARCH_SS:
+        result = run_march_(marchSS, sizeof(marchSS) / sizeof(marchSS[0]), background,
+            baseAddr, numWords, pStats, pPollFn, pContext);
+        break;
+
+    case MEMTEST_WALKING_ONES_BURST:
+        result = run_walking_burst_(baseAddr, numWords, pStats, pPollFn, pContext);
+        break;
+
+    case MEMTEST_NUM_ALGORITHMS:
+        __attribute__((fallthrough)); /* deliberately fallthrough */
+    default:
+        break;
+    }
+
+    return result && (pStats->errorCount == errorsBefore);
+}
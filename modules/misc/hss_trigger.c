@@ -17,6 +17,7 @@
 #include "assert.h"
 
 #include "hss_debug.h"
+#include "hss_clock.h"
 #include "hss_trigger.h"
 #include "riscv_atomic.h"
 
@@ -29,81 +30,94 @@
 
 #define CONFIG_DEBUG_TRIGGERS 0
 
-struct HSS_Triggers
-{
-    atomic_t opensbi_initialized;
-    atomic_t ipi_initialized;
-    atomic_t ddr_trained;
-    atomic_t startup_complete;
-    atomic_t usbdmsc_requested;
-    atomic_t usbdmsc_finished;
-    atomic_t post_boot;
-    atomic_t boot_complete;
-    atomic_t hart_state_changed;
-    atomic_t healthmon;
-} triggerStatus = {
-    .opensbi_initialized = ATOMIC_INITIALIZER(0),
-    .ipi_initialized =      ATOMIC_INITIALIZER(0),
-    .ddr_trained =         ATOMIC_INITIALIZER(0),
-    .startup_complete =    ATOMIC_INITIALIZER(0),
-    .usbdmsc_requested =   ATOMIC_INITIALIZER(0),
-    .usbdmsc_finished =    ATOMIC_INITIALIZER(0),
-    .post_boot =           ATOMIC_INITIALIZER(0),
-    .boot_complete =       ATOMIC_INITIALIZER(0),
-    .hart_state_changed =  ATOMIC_INITIALIZER(0),
-    .healthmon =           ATOMIC_INITIALIZER(0),
+_Static_assert(EVENT_NUM_EVENTS <= 64, "Events must fit in the 64-bit event word");
+
+// pulse events wake any waiters, but are never latched into the event word
+#define TRIGGER_PULSE_EVENTS (HSS_TRIGGER_EVENT(EVENT_BOOT_STARTED) \
+    | HSS_TRIGGER_EVENT(EVENT_HART_STATE_CHANGED) | HSS_TRIGGER_EVENT(EVENT_HEALTHMON))
+
+// DDR is considered notified as "trained" if training has completed,
+// or if DDR service is not enabled
+#define TRIGGER_ALWAYS_NOTIFIED_EVENTS \
+    (IS_ENABLED(CONFIG_SERVICE_DDR) ? 0llu : HSS_TRIGGER_EVENT(EVENT_DDR_TRAINED))
+
+static atomic_t triggerWord = ATOMIC_INITIALIZER(0);
+static struct HSS_Trigger_Waiter *pWaiterList = NULL;
+
+static char const * const triggerNames[] = {
+    [EVENT_OPENSBI_INITIALIZED] = "OpenSBI Initialized",
+    [EVENT_IPI_INITIALIZED] =     "IPI Initialized",
+    [EVENT_DDR_TRAINED] =         "DDR Trained",
+    [EVENT_STARTUP_COMPLETE] =    "Initial Startup Complete",
+    [EVENT_USBDMSC_REQUESTED] =   "USBDMSC Request",
+    [EVENT_USBDMSC_FINISHED] =    "USBDMSC Complete",
+    [EVENT_POST_BOOT] =           "Post First Boot",
+    [EVENT_BOOT_STARTED] =        "Boot Started",
+    [EVENT_BOOT_COMPLETE] =       "Boot Complete",
+    [EVENT_HART_STATE_CHANGED] =  "Hart State Changed",
+    [EVENT_HEALTHMON] =           "Healthmon Event",
+};
+
+static HSSTicks_t firstNotifyTime[EVENT_NUM_EVENTS];
+
+#if IS_ENABLED(CONFIG_DEBUG_TRIGGER_TIMELINE)
+struct TriggerTimelineEntry {
+    HSSTicks_t time;
+    uint8_t event;
+    bool cleared;
 };
 
+static struct TriggerTimelineEntry timeline[CONFIG_DEBUG_TRIGGER_TIMELINE_SIZE];
+static atomic_t timelineCount = ATOMIC_INITIALIZER(0);
+
+static void RecordTimeline_(enum HSS_Event event, bool cleared)
+{
+    HSSTicks_t const now = HSS_GetTime();
+    long const index = atomic_add_return(&timelineCount, 1) - 1;
+    struct TriggerTimelineEntry * const pEntry = &timeline[(unsigned long)index % ARRAY_SIZE(timeline)];
+
+    pEntry->time = now;
+    pEntry->event = (uint8_t)event;
+    pEntry->cleared = cleared;
+}
+#else
+static inline void RecordTimeline_(enum HSS_Event event, bool cleared)
+{
+    (void)event;
+    (void)cleared;
+}
+#endif
+
 void HSS_Trigger_Notify(enum HSS_Event event)
 {
+    assert(event < EVENT_NUM_EVENTS);
+
 #if IS_ENABLED(CONFIG_DEBUG_TRIGGERS)
-#define ARRAY_SIZE(x) (sizeof(x)/sizeof(x[0]))
-
-    char const * const triggerNames[] = {
-        [EVENT_OPENSBI_INITIALIZED] = "OpenSBI Initialized",
-        [EVENT_IPI_INITIALIZED] =     "IPI Initialized",
-        [EVENT_DDR_TRAINED] =         "DDR Trained",
-        [EVENT_STARTUP_COMPLETE] =    "Initial Startup Complete",
-        [EVENT_USBDMSC_REQUESTED] =   "USBDMSC Request",
-        [EVENT_USBDMSC_FINISHED] =    "USBDMSC Complete",
-        [EVENT_POST_BOOT] =           "Post First Boot",
-        [EVENT_BOOT_COMPLETE] =       "Boot Complete",
-        [EVENT_HART_STATE_CHANGED] =  "Hart State Changed",
-        [EVENT_HEALTHMON] =           "Healthmon Event",
-    };
-
-    assert(event < ARRAY_SIZE(triggerNames));
     mHSS_DEBUG_PRINTF(LOG_WARN, "*** TRIGGER: >>%s<<\n", (char *)triggerNames[event]);
 #endif
 
-    switch (event) {
-    case EVENT_OPENSBI_INITIALIZED:
-        atomic_write(&triggerStatus.opensbi_initialized, 1);
-        break;
+    RecordTimeline_(event, false);
 
-    case EVENT_IPI_INITIALIZED:
-        atomic_write(&triggerStatus.ipi_initialized, 1);
-        break;
+    if (!firstNotifyTime[event]) {
+        firstNotifyTime[event] = HSS_GetTime();
+    }
 
-    case EVENT_DDR_TRAINED:
-        atomic_write(&triggerStatus.ddr_trained, 1);
-        break;
+    if (!(HSS_TRIGGER_EVENT(event) & TRIGGER_PULSE_EVENTS)) {
+        atomic_set_bit((int)event, &triggerWord);
+    }
 
-    case EVENT_STARTUP_COMPLETE:
-        atomic_write(&triggerStatus.startup_complete, 1);
-        break;
+    for (struct HSS_Trigger_Waiter *pWaiter = pWaiterList; pWaiter; pWaiter = pWaiter->pNext) {
+        if (pWaiter->eventMask & HSS_TRIGGER_EVENT(event)) {
+            atomic_raw_set_bit((int)event, (volatile unsigned long *)&(pWaiter->pendingMask));
+        }
+    }
 
+    switch (event) {
     case EVENT_USBDMSC_REQUESTED:
-        atomic_write(&triggerStatus.usbdmsc_requested, 1);
 mHSS_DEBUG_PRINTF(LOG_WARN, "Notifying Trigger USBDMSC_REQUESTED\n");
         break;
 
-    case EVENT_USBDMSC_FINISHED:
-        atomic_write(&triggerStatus.usbdmsc_finished, 1);
-        break;
-
     case EVENT_POST_BOOT:
-        atomic_write(&triggerStatus.post_boot, 1);
 #if IS_ENABLED(CONFIG_SERVICE_BOOT) // TODO - move all this into uart_helper function
 #  if IS_ENABLED(CONFIG_UART_SURRENDER)
 #    if IS_ENABLED(CONFIG_SERVICE_TINYCLI)
@@ -116,116 +130,107 @@ mHSS_DEBUG_PRINTF(LOG_WARN, "Notifying Trigger USBDMSC_REQUESTED\n");
 #endif
         break;
 
-    case EVENT_BOOT_COMPLETE:
-        atomic_write(&triggerStatus.boot_complete, 1);
-        break;
-
-    case EVENT_HART_STATE_CHANGED:
-        break;
-
-    case EVENT_HEALTHMON:
-        break;
-
     default:
         break;
     }
 }
 
-bool HSS_Trigger_IsNotified(enum HSS_Event event)
+uint64_t HSS_Trigger_GetEvents(void)
 {
-    bool result = false;
-
-    switch (event) {
-    case EVENT_OPENSBI_INITIALIZED:
-        result = atomic_read(&triggerStatus.opensbi_initialized) ? true : false;
-        break;
-
-    case EVENT_IPI_INITIALIZED:
-        result = atomic_read(&triggerStatus.ipi_initialized) ? true : false;
-        break;
+    return (uint64_t)atomic_read(&triggerWord) | TRIGGER_ALWAYS_NOTIFIED_EVENTS;
+}
 
-    case EVENT_DDR_TRAINED:
-        // DDR is considered notified as "trained" if training has completed,
-        // or if DDR service is not enabled
-        result = atomic_read(&triggerStatus.ddr_trained) ? true : !IS_ENABLED(CONFIG_SERVICE_DDR);
-        break;
+uint64_t HSS_Trigger_GetFirstNotifyTime(enum HSS_Event event)
+{
+    assert(event < EVENT_NUM_EVENTS);
 
-    case EVENT_STARTUP_COMPLETE:
-        result = atomic_read(&triggerStatus.startup_complete) ? true : false;
-        break;
+    return firstNotifyTime[event];
+}
 
-    case EVENT_USBDMSC_REQUESTED:
-        result = atomic_read(&triggerStatus.usbdmsc_requested) ? true : false;
-        break;
+bool HSS_Trigger_IsNotified(enum HSS_Event event)
+{
+    return (HSS_Trigger_GetEvents() & HSS_TRIGGER_EVENT(event)) ? true : false;
+}
 
-    case EVENT_USBDMSC_FINISHED:
-        result = atomic_read(&triggerStatus.usbdmsc_finished) ? true : false;
-        break;
+void HSS_Trigger_Clear(enum HSS_Event event)
+{
+    assert(event < EVENT_NUM_EVENTS);
 
-    case EVENT_POST_BOOT:
-        result = atomic_read(&triggerStatus.post_boot) ? true : false;
-        break;
+    RecordTimeline_(event, true);
+    atomic_clear_bit((int)event, &triggerWord);
 
-    case EVENT_BOOT_COMPLETE:
-        result = atomic_read(&triggerStatus.boot_complete) ? true : false;
-        break;
+    if (event == EVENT_USBDMSC_REQUESTED) {
+mHSS_DEBUG_PRINTF(LOG_WARN, "Clearing Trigger USBDMSC_REQUESTED\n");
+    }
+}
 
-    case EVENT_HART_STATE_CHANGED:
-        break;
+/**
+ * \brief Register interest in a set of events
+ *
+ * Waiters are only ever added from the E51 superloop, and are never removed.
+ */
+void HSS_Trigger_Wait(struct HSS_Trigger_Waiter *pWaiter, uint64_t eventMask)
+{
+    assert(pWaiter != NULL);
 
-    case EVENT_HEALTHMON:
-        break;
+    pWaiter->eventMask = eventMask;
 
-    default:
-        break;
+    if (!pWaiter->registered) {
+        pWaiter->registered = true;
+        pWaiter->pNext = pWaiterList;
+        pWaiterList = pWaiter;
     }
-
-    return result;
 }
 
-void HSS_Trigger_Clear(enum HSS_Event event)
+bool HSS_Trigger_IsWaiterReady(struct HSS_Trigger_Waiter const *pWaiter)
 {
-    switch (event) {
-    case EVENT_OPENSBI_INITIALIZED:
-        atomic_write(&triggerStatus.opensbi_initialized, 0);
-        break;
+    return (pWaiter->pendingMask || (HSS_Trigger_GetEvents() & pWaiter->eventMask)) ? true : false;
+}
 
-    case EVENT_IPI_INITIALIZED:
-        atomic_write(&triggerStatus.ipi_initialized, 0);
-        break;
+uint64_t HSS_Trigger_Consume(struct HSS_Trigger_Waiter *pWaiter)
+{
+    return (uint64_t)atomic_raw_xchg_ulong((volatile unsigned long *)&(pWaiter->pendingMask), 0u);
+}
 
-    case EVENT_DDR_TRAINED:
-        atomic_write(&triggerStatus.ddr_trained, 0);
-        break;
+void HSS_Trigger_DumpTimeline(void)
+{
+    uint64_t const events = HSS_Trigger_GetEvents();
 
-    case EVENT_STARTUP_COMPLETE:
-        atomic_write(&triggerStatus.startup_complete, 0);
-        break;
+    mHSS_DEBUG_PRINTF(LOG_STATUS, "Event word: 0x%016" PRIx64 "\n", events);
 
-    case EVENT_USBDMSC_REQUESTED:
-        atomic_write(&triggerStatus.usbdmsc_requested, 0);
-mHSS_DEBUG_PRINTF(LOG_WARN, "Clearing Trigger USBDMSC_REQUESTED\n");
-        break;
+#if IS_ENABLED(CONFIG_DEBUG_TRIGGER_TIMELINE)
+    mHSS_DEBUG_PRINTF(LOG_STATUS, "%25s: %s : First Notified (ms since reset)\n", "Event", "Set");
 
-    case EVENT_USBDMSC_FINISHED:
-        atomic_write(&triggerStatus.usbdmsc_finished, 0);
-        break;
+    for (size_t i = 0u; i < ARRAY_SIZE(triggerNames); i++) {
+        HSSTicks_t const time = firstNotifyTime[i];
 
-    case EVENT_POST_BOOT:
-        atomic_write(&triggerStatus.post_boot, 0);
-        break;
+        if (time) {
+            mHSS_DEBUG_PRINTF(LOG_STATUS, "%25s:  %c  : %" PRIu64 ".%03" PRIu64 "\n", triggerNames[i],
+                (events & HSS_TRIGGER_EVENT(i)) ? 'Y' : 'N',
+                time / TICKS_PER_MILLISEC, ((time % TICKS_PER_MILLISEC) * 1000u) / TICKS_PER_MILLISEC);
+        } else {
+            mHSS_DEBUG_PRINTF(LOG_STATUS, "%25s:  %c  : -\n", triggerNames[i],
+                (events & HSS_TRIGGER_EVENT(i)) ? 'Y' : 'N');
+        }
+    }
 
-    case EVENT_BOOT_COMPLETE:
-        atomic_write(&triggerStatus.boot_complete, 0);
-        break;
+    unsigned long const count = (unsigned long)atomic_read(&timelineCount);
+    unsigned long const first = (count > ARRAY_SIZE(timeline)) ? (count - ARRAY_SIZE(timeline)) : 0u;
 
-    case EVENT_HART_STATE_CHANGED:
-        break;
+    mHSS_DEBUG_PRINTF(LOG_STATUS, "Timeline (%lu of %lu entries):\n", count - first, count);
 
-    case EVENT_HEALTHMON:
-        break;
+    for (unsigned long i = first; i < count; i++) {
+        struct TriggerTimelineEntry const * const pEntry = &timeline[i % ARRAY_SIZE(timeline)];
 
-    default:
-        break;
+        mHSS_DEBUG_PRINTF(LOG_STATUS, "%10" PRIu64 ".%03" PRIu64 " ms: %s %s\n",
+            pEntry->time / TICKS_PER_MILLISEC,
+            ((pEntry->time % TICKS_PER_MILLISEC) * 1000u) / TICKS_PER_MILLISEC,
+            pEntry->cleared ? "clear " : "notify", triggerNames[pEntry->event]);
     }
+#else
+    for (size_t i = 0u; i < ARRAY_SIZE(triggerNames); i++) {
+        mHSS_DEBUG_PRINTF(LOG_STATUS, "%25s: %c\n", triggerNames[i],
+            (events & HSS_TRIGGER_EVENT(i)) ? 'Y' : 'N');
+    }
+#endif
 }
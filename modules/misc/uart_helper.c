@@ -153,6 +153,19 @@ ssize_t uart_getline(char **pBuffer, size_t *pBufLen)
     return result;
 }
 
+#define UART_LSR_DATA_READY 0x01u
+
+bool uart_rx_ready(void)
+{
+    mss_uart_instance_t *pUart = HSS_UART_GetInstance(HSS_HART_E51);
+
+    // accumulate the line status as MSS_UART_get_rx() does, as reading LSR clears error bits
+    uint8_t const status = pUart->hw_reg->LSR;
+    pUart->status |= status;
+
+    return (status & UART_LSR_DATA_READY) ? true : false;
+}
+
 bool uart_getchar(uint8_t *pbuf, int32_t timeout_sec, bool do_sec_tick)
 {
     bool result = false;
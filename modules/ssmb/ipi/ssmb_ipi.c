@@ -116,6 +116,7 @@ __extension__ static const char * const ipiName[] = { // IPI_MSG_NUM_MSG_TYPES
     [ IPI_MSG_OPENSBI_INIT ]      = "IPI_MSG_OPENSBI_INIT",
     [ IPI_MSG_DDR_TRAIN ]         = "IPI_MSG_DDR_TRAIN",
     [ IPI_MSG_SCRUB ]             = "IPI_MSG_SCRUB",
+    [ IPI_MSG_MEMTEST ]           = "IPI_MSG_MEMTEST",
 };
 #endif
 
@@ -377,6 +378,37 @@ bool IPI_PollReceive(union HSSHartBitmask hartMask)
     return result;
 }
 
+//
+// @brief Get the types of IPI messages currently queued for this hart
+// @param hartMask [in] bitmask of source harts to look at
+// @return uint32_t bitmask with bit N set if a message of type N is pending
+//
+uint32_t IPI_GetPendingMsgTypes(union HSSHartBitmask hartMask)
+{
+    uint32_t result = 0u;
+    uint32_t i;
+
+    enum HSSHartId const myHartId = current_hartid();
+
+    for (i = 0u; i < MAX_NUM_HARTS; i++) {
+        if (i == myHartId) { continue; } // don't handle messages if to my own hartid
+        if (!((1u << i) & hartMask.uint)) { continue; } // only look at selected harts
+
+        uint32_t const index = IPI_CalculateQueueIndex(i, myHartId);
+        uint32_t j;
+
+        for (j = 0u; j < IPI_MAX_NUM_QUEUE_MESSAGES; j++) {
+            enum IPIMessagesEnum const msg_type = IPI_DATA.ipi_queues[index].msgQ[j].msg_type;
+
+            if ((msg_type != IPI_MSG_NO_MESSAGE) && (msg_type < IPI_MSG_NUM_MSG_TYPES)) {
+                result |= (1u << msg_type);
+            }
+        }
+    }
+
+    return result;
+}
+
 bool IPI_ConsumeIntent(enum HSSHartId source, enum IPIMessagesEnum msg_type)
 {
     bool intentFound = false;
@@ -651,6 +683,21 @@ enum IPIStatusCode IPI_ACK_IPIHandler(TxId_t transaction_id, enum HSSHartId sour
     return IPI_SUCCESS;
 }
 
+//
+// @brief Snapshot the IPI counters for a hart
+//
+void IPI_GetStats(enum HSSHartId hartId, struct IPI_Stats *pStats)
+{
+    assert(hartId < HSS_HART_NUM_PEERS);
+    assert(pStats);
+
+    pStats->message_allocs = IPI_DATA.mpfs_ipi_privateData[hartId].message_allocs;
+    pStats->message_delivers = IPI_DATA.mpfs_ipi_privateData[hartId].message_delivers;
+    pStats->message_frees = IPI_DATA.mpfs_ipi_privateData[hartId].message_frees;
+    pStats->consume_intents = IPI_DATA.mpfs_ipi_privateData[hartId].consume_intents;
+    pStats->ipi_sends = IPI_DATA.mpfs_ipi_privateData[hartId].ipi_sends;
+}
+
 //
 // @brief Dump IPI Debug Statistics and Counters
 //
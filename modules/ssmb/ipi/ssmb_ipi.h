@@ -102,6 +102,7 @@ enum IPIMessagesEnum {
     IPI_MSG_OPENSBI_INIT,
     IPI_MSG_SCRUB,
     IPI_MSG_DDR_TRAIN,
+    IPI_MSG_MEMTEST,
     IPI_MSG_NUM_MSG_TYPES,
 };
 
@@ -169,6 +170,7 @@ bool IPI_PollReceive(union HSSHartBitmask hartMask);
 bool IPI_QueuesInit(void);
 bool IPI_ConsumeIntent(enum HSSHartId source, enum IPIMessagesEnum msg_type);
 uint32_t IPI_GetQueuePendingCount(uint32_t queueIndex);
+uint32_t IPI_GetPendingMsgTypes(union HSSHartBitmask hartMask);
 
 bool IPI_MessageAlloc(uint32_t *indexOut);
 bool IPI_MessageDeliver(uint32_t index, enum HSSHartId target, enum IPIMessagesEnum message,
@@ -181,6 +183,15 @@ void IPI_MessageFree(uint32_t index);
 TxId_t IPI_DebugGetTxId(void);
 void IPI_DebugDumpStats(void);
 
+struct IPI_Stats {
+    uint64_t message_allocs;
+    uint64_t message_delivers;
+    uint64_t message_frees;
+    uint64_t consume_intents;
+    uint64_t ipi_sends;
+};
+void IPI_GetStats(enum HSSHartId hartId, struct IPI_Stats *pStats);
+
 struct IPI_Outbox_Msg *IPI_DirectionToFirstMsgInQueue(enum HSSHartId source, enum HSSHartId target);
 uint32_t IPI_CalculateQueueIndex(enum HSSHartId source, enum HSSHartId target);
 
@@ -29,6 +29,19 @@
 #include "mss_beu_def.h"
 #include "mss_beu.h"
 
+#if IS_ENABLED(CONFIG_SERVICE_BEU_INTERRUPTS)
+#  include "csr_helper.h"
+#  include "mss_plic.h"
+#endif
+
+#if IS_ENABLED(CONFIG_SERVICE_SCRUB_ADAPTIVE)
+#  include "scrub_service.h"
+#endif
+
+#if IS_ENABLED(CONFIG_SERVICE_TELEMETRY)
+#  include "telemetry_service.h"
+#endif
+
 static void beu_init_handler(struct StateMachine * const pMyMachine);
 static void beu_monitoring_handler(struct StateMachine * const pMyMachine);
 
@@ -49,6 +62,39 @@ static const struct StateDesc beu_state_descs[] = {
     { (const stateType_t)BEU_MONITORING,      (const char *)"monitoring", NULL, NULL, &beu_monitoring_handler },
 };
 
+#if IS_ENABLED(CONFIG_SERVICE_BEU_INTERRUPTS)
+/*!
+ * \brief BEU PLIC sources
+ *
+ * BEU events raise a PLIC interrupt, one source per hart. The E51 runs with
+ * interrupts masked, so these are not taken as traps. Instead, the pending
+ * bits for all five sources (which share a single PLIC pending word) are
+ * checked on each pass, and the BEU registers are only read for harts that
+ * have an event pending. An enabled pending source also wakes the E51 from
+ * WFI idle. All harts are still polled in full at a low rate as a fallback.
+ */
+#define BEU_PLIC_PENDING_WORD  (PLIC_E51_BUS_ERROR_UNIT_OFFSET / 32u)
+#define BEU_PLIC_PENDING_SHIFT (PLIC_E51_BUS_ERROR_UNIT_OFFSET % 32u)
+_Static_assert((PLIC_U54_4_BUS_ERROR_UNIT_OFFSET / 32u) == BEU_PLIC_PENDING_WORD,
+    "BEU PLIC sources must share a pending word");
+
+#define BEU_PLIC_PRIORITY      7u
+#define BEU_FALLBACK_PERIOD    ((HSSTicks_t)CONFIG_SERVICE_BEU_FALLBACK_POLL_MS * ONE_MILLISEC)
+
+static bool beu_irq_pending_(void);
+
+#  define BEU_WAKE_SOURCES     (SM_WAKE_POLL | SM_WAKE_TIMER)
+#  define BEU_WAKE_PERIOD      BEU_FALLBACK_PERIOD
+#  define BEU_WAKE_POLL        beu_irq_pending_
+#else
+/*!
+ * \brief BEU poll period when dispatched by the ready-mask scheduler
+ */
+#  define BEU_WAKE_SOURCES     SM_WAKE_TIMER
+#  define BEU_WAKE_PERIOD      (10llu * ONE_MILLISEC)
+#  define BEU_WAKE_POLL        NULL
+#endif
+
 /*!
  * \brief BEU Driver State Machine
  */
@@ -62,8 +108,11 @@ struct StateMachine beu_service = {
     .executionCount    = 0u,
     .pStateDescs       = beu_state_descs,
     .debugFlag         = true,
-    .priority          = 0u,
-    .pInstanceData     = NULL
+    .priority          = SM_PRIORITY_LOW(4u),
+    .pInstanceData     = NULL,
+    .wake              = { .sources = BEU_WAKE_SOURCES, .sleepState = BEU_MONITORING, .period = BEU_WAKE_PERIOD,
+                           .poll = BEU_WAKE_POLL },
+    .budget            = ONE_MILLISEC,
 };
 
 // BEU Events:
@@ -114,6 +163,160 @@ static struct {
   { BEU_EVENT_DATA_CACHE_UNCORRECTABLE, BEU_Event_Name[BEU_EVENT_DATA_CACHE_UNCORRECTABLE], 0llu }
 };
 
+#if IS_ENABLED(CONFIG_SERVICE_BEU_EVENT_LOG)
+/*!
+ * \brief Ring of recent BEU events
+ */
+static struct {
+    HSSTicks_t time;
+    uint64_t address;
+    uint8_t hartid;
+    uint8_t cause;
+} eventLog[CONFIG_SERVICE_BEU_EVENT_LOG_SIZE];
+static size_t eventLogCount = 0u;
+
+static void beu_log_event_(enum HSSHartId hartid, enum BEU_event_cause cause, uint64_t address,
+    HSSTicks_t const now)
+{
+    size_t const index = eventLogCount % ARRAY_SIZE(eventLog);
+
+    eventLog[index].time = now;
+    eventLog[index].address = address;
+    eventLog[index].hartid = (uint8_t)hartid;
+    eventLog[index].cause = (uint8_t)cause;
+    eventLogCount++;
+}
+#endif
+
+#if IS_ENABLED(CONFIG_SERVICE_BEU_INTERRUPTS)
+static HSSTicks_t lastFullPollTime = 0u;
+static HSSTicks_t statsStartTime = 0u;
+static uint64_t skippedPolls = 0u;
+static uint64_t skippedPollCycles = 0u;
+static uint64_t fullPolls = 0u;
+static uint64_t fullPollCycles = 0u;
+static uint64_t interruptCount = 0u;
+
+static inline uint32_t beu_irq_pending_harts_(void)
+{
+    return (PLIC->PENDING_ARRAY[BEU_PLIC_PENDING_WORD] >> BEU_PLIC_PENDING_SHIFT) & 0x1Fu;
+}
+
+static bool beu_irq_pending_(void)
+{
+    return beu_irq_pending_harts_() ? true : false;
+}
+
+static void beu_irq_init_(void)
+{
+    for (enum HSSHartId hartid = HSS_HART_E51; hartid <= HSS_HART_U54_4; hartid++) {
+        PLIC_IRQn_Type const source = (PLIC_IRQn_Type)(PLIC_E51_BUS_ERROR_UNIT_OFFSET + hartid);
+
+        BEU->regs[hartid].PLIC_INT = (unsigned long long)BEU_ENABLE_MASK;
+        PLIC_SetPriority(source, BEU_PLIC_PRIORITY);
+        PLIC_EnableIRQ(source);
+    }
+
+    statsStartTime = HSS_GetTime();
+    lastFullPollTime = statsStartTime;
+}
+
+static void beu_irq_complete_(uint32_t pendingHarts)
+{
+    // BEU sources have the highest priority, so each claim normally returns one of them.
+    // The sources are level-triggered, so any that are still asserted will simply re-pend
+    while (pendingHarts) {
+        uint32_t const source = PLIC_ClaimIRQ();
+
+        if (!source) {
+            break;
+        }
+
+        // every claimed source must be completed, or its gateway stays blocked for good
+        PLIC_CompleteIRQ(source);
+
+        if ((source < PLIC_E51_BUS_ERROR_UNIT_OFFSET) || (source > PLIC_U54_4_BUS_ERROR_UNIT_OFFSET)) {
+            // another source of equal priority was claimed. It is level-triggered, so
+            // completing it leaves it to re-pend for its owner
+            mHSS_DEBUG_PRINTF(LOG_WARN, "claimed non-BEU PLIC source %u\n", source);
+            break;
+        }
+
+        pendingHarts &= pendingHarts - 1u;
+        interruptCount++;
+    }
+}
+#endif
+
+static uint64_t shadow_accrued_[MAX_NUM_HARTS] = { 0llu, };
+static uint64_t shadow_value_[MAX_NUM_HARTS] = { 0llu, };
+
+static void beu_check_hart_(enum HSSHartId hartid, HSSTicks_t const now)
+{
+    uint64_t accrued = BEU->regs[hartid].ACCRUED;
+    uint64_t value = BEU->regs[hartid].VALUE;
+
+    (void)now;
+
+    if (accrued & BEU_ENABLE_MASK) {
+        if (accrued & BEU_ENABLE_UNCORRECTABLE_MASK) {
+            if ((BEU->regs[hartid].ENABLE) && (value == shadow_value_[hartid])) {
+                mHSS_DEBUG_PRINTF(LOG_ERROR, "Uncorrectable errors: %s%d: error %llu at %p\n",
+                    hartid ? "u54_" : "e5", hartid ? hartid: 1,
+                    accrued, value);
+            }
+
+            // hart has experienced fatal error, so stop checking for BEU errors for this hart...
+            BEU->regs[hartid].ENABLE = 0llu;
+#if IS_ENABLED(CONFIG_SERVICE_BEU_INTERRUPTS)
+            BEU->regs[hartid].PLIC_INT = 0llu;
+#endif
+        } else {
+            (void)(shadow_accrued_[hartid]); // reference to avoid compiler warning...
+        }
+
+#if IS_ENABLED(CONFIG_SERVICE_SCRUB_ADAPTIVE)
+        if (accrued & (BIT(BEU_EVENT_ITIM_CORRECTABLE) | BIT(BEU_EVENT_DATA_CACHE_CORRECTABLE))) {
+            // let the scrubber speed up around the faulting address
+            HSS_Scrub_ReportCorrectableError((uintptr_t)value);
+        }
+#endif
+
+#if IS_ENABLED(CONFIG_SERVICE_TELEMETRY)
+        struct HSS_Telemetry_Page * const pTelemetry = HSS_Telemetry_WriteBegin();
+#endif
+
+        for (size_t i = 0u; i < ARRAY_SIZE(beu_stats_); i++) {
+            if (accrued & BIT(beu_stats_[i].bit_position)) {
+                beu_stats_[i].counter++;
+                BEU->regs[hartid].ACCRUED &= ~(BIT(beu_stats_[i].bit_position));
+
+                mHSS_DEBUG_PRINTF(LOG_ERROR, "%s%d: BEU event: %45s\n",
+                   hartid ? "u54_" : "e5", hartid ? hartid: 1,
+                   beu_stats_[i].pName);
+
+#if IS_ENABLED(CONFIG_SERVICE_BEU_EVENT_LOG)
+                beu_log_event_(hartid, beu_stats_[i].bit_position, value, now);
+#endif
+
+#if IS_ENABLED(CONFIG_SERVICE_TELEMETRY)
+                if (pTelemetry) {
+                    pTelemetry->beu.causeCount[beu_stats_[i].bit_position] = beu_stats_[i].counter;
+                    pTelemetry->beu.hartEventCount[hartid]++;
+                }
+#endif
+            }
+        }
+
+#if IS_ENABLED(CONFIG_SERVICE_TELEMETRY)
+        HSS_Telemetry_WriteEnd(pTelemetry);
+#endif
+
+        shadow_accrued_[hartid] = accrued;
+        shadow_value_[hartid] = value;
+    }
+}
+
 // --------------------------------------------------------------------------------------------------
 // Handlers for each state in the state machine
 //
@@ -126,6 +329,10 @@ static void beu_init_handler(struct StateMachine * const pMyMachine)
         BEU->regs[hartid].ENABLE = (unsigned long long)BEU_ENABLE_MASK;
     }
 
+#if IS_ENABLED(CONFIG_SERVICE_BEU_INTERRUPTS)
+    beu_irq_init_();
+#endif
+
     pMyMachine->state++;
 }
 
@@ -133,44 +340,40 @@ static void beu_init_handler(struct StateMachine * const pMyMachine)
 static void beu_monitoring_handler(struct StateMachine * const pMyMachine)
 {
     (void)pMyMachine;
-    static uint64_t shadow_accrued_[MAX_NUM_HARTS] = { 0llu, };
-    static uint64_t shadow_value_[MAX_NUM_HARTS] = { 0llu, };
 
-    for (enum HSSHartId hartid = HSS_HART_E51; hartid <= HSS_HART_U54_4; hartid++)
-    {
-        uint64_t accrued = BEU->regs[hartid].ACCRUED;
-        uint64_t value = BEU->regs[hartid].VALUE;
-
-        if (accrued & BEU_ENABLE_MASK) {
-            if (accrued & BEU_ENABLE_UNCORRECTABLE_MASK) {
-                if ((BEU->regs[hartid].ENABLE) && (value == shadow_value_[hartid])) {
-                    mHSS_DEBUG_PRINTF(LOG_ERROR, "Uncorrectable errors: %s%d: error %llu at %p\n",
-                        hartid ? "u54_" : "e5", hartid ? hartid: 1,
-                        accrued, value);
-                }
+    HSSTicks_t const now = HSS_GetTime();
 
-                // hart has experienced fatal error, so stop checking for BEU errors for this hart...
-                BEU->regs[hartid].ENABLE = 0llu;
-            } else {
-                (void)(shadow_accrued_[hartid]); // reference to avoid compiler warning...
-            }
-
-            for (size_t i = 0u; i < ARRAY_SIZE(beu_stats_); i++) {
-                if (accrued & BIT(beu_stats_[i].bit_position)) {
-                    beu_stats_[i].counter++;
-                    BEU->regs[hartid].ACCRUED &= ~(BIT(beu_stats_[i].bit_position));
+#if IS_ENABLED(CONFIG_SERVICE_BEU_INTERRUPTS)
+    uint64_t const startCycles = CSR_GetTickCount();
+    uint32_t const pendingHarts = beu_irq_pending_harts_();
+    bool const fullPoll = HSS_Timer_IsElapsed(lastFullPollTime, BEU_FALLBACK_PERIOD);
 
-                    mHSS_DEBUG_PRINTF(LOG_ERROR, "%s%d: BEU event: %45s\n",
-                       hartid ? "u54_" : "e5", hartid ? hartid: 1,
-                       beu_stats_[i].pName);
-                }
+    if (fullPoll || pendingHarts) {
+        for (enum HSSHartId hartid = HSS_HART_E51; hartid <= HSS_HART_U54_4; hartid++) {
+            if (fullPoll || (pendingHarts & BIT(hartid))) {
+                beu_check_hart_(hartid, now);
             }
+        }
+
+        beu_irq_complete_(pendingHarts);
 
-            shadow_accrued_[hartid] = accrued;
-            shadow_value_[hartid] = value;
+        if (fullPoll) {
+            lastFullPollTime = now;
+            fullPolls++;
+            fullPollCycles += CSR_GetTickCount() - startCycles;
         }
+    } else {
+        skippedPolls++;
+        skippedPollCycles += CSR_GetTickCount() - startCycles;
     }
+#else
+    for (enum HSSHartId hartid = HSS_HART_E51; hartid <= HSS_HART_U54_4; hartid++)
+    {
+        beu_check_hart_(hartid, now);
+    }
+#endif
 }
+
 /////////////////
 void HSS_BEU_DumpStats(void)
 {
@@ -178,4 +381,32 @@ void HSS_BEU_DumpStats(void)
         mHSS_DEBUG_PRINTF(LOG_NORMAL, "% 45s:  %" PRIu64 "\n",
             beu_stats_[i].pName, beu_stats_[i].counter);
     }
+
+#if IS_ENABLED(CONFIG_SERVICE_BEU_INTERRUPTS)
+    HSSTicks_t const elapsed = HSS_GetTime() - statsStartTime;
+    uint64_t const fullPollCost = fullPolls ? (fullPollCycles / fullPolls) : 0u;
+    uint64_t const skippedPollCost = skippedPolls ? (skippedPollCycles / skippedPolls) : 0u;
+    uint64_t const savedCycles = (fullPollCost > skippedPollCost) ?
+        (skippedPolls * (fullPollCost - skippedPollCost)) : 0u;
+
+    mHSS_DEBUG_PRINTF(LOG_NORMAL, "%" PRIu64 " BEU interrupts, %" PRIu64 " fallback polls (%" PRIu64
+        " cycles each), %" PRIu64 " polls skipped (%" PRIu64 " cycles each)\n",
+        interruptCount, fullPolls, fullPollCost, skippedPolls, skippedPollCost);
+    mHSS_DEBUG_PRINTF(LOG_NORMAL, "Polling overhead saved: %" PRIu64 " cycles/s\n",
+        (elapsed >= ONE_SEC) ? (savedCycles / (elapsed / ONE_SEC)) : savedCycles);
+#endif
+
+#if IS_ENABLED(CONFIG_SERVICE_BEU_EVENT_LOG)
+    size_t const first = (eventLogCount > ARRAY_SIZE(eventLog)) ? (eventLogCount - ARRAY_SIZE(eventLog)) : 0u;
+
+    mHSS_DEBUG_PRINTF(LOG_NORMAL, "Recent BEU events (%lu of %lu):\n", eventLogCount - first, eventLogCount);
+    for (size_t i = first; i < eventLogCount; i++) {
+        size_t const index = i % ARRAY_SIZE(eventLog);
+
+        mHSS_DEBUG_PRINTF(LOG_NORMAL, "  %" PRIu64 " ms: %s%d: %s at 0x%" PRIx64 "\n",
+            eventLog[index].time / ONE_MILLISEC,
+            eventLog[index].hartid ? "u54_" : "e5", eventLog[index].hartid ? eventLog[index].hartid : 1,
+            BEU_Event_Name[eventLog[index].cause], eventLog[index].address);
+    }
+#endif
 }
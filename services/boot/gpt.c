@@ -168,6 +168,11 @@ bool GPT_ValidateHeader(HSS_GPT_t *pGpt)
         if (!result) {
             mHSS_DEBUG_PRINTF(LOG_ERROR, "GPT header revision is %08x vs expected %08x\n",
                 pGptHeader->revision, GPT_EXPECTED_REVISION);
+        } else if ((pGptHeader->headerSize < GPT_MIN_HEADER_SIZE)
+            || (pGptHeader->headerSize > pGpt->lbaSize)) {
+            // the header CRC covers headerSize bytes, which must be within the buffer
+            mHSS_DEBUG_PRINTF(LOG_ERROR, "GPT header size is %u\n", pGptHeader->headerSize);
+            result = false;
         } else {
             uint32_t origChecksum = pGptHeader->headerCrc32;
             pGptHeader->headerCrc32 = 0u;
@@ -191,6 +196,21 @@ bool GPT_ValidateHeader(HSS_GPT_t *pGpt)
                     if (!result) {
                         mHSS_DEBUG_PRINTF(LOG_ERROR, "GPT starting LBA of array of partition entries is %lu"
                             " vs expected %u\n", pGptHeader->currentLBA, 2u);
+                    } else {
+                        // entries are read into a two LBA buffer, so must not straddle more
+                        // than that, and the number of them bounds the time taken to search
+                        const uint32_t entrySize = pGptHeader->sizeOfPartitionEntry;
+
+                        result = (entrySize >= sizeof(HSS_GPT_PartitionEntry_t))
+                            && !(entrySize & (entrySize - 1u)) && (entrySize <= pGpt->lbaSize)
+                            && (pGptHeader->numPartitions <= GPT_MAX_NUM_PARTITIONS);
+
+                        if (!result) {
+                            mHSS_DEBUG_PRINTF(LOG_ERROR, "GPT has %u partition entries of %u bytes"
+                                " (max %u entries of at most %lu bytes)\n",
+                                pGptHeader->numPartitions, entrySize, GPT_MAX_NUM_PARTITIONS,
+                                pGpt->lbaSize);
+                        }
                     }
                 }
             }
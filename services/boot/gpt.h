@@ -84,6 +84,8 @@ typedef struct HSS_GPT_s {
 
 #define GPT_EXPECTED_SIGNATURE "EFI PART"
 #define GPT_EXPECTED_REVISION 0x00010000u
+#define GPT_MIN_HEADER_SIZE 92u
+#define GPT_MAX_NUM_PARTITIONS 1024u
 
 void GPT_RegisterReadFunction(bool (*fnPtr)(void *pDest, size_t srcOffset, size_t byteCount));
 
@@ -0,0 +1,313 @@
+/*******************************************************************************
+ * Copyright 2019-2025 Microchip FPGA Embedded Systems Solutions.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * MPFS HSS Embedded Software
+ *
+ */
+
+/*!
+ * \file  Boot Service Delta Updates
+ * \brief Apply a delta image to a boot image in storage
+ *
+ * Delta images are produced by hss-payload-generator -D. Rather than reflashing a
+ * whole payload to change one application, only the storage blocks which differ
+ * between the base and new images are rewritten. For cached QSPI, that means only the
+ * erase blocks containing them are erased and programmed when the cache is flushed.
+ *
+ * The work buffer holds a copy of the base image as read from storage, and the new
+ * image built from it. Each is rounded up to a whole number of storage blocks, so the
+ * new image also carries whatever follows the base image in storage.
+ */
+
+#include "config.h"
+#include "hss_types.h"
+#include "hss_debug.h"
+#include "hss_crc32.h"
+#include "hss_progress.h"
+#include "hss_boot_delta.h"
+
+#if IS_ENABLED(CONFIG_CRYPTO_SIGNING)
+#  include "hss_boot_secure.h"
+#endif
+
+#include <assert.h>
+#include <string.h>
+
+static size_t roundUpToBlock_(size_t value, size_t blockSize)
+{
+    return ((value + blockSize - 1u) / blockSize) * blockSize;
+}
+
+static size_t getRegionSize_(struct HSS_DeltaImage const * const pDelta, uint32_t blockSize)
+{
+    size_t const maxLength = (pDelta->baseImageLength > pDelta->newImageLength) ?
+        pDelta->baseImageLength : pDelta->newImageLength;
+
+    return roundUpToBlock_(maxLength, blockSize);
+}
+
+static bool checkRange_(size_t offset, size_t size, size_t limit)
+{
+    return (offset <= limit) && (size <= (limit - offset));
+}
+
+bool HSS_Boot_IsDeltaImage(struct HSS_DeltaImage const * const pDelta)
+{
+    bool result = false;
+
+    assert(pDelta);
+
+    if ((pDelta->magic == mHSS_DELTA_MAGIC) && (pDelta->version == mHSS_DELTA_VERSION)) {
+        struct HSS_DeltaImage shadowHdr = *pDelta;
+        shadowHdr.headerCrc = 0u;
+
+        uint32_t const headerCrc = CRC32_calculate((const uint8_t *)&shadowHdr, sizeof(shadowHdr));
+
+        if (headerCrc == pDelta->headerCrc) {
+            result = true;
+        } else {
+            mHSS_DEBUG_PRINTF(LOG_ERROR, "Delta image header CRC: calculated %08x vs expected %08x\n",
+                headerCrc, pDelta->headerCrc);
+        }
+    }
+
+    return result;
+}
+
+size_t HSS_Boot_GetDeltaWorkBufferSize(struct HSS_DeltaImage const * const pDelta,
+    uint32_t blockSize)
+{
+    assert(pDelta);
+    assert(blockSize);
+
+    return 2u * getRegionSize_(pDelta, blockSize);
+}
+
+static bool checkDeltaImage_(struct HSS_DeltaImage const * const pDelta)
+{
+    bool result = HSS_Boot_IsDeltaImage(pDelta);
+
+    if (!result) {
+        mHSS_DEBUG_PRINTF(LOG_ERROR, "Not a valid delta image\n");
+    } else if ((pDelta->headerLength < sizeof(struct HSS_DeltaImage))
+        || (pDelta->deltaImageLength < pDelta->headerLength)
+        || (pDelta->numRecords > (pDelta->deltaImageLength / sizeof(struct HSS_DeltaRecord)))
+        || !checkRange_(pDelta->recordTableOffset,
+            pDelta->numRecords * sizeof(struct HSS_DeltaRecord), pDelta->deltaImageLength)) {
+        mHSS_DEBUG_PRINTF(LOG_ERROR, "Delta image header is inconsistent\n");
+        result = false;
+    } else {
+        uint32_t const bodyCrc = CRC32_calculate((const uint8_t *)pDelta + pDelta->headerLength,
+            pDelta->deltaImageLength - pDelta->headerLength);
+
+        if (bodyCrc != pDelta->bodyCrc) {
+            mHSS_DEBUG_PRINTF(LOG_ERROR, "Delta image CRC: calculated %08x vs expected %08x\n",
+                bodyCrc, pDelta->bodyCrc);
+            result = false;
+        }
+    }
+
+    return result;
+}
+
+static bool applyRecords_(struct HSS_DeltaImage const * const pDelta,
+    uint8_t const * const pBase, uint8_t * const pNew)
+{
+    bool result = true;
+
+    struct HSS_DeltaRecord const * const pRecords = (struct HSS_DeltaRecord const *)
+        ((uint8_t const *)pDelta + pDelta->recordTableOffset);
+
+    for (size_t i = 0u; result && (i < pDelta->numRecords); i++) {
+        struct HSS_DeltaRecord const * const pRecord = &pRecords[i];
+
+        if (!checkRange_(pRecord->dstOffset, pRecord->size, pDelta->newImageLength)) {
+            result = false;
+        } else if (pRecord->type == DELTA_RECORD_COPY_BASE) {
+            if (checkRange_(pRecord->srcOffset, pRecord->size, pDelta->baseImageLength)) {
+                memcpy(pNew + pRecord->dstOffset, pBase + pRecord->srcOffset, pRecord->size);
+            } else {
+                result = false;
+            }
+        } else if (pRecord->type == DELTA_RECORD_COPY_DELTA) {
+            if (checkRange_(pRecord->srcOffset, pRecord->size, pDelta->deltaImageLength)) {
+                memcpy(pNew + pRecord->dstOffset, (uint8_t const *)pDelta + pRecord->srcOffset,
+                    pRecord->size);
+            } else {
+                result = false;
+            }
+        } else {
+            result = false;
+        }
+
+        if (!result) {
+            mHSS_DEBUG_PRINTF(LOG_ERROR, "Delta record %lu (type %u) is out of range\n",
+                i, pRecord->type);
+        }
+    }
+
+    return result;
+}
+
+static bool validateNewImage_(struct HSS_DeltaImage const * const pDelta, uint8_t * const pNew)
+{
+    bool result = false;
+
+    uint32_t const newCrc = CRC32_calculate(pNew, pDelta->newImageLength);
+    struct HSS_BootImage * const pBootImage = (struct HSS_BootImage *)pNew;
+
+    if (newCrc != pDelta->newImageCrc) {
+        mHSS_DEBUG_PRINTF(LOG_ERROR, "New image CRC: calculated %08x vs expected %08x\n",
+            newCrc, pDelta->newImageCrc);
+    } else if ((pDelta->newImageLength < sizeof(struct HSS_BootImage))
+        || (pBootImage->magic != mHSS_BOOT_MAGIC)
+        || (pBootImage->bootImageLength != pDelta->newImageLength)) {
+        mHSS_DEBUG_PRINTF(LOG_ERROR, "New image is not a valid boot image\n");
+    } else {
+#if IS_ENABLED(CONFIG_CRYPTO_SIGNING)
+        result = HSS_Boot_Secure_VerifyCodeSigning(pBootImage);
+#else
+        result = true;
+#endif
+    }
+
+    return result;
+}
+
+static bool writeChangedBlocks_(struct HSS_Storage *pStorage, size_t imageOffset,
+    uint8_t const * const pBase, uint8_t * const pNew, size_t regionSize,
+    uint32_t blockSize, uint32_t eraseSize)
+{
+    bool result = true;
+    size_t const numBlocks = regionSize / blockSize;
+    size_t changedBlocks = 0u, changedEraseBlocks = 0u;
+    size_t lastEraseBlock = (size_t)-1;
+
+    for (size_t block = 0u; result && (block < numBlocks); ) {
+        size_t const offset = block * blockSize;
+
+        if (!memcmp(pBase + offset, pNew + offset, blockSize)) {
+            block++;
+            continue;
+        }
+
+        // coalesce a run of changed blocks into a single write
+        size_t runLength = 0u;
+        while (((block + runLength) < numBlocks)
+            && memcmp(pBase + offset + (runLength * blockSize),
+                pNew + offset + (runLength * blockSize), blockSize)) {
+            size_t const eraseBlock = (imageOffset + offset + (runLength * blockSize)) / eraseSize;
+            if (eraseBlock != lastEraseBlock) {
+                changedEraseBlocks++;
+                lastEraseBlock = eraseBlock;
+            }
+            runLength++;
+        }
+
+        result = pStorage->writeBlock(imageOffset + offset, pNew + offset, runLength * blockSize);
+        if (!result) {
+            mHSS_DEBUG_PRINTF(LOG_ERROR, "%s: failed to write %lu bytes at 0x%lx\n",
+                pStorage->name, runLength * blockSize, imageOffset + offset);
+        }
+
+        changedBlocks += runLength;
+        block += runLength;
+        HSS_ShowProgress(numBlocks, numBlocks - block);
+    }
+    HSS_ShowProgress(numBlocks, 0u);
+
+    if (result && pStorage->flushWriteBuffer) {
+        pStorage->flushWriteBuffer();
+    }
+
+    mHSS_DEBUG_PRINTF(LOG_NORMAL, "%s: rewrote %lu of %lu %u-byte blocks (%lu erase blocks)\n",
+        pStorage->name, changedBlocks, numBlocks, blockSize, changedEraseBlocks);
+
+    return result;
+}
+
+bool HSS_Boot_ApplyDelta(struct HSS_Storage *pStorage, size_t imageOffset, size_t imageSpace,
+    struct HSS_DeltaImage const * const pDelta, void *pWorkBuffer, size_t workBufferSize)
+{
+    bool result = false;
+
+    assert(pStorage);
+    assert(pDelta);
+    assert(pWorkBuffer);
+
+    uint32_t blockSize = 0u, eraseSize = 0u, blockCount = 0u;
+    if (pStorage->getInfo) {
+        pStorage->getInfo(&blockSize, &eraseSize, &blockCount);
+    }
+
+    if (!pStorage->readBlock || !pStorage->writeBlock || !blockSize) {
+        mHSS_DEBUG_PRINTF(LOG_ERROR, "%s: storage does not support delta updates\n", pStorage->name);
+    } else if ((imageOffset % blockSize) != 0u) {
+        mHSS_DEBUG_PRINTF(LOG_ERROR, "Image offset 0x%lx is not block aligned\n", imageOffset);
+    } else if (checkDeltaImage_(pDelta)) {
+        if (!eraseSize) {
+            eraseSize = blockSize;
+        }
+
+        size_t const regionSize = getRegionSize_(pDelta, blockSize);
+        size_t const storageSize = (size_t)blockCount * blockSize;
+
+        if (!checkRange_(imageOffset, regionSize, storageSize)
+            || (imageSpace && (regionSize > imageSpace))) {
+            mHSS_DEBUG_PRINTF(LOG_ERROR, "%s: %lu byte image region at 0x%lx does not fit"
+                " (%lu bytes of storage, %lu byte partition)\n", pStorage->name, regionSize,
+                imageOffset, storageSize, imageSpace);
+        } else if (workBufferSize < HSS_Boot_GetDeltaWorkBufferSize(pDelta, blockSize)) {
+            mHSS_DEBUG_PRINTF(LOG_ERROR, "Delta work buffer too small (%lu bytes, need %lu)\n",
+                workBufferSize, HSS_Boot_GetDeltaWorkBufferSize(pDelta, blockSize));
+        } else {
+            uint8_t * const pBase = (uint8_t *)pWorkBuffer;
+            uint8_t * const pNew = pBase + regionSize;
+
+            mHSS_DEBUG_PRINTF(LOG_NORMAL, "%s: reading %lu byte base image ...\n", pStorage->name,
+                pDelta->baseImageLength);
+            result = pStorage->readBlock(pBase, imageOffset, regionSize);
+
+            if (!result) {
+                mHSS_DEBUG_PRINTF(LOG_ERROR, "%s: failed to read base image\n", pStorage->name);
+            } else {
+                uint32_t const baseCrc = CRC32_calculate(pBase, pDelta->baseImageLength);
+
+                if (baseCrc != pDelta->baseImageCrc) {
+                    mHSS_DEBUG_PRINTF(LOG_ERROR, "Base image CRC: calculated %08x vs expected %08x"
+                        " - delta does not apply to this image\n", baseCrc, pDelta->baseImageCrc);
+                    result = false;
+                }
+            }
+
+            if (result) {
+                mHSS_DEBUG_PRINTF(LOG_NORMAL, "Applying %lu delta records ...\n", pDelta->numRecords);
+                memcpy(pNew, pBase, regionSize);
+                result = applyRecords_(pDelta, pBase, pNew)
+                    && validateNewImage_(pDelta, pNew);
+            }
+
+            if (result) {
+                result = writeChangedBlocks_(pStorage, imageOffset, pBase, pNew, regionSize,
+                    blockSize, eraseSize);
+            }
+
+            if (result) {
+                // read back, into the base copy which is no longer needed
+                result = pStorage->readBlock(pBase, imageOffset, regionSize)
+                    && (CRC32_calculate(pBase, pDelta->newImageLength) == pDelta->newImageCrc);
+
+                if (result) {
+                    mHSS_DEBUG_PRINTF(LOG_STATUS, "%s: delta applied and verified\n", pStorage->name);
+                } else {
+                    mHSS_DEBUG_PRINTF(LOG_ERROR, "%s: verification after delta update failed\n",
+                        pStorage->name);
+                }
+            }
+        }
+    }
+
+    return result;
+}
@@ -0,0 +1,52 @@
+#ifndef HSS_BOOT_DELTA_H
+#define HSS_BOOT_DELTA_H
+
+/*******************************************************************************
+ * Copyright 2019-2025 Microchip FPGA Embedded Systems Solutions.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * MPFS HSS Embedded Software
+ *
+ */
+
+/*!
+ * \file  Boot Service Delta Updates
+ * \brief Apply a delta image to a boot image in storage
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "hss_types.h"
+
+/**
+ * Returns true if pDelta points to a delta image with a good header CRC.
+ */
+bool HSS_Boot_IsDeltaImage(struct HSS_DeltaImage const * const pDelta);
+
+/**
+ * Returns the number of bytes of work buffer HSS_Boot_ApplyDelta() needs for pDelta,
+ * given the storage block size.
+ */
+size_t HSS_Boot_GetDeltaWorkBufferSize(struct HSS_DeltaImage const * const pDelta,
+    uint32_t blockSize);
+
+/**
+ * Applies a delta image to the boot image at imageOffset in pStorage. The base image is
+ * read into the work buffer and its CRC checked, the new image is built and validated
+ * alongside it, and only the storage blocks that differ are then written. Finally, the
+ * new image is read back and checked. Storage is not written to unless the base and new
+ * images both check out, and the region they span fits within the storage and within
+ * imageSpace bytes of imageOffset (0 => up to the end of storage, otherwise e.g. the size
+ * of the GPT boot partition).
+ */
+bool HSS_Boot_ApplyDelta(struct HSS_Storage *pStorage, size_t imageOffset, size_t imageSpace,
+    struct HSS_DeltaImage const * const pDelta, void *pWorkBuffer, size_t workBufferSize);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
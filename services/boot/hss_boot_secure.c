@@ -40,28 +40,408 @@ static void __attribute__((__noreturn__)) boot_secure_failure_(void)
 
 static int perf_ctr_index = PERF_CTR_UNINITIALIZED;
 
-bool HSS_Boot_Secure_CheckCodeSigning(struct HSS_BootImage *pBootImage)
+//
+// The signature is zeroed in the image before verification, as that is how it was
+// signed, so a copy of the original is kept here for the verification, and for benchmarking
+//
+static struct HSS_Signature bootImageSig __attribute__((aligned));
+static struct HSS_BootImage *pVerifiedImage = NULL;
+
+#if IS_ENABLED(CONFIG_CRYPTO_SIGNING_MERKLE)
+//
+// For a Merkle-tree signed image, only the image up to its leaf table is signed. Once
+// the signature has passed, the leaves are checked against the (signed) root, and then
+// each boot machine checks its chunks against their leaves as it copies them
+//
+#  define MERKLE_MAX_DEPTH 32u
+
+static struct HSS_MerkleTable const *pMerkleTable = NULL;
+static uint8_t const *pMerkleLeaves = NULL;
+static bool merkleRootPassed = false;
+
+//
+// the chunk and ZI chunk tables, including their sentinels, must lie within the signed
+// region, i.e. between the Merkle table and the leaf hashes, so that the chunk table
+// cannot be redirected and a ZI chunk cannot be added without breaking the signature
+//
+static bool check_merkle_chunk_tables_(struct HSS_BootImage const *pBootImage,
+    struct HSS_MerkleTable const *pTable)
+{
+    bool result = false;
+    size_t const minOffset = sizeof(struct HSS_BootImage) + sizeof(struct HSS_MerkleTable);
+    size_t const limit = pTable->leafTableOffset;
+
+    if ((pBootImage->chunkTableOffset < minOffset) || (pBootImage->ziChunkTableOffset < minOffset)
+        || (pBootImage->chunkTableOffset > limit) || (pBootImage->ziChunkTableOffset > limit)
+        || ((pTable->numLeaves + 1u) > ((limit - pBootImage->chunkTableOffset)
+            / sizeof(struct HSS_BootChunkDesc)))) {
+        ;
+    } else {
+        size_t offset = pBootImage->ziChunkTableOffset;
+
+        while (!result && ((offset + sizeof(struct HSS_BootZIChunkDesc)) <= limit)) {
+            struct HSS_BootZIChunkDesc const *pZIChunk =
+                (struct HSS_BootZIChunkDesc const *)((char const *)pBootImage + offset);
+
+            result = (pZIChunk->size == 0u);
+            offset += sizeof(struct HSS_BootZIChunkDesc);
+        }
+    }
+
+    return result;
+}
+
+static struct HSS_MerkleTable const *get_merkle_table_(struct HSS_BootImage const *pBootImage)
+{
+    struct HSS_MerkleTable const *pResult = NULL;
+    size_t const tableOffset = sizeof(struct HSS_BootImage);
+
+    if ((pBootImage->headerLength > pBootImage->bootImageLength)
+        || ((tableOffset + sizeof(struct HSS_MerkleTable)) > pBootImage->headerLength)) {
+        mHSS_DEBUG_PRINTF(LOG_ERROR, "Merkle table does not fit in image header\n");
+    } else {
+        struct HSS_MerkleTable const *pTable =
+            (struct HSS_MerkleTable const *)((char const *)pBootImage + tableOffset);
+
+        if ((pTable->magic != mHSS_MERKLE_MAGIC)
+            || (pTable->leafTableOffset < (tableOffset + sizeof(struct HSS_MerkleTable)))
+            || (pTable->leafTableOffset > pBootImage->headerLength)
+            || (pTable->numLeaves > ((pBootImage->headerLength - pTable->leafTableOffset) / MERKLE_HASH_LEN))
+            || (pTable->numLeaves >= (1ul << (MERKLE_MAX_DEPTH - 1u)))) {
+            mHSS_DEBUG_PRINTF(LOG_ERROR, "Merkle table invalid\n");
+        } else if (!check_merkle_chunk_tables_(pBootImage, pTable)) {
+            mHSS_DEBUG_PRINTF(LOG_ERROR, "Chunk tables are not covered by the Merkle signature\n");
+        } else {
+            pResult = pTable;
+        }
+    }
+
+    return pResult;
+}
+
+static void merkle_node_(uint8_t const left[MERKLE_HASH_LEN], uint8_t const right[MERKLE_HASH_LEN],
+    uint8_t node[MERKLE_HASH_LEN])
+{
+    struct HSSCryptoSHA384Context ctx;
+    uint8_t const prefix = MERKLE_NODE_PREFIX;
+
+    HSS_Crypto_SHA384_Init(&ctx);
+    HSS_Crypto_SHA384_Update(&ctx, 1u, &prefix);
+    HSS_Crypto_SHA384_Update(&ctx, MERKLE_HASH_LEN, left);
+    HSS_Crypto_SHA384_Update(&ctx, MERKLE_HASH_LEN, right);
+    HSS_Crypto_SHA384_Final(&ctx, node);
+}
+
+static bool check_merkle_root_(struct HSS_MerkleTable const *pTable, uint8_t const *pLeaves)
+{
+    //
+    // rather than pairing up all of the nodes at each level in turn, the leaves are
+    // folded in one at a time, keeping only the last node at each level. Pairs at the
+    // same level are combined as soon as possible, and what is left over at the end is
+    // combined from the right, which is the same as carrying odd nodes up unchanged
+    //
+    static uint8_t nodes[MERKLE_MAX_DEPTH][MERKLE_HASH_LEN];
+    static uint8_t levels[MERKLE_MAX_DEPTH];
+    size_t numNodes = 0u;
+
+    assert(pTable);
+
+    for (size_t i = 0u; i < pTable->numLeaves; i++) {
+        memcpy(nodes[numNodes], pLeaves + (i * MERKLE_HASH_LEN), MERKLE_HASH_LEN);
+        levels[numNodes] = 0u;
+        numNodes++;
+
+        while ((numNodes > 1u) && (levels[numNodes-2u] == levels[numNodes-1u])) {
+            merkle_node_(nodes[numNodes-2u], nodes[numNodes-1u], nodes[numNodes-2u]);
+            levels[numNodes-2u]++;
+            numNodes--;
+        }
+    }
+
+    while (numNodes > 1u) {
+        merkle_node_(nodes[numNodes-2u], nodes[numNodes-1u], nodes[numNodes-2u]);
+        numNodes--;
+    }
+
+    if (!numNodes) {
+        // nothing to authenticate
+        memset(nodes[0], 0, MERKLE_HASH_LEN);
+    }
+
+    return (memcmp(nodes[0], pTable->root, MERKLE_HASH_LEN) == 0);
+}
+
+static bool check_merkle_leaf_(struct HSS_MerkleTable const *pTable, uint8_t const *pLeaves,
+    uint8_t const digest[MERKLE_HASH_LEN], size_t chunkIndex)
+{
+    bool result = false;
+
+    if (chunkIndex >= pTable->numLeaves) {
+        mHSS_DEBUG_PRINTF(LOG_ERROR, "No Merkle leaf for chunk %zu\n", chunkIndex);
+    } else if (memcmp(digest, pLeaves + (chunkIndex * MERKLE_HASH_LEN), MERKLE_HASH_LEN)) {
+        mHSS_DEBUG_PRINTF(LOG_ERROR, "Chunk %zu does not match its Merkle leaf\n", chunkIndex);
+    } else {
+        result = true;
+    }
+
+    return result;
+}
+
+static bool check_merkle_chunks_(struct HSS_BootImage const *pBootImage, struct HSS_MerkleTable const *pTable,
+    uint8_t const *pLeaves)
+{
+    bool result = true;
+    bool done = false;
+    struct HSS_BootChunkDesc const *pChunk =
+        (struct HSS_BootChunkDesc const *)((char const *)pBootImage + pBootImage->chunkTableOffset);
+    char const * const pChunkTableEnd = (char const *)pBootImage + pTable->leafTableOffset;
+
+    // every chunk needs a leaf, and every leaf a chunk
+    for (size_t chunkIndex = 0u; result && !done; chunkIndex++, pChunk++) {
+        if ((char const *)(pChunk + 1) > pChunkTableEnd) {
+            result = false;
+        } else if (!pChunk->size) {
+            result = (chunkIndex == pTable->numLeaves);
+            done = true;
+        } else if ((pChunk->loadAddr > pBootImage->bootImageLength)
+            || (pChunk->size > (pBootImage->bootImageLength - pChunk->loadAddr))) {
+            result = false;
+        } else {
+            struct HSSCryptoSHA384Context ctx;
+            uint8_t digest[MERKLE_HASH_LEN];
+
+            HSS_Boot_Secure_ChunkHash_Init(&ctx);
+            HSS_Boot_Secure_ChunkHash_Update(&ctx, (char const *)pBootImage + pChunk->loadAddr, pChunk->size);
+            HSS_Crypto_SHA384_Final(&ctx, digest);
+            result = check_merkle_leaf_(pTable, pLeaves, digest, chunkIndex);
+        }
+    }
+
+    if (!result) {
+        mHSS_DEBUG_PRINTF(LOG_ERROR, "Boot image chunks do not match Merkle tree\n");
+    }
+
+    return result;
+}
+#endif
+
+bool HSS_Boot_Secure_StartCodeSigning(struct HSS_BootImage *pBootImage)
 {
     bool result = false;
 
     assert(pBootImage != NULL);
 
-    struct HSS_Signature originalSig __attribute__((aligned)) = pBootImage->signature;
+    bootImageSig = pBootImage->signature;
     memset((void *)&(pBootImage->signature), 0, sizeof(struct HSS_Signature));
+    pVerifiedImage = pBootImage;
+
+    size_t signedLength = pBootImage->bootImageLength;
+
+#if IS_ENABLED(CONFIG_CRYPTO_SIGNING_MERKLE)
+    pMerkleTable = NULL;
+    pMerkleLeaves = NULL;
+    merkleRootPassed = false;
+
+    if (pBootImage->version == mHSS_BOOT_VERSION_MERKLE) {
+        pMerkleTable = get_merkle_table_(pBootImage);
+
+        if (!pMerkleTable) {
+            boot_secure_failure_();
+        }
+
+        pMerkleLeaves = (uint8_t const *)pBootImage + pMerkleTable->leafTableOffset;
+        signedLength = pMerkleTable->leafTableOffset;
+    }
+#else
+    if (pBootImage->version == mHSS_BOOT_VERSION_MERKLE) {
+        mHSS_DEBUG_PRINTF(LOG_ERROR, "Merkle-tree signed boot images need CONFIG_CRYPTO_SIGNING_MERKLE\n");
+    }
+#endif
 
     HSS_PerfCtr_Allocate(&perf_ctr_index, "SecureBoot");
     HSS_PerfCtr_Start(perf_ctr_index);
 
-    result = HSS_Crypto_Verify_ECDSA_P384(ARRAY_SIZE(originalSig.ecdsaSig), &(originalSig.ecdsaSig[0]),
-        pBootImage->bootImageLength, (uint8_t *)pBootImage);
+    result = HSS_Crypto_Verify_Start_ECDSA_P384(ARRAY_SIZE(bootImageSig.ecdsaSig), &(bootImageSig.ecdsaSig[0]),
+        signedLength, (uint8_t *)pBootImage);
 
     if (!result) {
         boot_secure_failure_();
-    } else {
-        mHSS_DEBUG_PRINTF(LOG_STATUS, "ECDSA verification passed\n");
     }
 
-    HSS_PerfCtr_Lap(perf_ctr_index);
+    return result;
+}
+
+bool HSS_Boot_Secure_IsCodeSigningComplete(void)
+{
+    bool result = false;
+
+    switch (HSS_Crypto_Verify_Poll()) {
+    case HSS_CRYPTO_VERIFY_BUSY:
+        break;
+
+    case HSS_CRYPTO_VERIFY_PASSED:
+        if (pVerifiedImage) {
+            mHSS_DEBUG_PRINTF(LOG_STATUS, "ECDSA verification passed\n");
+#if IS_ENABLED(CONFIG_CRYPTO_SIGNING_MERKLE)
+            if (pMerkleTable) {
+                if (!check_merkle_root_(pMerkleTable, pMerkleLeaves)) {
+                    mHSS_DEBUG_PRINTF(LOG_ERROR, "Merkle root does not match chunk hashes\n");
+                    boot_secure_failure_();
+                }
+
+                mHSS_DEBUG_PRINTF(LOG_STATUS, "Merkle root of %zu chunk hashes passed\n",
+                    pMerkleTable->numLeaves);
+                merkleRootPassed = true;
+            }
+#endif
+            HSS_PerfCtr_Lap(perf_ctr_index);
+            pVerifiedImage = NULL;
+        }
+        result = true;
+        break;
+
+    case HSS_CRYPTO_VERIFY_IDLE:
+        // nothing outstanding (e.g. after a benchmark run)
+        result = true;
+        break;
+
+    case HSS_CRYPTO_VERIFY_FAILED:
+        __attribute__((fallthrough)); // deliberate fallthrough
+    default:
+        boot_secure_failure_();
+        break;
+    }
 
     return result;
 }
+
+bool HSS_Boot_Secure_VerifyCodeSigning(struct HSS_BootImage *pBootImage)
+{
+    //
+    // kept apart from the boot-time verification state, so that checking another image
+    // (such as one built by a delta update) leaves that of the booted image alone
+    //
+    static struct HSS_Signature signature __attribute__((aligned));
+    bool result = true;
+
+    assert(pBootImage != NULL);
+
+    // wait for any boot-time verification to complete first, as it shares the back ends
+    while (!HSS_Boot_Secure_IsCodeSigningComplete()) { ; }
+
+    signature = pBootImage->signature;
+    memset((void *)&(pBootImage->signature), 0, sizeof(struct HSS_Signature));
+
+    size_t signedLength = pBootImage->bootImageLength;
+
+#if IS_ENABLED(CONFIG_CRYPTO_SIGNING_MERKLE)
+    struct HSS_MerkleTable const *pTable = NULL;
+    uint8_t const *pLeaves = NULL;
+
+    if (pBootImage->version == mHSS_BOOT_VERSION_MERKLE) {
+        pTable = get_merkle_table_(pBootImage);
+
+        if (pTable) {
+            pLeaves = (uint8_t const *)pBootImage + pTable->leafTableOffset;
+            signedLength = pTable->leafTableOffset;
+        } else {
+            result = false;
+        }
+    }
+#endif
+
+    if (result) {
+        result = HSS_Crypto_Verify_ECDSA_P384(ARRAY_SIZE(signature.ecdsaSig), &(signature.ecdsaSig[0]),
+            signedLength, (uint8_t *)pBootImage);
+
+        if (!result) {
+            mHSS_DEBUG_PRINTF(LOG_ERROR, "ECDSA verification failed\n");
+        }
+    }
+
+#if IS_ENABLED(CONFIG_CRYPTO_SIGNING_MERKLE)
+    // nothing else will check the chunks, so check them all now
+    if (result && pTable) {
+        result = check_merkle_root_(pTable, pLeaves);
+
+        if (!result) {
+            mHSS_DEBUG_PRINTF(LOG_ERROR, "Merkle root does not match chunk hashes\n");
+        } else {
+            result = check_merkle_chunks_(pBootImage, pTable, pLeaves);
+        }
+    }
+#endif
+
+    pBootImage->signature = signature;
+
+    return result;
+}
+
+bool HSS_Boot_Secure_CheckCodeSigning(struct HSS_BootImage *pBootImage)
+{
+    bool const result = HSS_Boot_Secure_VerifyCodeSigning(pBootImage);
+
+    if (!result) {
+        boot_secure_failure_();
+    }
+
+    return result;
+}
+
+#if IS_ENABLED(CONFIG_CRYPTO_SIGNING_MERKLE)
+bool HSS_Boot_Secure_HasChunkHashes(void)
+{
+    return (pMerkleTable != NULL);
+}
+
+void HSS_Boot_Secure_ChunkHash_Init(struct HSSCryptoSHA384Context *pCtx)
+{
+    uint8_t const prefix = MERKLE_LEAF_PREFIX;
+
+    HSS_Crypto_SHA384_Init(pCtx);
+    HSS_Crypto_SHA384_Update(pCtx, 1u, &prefix);
+}
+
+void HSS_Boot_Secure_ChunkHash_Update(struct HSSCryptoSHA384Context *pCtx, void const *pData, size_t len)
+{
+    HSS_Crypto_SHA384_Update(pCtx, len, (uint8_t const *)pData);
+}
+
+bool HSS_Boot_Secure_ChunkHash_Check(struct HSSCryptoSHA384Context *pCtx, size_t chunkIndex)
+{
+    bool result = false;
+    uint8_t digest[MERKLE_HASH_LEN];
+
+    HSS_Crypto_SHA384_Final(pCtx, digest);
+
+    if (!merkleRootPassed) {
+        mHSS_DEBUG_PRINTF(LOG_ERROR, "Merkle root not verified\n");
+    } else {
+        result = check_merkle_leaf_(pMerkleTable, pMerkleLeaves, digest, chunkIndex);
+    }
+
+    return result;
+}
+#endif
+
+void HSS_Boot_Secure_Benchmark(void)
+{
+    extern struct HSS_BootImage *pBootImage;
+
+    if (!pBootImage || (pBootImage->magic != mHSS_BOOT_MAGIC)) {
+        mHSS_DEBUG_PRINTF(LOG_ERROR, "Valid boot image not registered\n");
+    } else {
+        // wait for any boot-time verification to complete first, as it shares the back ends
+        while (!HSS_Boot_Secure_IsCodeSigningComplete()) { ; }
+
+        size_t signedLength = pBootImage->bootImageLength;
+#if IS_ENABLED(CONFIG_CRYPTO_SIGNING_MERKLE)
+        if (pMerkleTable) {
+            signedLength = pMerkleTable->leafTableOffset;
+        }
+#endif
+
+        HSS_Crypto_Benchmark_ECDSA_P384(ARRAY_SIZE(bootImageSig.ecdsaSig), &(bootImageSig.ecdsaSig[0]),
+            signedLength, (uint8_t *)pBootImage);
+    }
+}
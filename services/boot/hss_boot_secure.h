@@ -16,6 +16,51 @@
  */
 
 
+/**
+ * Starts verifying the code signature of a boot image in the background. The
+ * signature is zeroed in the image, as it was when the image was signed.
+ */
+bool HSS_Boot_Secure_StartCodeSigning(struct HSS_BootImage *pBootImage) __attribute__((nonnull));
+
+/**
+ * Advances a background code signature verification, and returns true once it has
+ * passed. As with a synchronous check, a verification failure does not return.
+ */
+bool HSS_Boot_Secure_IsCodeSigningComplete(void);
+
+/**
+ * Verifies the code signature of a boot image, and for a Merkle-tree signed image,
+ * checks each of its chunks against the tree. Returns false on failure, and leaves
+ * the image (including its signature) and any boot-time verification untouched.
+ */
+bool HSS_Boot_Secure_VerifyCodeSigning(struct HSS_BootImage *pBootImage) __attribute__((nonnull));
+
+/**
+ * As HSS_Boot_Secure_VerifyCodeSigning(), except that a failure does not return.
+ */
 bool HSS_Boot_Secure_CheckCodeSigning(struct HSS_BootImage *pBootImage) __attribute__((nonnull));
 
+#if IS_ENABLED(CONFIG_CRYPTO_SIGNING_MERKLE)
+struct HSSCryptoSHA384Context;
+
+/**
+ * Returns true if the image being verified is Merkle-tree signed, in which case its
+ * signature does not cover the chunks, and each chunk must instead be hashed with
+ * HSS_Boot_Secure_ChunkHash_Init()/Update() as it is copied, and checked with
+ * HSS_Boot_Secure_ChunkHash_Check() before it is used.
+ */
+bool HSS_Boot_Secure_HasChunkHashes(void);
+void HSS_Boot_Secure_ChunkHash_Init(struct HSSCryptoSHA384Context *pCtx) __attribute__((nonnull));
+void HSS_Boot_Secure_ChunkHash_Update(struct HSSCryptoSHA384Context *pCtx, void const *pData, size_t len)
+    __attribute__((nonnull));
+bool HSS_Boot_Secure_ChunkHash_Check(struct HSSCryptoSHA384Context *pCtx, size_t chunkIndex)
+    __attribute__((nonnull));
+#endif
+
+/**
+ * Times the digest and verify stages of code signature verification of the registered
+ * boot image, with each of the available crypto back ends.
+ */
+void HSS_Boot_Secure_Benchmark(void);
+
 #endif
@@ -24,6 +24,7 @@
 #include "hss_clock.h"
 #include "hss_debug.h"
 #include "hss_perfctr.h"
+#include "hss_timeline.h"
 #include "common/mss_peripherals.h"
 #include "hss_crc32.h"
 #include "u54_state.h"
@@ -64,6 +65,7 @@
 #include "fpga_design_config/fpga_design_config.h"
 
 #if IS_ENABLED(CONFIG_CRYPTO_SIGNING)
+#  include "hss_crypto.h"
 #  include "hss_boot_secure.h"
 #endif
 
@@ -89,6 +91,7 @@ static void boot_setup_pmp_onEntry(struct StateMachine * const pMyMachine);
 static void boot_setup_pmp_handler(struct StateMachine * const pMyMachine);
 static void boot_setup_pmp_complete_onEntry(struct StateMachine * const pMyMachine);
 static void boot_setup_pmp_complete_handler(struct StateMachine * const pMyMachine);
+static void boot_setup_pmp_complete_onExit(struct StateMachine * const pMyMachine);
 static void boot_zero_init_chunks_onEntry(struct StateMachine * const pMyMachine);
 static void boot_zero_init_chunks_handler(struct StateMachine * const pMyMachine);
 static void boot_download_chunks_onEntry(struct StateMachine * const pMyMachine);
@@ -99,6 +102,7 @@ static void boot_opensbi_init_handler(struct StateMachine * const pMyMachine);
 static void boot_opensbi_init_onExit(struct StateMachine * const pMyMachine);
 static void boot_wait_onEntry(struct StateMachine * const pMyMachine);
 static void boot_wait_handler(struct StateMachine * const pMyMachine);
+static void boot_wait_onExit(struct StateMachine * const pMyMachine);
 static void boot_error_handler(struct StateMachine * const pMyMachine);
 static void boot_complete_onEntry(struct StateMachine * const pMyMachine);
 static void boot_complete_handler(struct StateMachine * const pMyMachine);
@@ -108,6 +112,11 @@ static void boot_idle_handler(struct StateMachine * const pMyMachine);
 static void boot_do_download_chunk(struct HSS_BootChunkDesc const *pChunk,
     ptrdiff_t subChunkOffset, size_t subChunkSize);
 static void boot_do_zero_init_chunk(struct HSS_BootZIChunkDesc const *pZiChunk);
+#if IS_ENABLED(CONFIG_CRYPTO_SIGNING_MERKLE)
+static void boot_hash_sub_chunk_(struct HSS_BootChunkDesc const *pChunk,
+    size_t subChunkOffset, size_t subChunkSize);
+static bool boot_check_chunk_hash_(struct HSS_BootChunkDesc const *pChunk);
+#endif
 
 static bool validateCrc_(struct HSS_BootImage *pImage);
 
@@ -136,11 +145,11 @@ enum BootStatesEnum {
 static const struct StateDesc boot_state_descs[] = {
     { (const stateType_t)BOOT_INITIALIZATION,     (const char *)"Init",             NULL,                             NULL,                         &boot_init_handler },
     { (const stateType_t)BOOT_SETUP_PMP,          (const char *)"SetupPMP",         &boot_setup_pmp_onEntry,          NULL,                         &boot_setup_pmp_handler },
-    { (const stateType_t)BOOT_SETUP_PMP_COMPLETE, (const char *)"SetupPMPComplete", &boot_setup_pmp_complete_onEntry, NULL,                         &boot_setup_pmp_complete_handler },
+    { (const stateType_t)BOOT_SETUP_PMP_COMPLETE, (const char *)"SetupPMPComplete", &boot_setup_pmp_complete_onEntry, &boot_setup_pmp_complete_onExit, &boot_setup_pmp_complete_handler },
     { (const stateType_t)BOOT_ZERO_INIT_CHUNKS,   (const char *)"ZeroInit",         &boot_zero_init_chunks_onEntry,   NULL,                         &boot_zero_init_chunks_handler },
     { (const stateType_t)BOOT_DOWNLOAD_CHUNKS,    (const char *)"Download",         &boot_download_chunks_onEntry,    &boot_download_chunks_onExit, &boot_download_chunks_handler },
     { (const stateType_t)BOOT_OPENSBI_INIT,       (const char *)"OpenSBIInit",      &boot_opensbi_init_onEntry,       &boot_opensbi_init_onExit,    &boot_opensbi_init_handler },
-    { (const stateType_t)BOOT_WAIT,               (const char *)"Wait",             &boot_wait_onEntry,               NULL,                         &boot_wait_handler },
+    { (const stateType_t)BOOT_WAIT,               (const char *)"Wait",             &boot_wait_onEntry,               &boot_wait_onExit,            &boot_wait_handler },
     { (const stateType_t)BOOT_COMPLETE,           (const char *)"Complete",         &boot_complete_onEntry,           NULL,                         &boot_complete_handler },
     { (const stateType_t)BOOT_IDLE,               (const char *)"Idle",             &boot_idle_onEntry,               NULL,                         &boot_idle_handler },
     { (const stateType_t)BOOT_ERROR,              (const char *)"Error",            NULL,                             NULL,                         &boot_error_handler } };
@@ -162,6 +171,9 @@ struct HSS_Boot_LocalData {
     unsigned int iterator;
     uintptr_t ancilliaryData;
     uint32_t msgIndexAux[MAX_NUM_HARTS-1];
+#if IS_ENABLED(CONFIG_CRYPTO_SIGNING_MERKLE)
+    struct HSSCryptoSHA384Context chunkHashCtx;
+#endif
 };
 
 
@@ -188,8 +200,11 @@ struct StateMachine boot_service1 = {
     .executionCount    = 0u,
     .pStateDescs       = boot_state_descs,
     .debugFlag         = true,
-    .priority          = 0u,
-    .pInstanceData     = (void *)&localData[0]
+    .priority          = SM_PRIORITY_TOP,
+    .busyStates        = SM_STATE_BIT(BOOT_ZERO_INIT_CHUNKS) | SM_STATE_BIT(BOOT_DOWNLOAD_CHUNKS),
+    .pInstanceData     = (void *)&localData[0],
+    .wake              = { .sources = SM_WAKE_IPI, .sleepState = BOOT_IDLE, .ipiTypes = SM_WAKE_IPI_TYPE(IPI_MSG_BOOT_REQUEST),
+                           .ipiHarts = SM_WAKE_IPI_HART(HSS_HART_U54_1) },
 };
 
 struct StateMachine boot_service2 = {
@@ -202,8 +217,11 @@ struct StateMachine boot_service2 = {
     .executionCount    = 0u,
     .pStateDescs       = boot_state_descs,
     .debugFlag         = true,
-    .priority          = 0u,
-    .pInstanceData     = (void *)&localData[1]
+    .priority          = SM_PRIORITY_TOP,
+    .busyStates        = SM_STATE_BIT(BOOT_ZERO_INIT_CHUNKS) | SM_STATE_BIT(BOOT_DOWNLOAD_CHUNKS),
+    .pInstanceData     = (void *)&localData[1],
+    .wake              = { .sources = SM_WAKE_IPI, .sleepState = BOOT_IDLE, .ipiTypes = SM_WAKE_IPI_TYPE(IPI_MSG_BOOT_REQUEST),
+                           .ipiHarts = SM_WAKE_IPI_HART(HSS_HART_U54_2) },
 };
 
 struct StateMachine boot_service3 = {
@@ -216,8 +234,11 @@ struct StateMachine boot_service3 = {
     .executionCount    = 0u,
     .pStateDescs       = boot_state_descs,
     .debugFlag         = true,
-    .priority          = 0u,
-    .pInstanceData     = (void *)&localData[2]
+    .priority          = SM_PRIORITY_TOP,
+    .busyStates        = SM_STATE_BIT(BOOT_ZERO_INIT_CHUNKS) | SM_STATE_BIT(BOOT_DOWNLOAD_CHUNKS),
+    .pInstanceData     = (void *)&localData[2],
+    .wake              = { .sources = SM_WAKE_IPI, .sleepState = BOOT_IDLE, .ipiTypes = SM_WAKE_IPI_TYPE(IPI_MSG_BOOT_REQUEST),
+                           .ipiHarts = SM_WAKE_IPI_HART(HSS_HART_U54_3) },
 };
 
 struct StateMachine boot_service4 = {
@@ -230,8 +251,11 @@ struct StateMachine boot_service4 = {
     .executionCount    = 0u,
     .pStateDescs       = boot_state_descs,
     .debugFlag         = true,
-    .priority          = 0u,
-    .pInstanceData     = (void *)&localData[3]
+    .priority          = SM_PRIORITY_TOP,
+    .busyStates        = SM_STATE_BIT(BOOT_ZERO_INIT_CHUNKS) | SM_STATE_BIT(BOOT_DOWNLOAD_CHUNKS),
+    .pInstanceData     = (void *)&localData[3],
+    .wake              = { .sources = SM_WAKE_IPI, .sleepState = BOOT_IDLE, .ipiTypes = SM_WAKE_IPI_TYPE(IPI_MSG_BOOT_REQUEST),
+                           .ipiHarts = SM_WAKE_IPI_HART(HSS_HART_U54_4) },
 };
 
 /*
@@ -271,10 +295,19 @@ static void boot_do_download_chunk(struct HSS_BootChunkDesc const *pChunk, ptrdi
 {
     assert(pChunk);
     assert(pChunk->size);
+    assert((size_t)subChunkOffset < pChunk->size);
+
+    // the last sub-chunk must not run past the end of the chunk, as it would otherwise
+    // overwrite whatever follows it, including any zero-init chunk already cleared
+    subChunkSize = MIN(subChunkSize, pChunk->size - (size_t)subChunkOffset);
 
     const uintptr_t execAddr = (uintptr_t)pChunk->execAddr + subChunkOffset;
     const uintptr_t loadAddr = (uintptr_t)pBootImage + (uintptr_t)pChunk->loadAddr + subChunkOffset;
     memcpy_via_pdma((void *)execAddr, (void*)loadAddr, subChunkSize);
+
+#if IS_ENABLED(CONFIG_CRYPTO_SIGNING_MERKLE)
+    boot_hash_sub_chunk_(pChunk, (size_t)subChunkOffset, subChunkSize);
+#endif
 }
 
 static void boot_do_zero_init_chunk(struct HSS_BootZIChunkDesc const *pZiChunk)
@@ -287,6 +320,51 @@ static void boot_do_zero_init_chunk(struct HSS_BootZIChunkDesc const *pZiChunk)
     memset((void *)execAddr, 0, ziChunkSize);
 }
 
+#if IS_ENABLED(CONFIG_CRYPTO_SIGNING_MERKLE)
+//
+// The signature of a Merkle-tree signed image does not cover its chunks, so each chunk
+// is hashed where it has been copied to, a sub-chunk at a time, and checked against its
+// leaf once it is complete. Chunks are only copied by (or for) their owner, so the hash
+// context is kept with the owner's boot machine
+//
+static struct HSSCryptoSHA384Context *boot_chunk_hash_ctx_(struct HSS_BootChunkDesc const *pChunk)
+{
+    enum HSSHartId const owner = pChunk->owner & ~BOOT_FLAG_ANCILLIARY_DATA;
+
+    assert((owner >= HSS_HART_U54_1) && (owner <= HSS_HART_U54_4));
+    return &localData[owner - 1].chunkHashCtx;
+}
+
+static void boot_hash_sub_chunk_(struct HSS_BootChunkDesc const *pChunk,
+    size_t subChunkOffset, size_t subChunkSize)
+{
+    if (HSS_Boot_Secure_HasChunkHashes()) {
+        struct HSSCryptoSHA384Context * const pCtx = boot_chunk_hash_ctx_(pChunk);
+
+        if (!subChunkOffset) {
+            HSS_Boot_Secure_ChunkHash_Init(pCtx);
+        }
+
+        HSS_Boot_Secure_ChunkHash_Update(pCtx, (void const *)(pChunk->execAddr + subChunkOffset),
+            subChunkSize);
+    }
+}
+
+static bool boot_check_chunk_hash_(struct HSS_BootChunkDesc const *pChunk)
+{
+    bool result = true;
+
+    if (HSS_Boot_Secure_HasChunkHashes()) {
+        struct HSS_BootChunkDesc const * const pChunkTable =
+            (struct HSS_BootChunkDesc const *)((char *)pBootImage + pBootImage->chunkTableOffset);
+
+        result = HSS_Boot_Secure_ChunkHash_Check(boot_chunk_hash_ctx_(pChunk), (size_t)(pChunk - pChunkTable));
+    }
+
+    return result;
+}
+#endif
+
 static void free_msg_index(struct HSS_Boot_LocalData * const pInstanceData)
 {
     if (pInstanceData->msgIndex != IPI_MAX_NUM_OUTSTANDING_COMPLETES) {
@@ -332,12 +410,24 @@ static bool check_for_ipi_acks(struct StateMachine * const pMyMachine)
 }
 
 
+static bool code_signing_complete_(void)
+{
+#if IS_ENABLED(CONFIG_CRYPTO_SIGNING)
+    // the image signature is verified in the background (started by HSS_Boot_ValidateImage()),
+    // so that the superloop keeps running while the image is hashed
+    return HSS_Boot_Secure_IsCodeSigningComplete();
+#else
+    return true;
+#endif
+}
+
 // --------------------------------------------------------------------------------------------------
 // Handlers for each state in the state machine
 //
 static void boot_init_handler(struct StateMachine * const pMyMachine)
 {
-    if (HSS_Trigger_IsNotified(EVENT_DDR_TRAINED) && HSS_Trigger_IsNotified(EVENT_STARTUP_COMPLETE)) {
+    if (HSS_Trigger_IsNotified(EVENT_DDR_TRAINED) && HSS_Trigger_IsNotified(EVENT_STARTUP_COMPLETE)
+        && code_signing_complete_()) {
         if (pBootImage) {
             //mHSS_DEBUG_PRINTF(LOG_NORMAL, "%s::\tstarting boot\n", pMyMachine->pMachineName);
             SYSREG->BOOT_FAIL_CR = 0;
@@ -423,6 +513,10 @@ static void register_harts(struct StateMachine * const pMyMachine)
 
 static void boot_setup_pmp_onEntry(struct StateMachine * const pMyMachine)
 {
+    struct HSS_Boot_LocalData * const pInstanceData = pMyMachine->pInstanceData;
+
+    HSS_Timeline_Begin(TIMELINE_PMP_SETUP, pInstanceData->target);
+
     /* Initially register harts, so that IPIs work for remainder of boot */
     register_harts(pMyMachine);
 }
@@ -482,6 +576,13 @@ static void boot_setup_pmp_complete_handler(struct StateMachine * const pMyMachi
     }
 }
 
+static void boot_setup_pmp_complete_onExit(struct StateMachine * const pMyMachine)
+{
+    struct HSS_Boot_LocalData * const pInstanceData = pMyMachine->pInstanceData;
+
+    HSS_Timeline_End(TIMELINE_PMP_SETUP, pInstanceData->target);
+}
+
 /////////////////
 
 static void boot_zero_init_chunks_onEntry(struct StateMachine * const pMyMachine)
@@ -532,6 +633,8 @@ static void boot_download_chunks_onEntry(struct StateMachine * const pMyMachine)
 
     assert(pBootImage != NULL);
 
+    HSS_Timeline_Begin(TIMELINE_CHUNK_DOWNLOAD, target);
+
     if (pBootImage->hart[target-1].numChunks) {
         mHSS_DEBUG_PRINTF(LOG_NORMAL, "%s::Processing boot image: \"%s\"\n",
             pMyMachine->pMachineName, pBootImage->hart[target-1].name);
@@ -598,16 +701,26 @@ static void boot_download_chunks_handler(struct StateMachine * const pMyMachine)
 
 #ifdef BOOT_SUB_CHUNK_SIZE
                 pInstanceData->subChunkOffset += BOOT_SUB_CHUNK_SIZE;
-                if (pInstanceData->subChunkOffset > pChunk->size) {
+                if (pInstanceData->subChunkOffset >= pChunk->size) {
 #  if IS_ENABLED(CONFIG_DEBUG_CHUNK_DOWNLOADS)
                     mHSS_DEBUG_PRINTF(LOG_NORMAL, "%s::%d:sub-chunk finished at 0x%x\n",
                         pMyMachine->pMachineName, pInstanceData->chunkCount, pInstanceData->subChunkOffset);
+#  endif
+#  if IS_ENABLED(CONFIG_CRYPTO_SIGNING_MERKLE)
+                    if (!boot_check_chunk_hash_(pChunk)) {
+                        pMyMachine->state = BOOT_ERROR;
+                    }
 #  endif
                     pInstanceData->subChunkOffset = 0u;
                     pInstanceData->chunkCount++;
                     pInstanceData->pChunk++;
                 }
 #else
+#  if IS_ENABLED(CONFIG_CRYPTO_SIGNING_MERKLE)
+                if (!boot_check_chunk_hash_(pChunk)) {
+                    pMyMachine->state = BOOT_ERROR;
+                }
+#  endif
                 pInstanceData->chunkCount++;
                 pInstanceData->pChunk++;
 #endif
@@ -638,6 +751,10 @@ static void boot_download_chunks_handler(struct StateMachine * const pMyMachine)
 
 static void boot_download_chunks_onExit(struct StateMachine * const pMyMachine)
 {
+    struct HSS_Boot_LocalData * const pInstanceData = pMyMachine->pInstanceData;
+
+    HSS_Timeline_End(TIMELINE_CHUNK_DOWNLOAD, pInstanceData->target);
+
     /* Re-register harts now that we've fully parsed the boot image (ancillary data etc) */
     register_harts(pMyMachine);
 }
@@ -651,6 +768,8 @@ static void boot_opensbi_init_onEntry(struct StateMachine * const pMyMachine)
 
     assert(pBootImage != NULL);
 
+    HSS_Timeline_Begin(TIMELINE_OPENSBI_INIT, target);
+
     if (pBootImage->hart[target-1].entryPoint) {
         pInstanceData->iterator = 0u;
     }
@@ -737,6 +856,11 @@ static void boot_opensbi_init_onExit(struct StateMachine * const pMyMachine)
         mHSS_DEBUG_PRINTF(LOG_NORMAL, "%s::target is %u, pBootImage is %p, skipping goto/sbi_init %p\n",
             pMyMachine->pMachineName, target, pBootImage, pBootImage->hart[target-1].entryPoint);
     }
+
+    // on failure, BOOT_WAIT (whose onExit normally ends the phase) is skipped
+    if (pMyMachine->state == BOOT_ERROR) {
+        HSS_Timeline_End(TIMELINE_OPENSBI_INIT, target);
+    }
 }
 
 /////////////////
@@ -784,6 +908,14 @@ static void boot_wait_handler(struct StateMachine * const pMyMachine)
     }
 }
 
+static void boot_wait_onExit(struct StateMachine * const pMyMachine)
+{
+    struct HSS_Boot_LocalData * const pInstanceData = pMyMachine->pInstanceData;
+
+    // OpenSBI init is complete once the target (and its peers) have acknowledged it
+    HSS_Timeline_End(TIMELINE_OPENSBI_INIT, pInstanceData->target);
+}
+
 /////////////////
 
 static void boot_error_handler(struct StateMachine * const pMyMachine)
@@ -1025,7 +1157,13 @@ static bool validateCrc_(struct HSS_BootImage *pImageHdr)
         break;
     }
 
+    static int perf_ctr_index = PERF_CTR_UNINITIALIZED;
+    HSS_PerfCtr_Allocate(&perf_ctr_index, "Boot Image Header CRC");
+    HSS_PerfCtr_Start(perf_ctr_index);
+
     headerCrc = CRC32_calculate((const uint8_t *)&shadowHdr, crcLen);
+    HSS_PerfCtr_Lap(perf_ctr_index);
+
     if (headerCrc == pImageHdr->headerCrc) {
         result = true;
     } else {
@@ -1050,7 +1188,7 @@ bool HSS_Boot_ValidateImage(struct HSS_BootImage *pImage)
         } else if (pImage->magic != mHSS_BOOT_MAGIC) {
             mHSS_DEBUG_PRINTF(LOG_ERROR, "Boot Image magic invalid, ignoring\n");
 #  if IS_ENABLED(CONFIG_CRYPTO_SIGNING)
-        } else if (!HSS_Boot_Secure_CheckCodeSigning(pImage)) {
+        } else if (!HSS_Boot_Secure_StartCodeSigning(pImage)) {
             mHSS_DEBUG_PRINTF(LOG_ERROR, "Boot Image failed code signing\n");
 #  endif
         } else if (validateCrc_(pImage)) {
@@ -1069,6 +1207,9 @@ bool HSS_Boot_ValidateImage(struct HSS_BootImage *pImage)
 #  pragma GCC diagnostic pop
 
 #  if defined(CONFIG_SERVICE_BOOT_CUSTOM_FLOW)
+            // the custom flow jumps straight into the image, so can't leave its
+            // signature to be checked in the background
+            while (!code_signing_complete_()) { ; }
             result = HSS_Boot_Custom();
 #  else
             result = true;
@@ -1160,13 +1301,23 @@ bool HSS_Boot_Custom(void)
             boot_do_download_chunk(pChunk, subChunkOffset, BOOT_SUB_CHUNK_SIZE);
 
             subChunkOffset += BOOT_SUB_CHUNK_SIZE;
-            if (subChunkOffset > pChunk->size) {
+            if (subChunkOffset >= pChunk->size) {
+#  if IS_ENABLED(CONFIG_CRYPTO_SIGNING_MERKLE)
+                if (!boot_check_chunk_hash_(pChunk)) {
+                    return false;
+                }
+#  endif
                 subChunkOffset = 0u;
                 chunkNum++;
                 pChunk++;
             }
 #else
             boot_do_download_chunk(pChunk, 0u, pChunk->size);
+#  if IS_ENABLED(CONFIG_CRYPTO_SIGNING_MERKLE)
+            if (!boot_check_chunk_hash_(pChunk)) {
+                return false;
+            }
+#  endif
             chunkNum++;
             pChunk++;
             (void)subChunkOffset;
@@ -68,7 +68,8 @@ struct StateMachine ddr_service = {
     .pStateDescs       = ddr_state_descs,
     .debugFlag         = false,
     .priority          = 0u,
-    .pInstanceData     = NULL
+    .pInstanceData     = NULL,
+    .wake              = { .sources = SM_WAKE_TIMER, .sleepState = DDR_IDLE, .period = ONE_SEC },
 };
 
 // --------------------------------------------------------------------------------------------------
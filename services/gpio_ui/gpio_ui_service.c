@@ -75,8 +75,9 @@ struct StateMachine gpio_ui_service = {
     .executionCount    = 0u,
     .pStateDescs       = gpio_ui_state_descs,
     .debugFlag         = true,
-    .priority          = 0u,
-    .pInstanceData     = NULL
+    .priority          = SM_PRIORITY_LOW(4u),
+    .pInstanceData     = NULL,
+    .wake              = { .sources = SM_WAKE_TRANSITION, .sleepState = GPIO_UI_IDLE },
 };
 
 // --------------------------------------------------------------------------------------------------
@@ -28,6 +28,10 @@
 
 #include "mss_hart_ints.h"
 
+#if IS_ENABLED(CONFIG_SERVICE_TELEMETRY)
+#  include "telemetry_service.h"
+#endif
+
 extern int sbi_snprintf(char *out, u32 out_sz, const char *format, ...);
 
 static void healthmon_init_handler(struct StateMachine * const pMyMachine);
@@ -50,6 +54,13 @@ static const struct StateDesc healthmon_state_descs[] = {
     { (const stateType_t)HEALTH_MONITORING,     (const char *)"monitoring", NULL, NULL, &healthmon_monitoring_handler },
 };
 
+/*!
+ * \brief Monitor sample period
+ *
+ * This is also the wake period used by the ready-mask scheduler.
+ */
+#define HEALTHMON_WAKE_PERIOD ((HSSTicks_t)CONFIG_SERVICE_HEALTHMON_SAMPLE_PERIOD_MS * ONE_MILLISEC)
+
 /*!
  * \brief Health Driver State Machine
  */
@@ -63,8 +74,10 @@ struct StateMachine healthmon_service = {
     .executionCount    = 0u,
     .pStateDescs       = healthmon_state_descs,
     .debugFlag         = true,
-    .priority          = 0u,
-    .pInstanceData     = NULL
+    .priority          = SM_PRIORITY_LOW(16u),
+    .pInstanceData     = NULL,
+    .wake              = { .sources = SM_WAKE_TIMER, .sleepState = HEALTH_MONITORING, .period = HEALTHMON_WAKE_PERIOD },
+    .budget            = ONE_MILLISEC,
 };
 
 char const * const checkName[] = {
@@ -86,6 +99,208 @@ extern const struct HealthMonitor monitors[];
 extern struct HealthMonitor_Status monitor_status[];
 extern const size_t monitors_array_size;
 
+/*!
+ * \brief Monitor deadline queue
+ *
+ * A binary min-heap of monitor indices, keyed on each monitor's next sample
+ * deadline, so that each pass only evaluates the monitors that are due
+ * rather than scanning the whole monitors[] array.
+ */
+static uint16_t deadlineHeap[CONFIG_SERVICE_HEALTHMON_MAX_MONITORS];
+static size_t deadlineHeapSize = 0u;
+
+static uint64_t passCount = 0u;
+static uint64_t evaluationCount = 0u;
+
+/*!
+ * \brief History of sample value changes, across all monitors
+ */
+static struct {
+    HSSTicks_t time;
+    uint16_t monitor;
+    uint32_t value;
+} history[CONFIG_SERVICE_HEALTHMON_HISTORY_SIZE];
+static size_t historyHead = 0u;
+static size_t historyCount = 0u;
+
+static inline HSSTicks_t healthmon_deadline_(size_t heapIdx)
+{
+    return monitor_status[deadlineHeap[heapIdx]].nextDeadline;
+}
+
+static void healthmon_heap_swap_(size_t a, size_t b)
+{
+    uint16_t const tmp = deadlineHeap[a];
+    deadlineHeap[a] = deadlineHeap[b];
+    deadlineHeap[b] = tmp;
+}
+
+static void healthmon_heap_sift_down_(size_t idx)
+{
+    for (;;) {
+        size_t const left = (2u * idx) + 1u;
+        size_t const right = left + 1u;
+        size_t smallest = idx;
+
+        if ((left < deadlineHeapSize) && (healthmon_deadline_(left) < healthmon_deadline_(smallest))) {
+            smallest = left;
+        }
+        if ((right < deadlineHeapSize) && (healthmon_deadline_(right) < healthmon_deadline_(smallest))) {
+            smallest = right;
+        }
+
+        if (smallest == idx) {
+            break;
+        }
+
+        healthmon_heap_swap_(idx, smallest);
+        idx = smallest;
+    }
+}
+
+static void healthmon_heap_init_(HSSTicks_t const now)
+{
+    deadlineHeapSize = MIN(monitors_array_size, (size_t)CONFIG_SERVICE_HEALTHMON_MAX_MONITORS);
+
+    if (deadlineHeapSize < monitors_array_size) {
+        mHSS_DEBUG_PRINTF(LOG_ERROR, "Only %lu of %lu health monitors will be scheduled"
+            " - increase CONFIG_SERVICE_HEALTHMON_MAX_MONITORS\n",
+            deadlineHeapSize, monitors_array_size);
+    }
+
+    // all deadlines are equal, so the identity order is already a valid heap
+    for (size_t i = 0u; i < deadlineHeapSize; i++) {
+        deadlineHeap[i] = (uint16_t)i;
+        monitor_status[i].nextDeadline = now;
+    }
+
+#if IS_ENABLED(CONFIG_SERVICE_TELEMETRY)
+    struct HSS_Telemetry_Page * const pTelemetry = HSS_Telemetry_WriteBegin();
+
+    if (pTelemetry) {
+        pTelemetry->healthmon.count = (uint32_t)MIN(deadlineHeapSize, (size_t)HSS_TELEMETRY_MAX_MONITORS);
+        for (size_t i = 0u; i < pTelemetry->healthmon.count; i++) {
+            strncpy(pTelemetry->healthmon.monitors[i].name, monitors[i].pName,
+                HSS_TELEMETRY_MONITOR_NAME_LEN - 1u);
+        }
+        HSS_Telemetry_WriteEnd(pTelemetry);
+    }
+#endif
+}
+
+static void healthmon_record_sample_(size_t i, uint32_t value, HSSTicks_t const now)
+{
+    if (!monitor_status[i].sampleCount || (value != monitor_status[i].lastSample)) {
+        history[historyHead].time = now;
+        history[historyHead].monitor = (uint16_t)i;
+        history[historyHead].value = value;
+        historyHead = (historyHead + 1u) % ARRAY_SIZE(history);
+        if (historyCount < ARRAY_SIZE(history)) { historyCount++; }
+    }
+
+    if (!monitor_status[i].sampleCount) {
+        monitor_status[i].minSample = value;
+        monitor_status[i].maxSample = value;
+    } else {
+        if (value < monitor_status[i].minSample) { monitor_status[i].minSample = value; }
+        if (value > monitor_status[i].maxSample) { monitor_status[i].maxSample = value; }
+    }
+
+    monitor_status[i].lastSample = value;
+    monitor_status[i].sampleCount++;
+}
+
+#if IS_ENABLED(CONFIG_SERVICE_TELEMETRY)
+static void healthmon_publish_telemetry_(struct HSS_Telemetry_Page * const pTelemetry, size_t i)
+{
+    if (pTelemetry && (i < HSS_TELEMETRY_MAX_MONITORS)) {
+        pTelemetry->healthmon.monitors[i].last = monitor_status[i].lastSample;
+        pTelemetry->healthmon.monitors[i].min = monitor_status[i].minSample;
+        pTelemetry->healthmon.monitors[i].max = monitor_status[i].maxSample;
+        pTelemetry->healthmon.monitors[i].fires = monitor_status[i].count;
+        pTelemetry->healthmon.monitors[i].samples = monitor_status[i].sampleCount;
+    }
+}
+#endif
+
+static bool healthmon_evaluate_(size_t i, HSSTicks_t const now)
+{
+    uint32_t value = *(uint32_t volatile *)(monitors[i].pAddr);
+    enum HealthMon_CheckType checkType = monitors[i].checkType;
+    bool triggered = false;
+    bool result = false;
+
+    if (monitors[i].shift) { value = value >> monitors[i].shift; }
+    if (monitors[i].mask) { value = value & monitors[i].mask; }
+
+    healthmon_record_sample_(i, value, now);
+
+    switch (checkType) {
+    case ABOVE_THRESHOLD:
+        if (value > monitors[i].maxValue) { triggered = true; }
+        break;
+
+    case BELOW_THRESHOLD:
+        if (value < monitors[i].minValue) { triggered = true; }
+        break;
+
+    case ABOVE_OR_BELOW_THRESHOLD:
+        if (value > monitors[i].maxValue) {
+            triggered = true;
+            checkType = ABOVE_THRESHOLD;
+        } else if (value < monitors[i].minValue) {
+            triggered = true;
+            checkType = BELOW_THRESHOLD;
+        }
+        break;
+
+    case EQUAL_TO_VALUE:
+        if (value == monitors[i].maxValue) { triggered = true; }
+        break;
+
+    case NOT_EQUAL_TO_VALUE:
+        if (value != monitors[i].maxValue) { triggered = true; }
+        break;
+
+    case CHANGED_SINCE_LAST:
+        if (monitor_status[i].initialized) {
+            if (value != monitor_status[i].lastValue) {
+                triggered = true;
+            }
+        } else {
+            monitor_status[i].initialized = true;
+        }
+        break;
+
+    default:
+        // unexpected check type
+        break;
+    }
+
+    if (triggered && value != monitor_status[i].lastValue) {
+        monitor_status[i].count++;
+
+        mHSS_DEBUG_PRINTF(LOG_ERROR, "%s %s ",
+            monitors[i].pName, checkName[monitors[i].checkType]);
+        HSS_Debug_Highlight(HSS_DEBUG_LOG_ERROR);
+        if (checkType != CHANGED_SINCE_LAST) {
+            mHSS_DEBUG_PRINTF_EX("0x%x ", monitors[i].maxValue);
+        }
+        mHSS_DEBUG_PRINTF_EX("(0x%x)\n", value);
+        HSS_Debug_Highlight(HSS_DEBUG_LOG_NORMAL);
+
+        if (monitors[i].triggerCallback) {
+            monitors[i].triggerCallback(monitors[i].pAddr);
+        }
+
+        monitor_status[i].throttle_startTime = now;
+        monitor_status[i].lastValue = value;
+        result = true;
+    }
+
+    return result;
+}
+
 // --------------------------------------------------------------------------------------------------
 // Handlers for each state in the state machine
 //
@@ -93,6 +308,7 @@ static void healthmon_init_handler(struct StateMachine * const pMyMachine)
 {
     if (HSS_Trigger_IsNotified(EVENT_DDR_TRAINED) && HSS_Trigger_IsNotified(EVENT_STARTUP_COMPLETE)
         && HSS_Trigger_IsNotified(EVENT_POST_BOOT)) {
+        healthmon_heap_init_(HSS_GetTime());
         pMyMachine->state = HEALTH_MONITORING;
     }
 }
@@ -102,85 +318,40 @@ static void healthmon_monitoring_handler(struct StateMachine * const pMyMachine)
 {
     (void)pMyMachine;
 
-    // general health monitoring...
-    {
-        for (size_t i = 0u; i < monitors_array_size; i++) {
-            if (HSS_Timer_IsElapsed(monitor_status[i].throttle_startTime, monitors[i].throttleScale * ONE_SEC)) {
-                uint32_t value = *(uint32_t volatile *)(monitors[i].pAddr);
-                enum HealthMon_CheckType checkType = monitors[i].checkType;
-                bool triggered = false;
-
-                if (monitors[i].shift) { value = value >> monitors[i].shift; }
-                if (monitors[i].mask) { value = value & monitors[i].mask; }
-
-                switch (checkType) {
-                case ABOVE_THRESHOLD:
-                    if (value > monitors[i].maxValue) { triggered = true; }
-                    break;
-
-                case BELOW_THRESHOLD:
-                    if (value < monitors[i].minValue) { triggered = true; }
-                    break;
-
-                case ABOVE_OR_BELOW_THRESHOLD:
-                    if (value > monitors[i].maxValue) {
-                        triggered = true;
-                        checkType = ABOVE_THRESHOLD;
-                    } else if (value < monitors[i].minValue) {
-                        triggered = true;
-                        checkType = BELOW_THRESHOLD;
-                    }
-                    break;
-
-                case EQUAL_TO_VALUE:
-                    if (value == monitors[i].maxValue) { triggered = true; }
-                    break;
-
-                case NOT_EQUAL_TO_VALUE:
-                    if (value != monitors[i].maxValue) { triggered = true; }
-                    break;
-
-                case CHANGED_SINCE_LAST:
-                    if (monitor_status[i].initialized) {
-                        if (value != monitor_status[i].lastValue) {
-                            triggered = true;
-                        }
-                    } else {
-                        monitor_status[i].initialized = true;
-                    }
-                    break;
-
-                default:
-                    // unexpected check type
-                    break;
-                }
-
-                if (triggered && value != monitor_status[i].lastValue) {
-                    monitor_status[i].count++;
-
-                    mHSS_DEBUG_PRINTF(LOG_ERROR, "%s %s ",
-                        monitors[i].pName, checkName[monitors[i].checkType]);
-                    HSS_Debug_Highlight(HSS_DEBUG_LOG_ERROR);
-                    if (checkType != CHANGED_SINCE_LAST) {
-                        mHSS_DEBUG_PRINTF_EX("0x%x ", monitors[i].maxValue);
-                    }
-                    mHSS_DEBUG_PRINTF_EX("(0x%x)\n", value);
-                    HSS_Debug_Highlight(HSS_DEBUG_LOG_NORMAL);
-
-                    if (monitors[i].triggerCallback) {
-                        monitors[i].triggerCallback(monitors[i].pAddr);
-                    }
-
-                    monitor_status[i].throttle_startTime = HSS_GetTime();
-                    monitor_status[i].lastValue = value;
-                }
-            }
+    HSSTicks_t const now = HSS_GetTime();
+
+    passCount++;
+
+#if IS_ENABLED(CONFIG_SERVICE_TELEMETRY)
+    struct HSS_Telemetry_Page *pTelemetry = NULL;
+#endif
+
+    // only the monitors at the top of the deadline queue are due
+    while (deadlineHeapSize && (healthmon_deadline_(0u) <= now)) {
+        size_t const i = deadlineHeap[0];
+
+        evaluationCount++;
+
+        if (healthmon_evaluate_(i, now)) {
+            // fired, so throttle console messages for this monitor
+            monitor_status[i].nextDeadline = now + (monitors[i].throttleScale * ONE_SEC);
+        } else {
+            monitor_status[i].nextDeadline = now + HEALTHMON_WAKE_PERIOD;
         }
 
-        //if (!triggered) {
-        // mHSS_DEBUG_PRINTF(LOG_NORMAL, "No HealthMon triggers fired\n");
-        //}
+#if IS_ENABLED(CONFIG_SERVICE_TELEMETRY)
+        if (!pTelemetry) {
+            pTelemetry = HSS_Telemetry_WriteBegin();
+        }
+        healthmon_publish_telemetry_(pTelemetry, i);
+#endif
+
+        healthmon_heap_sift_down_(0u);
     }
+
+#if IS_ENABLED(CONFIG_SERVICE_TELEMETRY)
+    HSS_Telemetry_WriteEnd(pTelemetry);
+#endif
 }
 
 /////////////////
@@ -227,6 +398,31 @@ void HSS_Health_DumpStats(void)
             // we have an entry with a valid checkType
             mHSS_DEBUG_PRINTF(LOG_NORMAL, "% 60s: %" PRIu64 "\n",
                 tmp_buffer, monitor_status[i].count);
+            if (monitor_status[i].sampleCount) {
+                mHSS_DEBUG_PRINTF(LOG_NORMAL, "% 60s  last 0x%x, min 0x%x, max 0x%x over %" PRIu64 " samples\n",
+                    "", monitor_status[i].lastSample, monitor_status[i].minSample,
+                    monitor_status[i].maxSample, monitor_status[i].sampleCount);
+            }
         }
     }
+
+    mHSS_DEBUG_PRINTF(LOG_NORMAL, "%" PRIu64 " monitor evaluations over %" PRIu64 " passes\n",
+        evaluationCount, passCount);
+    if (deadlineHeapSize) {
+        HSSTicks_t const now = HSS_GetTime();
+        HSSTicks_t const nextDeadline = healthmon_deadline_(0u);
+
+        mHSS_DEBUG_PRINTF(LOG_NORMAL, "next monitor due in %" PRIu64 " ms (%s)\n",
+            (nextDeadline > now) ? ((nextDeadline - now) / ONE_MILLISEC) : 0u,
+            monitors[deadlineHeap[0]].pName);
+    }
+
+    mHSS_DEBUG_PRINTF(LOG_NORMAL, "Recent sample changes (oldest first):\n");
+    for (size_t n = 0u; n < historyCount; n++) {
+        size_t const idx = (historyHead + ARRAY_SIZE(history) - historyCount + n) % ARRAY_SIZE(history);
+
+        mHSS_DEBUG_PRINTF(LOG_NORMAL, "  %" PRIu64 " ms: %s = 0x%x\n",
+            history[idx].time / ONE_MILLISEC, monitors[history[idx].monitor].pName,
+            history[idx].value);
+    }
 }
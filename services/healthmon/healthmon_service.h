@@ -76,6 +76,13 @@ struct HealthMonitor_Status
     uint32_t lastValue;
     size_t count;
     bool initialized;
+
+    // maintained by the service, and need not be initialized by the board
+    HSSTicks_t nextDeadline;
+    uint32_t lastSample;
+    uint32_t minSample;
+    uint32_t maxSample;
+    uint64_t sampleCount;
 };
 #ifdef __cplusplus
 }
@@ -64,8 +64,9 @@ struct StateMachine ipi_poll_service = {
     .executionCount    = 0u,
     .pStateDescs       = ipiPoll_state_descs,
     .debugFlag         = true,
-    .priority          = 0u,
+    .priority          = SM_PRIORITY_TOP,
     .pInstanceData     = NULL,
+    .wake              = { .sources = SM_WAKE_IPI, .sleepState = IPI_POLL_MONITORING, .ipiTypes = ~0u },
 };
 
 // ----------------------------------------------------------------------------------------------------------------------
@@ -64,7 +64,8 @@ struct StateMachine lockdown_service = {
     .pStateDescs       = lockdown_state_descs,
     .debugFlag         = true,
     .priority          = 0u,
-    .pInstanceData     = NULL
+    .pInstanceData     = NULL,
+    .wake              = { .sources = SM_WAKE_TRIGGER, .sleepState = LOCKDOWN_INITIALIZATION, .events = SM_WAKE_EVENT(EVENT_BOOT_COMPLETE) },
 };
 
 
@@ -40,6 +40,10 @@
 #  include "opensbi_crypto_ecall.h"
 #endif
 
+#if IS_ENABLED(CONFIG_SERVICE_TELEMETRY)
+#  include "telemetry_service.h"
+#endif
+
 #include "hss_boot_service.h"
 
 int HSS_SBI_ECALL_Handler(long extid, long funcid,
@@ -89,6 +93,15 @@ int HSS_SBI_ECALL_Handler(long extid, long funcid,
             result = SBI_OK;
             break;
 
+        case SBI_EXT_HSS_TELEMETRY:
+#if IS_ENABLED(CONFIG_SERVICE_TELEMETRY)
+            *out_val = HSS_Telemetry_GetAddress();
+            result = *out_val ? SBI_OK : SBI_ENODEV;
+#else
+            result = SBI_ENOTSUPP;
+#endif
+            break;
+
         default:
             result = SBI_ENOTSUPP;
     };
@@ -135,6 +135,7 @@ struct StateMachine opensbi_service = {
     .debugFlag         = false,
     .priority          = 0u,
     .pInstanceData     = NULL,
+    .wake              = { .sources = SM_WAKE_TRANSITION, .sleepState = OPENSBI_IDLE },
 };
 
 
@@ -57,7 +57,8 @@ struct StateMachine powermode_service = {
     .pStateDescs       =  powermode_state_descs,
     .debugFlag         =  false,
     .priority          =  0u,
-    .pInstanceData     =  NULL
+    .pInstanceData     =  NULL,
+    .wake              =  { .sources = SM_WAKE_IPI, .sleepState = POWER_MODE_STATE1_DO_SOMETHING, .ipiTypes = SM_WAKE_IPI_TYPE(IPI_MSG_POWERMODE) },
 };
 
 // --------------------------------------------------------------------------------------------------
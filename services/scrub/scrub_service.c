@@ -28,6 +28,15 @@
 #include "scrub_types.h"
 
 #include "mss_l2_cache.h"
+#include "mss_sysreg.h"
+
+#if IS_ENABLED(CONFIG_SERVICE_SCRUB_PDMA)
+#  include "drivers/mss/mss_pdma/mss_pdma.h"
+#endif
+
+#if IS_ENABLED(CONFIG_SERVICE_TELEMETRY)
+#  include "telemetry_service.h"
+#endif
 
 #ifndef PRIx64
 #  define PRIx64 "llu"
@@ -53,6 +62,14 @@ static const struct StateDesc scrub_state_descs[] = {
     { (const stateType_t)SCRUB_SCRUBBING,      (const char *)"scrubbing", NULL, NULL, &scrub_scrubbing_handler },
 };
 
+/*!
+ * \brief Scrub period when dispatched by the ready-mask scheduler
+ *
+ * The superloop rate is no longer fixed when the ready-mask scheduler is used,
+ * so scrubbing is paced by time rather than by SERVICE_SCRUB_RUN_EVERY_X_SUPERLOOPS.
+ */
+#define SCRUB_WAKE_PERIOD (ONE_MILLISEC)
+
 /*!
  * \brief SCRUB Driver State Machine
  */
@@ -67,7 +84,9 @@ struct StateMachine scrub_service = {
     .pStateDescs       = scrub_state_descs,
     .debugFlag         = true,
     .priority          = 0u,
-    .pInstanceData     = NULL
+    .pInstanceData     = NULL,
+    .wake              = { .sources = SM_WAKE_TIMER, .sleepState = SCRUB_SCRUBBING, .period = SCRUB_WAKE_PERIOD },
+    .budget            = ONE_MILLISEC,
 };
 
 
@@ -127,40 +146,357 @@ const struct {
 static uintptr_t offset = 0u;
 static size_t idx = 0u;
 static size_t entryCount = 0u;
+static uint64_t regionPassCount = 0u;
+
+#if IS_ENABLED(CONFIG_SERVICE_SCRUB_ADAPTIVE)
+/*!
+ * \brief Adaptive scrub rate state, per region
+ *
+ * The chunk size scrubbed per invocation is the configured base size shifted
+ * left by the rate level (or right, if negative). A correctable error in a
+ * region raises its level to the maximum boost; each clean decay interval
+ * then steps it back down, to below the base rate.
+ */
+static struct {
+    int level;
+    uint64_t errorCount;
+    HSSTicks_t lastDecayTime;
+    HSSTicks_t passStartTime;
+    HSSTicks_t lastPassDuration;
+    HSSTicks_t lastPassCompleteTime;
+    uint64_t passCount;
+} regionStats[ARRAY_SIZE(rams)];
+
+#define SCRUB_DUTY_CYCLE_WINDOW (100llu * ONE_MILLISEC)
+#define SCRUB_DECAY_INTERVAL    (CONFIG_SERVICE_SCRUB_ADAPTIVE_DECAY_MS * ONE_MILLISEC)
+
+static uint64_t unattributedErrorCount = 0u;
+static uint32_t lastL2DataFixCount = 0u;
+#if !IS_ENABLED(CONFIG_SKIP_DDR)
+static uint32_t lastDDRCFixCount = 0u;
+#endif
+static HSSTicks_t dutyCycleWindowStart = 0u;
+static HSSTicks_t dutyCycleBusyTime = 0u;
+static uint64_t dutyCycleThrottleCount = 0u;
+
+static void scrub_boost_region_(size_t const region, uint64_t const errorCount)
+{
+    regionStats[region].errorCount += errorCount;
+    regionStats[region].level = CONFIG_SERVICE_SCRUB_ADAPTIVE_MAX_BOOST;
+    regionStats[region].lastDecayTime = HSS_GetTime();
+}
+
+void HSS_Scrub_ReportCorrectableError(uintptr_t addr)
+{
+    size_t i;
+
+    for (i = 0u; i < ARRAY_SIZE(rams); i++) {
+        if ((addr >= rams[i].baseAddr) && (addr < rams[i].endAddr)) {
+            break;
+        }
+    }
+
+    if (i < ARRAY_SIZE(rams)) {
+        scrub_boost_region_(i, 1u);
+    } else {
+        unattributedErrorCount++;
+    }
+}
+
+#if !IS_ENABLED(CONFIG_SKIP_DDR)
+/*!
+ * \brief Attribute DDR controller correctable errors
+ *
+ * The DDR controller only counts its single bit errors, without latching an
+ * address, so every scrubbed region in DDR is boosted.
+ */
+static void scrub_report_ddr_errors_(uint32_t const errorCount)
+{
+    bool found = false;
+
+    for (size_t i = 0u; i < ARRAY_SIZE(rams); i++) {
+        if (((rams[i].baseAddr >= (uintptr_t)&__ddr_start) && (rams[i].endAddr <= (uintptr_t)&__ddr_end))
+            || ((rams[i].baseAddr >= (uintptr_t)&__ddrhi_start) && (rams[i].endAddr <= (uintptr_t)&__ddrhi_end))) {
+            scrub_boost_region_(i, errorCount);
+            found = true;
+        }
+    }
+
+    if (!found) {
+        unattributedErrorCount += errorCount;
+    }
+}
+#endif
+
+static void scrub_sample_ecc_counters_(HSSTicks_t const now)
+{
+    uint32_t const l2DataFixCount = CACHE_CTRL->ECC_DATA_FIX_COUNT;
+
+    if (l2DataFixCount != lastL2DataFixCount) {
+        lastL2DataFixCount = l2DataFixCount;
+        HSS_Scrub_ReportCorrectableError((uintptr_t)CACHE_CTRL->ECC_DATA_FIX_ADDR);
+    }
+
+#if !IS_ENABLED(CONFIG_SKIP_DDR)
+    uint32_t const ddrcFixCount = SYSREG->EDAC_CNT_DDRC & EDAC_CNT_DDRC_COUNT_MASK;
+
+    if (ddrcFixCount != lastDDRCFixCount) {
+        scrub_report_ddr_errors_((ddrcFixCount - lastDDRCFixCount) & EDAC_CNT_DDRC_COUNT_MASK);
+        lastDDRCFixCount = ddrcFixCount;
+    }
+#endif
+
+    for (size_t i = 0u; i < ARRAY_SIZE(rams); i++) {
+        if (HSS_Timer_IsElapsed(regionStats[i].lastDecayTime, SCRUB_DECAY_INTERVAL)) {
+            if (regionStats[i].level > -CONFIG_SERVICE_SCRUB_ADAPTIVE_MAX_BACKOFF) {
+                regionStats[i].level--;
+            }
+            regionStats[i].lastDecayTime = now;
+        }
+    }
+}
+
+static bool scrub_is_over_duty_cycle_(HSSTicks_t const now)
+{
+    bool result = false;
+
+    if (!dutyCycleWindowStart || HSS_Timer_IsElapsed(dutyCycleWindowStart, SCRUB_DUTY_CYCLE_WINDOW)) {
+        dutyCycleWindowStart = now;
+        dutyCycleBusyTime = 0u;
+    } else if ((dutyCycleBusyTime * 100u)
+        > ((now - dutyCycleWindowStart) * CONFIG_SERVICE_SCRUB_ADAPTIVE_DUTY_CYCLE_PCT)) {
+        dutyCycleThrottleCount++;
+        result = true;
+    }
+
+    return result;
+}
+
+static size_t scrub_chunk_size_(size_t const region)
+{
+    int const level = regionStats[region].level;
+    size_t chunkSize = CONFIG_SERVICE_SCRUB_MAX_SIZE_PER_LOOP_ITER;
+
+    if (level > 0) {
+        chunkSize <<= level;
+    } else if (level < 0) {
+        chunkSize >>= -level;
+    }
+
+    chunkSize &= ~(sizeof(uint64_t) - 1u);
+
+    return chunkSize ? chunkSize : sizeof(uint64_t);
+}
+
+static void scrub_region_complete_(size_t const region, HSSTicks_t const now)
+{
+    if (regionStats[region].passStartTime) {
+        regionStats[region].lastPassDuration = now - regionStats[region].passStartTime;
+    }
+    regionStats[region].lastPassCompleteTime = now;
+    regionStats[region].passCount++;
+}
+#else
+#  define scrub_chunk_size_(region) ((size_t)CONFIG_SERVICE_SCRUB_MAX_SIZE_PER_LOOP_ITER)
+#endif
+
+static struct {
+    uint64_t bytes;
+    HSSTicks_t time;
+} cpuScrubStats = { 0u, 0u };
+
+static void scrub_cpu_(uintptr_t const chunkStartAddr, size_t const chunkSize, bool const use_atomic_or)
+{
+    HSSTicks_t const startTime = HSS_GetTime();
+    const uintptr_t chunkEndAddr = chunkStartAddr + chunkSize;
+
+    for (uint64_t *pMem = (uint64_t*)chunkStartAddr; pMem < (uint64_t*)chunkEndAddr; pMem++) {
+        if (unlikely(use_atomic_or)) {
+            __atomic_or_fetch((volatile uint64_t *)pMem, (uint64_t)0u, __ATOMIC_RELAXED);
+        } else {
+            *(volatile uint64_t *)pMem;
+        }
+    }
+
+    cpuScrubStats.bytes += chunkSize;
+    cpuScrubStats.time += HSS_GetTime() - startTime;
+}
+
+#if IS_ENABLED(CONFIG_SERVICE_SCRUB_PDMA)
+/*!
+ * \brief PDMA scrub engine
+ *
+ * Bursts are read from the region being scrubbed into a discard sink by a
+ * spare PDMA channel, so that ECC correction is triggered on the read without
+ * involving E51 loads or polluting the E51 D$. Each burst runs in the
+ * background and is reaped on a later dispatch.
+ */
+#define SCRUB_PDMA_CHANNEL ((mss_pdma_channel_id_t)CONFIG_SERVICE_SCRUB_PDMA_CHANNEL)
+
+static uint8_t pdmaSink[CONFIG_SERVICE_SCRUB_PDMA_SINK_SIZE] __attribute__((aligned(64)));
+static bool pdmaInFlight = false;
+static bool pdmaDisabled = false;
+static size_t pdmaInFlightBytes = 0u;
+static HSSTicks_t pdmaStartTime = 0u;
+static uint64_t pdmaFallbackCount = 0u;
+
+static struct {
+    uint64_t bytes;
+    HSSTicks_t time;
+} pdmaScrubStats = { 0u, 0u };
+
+static bool scrub_pdma_is_busy_(void)
+{
+    bool result = false;
+
+    if (pdmaInFlight) {
+        if (MSS_PDMA_get_transfer_error_status(SCRUB_PDMA_CHANNEL)) {
+            MSS_PDMA_clear_transfer_error_status(SCRUB_PDMA_CHANNEL);
+            mHSS_DEBUG_PRINTF(LOG_ERROR, "PDMA channel %d scrub error, falling back to CPU\n",
+                CONFIG_SERVICE_SCRUB_PDMA_CHANNEL);
+            pdmaDisabled = true;
+            pdmaInFlight = false;
+        } else if (MSS_PDMA_get_transfer_complete_status(SCRUB_PDMA_CHANNEL)) {
+            MSS_PDMA_clear_transfer_complete_status(SCRUB_PDMA_CHANNEL);
+            pdmaScrubStats.bytes += pdmaInFlightBytes;
+            pdmaScrubStats.time += HSS_GetTime() - pdmaStartTime;
+            pdmaInFlight = false;
+        } else {
+            result = true;
+        }
+    }
+
+    return result;
+}
+
+static bool scrub_pdma_start_(uintptr_t const chunkStartAddr, size_t const chunkSize)
+{
+    bool result = false;
+
+    // the PDMA needs 16-byte aligned sources and 16-byte multiples
+    if (!pdmaDisabled && !(chunkStartAddr & 0xFu) && !(chunkSize & 0xFu)) {
+        mss_pdma_channel_config_t pdma_config = {
+            .src_addr = (size_t)chunkStartAddr,
+            .dest_addr = (size_t)pdmaSink,
+            .num_bytes = chunkSize,
+            .enable_done_int = 0,
+            .enable_err_int = 0,
+            .force_order = 0,
+            .repeat = 0u };
+
+        if ((MSS_PDMA_setup_transfer(SCRUB_PDMA_CHANNEL, &pdma_config) == MSS_PDMA_OK)
+            && (MSS_PDMA_start_transfer(SCRUB_PDMA_CHANNEL) == MSS_PDMA_OK)) {
+            pdmaInFlight = true;
+            pdmaInFlightBytes = chunkSize;
+            pdmaStartTime = HSS_GetTime();
+            result = true;
+        }
+    }
+
+    if (!result) {
+        pdmaFallbackCount++;
+    }
+
+    return result;
+}
+#endif
+
+#if IS_ENABLED(CONFIG_SERVICE_TELEMETRY)
+static void scrub_publish_telemetry_(void)
+{
+    struct HSS_Telemetry_Page * const pTelemetry = HSS_Telemetry_WriteBegin();
+
+    if (pTelemetry) {
+        pTelemetry->scrub.region = idx;
+        pTelemetry->scrub.offset = offset;
+        pTelemetry->scrub.regionPasses = regionPassCount;
+        pTelemetry->scrub.cpuBytes = cpuScrubStats.bytes;
+#  if IS_ENABLED(CONFIG_SERVICE_SCRUB_PDMA)
+        pTelemetry->scrub.pdmaBytes = pdmaScrubStats.bytes;
+#  endif
+        HSS_Telemetry_WriteEnd(pTelemetry);
+    }
+}
+#endif
+
 static void scrub_scrubbing_handler(struct StateMachine * const pMyMachine)
 {
 #if IS_ENABLED(CONFIG_SERVICE_SCRUB_L2LIM) || IS_ENABLED(CONFIG_SERVICE_SCRUB_L2SCRATCH) || IS_ENABLED(CONFIG_SERVICE_SCRUB_DTIM) || IS_ENABLED(CONFIG_SERVICE_SCRUB_CACHED_DDR) || IS_ENABLED(CONFIG_SERVICE_SCRUB_NONCACHED_DDR)
 
     (void)pMyMachine;
 
+    bool scrubNow = !entryCount;
+
+#  if IS_ENABLED(CONFIG_SERVICE_SCRUB_PDMA)
+    if (scrubNow && scrub_pdma_is_busy_()) {
+        scrubNow = false; // previous burst still in flight
+    }
+#  endif
+
+#  if IS_ENABLED(CONFIG_SERVICE_SCRUB_ADAPTIVE)
+    HSSTicks_t const scrubStartTime = HSS_GetTime();
+
+    if (scrubNow) {
+        scrub_sample_ecc_counters_(scrubStartTime);
+        scrubNow = !scrub_is_over_duty_cycle_(scrubStartTime);
+    }
+#  endif
+
     if (ARRAY_SIZE(rams)) {
-        if (!entryCount) {
+        if (scrubNow) {
             if ((rams[idx].baseAddr + offset)  >= rams[idx].endAddr) {
+#  if IS_ENABLED(CONFIG_SERVICE_SCRUB_ADAPTIVE)
+                scrub_region_complete_(idx, scrubStartTime);
+#  endif
                 idx = (idx + 1u) % ARRAY_SIZE(rams);
+                regionPassCount++;
                 // mHSS_DEBUG_PRINTF(LOG_NORMAL, "Scrubbing %p to %p\n", rams[idx].baseAddr, rams[idx].endAddr);
                 offset = 0u;
             }
 
             const uintptr_t length = rams[idx].endAddr - rams[idx].baseAddr;
 
+#  if IS_ENABLED(CONFIG_SERVICE_SCRUB_ADAPTIVE)
+            if (!offset) {
+                regionStats[idx].passStartTime = scrubStartTime;
+            }
+#  endif
+
             if (length) {
-                const size_t chunkSize = MIN(CONFIG_SERVICE_SCRUB_MAX_SIZE_PER_LOOP_ITER, length-offset);
+                size_t chunkSize = MIN(scrub_chunk_size_(idx), length-offset);
 
                 const uintptr_t chunkStartAddr = (uintptr_t)(rams[idx].baseAddr) + offset;
-                const uintptr_t chunkEndAddr =   (uintptr_t)(chunkStartAddr) + chunkSize;
-
-                for (uint64_t *pMem = (uint64_t*)chunkStartAddr; pMem < (uint64_t*)chunkEndAddr; pMem++) {
-                    if (unlikely(rams[idx].use_atomic_or)) {
-                        __atomic_or_fetch((volatile uint64_t *)pMem, (uint64_t)0u, __ATOMIC_RELAXED);
-                    } else {
-                        *(volatile uint64_t *)pMem;
-                    }
+                bool done = false;
+
+#  if IS_ENABLED(CONFIG_SERVICE_SCRUB_PDMA)
+                // regions needing an atomic write-back stay on the CPU, as an in-place
+                // DMA copy could lose a concurrent update
+                if (!rams[idx].use_atomic_or) {
+                    chunkSize = MIN(chunkSize, sizeof(pdmaSink));
+                    done = scrub_pdma_start_(chunkStartAddr, chunkSize);
+                }
+#  endif
+
+                if (!done) {
+                    scrub_cpu_(chunkStartAddr, chunkSize, rams[idx].use_atomic_or);
                 }
                 offset = offset + chunkSize;
             }
         }
     }
 
+#  if IS_ENABLED(CONFIG_SERVICE_SCRUB_ADAPTIVE)
+    if (scrubNow) {
+        dutyCycleBusyTime += HSS_GetTime() - scrubStartTime;
+    }
+#  endif
+
+#  if IS_ENABLED(CONFIG_SERVICE_TELEMETRY)
+    if (scrubNow) {
+        scrub_publish_telemetry_();
+    }
+#  endif
+
 #  if IS_ENABLED(CONFIG_SERVICE_SCRUB_CACHES)
     static size_t trigger_cache_flush = 0u;
     static enum HSSHartId last_peer = HSS_HART_U54_1;
@@ -204,7 +540,7 @@ static void scrub_scrubbing_handler(struct StateMachine * const pMyMachine)
     }
 #  endif
 
-#  if defined(CONFIG_SERVICE_SCRUB_RUN_EVERY_X_SUPERLOOPS)
+#  if defined(CONFIG_SERVICE_SCRUB_RUN_EVERY_X_SUPERLOOPS) && !IS_ENABLED(CONFIG_SCHED_READY_MASK)
     entryCount = (entryCount + 1u) % CONFIG_SERVICE_SCRUB_RUN_EVERY_X_SUPERLOOPS;
 #  else
     entryCount = 0u;
@@ -237,4 +573,94 @@ void scrub_dump_stats(void)
     mHSS_DEBUG_PRINTF(LOG_NORMAL, "mem base:   0x%" PRIx64 "\n", rams[idx].baseAddr);
     mHSS_DEBUG_PRINTF(LOG_NORMAL, "offset:     0x%" PRIx64 "\n", offset);
     mHSS_DEBUG_PRINTF(LOG_NORMAL, "entryCount: 0x%" PRIx64 "\n", entryCount);
+    mHSS_DEBUG_PRINTF(LOG_NORMAL, "passes:     %" PRIu64 "\n", regionPassCount);
+
+    mHSS_DEBUG_PRINTF(LOG_NORMAL, "cpu scrub:  %" PRIu64 " bytes in %" PRIu64 " ms (%" PRIu64 " bytes/s)\n",
+        cpuScrubStats.bytes, cpuScrubStats.time / TICKS_PER_MILLISEC,
+        cpuScrubStats.time ? ((cpuScrubStats.bytes * TICKS_PER_SEC) / cpuScrubStats.time) : 0u);
+#if IS_ENABLED(CONFIG_SERVICE_SCRUB_PDMA)
+    mHSS_DEBUG_PRINTF(LOG_NORMAL, "pdma scrub: %" PRIu64 " bytes in %" PRIu64 " ms (%" PRIu64 " bytes/s),"
+        " %" PRIu64 " fallbacks to cpu%s\n",
+        pdmaScrubStats.bytes, pdmaScrubStats.time / TICKS_PER_MILLISEC,
+        pdmaScrubStats.time ? ((pdmaScrubStats.bytes * TICKS_PER_SEC) / pdmaScrubStats.time) : 0u,
+        pdmaFallbackCount, pdmaDisabled ? " (disabled after error)" : "");
+    mHSS_DEBUG_PRINTF(LOG_NORMAL, "(pdma time includes the wait for the next dispatch to reap each burst)\n");
+#endif
+
+#if IS_ENABLED(CONFIG_SERVICE_SCRUB_ADAPTIVE)
+    HSSTicks_t const now = HSS_GetTime();
+
+    mHSS_DEBUG_PRINTF(LOG_NORMAL, "unattributed errors: %" PRIu64 ", duty cycle throttles: %" PRIu64
+        " (cap %u percent)\n", unattributedErrorCount, dutyCycleThrottleCount,
+        CONFIG_SERVICE_SCRUB_ADAPTIVE_DUTY_CYCLE_PCT);
+    mHSS_DEBUG_PRINTF(LOG_NORMAL, "            Region             : Level : Chunk : Errors : Passes : Last Pass (ms) : Since (ms)\n");
+
+    for (size_t i = 0u; i < ARRAY_SIZE(rams); i++) {
+        mHSS_DEBUG_PRINTF(LOG_NORMAL, "%012" PRIx64 "-%012" PRIx64 " : % 5d : % 5lu : % 6" PRIu64 " : % 6" PRIu64
+            " : % 14" PRIu64 " : ",
+            (uint64_t)rams[i].baseAddr, (uint64_t)rams[i].endAddr, regionStats[i].level,
+            scrub_chunk_size_(i), regionStats[i].errorCount, regionStats[i].passCount,
+            regionStats[i].lastPassDuration / TICKS_PER_MILLISEC);
+
+        if (regionStats[i].passCount) {
+            mHSS_DEBUG_PRINTF_EX("%" PRIu64 "\n", (now - regionStats[i].lastPassCompleteTime) / TICKS_PER_MILLISEC);
+        } else {
+            mHSS_DEBUG_PRINTF_EX("-\n");
+        }
+    }
+#endif
+}
+
+#define SCRUB_BENCHMARK_SIZE (256u * 1024u)
+
+void scrub_benchmark(void)
+{
+    size_t i;
+
+    for (i = 0u; i < ARRAY_SIZE(rams); i++) {
+        if (!rams[i].use_atomic_or && (rams[i].endAddr > rams[i].baseAddr)) {
+            break;
+        }
+    }
+
+    if (i >= ARRAY_SIZE(rams)) {
+        mHSS_DEBUG_PRINTF(LOG_ERROR, "No read-only scrub region to benchmark\n");
+        return;
+    }
+
+    size_t const length = MIN(rams[i].endAddr - rams[i].baseAddr, (uintptr_t)SCRUB_BENCHMARK_SIZE) & ~0xFu;
+    HSSTicks_t startTime = HSS_GetTime();
+    HSSTicks_t cpuTime, pdmaTime = 0u;
+
+    for (volatile uint64_t *pMem = (uint64_t *)rams[i].baseAddr;
+        pMem < (uint64_t *)(rams[i].baseAddr + length); pMem++) {
+        (void)*pMem;
+    }
+    cpuTime = HSS_GetTime() - startTime;
+
+    mHSS_DEBUG_PRINTF(LOG_NORMAL, "cpu:  %lu bytes in %" PRIu64 " ticks (%" PRIu64 " bytes/s)\n",
+        length, cpuTime, cpuTime ? ((length * TICKS_PER_SEC) / cpuTime) : 0u);
+
+#if IS_ENABLED(CONFIG_SERVICE_SCRUB_PDMA)
+    while (scrub_pdma_is_busy_()) { ; }
+
+    size_t done = 0u;
+    startTime = HSS_GetTime();
+
+    while (!pdmaDisabled && (done < length)) {
+        size_t const chunkSize = MIN(length - done, sizeof(pdmaSink));
+
+        if (!scrub_pdma_start_(rams[i].baseAddr + done, chunkSize)) {
+            break;
+        }
+        while (scrub_pdma_is_busy_()) { ; }
+        done += chunkSize;
+    }
+    pdmaTime = HSS_GetTime() - startTime;
+
+    mHSS_DEBUG_PRINTF(LOG_NORMAL, "pdma: %lu bytes in %" PRIu64 " ticks (%" PRIu64 " bytes/s)\n",
+        done, pdmaTime, pdmaTime ? ((done * TICKS_PER_SEC) / pdmaTime) : 0u);
+#else
+    (void)pdmaTime;
+#endif
 }
@@ -48,6 +48,8 @@ extern "C" {
 extern struct StateMachine scrub_service;
 
 void scrub_dump_stats(void);
+void scrub_benchmark(void);
+void HSS_Scrub_ReportCorrectableError(uintptr_t addr);
 
 
 enum IPIStatusCode Scrub_IPIHandler(TxId_t transaction_id, enum HSSHartId source,
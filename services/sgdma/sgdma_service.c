@@ -63,7 +63,8 @@ struct StateMachine sgdma_service = {
     .pStateDescs       = sgdma_state_descs,
     .debugFlag         = false,
     .priority          = 0u,
-    .pInstanceData     = NULL
+    .pInstanceData     = NULL,
+    .wake              = { .sources = SM_WAKE_IPI, .sleepState = SGDMA_IDLE, .ipiTypes = SM_WAKE_IPI_TYPE(IPI_MSG_SCATTERGATHER_DMA) },
 };
 
 
@@ -59,7 +59,8 @@ struct StateMachine spi_service = {
     .pStateDescs       = spi_state_descs,
     .debugFlag         = false,
     .priority          = 0u,
-    .pInstanceData     = NULL
+    .pInstanceData     = NULL,
+    .wake              = { .sources = SM_WAKE_TRANSITION, .sleepState = SPI_INITIALIZATION },
 };
 
 // --------------------------------------------------------------------------------------------------
@@ -72,7 +72,8 @@ struct StateMachine startup_service = {
     .pStateDescs       = startup_state_descs,
     .debugFlag         = true,
     .priority          = 0u,
-    .pInstanceData     = NULL
+    .pInstanceData     = NULL,
+    .wake              = { .sources = SM_WAKE_TRANSITION, .sleepState = STARTUP_IDLE },
 };
 
 
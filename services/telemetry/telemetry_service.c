@@ -0,0 +1,178 @@
+/*******************************************************************************
+ * Copyright 2019-2025 Microchip FPGA Embedded Systems Solutions.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * MPFS HSS Embedded Software
+ *
+ */
+
+/*!
+ * \file Telemetry State Machine
+ * \brief Shared-memory telemetry page
+ */
+
+#include "config.h"
+#include "hss_types.h"
+#include "hss_state_machine.h"
+#include "hss_debug.h"
+#include "hss_clock.h"
+#include "hss_trigger.h"
+
+#include "ssmb_ipi.h"
+#include <assert.h>
+#include <string.h>
+
+#include "telemetry_service.h"
+
+_Static_assert(sizeof(struct HSS_Telemetry_Page) <= 4096u, "Telemetry page exceeds 4KiB");
+_Static_assert(EVENT_NUM_EVENTS <= HSS_TELEMETRY_MAX_EVENTS, "Too many events for telemetry page");
+_Static_assert(HSS_HART_NUM_PEERS <= HSS_TELEMETRY_MAX_HARTS, "Too many harts for telemetry page");
+_Static_assert(!(CONFIG_SERVICE_TELEMETRY_BASE_ADDR & 0xFFFu), "Telemetry page must be 4KiB aligned");
+
+static void telemetry_init_handler(struct StateMachine * const pMyMachine);
+static void telemetry_publishing_handler(struct StateMachine * const pMyMachine);
+
+/*!
+ * \brief Telemetry Driver States
+ */
+enum TelemetryStatesEnum {
+    TELEMETRY_INITIALIZATION,
+    TELEMETRY_PUBLISHING,
+    TELEMETRY_NUM_STATES = TELEMETRY_PUBLISHING+1
+};
+
+/*!
+ * \brief Telemetry Driver State Descriptors
+ */
+static const struct StateDesc telemetry_state_descs[] = {
+    { (const stateType_t)TELEMETRY_INITIALIZATION, (const char *)"init",       NULL, NULL, &telemetry_init_handler },
+    { (const stateType_t)TELEMETRY_PUBLISHING,     (const char *)"publishing", NULL, NULL, &telemetry_publishing_handler },
+};
+
+#define TELEMETRY_WAKE_PERIOD ((HSSTicks_t)CONFIG_SERVICE_TELEMETRY_REFRESH_MS * ONE_MILLISEC)
+
+/*!
+ * \brief Telemetry Driver State Machine
+ */
+struct StateMachine telemetry_service = {
+    .state             = (stateType_t)TELEMETRY_INITIALIZATION,
+    .prevState         = (stateType_t)SM_INVALID_STATE,
+    .numStates         = (const uint32_t)TELEMETRY_NUM_STATES,
+    .pMachineName      = (const char *)"telemetry_service",
+    .startTime         = 0u,
+    .lastExecutionTime = 0u,
+    .executionCount    = 0u,
+    .pStateDescs       = telemetry_state_descs,
+    .debugFlag         = false,
+    .priority          = SM_PRIORITY_LOW(16u),
+    .pInstanceData     = NULL,
+    .wake              = { .sources = SM_WAKE_TIMER, .sleepState = TELEMETRY_PUBLISHING, .period = TELEMETRY_WAKE_PERIOD },
+};
+
+static struct HSS_Telemetry_Page * const pTelemetryPage =
+    (struct HSS_Telemetry_Page *)CONFIG_SERVICE_TELEMETRY_BASE_ADDR;
+static bool pageInitialized = false;
+static size_t writeDepth = 0u;
+
+static bool telemetry_page_init_(void)
+{
+    // the page lives in DDR, so nothing can be published until training is complete
+    if (!pageInitialized && HSS_Trigger_IsNotified(EVENT_DDR_TRAINED)) {
+        memset(pTelemetryPage, 0, sizeof(*pTelemetryPage));
+
+        pTelemetryPage->version = HSS_TELEMETRY_VERSION;
+        pTelemetryPage->size = sizeof(*pTelemetryPage);
+        pTelemetryPage->ticksPerSec = TICKS_PER_SEC;
+
+        // readers check the magic last
+        __atomic_thread_fence(__ATOMIC_RELEASE);
+        pTelemetryPage->magic = HSS_TELEMETRY_MAGIC;
+
+        pageInitialized = true;
+        mHSS_DEBUG_PRINTF(LOG_NORMAL, "Telemetry page at %p\n", pTelemetryPage);
+    }
+
+    return pageInitialized;
+}
+
+/*!
+ * \brief Begin an update of the telemetry page
+ *
+ * Returns NULL if the page is not yet available. Otherwise, the caller must
+ * pass the returned pointer to HSS_Telemetry_WriteEnd() once done.
+ */
+struct HSS_Telemetry_Page *HSS_Telemetry_WriteBegin(void)
+{
+    struct HSS_Telemetry_Page *pResult = NULL;
+
+    if (telemetry_page_init_()) {
+        if (!writeDepth) {
+            __atomic_store_n(&pTelemetryPage->sequence, pTelemetryPage->sequence + 1u, __ATOMIC_RELAXED);
+            __atomic_thread_fence(__ATOMIC_RELEASE);
+        }
+        writeDepth++;
+        pResult = pTelemetryPage;
+    }
+
+    return pResult;
+}
+
+void HSS_Telemetry_WriteEnd(struct HSS_Telemetry_Page *pPage)
+{
+    if (pPage) {
+        assert(writeDepth);
+        writeDepth--;
+
+        if (!writeDepth) {
+            pPage->lastUpdateTime = HSS_GetTime();
+            __atomic_thread_fence(__ATOMIC_RELEASE);
+            __atomic_store_n(&pPage->sequence, pPage->sequence + 1u, __ATOMIC_RELAXED);
+        }
+    }
+}
+
+uintptr_t HSS_Telemetry_GetAddress(void)
+{
+    return pageInitialized ? (uintptr_t)pTelemetryPage : 0u;
+}
+
+// --------------------------------------------------------------------------------------------------
+// Handlers for each state in the state machine
+//
+static void telemetry_init_handler(struct StateMachine * const pMyMachine)
+{
+    if (telemetry_page_init_()) {
+        pMyMachine->state = TELEMETRY_PUBLISHING;
+    }
+}
+
+/////////////////
+static void telemetry_publishing_handler(struct StateMachine * const pMyMachine)
+{
+    (void)pMyMachine;
+
+    // IPI counters are updated on every hart and boot events from anywhere, so
+    // these are copied in periodically rather than published by their owners
+    struct HSS_Telemetry_Page * const pPage = HSS_Telemetry_WriteBegin();
+
+    if (pPage) {
+        pPage->boot.events = HSS_Trigger_GetEvents();
+        for (enum HSS_Event event = 0u; event < EVENT_NUM_EVENTS; event++) {
+            pPage->boot.firstNotifyTime[event] = HSS_Trigger_GetFirstNotifyTime(event);
+        }
+
+        for (enum HSSHartId hartId = HSS_HART_E51; hartId < HSS_HART_NUM_PEERS; hartId++) {
+            struct IPI_Stats stats;
+
+            IPI_GetStats(hartId, &stats);
+            pPage->ipi[hartId].messageAllocs = stats.message_allocs;
+            pPage->ipi[hartId].messageDelivers = stats.message_delivers;
+            pPage->ipi[hartId].messageFrees = stats.message_frees;
+            pPage->ipi[hartId].consumeIntents = stats.consume_intents;
+            pPage->ipi[hartId].ipiSends = stats.ipi_sends;
+        }
+
+        HSS_Telemetry_WriteEnd(pPage);
+    }
+}
@@ -0,0 +1,127 @@
+#ifndef HSS_TELEMETRY_SERVICE_H
+#define HSS_TELEMETRY_SERVICE_H
+
+/*******************************************************************************
+ * Copyright 2019-2025 Microchip FPGA Embedded Systems Solutions.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ *
+ *
+ * Hart Software Services - Telemetry Service API
+ *
+ */
+
+
+/*!
+ * \file Telemetry API
+ * \brief Telemetry State Machine API function declarations and shared page layout
+ *
+ * The telemetry page is a fixed-layout structure in a reserved region of DDR,
+ * which software on the U54s can map and read. Its address is returned by the
+ * SBI_EXT_HSS_TELEMETRY vendor ecall.
+ *
+ * All fields are little-endian. The layout is only ever extended at the end,
+ * and incompatible changes bump HSS_TELEMETRY_VERSION.
+ *
+ * The E51 is the only writer. It increments \a sequence before and after each
+ * update, so readers should copy the page and retry if \a sequence was odd, or
+ * changed while copying.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "hss_state_machine.h"
+#include "hss_debug.h"
+
+#define HSS_TELEMETRY_MAGIC            0x4D454C4554535348llu // "HSSTELEM"
+#define HSS_TELEMETRY_VERSION          1u
+
+#define HSS_TELEMETRY_MAX_EVENTS       16u
+#define HSS_TELEMETRY_MAX_BEU_CAUSES   8u
+#define HSS_TELEMETRY_MAX_HARTS        5u
+#define HSS_TELEMETRY_MAX_MONITORS     32u
+#define HSS_TELEMETRY_MONITOR_NAME_LEN 24u
+
+struct HSS_Telemetry_Page
+{
+    uint64_t magic;
+    uint16_t version;
+    uint16_t reserved0;
+    uint32_t size;
+    uint32_t sequence;
+    uint32_t reserved1;
+    uint64_t ticksPerSec;
+    uint64_t lastUpdateTime;
+
+    struct {
+        uint64_t events;
+        uint64_t firstNotifyTime[HSS_TELEMETRY_MAX_EVENTS]; // 0 => not yet notified
+    } boot;
+
+    struct {
+        uint64_t causeCount[HSS_TELEMETRY_MAX_BEU_CAUSES];
+        uint64_t hartEventCount[HSS_TELEMETRY_MAX_HARTS];
+    } beu;
+
+    struct {
+        uint64_t messageAllocs;
+        uint64_t messageDelivers;
+        uint64_t messageFrees;
+        uint64_t consumeIntents;
+        uint64_t ipiSends;
+    } ipi[HSS_TELEMETRY_MAX_HARTS];
+
+    struct {
+        uint64_t region;
+        uint64_t offset;
+        uint64_t regionPasses;
+        uint64_t cpuBytes;
+        uint64_t pdmaBytes;
+    } scrub;
+
+    struct {
+        uint32_t count;
+        uint32_t reserved;
+        struct {
+            char name[HSS_TELEMETRY_MONITOR_NAME_LEN];
+            uint32_t last;
+            uint32_t min;
+            uint32_t max;
+            uint32_t reserved;
+            uint64_t fires;
+            uint64_t samples;
+        } monitors[HSS_TELEMETRY_MAX_MONITORS];
+    } healthmon;
+};
+
+extern struct StateMachine telemetry_service;
+
+struct HSS_Telemetry_Page *HSS_Telemetry_WriteBegin(void);
+void HSS_Telemetry_WriteEnd(struct HSS_Telemetry_Page *pPage);
+uintptr_t HSS_Telemetry_GetAddress(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -38,7 +38,11 @@
 #include "reboot_service.h"
 #include "wdog_service.h"
 #include "hss_perfctr.h"
+#include "hss_timeline.h"
 #include "profiling.h"
+#if IS_ENABLED(CONFIG_DEBUG_SAMPLER)
+#  include "hss_sampler.h"
+#endif
 #include "hss_trigger.h"
 #include "u54_state.h"
 
@@ -138,6 +142,10 @@ static void tinyCLI_CRC32_(void);
 static void tinyCLI_HexDump_(void);
 #if IS_ENABLED(CONFIG_MEMTEST)
 static void tinyCLI_MemTest_(void);
+static void tinyCLI_MemTestMarchC_(void);
+static void tinyCLI_MemTestMarchSS_(void);
+static void tinyCLI_MemTestWalk_(void);
+static void tinyCLI_MemTestPatterns_(void);
 #endif
 static void tinyCLI_UnsupportedBootMechanism_(char const * const pName);
 #if IS_ENABLED(CONFIG_SERVICE_YMODEM)
@@ -148,6 +156,7 @@ static void tinyCLI_Scrub_(void);
 #endif
 static void output_duration_(char const * const description, const uint32_t val, bool continuation);
 static void tinyCLI_DumpStateMachines_(void);
+static void tinyCLI_ResetStateMachines_(void);
 static void tinyCLI_IPIDumpStats_(void);
 static void tinyCLI_EMMC_(void);
 static void tinyCLI_MMC_(void);
@@ -170,6 +179,11 @@ static void tinyCLI_PerfCtrs_(void);
 #if IS_ENABLED(CONFIG_DEBUG_PROFILING_SUPPORT)
 static void tinyCLI_ProfileCtrs_(void);
 #endif
+#if IS_ENABLED(CONFIG_DEBUG_SAMPLER)
+static void tinyCLI_Sample_(void);
+static void tinyCLI_SampleStart_(void);
+static void tinyCLI_SampleStop_(void);
+#endif
 static void tinyCLI_OpenSBI_(void);
 static void tinyCLI_Seg_(void);
 static void tinyCLI_L2Cache_(void);
@@ -208,6 +222,10 @@ enum CmdId {
     CMD_DBG_L2CACHE,
     CMD_DBG_PERFCTR,
     CMD_DBG_WDOG,
+    CMD_DBG_TRIGGERS,
+    CMD_DBG_SAMPLE,
+    CMD_DBG_TIMELINE,
+    CMD_DBG_CRYPTO,
 
     CMD_DBG_MONITOR_CREATE,
     CMD_DBG_MONITOR_DESTROY,
@@ -215,6 +233,18 @@ enum CmdId {
     CMD_DBG_MONITOR_DISABLE,
     CMD_DBG_MONITOR_LIST,
 
+    CMD_DBG_SM_RESET,
+    CMD_SCRUB_BENCH,
+
+    CMD_MEMTEST_MARCHC,
+    CMD_MEMTEST_MARCHSS,
+    CMD_MEMTEST_WALK,
+    CMD_MEMTEST_PATTERNS,
+
+    CMD_DBG_SAMPLE_START,
+    CMD_DBG_SAMPLE_STOP,
+    CMD_DBG_SAMPLE_DUMP,
+
     CMD_BOOT_INFO,
     CMD_BOOT_LIST,
     CMD_BOOT_SELECT,
@@ -233,6 +263,33 @@ static const struct tinycli_cmd monitorCmds[] = {
 };
 #endif
 
+static const struct tinycli_cmd smCmds[] = {
+    { CMD_DBG_SM_RESET, "RESET", "reset state machine statistics", tinyCLI_ResetStateMachines_ },
+};
+
+#if IS_ENABLED(CONFIG_SERVICE_SCRUB)
+static const struct tinycli_cmd scrubCmds[] = {
+    { CMD_SCRUB_BENCH, "BENCH", "measure cpu and pdma scrub throughput", scrub_benchmark },
+};
+#endif
+
+#if IS_ENABLED(CONFIG_MEMTEST)
+static const struct tinycli_cmd memtestCmds[] = {
+    { CMD_MEMTEST_MARCHC,   "MARCHC",   "[<pattern>|ALL] [0x<start_addr> <count>] March C- test", tinyCLI_MemTestMarchC_ },
+    { CMD_MEMTEST_MARCHSS,  "MARCHSS",  "[<pattern>|ALL] [0x<start_addr> <count>] March SS test", tinyCLI_MemTestMarchSS_ },
+    { CMD_MEMTEST_WALK,     "WALK",     "[0x<start_addr> <count>] walking ones burst test", tinyCLI_MemTestWalk_ },
+    { CMD_MEMTEST_PATTERNS, "PATTERNS", "list March test data backgrounds", tinyCLI_MemTestPatterns_ },
+};
+#endif
+
+#if IS_ENABLED(CONFIG_DEBUG_SAMPLER)
+static const struct tinycli_cmd sampleCmds[] = {
+    { CMD_DBG_SAMPLE_START, "START", "[0x<hart_mask>] start sampling (default E51 only)", tinyCLI_SampleStart_ },
+    { CMD_DBG_SAMPLE_STOP,  "STOP",  "stop sampling", tinyCLI_SampleStop_ },
+    { CMD_DBG_SAMPLE_DUMP,  "DUMP",  "dump raw samples", HSS_Sampler_DumpAll },
+};
+#endif
+
 static const struct tinycli_cmd debugCmds[] = {
 #if IS_ENABLED(CONFIG_SERVICE_BEU)
     { CMD_DBG_BEU,      "BEU",     "debug Bus Error Unit monitor", tinyCLI_BEU_ },
@@ -240,8 +297,15 @@ static const struct tinycli_cmd debugCmds[] = {
 #if IS_ENABLED(CONFIG_SERVICE_HEALTHMON)
     { CMD_DBG_HEALTHMON, "HEALTHMON", "debug health monitor", tinyCLI_HEALTHMON_ },
 #endif
-    { CMD_DBG_SM,       "SM",      "debug state machines", tinyCLI_DumpStateMachines_ },
+    { CMD_DBG_SM,       "SM",      "debug state machines [RESET]", tinyCLI_DumpStateMachines_ },
     { CMD_DBG_IPI,      "IPI",     "debug HSS IPI Queues", tinyCLI_IPIDumpStats_ },
+    { CMD_DBG_TRIGGERS, "TRIGGERS", "display trigger events and timeline", HSS_Trigger_DumpTimeline },
+#if IS_ENABLED(CONFIG_DEBUG_BOOT_TIMELINE)
+    { CMD_DBG_TIMELINE, "TIMELINE", "dump boot phase timeline", HSS_Timeline_Dump },
+#endif
+#if IS_ENABLED(CONFIG_CRYPTO_SIGNING)
+    { CMD_DBG_CRYPTO,   "CRYPTO",  "time image digest and signature verify stages", HSS_Boot_Secure_Benchmark },
+#endif
     { CMD_DBG_CRC32,    "CRC32",   "calculate CRC32 over memory region", tinyCLI_CRC32_ },
     { CMD_DBG_HEXDUMP,  "HEXDUMP", "display memory as hex dump", tinyCLI_HexDump_ },
 #if IS_ENABLED(CONFIG_SERVICE_TINYCLI_MONITOR)
@@ -256,6 +320,9 @@ static const struct tinycli_cmd debugCmds[] = {
 #if IS_ENABLED(CONFIG_DEBUG_PROFILING_SUPPORT)
     { CMD_DBG_PERFCTR , "PROFILE", "display profiling counters", tinyCLI_ProfileCtrs_ },
 #endif
+#if IS_ENABLED(CONFIG_DEBUG_SAMPLER)
+    { CMD_DBG_SAMPLE,   "SAMPLE",  "sampling profiler [START|STOP|DUMP]", tinyCLI_Sample_ },
+#endif
 #if IS_ENABLED(CONFIG_SERVICE_WDOG)
     { CMD_DBG_WDOG ,    "WDOG",    "display watchdog statistics", HSS_Wdog_DumpStats },
 #endif
@@ -291,7 +358,7 @@ static const struct tinycli_cmd toplevelCmds[] = {
     { CMD_UPTIME,  "UPTIME",  "Display uptime information.", tinyCLI_PrintUptime_ },
     { CMD_DEBUG,   "DEBUG",   "Display debug information.", tinyCLI_Debug_ },
 #if IS_ENABLED(CONFIG_MEMTEST)
-    { CMD_MEMTEST, "MEMTEST", "Full DDR memory test.", tinyCLI_MemTest_ },
+    { CMD_MEMTEST, "MEMTEST", "Full DDR memory test [MARCHC|MARCHSS|WALK|PATTERNS].", tinyCLI_MemTest_ },
 #endif
     { CMD_QSPI,    "QSPI",    "Select boot via QSPI.", tinyCLI_QSPI_ },
     { CMD_EMMC,    "EMMC",    "Select boot via eMMC.", tinyCLI_EMMC_ },
@@ -303,7 +370,7 @@ static const struct tinycli_cmd toplevelCmds[] = {
     { CMD_USBDMSC, "USBDMSC", "Export eMMC as USBD Mass Storage Class.", tinyCLI_USBDMSC_ },
 #endif
 #if IS_ENABLED(CONFIG_SERVICE_SCRUB)
-    { CMD_SCRUB,   "SCRUB",   "Dump Scrub service stats.", tinyCLI_Scrub_ },
+    { CMD_SCRUB,   "SCRUB",   "Dump Scrub service stats [BENCH].", tinyCLI_Scrub_ },
 #endif
 #if IS_ENABLED(CONFIG_SERVICE_BEU)
     { CMD_ECC,     "ECC",   "Dump ECC stats.", tinyCLI_ECC_ },
@@ -431,11 +498,34 @@ static void tinyCLI_PrintVersion_(void)
 }
 
 #if IS_ENABLED(CONFIG_MEMTEST)
+static void tinyCLI_MemTestStatus_(bool status)
+{
+    if (!status) {
+        mHSS_FANCY_PRINTF(LOG_ERROR, "Failed!\n");
+    } else {
+        mHSS_FANCY_PRINTF(LOG_STATUS, "Passed!\n");
+    }
+}
+
+static bool tinyCLI_IsNumber_(char const * const pToken)
+{
+    return (pToken[0] >= '0') && (pToken[0] <= '9');
+}
+
 static void tinyCLI_MemTest_(void)
 {
     bool status = false;
 
+    if (dispatch_command_(memtestCmds, ARRAY_SIZE(memtestCmds), 1u)) {
+        return;
+    }
+
     if (argc_tokenCount > 1u) {
+        if (!tinyCLI_IsNumber_(argv_tokenArray[1])) {
+            display_help_(memtestCmds, ARRAY_SIZE(memtestCmds), 1u);
+            return;
+        }
+
         size_t count = 256u;
         const uintptr_t startAddr = tinyCLI_strtoul_wrapper_(argv_tokenArray[1]);
 
@@ -448,10 +538,71 @@ static void tinyCLI_MemTest_(void)
         status = HSS_MemTestDDRFull();
     }
 
-    if (!status) {
-        mHSS_FANCY_PRINTF(LOG_ERROR, "Failed!\n");
-    } else {
-        mHSS_FANCY_PRINTF(LOG_STATUS, "Passed!\n");
+    tinyCLI_MemTestStatus_(status);
+}
+
+static void tinyCLI_MemTestAlgorithm_(enum HSS_MemTest_Algorithm algorithm)
+{
+    size_t argIndex = 2u;
+    uint32_t patternMask = 1u;
+    uintptr_t startAddr = HSS_DDR_GetStart();
+    size_t count = HSS_DDR_GetSize();
+
+    if ((algorithm != MEMTEST_WALKING_ONES_BURST) && (argc_tokenCount > argIndex)
+            && !tinyCLI_IsNumber_(argv_tokenArray[argIndex])) {
+        if (strcasecmp(argv_tokenArray[argIndex], "ALL") == 0) {
+            patternMask = (1u << HSS_MemTest_NumPatterns) - 1u;
+        } else {
+            size_t i;
+
+            for (i = 0u; i < HSS_MemTest_NumPatterns; i++) {
+                if (strcasecmp(argv_tokenArray[argIndex], HSS_MemTest_Patterns[i].name) == 0) {
+                    patternMask = 1u << i;
+                    break;
+                }
+            }
+
+            if (i == HSS_MemTest_NumPatterns) {
+                mHSS_DEBUG_PRINTF(LOG_ERROR, "Unknown pattern >>%s<<\n", argv_tokenArray[argIndex]);
+                tinyCLI_MemTestPatterns_();
+                return;
+            }
+        }
+        argIndex++;
+    }
+
+    if (argc_tokenCount > argIndex) {
+        startAddr = tinyCLI_strtoul_wrapper_(argv_tokenArray[argIndex]);
+        count = 256u;
+
+        if (argc_tokenCount > (argIndex + 1u)) {
+            count = tinyCLI_strtoul_wrapper_(argv_tokenArray[argIndex + 1u]);
+        }
+    }
+
+    tinyCLI_MemTestStatus_(HSS_MemTestMarch(algorithm, patternMask, (uint64_t *)startAddr, count));
+}
+
+static void tinyCLI_MemTestMarchC_(void)
+{
+    tinyCLI_MemTestAlgorithm_(MEMTEST_MARCH_C_MINUS);
+}
+
+static void tinyCLI_MemTestMarchSS_(void)
+{
+    tinyCLI_MemTestAlgorithm_(MEMTEST_MARCH_SS);
+}
+
+static void tinyCLI_MemTestWalk_(void)
+{
+    tinyCLI_MemTestAlgorithm_(MEMTEST_WALKING_ONES_BURST);
+}
+
+static void tinyCLI_MemTestPatterns_(void)
+{
+    for (size_t i = 0u; i < HSS_MemTest_NumPatterns; i++) {
+        mHSS_DEBUG_PRINTF_EX(" %-8s 0x%016" PRIx64 "\n", HSS_MemTest_Patterns[i].name,
+            HSS_MemTest_Patterns[i].background);
     }
 }
 #endif
@@ -530,9 +681,43 @@ static void tinyCLI_ProfileCtrs_(void)
 }
 #endif
 
+#if IS_ENABLED(CONFIG_DEBUG_SAMPLER)
+static void tinyCLI_Sample_(void)
+{
+    if (!dispatch_command_(sampleCmds, ARRAY_SIZE(sampleCmds), 2u)) {
+        display_help_(sampleCmds, ARRAY_SIZE(sampleCmds), 2u);
+    }
+}
+
+static void tinyCLI_SampleStart_(void)
+{
+    uint32_t hartMask = 1u << HSS_HART_E51;
+
+    if (argc_tokenCount > 3u) {
+        hartMask = (uint32_t)tinyCLI_strtoul_wrapper_(argv_tokenArray[3]);
+    }
+
+    HSS_Sampler_Start(hartMask);
+}
+
+static void tinyCLI_SampleStop_(void)
+{
+    HSS_Sampler_Stop();
+    mHSS_FANCY_PRINTF(LOG_STATUS, "Sampling stopped\n");
+}
+#endif
+
 static void tinyCLI_DumpStateMachines_(void)
 {
-    DumpStateMachineStats();
+    if (!dispatch_command_(smCmds, ARRAY_SIZE(smCmds), 2u)) {
+        DumpStateMachineStats();
+    }
+}
+
+static void tinyCLI_ResetStateMachines_(void)
+{
+    ResetStateMachineStats();
+    mHSS_FANCY_PRINTF(LOG_STATUS, "State machine statistics reset\n");
 }
 
 static void tinyCLI_IPIDumpStats_(void)
@@ -890,7 +1075,9 @@ static void tinyCLI_YModem_(void)
 #if IS_ENABLED(CONFIG_SERVICE_SCRUB)
 static void tinyCLI_Scrub_(void)
 {
-    scrub_dump_stats();
+    if (!dispatch_command_(scrubCmds, ARRAY_SIZE(scrubCmds), 1u)) {
+        scrub_dump_stats();
+    }
 }
 #endif
 
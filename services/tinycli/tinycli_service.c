@@ -87,7 +87,9 @@ struct StateMachine tinycli_service = {
     .pStateDescs       = tinycli_state_descs,
     .debugFlag         = false,
     .priority          = 0u,
-    .pInstanceData     = NULL
+    .pInstanceData     = NULL,
+    .wake              = { .sources = SM_WAKE_POLL | SM_WAKE_TIMER, .sleepState = TINYCLI_READLINE,
+                           .period = ONE_SEC, .poll = uart_rx_ready },
 };
 
 // --------------------------------------------------------------------------------------------------
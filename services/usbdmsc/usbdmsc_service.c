@@ -76,7 +76,8 @@ struct StateMachine usbdmsc_service = {
     .pStateDescs       = usbdmsc_state_descs,
     .debugFlag         = true,
     .priority          = 0u,
-    .pInstanceData     = NULL
+    .pInstanceData     = NULL,
+    .wake              = { .sources = SM_WAKE_TRIGGER, .sleepState = USBDMSC_IDLE, .events = SM_WAKE_EVENT(EVENT_USBDMSC_REQUESTED) },
 };
 
 // --------------------------------------------------------------------------------------------------
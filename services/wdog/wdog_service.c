@@ -59,6 +59,9 @@ static const struct StateDesc wdog_state_descs[] = {
     { (const stateType_t)WDOG_MONITORING,     (const char *)"monitoring", NULL, NULL, &wdog_monitoring_handler }
 };
 
+// keep the E51 watchdog tickled, and U54 watchdog status checked, while the E51 idles
+#define WDOG_WAKE_PERIOD (10llu * ONE_MILLISEC)
+
 /*!
  * \brief WDOG Driver State Machine
  *
@@ -74,7 +77,8 @@ struct StateMachine wdog_service = {
     .pStateDescs       = wdog_state_descs,
     .debugFlag         = false,
     .priority          = 0u,
-    .pInstanceData     = NULL
+    .pInstanceData     = NULL,
+    .wake              = { .sources = SM_WAKE_TIMER, .sleepState = WDOG_MONITORING, .period = WDOG_WAKE_PERIOD },
 };
 
 // --------------------------------------------------------------------------------------------------
@@ -35,6 +35,7 @@
 #include "hss_debug.h"
 #include "ddr_service.h"
 
+#include <assert.h>
 #include <string.h>
 #include <sys/types.h>
 
@@ -64,6 +65,12 @@
 #  include "mss_mmc.h"
 #endif
 
+#if IS_ENABLED(CONFIG_SERVICE_BOOT_DELTA)
+#  include "hss_boot_delta.h"
+extern struct HSS_Storage *HSS_BootGetActiveStorage(void);
+extern size_t HSS_BootGetImageOffset(struct HSS_Storage *pStorage, size_t *pImageSpace);
+#endif
+
 
 //
 // Local prototypes
@@ -79,6 +86,10 @@ static bool hss_loader_mmc_init(void);
 static bool hss_loader_mmc_program(uint8_t *pBuffer, size_t wrAddr, size_t receivedCount);
 #endif
 
+#if IS_ENABLED(CONFIG_SERVICE_BOOT_DELTA)
+static bool hss_loader_delta_apply(uint8_t *pBuffer, size_t bufferSize);
+#endif
+
 #if IS_ENABLED(CONFIG_SERVICE_QSPI)
 static bool hss_loader_qspi_init(void)
 {
@@ -126,6 +137,51 @@ bool hss_loader_mmc_program(uint8_t *pBuffer, size_t wrAddr, size_t receivedCoun
 }
 #endif
 
+#if IS_ENABLED(CONFIG_SERVICE_BOOT_DELTA)
+//
+// The QSPI driver keeps its block maps and cache at the start of DDR, so the delta
+// image is received into, and the work buffers are placed in, the upper half
+//
+static bool hss_loader_delta_apply(uint8_t *pBuffer, size_t bufferSize)
+{
+    bool result = false;
+
+    uint8_t * const pDeltaBuffer = pBuffer + (bufferSize / 2u);
+    size_t const deltaBufferSize = bufferSize - (bufferSize / 2u);
+
+    mHSS_PUTS("\nAttempting to receive delta .bin file using YMODEM (CTRL-C to cancel)\n");
+    size_t const receivedCount = ymodem_receive(pDeltaBuffer, deltaBufferSize);
+
+    struct HSS_DeltaImage const * const pDelta = (struct HSS_DeltaImage const *)pDeltaBuffer;
+
+    if (!receivedCount) {
+        mHSS_PUTS("\nYMODEM failed to receive file successfully\n");
+    } else if ((receivedCount < sizeof(struct HSS_DeltaImage))
+        || !HSS_Boot_IsDeltaImage(pDelta) || (pDelta->deltaImageLength > receivedCount)) {
+        mHSS_PUTS("\nReceived file is not a delta image\n");
+    } else {
+        struct HSS_Storage * const pStorage = HSS_BootGetActiveStorage();
+        assert(pStorage);
+
+        mHSS_PRINTF("\nApplying delta (%lu bytes) to %s ...\n", pDelta->deltaImageLength,
+            pStorage->name);
+
+        result = (pStorage->init) ? pStorage->init() : true;
+
+        if (result) {
+            size_t imageSpace = 0u;
+            size_t const imageOffset = HSS_BootGetImageOffset(pStorage, &imageSpace);
+            size_t const workOffset = (pDelta->deltaImageLength + 63u) & ~(size_t)63u;
+            size_t const workSize = (workOffset < deltaBufferSize) ? (deltaBufferSize - workOffset) : 0u;
+
+            result = HSS_Boot_ApplyDelta(pStorage, imageOffset, imageSpace, pDelta, pDeltaBuffer + workOffset, workSize);
+        }
+    }
+
+    return result;
+}
+#endif
+
 void hss_loader_ymodem_loop(void);
 void hss_loader_ymodem_loop(void)
 {
@@ -137,7 +193,7 @@ void hss_loader_ymodem_loop(void)
     uint32_t g_rx_size = HSS_DDR_GetSize();
 
     while (!done) {
-#if IS_ENABLED(CONFIG_SERVICE_QSPI) || IS_ENABLED(CONFIG_SERVICE_MMC)
+#if IS_ENABLED(CONFIG_SERVICE_QSPI) || IS_ENABLED(CONFIG_SERVICE_MMC) || IS_ENABLED(CONFIG_SERVICE_BOOT_DELTA)
         bool result = false;
 #endif
         static const char menuText[] = "\n"
@@ -163,6 +219,9 @@ void hss_loader_ymodem_loop(void)
 #endif
 #if IS_ENABLED(CONFIG_SERVICE_MMC)
             " 5. MMC Write -- write application file to the Device\n"
+#endif
+#if IS_ENABLED(CONFIG_SERVICE_BOOT_DELTA)
+            " 7. Delta Update -- receive a delta file and apply it to the boot image\n"
 #endif
             " 6. Quit -- quit QSPI Utility\n\n"
             " Select a number:\n";
@@ -272,6 +331,28 @@ void hss_loader_ymodem_loop(void)
                 break;
 #endif
 
+#if IS_ENABLED(CONFIG_SERVICE_BOOT_DELTA)
+            case '7':
+                if (receivedCount) {
+                    // option 3 will have overwritten the start of DDR, including any
+                    // QSPI driver state, so don't risk flushing a corrupt cache
+                    mHSS_PUTS("\nDelta update is not possible after receiving a file, please"
+                        " reset first\n");
+                    break;
+                }
+
+                result = hss_loader_delta_apply(pBuffer, g_rx_size);
+
+                if (result) {
+                    mHSS_PUTS(" Success\n");
+                } else {
+                    HSS_Debug_Highlight(HSS_DEBUG_LOG_ERROR);
+                    mHSS_PUTS(" FAILED\n");
+                    HSS_Debug_Highlight(HSS_DEBUG_LOG_NORMAL);
+                }
+                break;
+#endif
+
             case '6':
                 done = true;
                 break;
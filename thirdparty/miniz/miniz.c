@@ -2252,12 +2252,18 @@ extern "C" {
     switch (r->m_state) \
     {                   \
         case 0:
+#if defined(__riscv)
+#define TINFL_CR_TRAP() asm("ebreak")
+#else
+/* host builds, e.g. tools/hss-payload-generator */
+#define TINFL_CR_TRAP() ((void)0)
+#endif
 #define TINFL_CR_RETURN(state_index, result) \
     do                                       \
     {                                        \
         status = result;                     \
 	if (status == TINFL_STATUS_FAILED)   \
-            asm("ebreak");                   \
+            TINFL_CR_TRAP();                 \
         r->m_state = state_index;            \
         goto common_exit;                    \
         case state_index:;                   \
@@ -282,7 +282,8 @@ static int print(char **out, u32 *out_len, const char *format, va_list args)
 						     width, flags, '0');
 				}
 				continue;
-			} else if (*format == 'l') {
+			} else if (*format == 'l' || *format == 'z') {
+				/* size_t is unsigned long on RV32 and RV64 alike */
 				if (*(format + 1) == 'u') {
 					format += 1;
 					pc += printi(
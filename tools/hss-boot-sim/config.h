@@ -0,0 +1,81 @@
+#ifndef HSS_BOOT_SIM_CONFIG_H
+#define HSS_BOOT_SIM_CONFIG_H
+
+/******************************************************************************************
+ *
+ * MPFS HSS Embedded Software - tools/hss-boot-sim
+ *
+ * Copyright 2019-2025 Microchip FPGA Embedded Systems Solutions.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/*
+ * Fixed configuration for the host boot simulator, in the form genconfig.py
+ * generates from .config. It is loosely based on the mpfs-icicle-kit-es
+ * def_config, trimmed to the services that are built into the simulator. All of the
+ * boot sources are enabled; which one is used is selected at run time (see -s).
+ *
+ * Scheduler and debug options can be added at build time, e.g.
+ *
+ *     make SIM_CONFIG="CONFIG_SCHED_READY_MASK CONFIG_SCHED_PRIORITY"
+ */
+
+#define CONFIG_SERVICE_BOOT 1
+#define CONFIG_SERVICE_BOOT_USE_PAYLOAD 1
+#define CONFIG_SERVICE_BOOT_USE_PAYLOAD_IN_FABRIC 1
+#define CONFIG_SERVICE_BOOT_USE_PAYLOAD_IN_FABRIC_ADDRESS 0x60000000
+#define CONFIG_SERVICE_BOOT_DDR_TARGET_ADDR 0x103FC00000
+#define CONFIG_SERVICE_BOOT_MMC_USE_GPT 1
+#define CONFIG_SERVICE_BOOT_SPI_FLASH_OFFSET 0x400
+#define CONFIG_SERVICE_DDR 1
+#define CONFIG_SERVICE_GOTO 1
+#define CONFIG_SERVICE_IPI_POLL 1
+#define CONFIG_SERVICE_MMC 1
+#define CONFIG_SERVICE_MMC_MODE_EMMC 1
+#define CONFIG_SERVICE_MMC_MODE_SDCARD 1
+#define CONFIG_SERVICE_MMC_BUS_VOLTAGE_1V8 1
+#define CONFIG_SERVICE_OPENSBI 1
+#define CONFIG_SERVICE_QSPI 1
+#define CONFIG_SERVICE_QSPI_WINBOND_W25N01GV 1
+#define CONFIG_SERVICE_SPI 1
+#define CONFIG_COMPRESSION 1
+#define CONFIG_COMPRESSION_MINIZ 1
+#define CONFIG_CC_HAS_INTTYPES 1
+#define CONFIG_IPI_MAX_NUM_QUEUE_MESSAGES 4
+
+#define CONFIG_DEBUG_LOG_STATE_TRANSITIONS 1
+#define CONFIG_DEBUG_LOOP_TIMES 1
+#define CONFIG_DEBUG_LOOP_TIMES_THRESHOLD 2500000
+#define CONFIG_DEBUG_BOOT_TIMELINE 1
+#define CONFIG_DEBUG_BOOT_TIMELINE_NUM_EVENTS 64
+
+// Kconfig defaults for options that depend on the SIM_CONFIG ones
+#ifdef CONFIG_SCHED_PRIORITY
+#  define CONFIG_SCHED_PRIORITY_PASS_BUDGET_US 500
+#  define CONFIG_SCHED_PRIORITY_STARVATION_LIMIT_MS 100
+#endif
+#ifdef CONFIG_SCHED_IDLE_WFI
+#  define CONFIG_SCHED_IDLE_WFI_MAX_SLEEP_MS 10
+#  define CONFIG_SCHED_IDLE_WFI_POLL_INTERVAL_US 1000
+#endif
+
+#endif
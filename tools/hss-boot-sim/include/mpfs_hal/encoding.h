@@ -0,0 +1,120 @@
+#ifndef HSS_BOOT_SIM_ENCODING_H
+#define HSS_BOOT_SIM_ENCODING_H
+
+/******************************************************************************************
+ *
+ * MPFS HSS Embedded Software - tools/hss-boot-sim
+ *
+ * Copyright 2019-2025 Microchip FPGA Embedded Systems Solutions.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/*
+ * Simulated RISC-V CSR access.
+ *
+ * Each simulated hart is a host thread. mhartid comes from thread-local state, mip
+ * is backed by the simulated CLINT, and mcycle and time by the host clock. Other
+ * CSRs are plain per-hart storage (see sim_hart.c).
+ */
+
+#include <stdint.h>
+
+#define MIP_MSIP            (1u << 3)
+#define MIP_MTIP            (1u << 7)
+#define MIP_MEIP            (1u << 11)
+#define MIE_MSIE            MIP_MSIP
+#define MIE_MTIE            MIP_MTIP
+#define MIE_MEIE            MIP_MEIP
+#define MSTATUS_MIE         0x00000008u
+
+#define CSR_MHARTID         0xf14
+#define CSR_MIP             0x344
+#define CSR_MIE             0x304
+#define CSR_MSTATUS         0x300
+#define CSR_MSCRATCH        0x340
+#define CSR_MCYCLE          0xb00
+#define CSR_MINSTRET        0xb02
+#define CSR_TIME            0xc01
+
+unsigned long HSS_Sim_ReadCSR(unsigned int csr);
+void HSS_Sim_WriteCSR(unsigned int csr, unsigned long value);
+void HSS_Sim_WFI(void);
+
+static inline void HSS_Sim_SetCSR(unsigned int csr, unsigned long bits)
+{
+    HSS_Sim_WriteCSR(csr, HSS_Sim_ReadCSR(csr) | bits);
+}
+
+static inline void HSS_Sim_ClearCSR(unsigned int csr, unsigned long bits)
+{
+    HSS_Sim_WriteCSR(csr, HSS_Sim_ReadCSR(csr) & ~bits);
+}
+
+#define read_csr(reg)       HSS_Sim_ReadCSR(CSR_##reg)
+#define write_csr(reg, val) HSS_Sim_WriteCSR(CSR_##reg, (unsigned long)(val))
+#define set_csr(reg, bit)   HSS_Sim_SetCSR(CSR_##reg, (unsigned long)(bit))
+#define clear_csr(reg, bit) HSS_Sim_ClearCSR(CSR_##reg, (unsigned long)(bit))
+#define wfi()               HSS_Sim_WFI()
+
+// OpenSBI-style accessors, which take CSR_<NAME> rather than the bare register name
+#define csr_set             set_csr
+#define csr_clear           clear_csr
+#define csr_read_clear(csr, bit) __extension__({ \
+    unsigned long __tmp = HSS_Sim_ReadCSR(CSR_##csr); \
+    HSS_Sim_WriteCSR(CSR_##csr, __tmp & ~(unsigned long)(bit)); \
+    __tmp; })
+#define CSR_CSR_MSTATUS     CSR_MSTATUS
+#define CSR_CSR_MIE         CSR_MIE
+#define CSR_CSR_MIP         CSR_MIP
+
+#define CSR_mhartid         CSR_MHARTID
+#define CSR_mip             CSR_MIP
+#define CSR_mie             CSR_MIE
+#define CSR_mstatus         CSR_MSTATUS
+#define CSR_mscratch        CSR_MSCRATCH
+#define CSR_mcycle          CSR_MCYCLE
+#define CSR_minstret        CSR_MINSTRET
+#define CSR_time            CSR_TIME
+#define CSR_pmpcfg0         0x3a0
+#define CSR_pmpcfg1         0x3a1
+#define CSR_pmpcfg2         0x3a2
+#define CSR_pmpcfg3         0x3a3
+#define CSR_pmpaddr0        0x3b0
+#define CSR_pmpaddr1        0x3b1
+#define CSR_pmpaddr2        0x3b2
+#define CSR_pmpaddr3        0x3b3
+#define CSR_pmpaddr4        0x3b4
+#define CSR_pmpaddr5        0x3b5
+#define CSR_pmpaddr6        0x3b6
+#define CSR_pmpaddr7        0x3b7
+#define CSR_pmpaddr8        0x3b8
+#define CSR_pmpaddr9        0x3b9
+#define CSR_pmpaddr10       0x3ba
+#define CSR_pmpaddr11       0x3bb
+#define CSR_pmpaddr12       0x3bc
+#define CSR_pmpaddr13       0x3bd
+#define CSR_pmpaddr14       0x3be
+#define CSR_pmpaddr15       0x3bf
+
+#define current_hartid()    ((unsigned int)read_csr(mhartid))
+
+#endif
@@ -0,0 +1,49 @@
+#ifndef HSS_BOOT_SIM_MSS_IO_CONFIG_H
+#define HSS_BOOT_SIM_MSS_IO_CONFIG_H
+
+/******************************************************************************************
+ *
+ * MPFS HSS Embedded Software - tools/hss-boot-sim
+ *
+ * Copyright 2019-2025 Microchip FPGA Embedded Systems Solutions.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/*
+ * Simulated MSSIO configuration switching between SD card and eMMC. The switch always
+ * succeeds; which card answers is up to the simulated storage (sim_storage.c).
+ */
+
+#include <stdint.h>
+
+typedef enum MSS_IO_OPTIONS_ {
+    NO_SUPPORT_MSSIO_CONFIGURATION = 0x00,
+    NOT_SETUP_MSSIO_CONFIGURATION = 0x01,
+    SD_MSSIO_CONFIGURATION = 0x02,
+    EMMC_MSSIO_CONFIGURATION = 0x03,
+} MSS_IO_OPTIONS;
+
+uint8_t mss_does_xml_ver_support_switch(void);
+uint8_t switch_mssio_config(MSS_IO_OPTIONS option);
+uint8_t switch_demux_using_fabric_ip(MSS_IO_OPTIONS option);
+
+#endif
@@ -0,0 +1,91 @@
+#ifndef HSS_BOOT_SIM_MSS_MMC_H
+#define HSS_BOOT_SIM_MSS_MMC_H
+
+/******************************************************************************************
+ *
+ * MPFS HSS Embedded Software - tools/hss-boot-sim
+ *
+ * Copyright 2019-2025 Microchip FPGA Embedded Systems Solutions.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/*
+ * Simulated MSS MMC driver. The subset of the driver API used by the MMC service,
+ * with the constants and status codes of the real driver; the card is modelled in
+ * sim_storage.c. As with the real driver, SDMA transfers complete asynchronously, and
+ * are polled for with PLIC_mmc_main_IRQHandler().
+ */
+
+#include <stdint.h>
+
+#define MSS_MMC_CLOCK_50MHZ             50000u
+#define MSS_MMC_CLOCK_200MHZ            200000u
+
+#define MSS_MMC_CARD_TYPE_MMC           1u
+#define MSS_MMC_CARD_TYPE_SD            2u
+
+#define MSS_MMC_MODE_SDR                0x2u
+#define MSS_MMC_MODE_HS200              0x4u
+#define MSS_SDCARD_MODE_DEFAULT_SPEED   0x8u
+#define MSS_SDCARD_MODE_HIGH_SPEED      0x9u
+
+#define MSS_MMC_DATA_WIDTH_4BIT         0x01u
+#define MSS_MMC_DATA_WIDTH_8BIT         0x02u
+
+#define MSS_MMC_1_8V_BUS_VOLTAGE        18u
+#define MSS_MMC_3_3V_BUS_VOLTAGE        33u
+
+typedef enum {
+    MSS_MMC_INIT_SUCCESS = 0u,
+    MSS_MMC_INIT_FAILURE,
+    MSS_MMC_NOT_INITIALISED,
+    MSS_MMC_TRANSFER_IN_PROGRESS,
+    MSS_MMC_TRANSFER_FAIL,
+    MSS_MMC_TRANSFER_SUCCESS,
+    MSS_MMC_DWIDTH_ERR,
+    MSS_MMC_RCA_ERROR,
+    MSS_MMC_CID_RESP_ERR,
+    MSS_MMC_OP_COND_ERR,
+    MSS_MMC_RESET_ERR,
+    MSS_MMC_CRC_ERR,
+    MSS_MMC_UNSUPPORTED_HW_REVISION,
+    MSS_MMC_INVALID_PARAMETER,
+    MSS_MMC_NO_ERROR,
+} mss_mmc_status_t;
+
+typedef struct {
+    uint32_t clk_rate;
+    uint8_t card_type;
+    uint8_t data_bus_width;
+    uint8_t bus_speed_mode;
+    uint8_t bus_voltage;
+} mss_mmc_cfg_t;
+
+mss_mmc_status_t MSS_MMC_init(const mss_mmc_cfg_t *cfg);
+void MSS_MMC_get_info(uint16_t *sector_size, uint32_t *sector_count);
+mss_mmc_status_t MSS_MMC_single_block_write(const uint32_t *src_addr, uint32_t dst_addr);
+mss_mmc_status_t MSS_MMC_sdma_write(const uint8_t *src, uint32_t dest, uint32_t size);
+mss_mmc_status_t MSS_MMC_sdma_read(uint32_t src, uint8_t *dest, uint32_t size);
+mss_mmc_status_t MSS_MMC_get_transfer_status(void);
+uint8_t PLIC_mmc_main_IRQHandler(void);
+
+#endif
@@ -0,0 +1,48 @@
+#ifndef HSS_BOOT_SIM_MSS_SYS_SERVICES_H
+#define HSS_BOOT_SIM_MSS_SYS_SERVICES_H
+
+/******************************************************************************************
+ *
+ * MPFS HSS Embedded Software - tools/hss-boot-sim
+ *
+ * Copyright 2019-2025 Microchip FPGA Embedded Systems Solutions.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/*
+ * Simulated system controller services. Only the SPI copy service, which copies from
+ * the system controller's SPI flash into memory, is provided; the flash is modelled
+ * in sim_storage.c.
+ */
+
+#include <stdint.h>
+
+#define MSS_SYS_SERVICE_POLLING_MODE    0u
+
+typedef void (*mss_sys_service_handler_t)(void);
+
+void MSS_SYS_select_service_mode(uint8_t sys_service_mode,
+    mss_sys_service_handler_t mss_sys_service_interrupt_handler);
+uint16_t MSS_SYS_spi_copy(uint64_t mss_dest_addr, uint32_t mss_spi_flash, uint32_t n_bytes,
+    uint8_t options, uint16_t mb_offset);
+
+#endif
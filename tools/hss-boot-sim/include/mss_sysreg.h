@@ -0,0 +1,67 @@
+#ifndef HSS_BOOT_SIM_MSS_SYSREG_H
+#define HSS_BOOT_SIM_MSS_SYSREG_H
+
+/******************************************************************************************
+ *
+ * MPFS HSS Embedded Software - tools/hss-boot-sim
+ *
+ * Copyright 2019-2025 Microchip FPGA Embedded Systems Solutions.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/*
+ * Simulated MSS system registers. Only the registers the simulated sources touch are
+ * named; the block lives in simulated physical memory at its real address.
+ */
+
+#include <stdint.h>
+
+#define BASE32_ADDR_MSS_SYSREG  0x20002000UL
+
+typedef struct {
+    volatile uint32_t TEMP0;
+    volatile uint32_t TEMP1;
+    volatile uint32_t CLOCK_CONFIG_CR;
+    volatile uint32_t RTC_CLOCK_CR;
+    volatile uint32_t FABRIC_RESET_CR;
+    volatile uint32_t BOOT_FAIL_CR;
+    volatile uint32_t MSS_RESET_CR;
+    volatile uint32_t CONFIG_LOCK_CR;
+    volatile uint32_t RESET_SR;
+    volatile uint32_t DEVICE_STATUS;
+    volatile uint32_t MSS_BUILD;
+    volatile uint32_t RESERVED0[5];
+    volatile uint32_t FAB_INTEN_U54[4];
+    volatile uint32_t FAB_INTEN_MISC;
+    volatile uint32_t GPIO_INTERRUPT_FAB_CR;
+    volatile uint32_t RESERVED1[10];
+    volatile uint32_t APBBUS_CR;
+    volatile uint32_t SUBBLK_CLOCK_CR;
+    volatile uint32_t SOFT_RESET_CR;
+} mss_sysreg_t;
+
+#define SUBBLK_CLOCK_CR_MMC_MASK    (0x01 << 0x3)
+#define SOFT_RESET_CR_MMC_MASK      (0x01 << 0x3)
+
+#define SYSREG  ((volatile mss_sysreg_t * const) BASE32_ADDR_MSS_SYSREG)
+
+#endif
@@ -0,0 +1,55 @@
+#ifndef HSS_BOOT_SIM_RISCV_ATOMIC_H
+#define HSS_BOOT_SIM_RISCV_ATOMIC_H
+
+/******************************************************************************************
+ *
+ * MPFS HSS Embedded Software - tools/hss-boot-sim
+ *
+ * Copyright 2019-2025 Microchip FPGA Embedded Systems Solutions.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/*
+ * Host implementation of the OpenSBI atomic API (see sim_hart.c).
+ */
+
+typedef struct {
+    volatile long counter;
+} atomic_t;
+
+#define ATOMIC_INIT(_lptr, val) (_lptr)->counter = (val)
+#define ATOMIC_INITIALIZER(val) { .counter = (val), }
+
+long atomic_read(atomic_t *atom);
+void atomic_write(atomic_t *atom, long value);
+long atomic_add_return(atomic_t *atom, long value);
+long atomic_sub_return(atomic_t *atom, long value);
+long atomic_cmpxchg(atomic_t *atom, long oldval, long newval);
+long atomic_xchg(atomic_t *atom, long newval);
+unsigned int atomic_raw_xchg_uint(volatile unsigned int *ptr, unsigned int newval);
+unsigned long atomic_raw_xchg_ulong(volatile unsigned long *ptr, unsigned long newval);
+int atomic_set_bit(int nr, atomic_t *atom);
+int atomic_clear_bit(int nr, atomic_t *atom);
+int atomic_raw_set_bit(int nr, volatile unsigned long *addr);
+int atomic_raw_clear_bit(int nr, volatile unsigned long *addr);
+
+#endif
@@ -0,0 +1,47 @@
+#ifndef HSS_BOOT_SIM_WINBOND_W25N01GV_H
+#define HSS_BOOT_SIM_WINBOND_W25N01GV_H
+
+/******************************************************************************************
+ *
+ * MPFS HSS Embedded Software - tools/hss-boot-sim
+ *
+ * Copyright 2019-2025 Microchip FPGA Embedded Systems Solutions.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/*
+ * Winbond W25N01GV QSPI NAND driver API, as used by the QSPI service. The flash is
+ * modelled in sim_storage.c.
+ */
+
+#include <stdint.h>
+#include "mss_qspi.h"
+
+void Flash_init(mss_qspi_io_format io_format);
+void Flash_readid(uint8_t *buf);
+uint8_t Flash_read(uint8_t *buf, uint32_t addr, uint32_t len);
+uint8_t Flash_erase(void);
+uint8_t Flash_erase_block(uint16_t block_nb);
+uint8_t Flash_program(uint8_t *buf, uint32_t addr, uint32_t len);
+uint32_t Flash_scan_for_bad_blocks(uint16_t *buf);
+
+#endif
@@ -0,0 +1,134 @@
+#ifndef HSS_BOOT_SIM_H
+#define HSS_BOOT_SIM_H
+
+/******************************************************************************************
+ *
+ * MPFS HSS Embedded Software - tools/hss-boot-sim
+ *
+ * Copyright 2019-2025 Microchip FPGA Embedded Systems Solutions.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/*
+ * Host boot simulator - shared definitions
+ *
+ * The real HSS boot path (state machine core, startup and boot services, IPI, CRC,
+ * decompression and payload parsing) is compiled unmodified for Linux, against the
+ * shim headers in include/. The hardware it touches is replaced by simulated
+ * back-ends: physical memory is mapped at the real addresses, each U54 is a host
+ * thread, and the CLINT, PDMA, DDR, UART and boot storage are modelled here.
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "hss_types.h"
+
+//
+// simulated physical memory map
+//
+#define SIM_CLINT_BASE		0x02000000ul
+#define SIM_CLINT_SIZE		0x00010000ul
+#define SIM_SYSREG_BASE		0x20000000ul
+#define SIM_SYSREG_SIZE		0x00010000ul
+#define SIM_DDR_LO_BASE		0x80000000ul
+#define SIM_DDR_LO_SIZE		0x40000000ul
+#define SIM_DDR_HI_BASE		0x1000000000ul
+
+struct Sim_Options {
+	char const *payloadFilename;
+	char const *timelineFilename;
+	bool verbose;
+	size_t ddrSize;			// bytes of DDR
+	uint32_t ddrTrainMs;		// simulated DDR training time
+	uint32_t pdmaMBps;		// simulated PDMA throughput, 0 for unthrottled
+	uint32_t uartBaud;		// simulated UART rate, 0 for unthrottled
+	uint64_t maxLoops;		// superloop iteration budget, 0 for no limit
+	uint32_t maxMs;			// boot time budget, 0 for no limit
+	uint32_t timeoutMs;		// give up waiting for the boot to complete
+	char const *storageSpec;	// boot from simulated storage, <model>[:<image>]
+	char const *usbWriteSpec;	// write <file>[@<offset>] to it first, as over USB
+	char const *traceFilename;	// record its accesses
+	char const *replayFilename;	// replay recorded accesses against it, instead of booting
+	char const *snapshotSpec;	// write <file>@<addr>:<bytes> of DDR after the boot
+};
+
+extern struct Sim_Options simOptions;
+
+//
+// what each U54 did when the boot service handed over to its payload
+//
+struct Sim_HartResult {
+	bool entered;
+	bool viaOpenSBI;		// OPENSBI_INIT, rather than GOTO
+	uintptr_t entryPoint;
+	uint32_t privMode;
+	uintptr_t arg1;			// ancilliary data (DTB) address
+	uint64_t entryTimeNs;
+	size_t chunksGood;
+	size_t chunksBad;
+	bool entryLoaded;		// entry point is within a downloaded chunk
+};
+
+extern struct Sim_HartResult simHartResult[MAX_NUM_HARTS];
+
+struct Sim_Stats {
+	uint64_t pdmaCalls;
+	uint64_t pdmaBytes;
+	uint64_t pdmaNs;
+	uint64_t uartBytes;
+	uint64_t u54Wakes;
+};
+
+extern struct Sim_Stats simStats;
+
+// sim_memory.c
+bool sim_memory_init(size_t ddrSize);
+bool sim_memory_load_payload(char const *filename, uintptr_t physAddr, size_t *pSize);
+bool sim_memory_snapshot_begin(char const *spec);
+bool sim_memory_snapshot_end(void);
+void sim_memory_exit(void);
+
+// sim_hart.c
+void sim_clock_init(void);
+uint64_t sim_clock_ns(void);
+void sim_spin_ns(uint64_t ns);
+bool sim_harts_start(void);
+void sim_harts_stop(void);
+size_t sim_harts_running(void);
+void sim_hart_enter_payload(void) __attribute__((noreturn));
+
+// sim_platform.c
+void sim_console_flush(void);
+
+// sim_storage.c
+bool sim_storage_select(char const *spec);
+bool sim_storage_set(char const *param);
+bool sim_storage_init(char const *traceFilename);
+void sim_storage_select_boot_source(void);
+bool sim_storage_usb_write(char const *spec);
+bool sim_storage_replay(char const *filename);
+void sim_storage_report(void);
+void sim_storage_exit(void);
+
+#endif
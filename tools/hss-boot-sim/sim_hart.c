@@ -0,0 +1,335 @@
+/******************************************************************************************
+ *
+ * MPFS HSS Embedded Software - tools/hss-boot-sim
+ *
+ * Copyright 2019-2025 Microchip FPGA Embedded Systems Solutions.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/*
+ * Simulated harts, CSRs and CLINT
+ *
+ * The E51 is the main thread. Each U54 is a host thread that, like the U54 start-up
+ * code in crt.S, announces itself Idle and then sleeps until its CLINT MSIP word is
+ * raised, whereupon it hands the IPI to the real HSS_U54_HandleIPI(). A U54 leaves
+ * the simulation when it is handed over to its payload.
+ *
+ * mtime runs at TICKS_PER_SEC (1 MHz) from host monotonic time, and mcycle counts
+ * nanoseconds.
+ */
+
+#include <pthread.h>
+#include <setjmp.h>
+#include <stdio.h>
+#include <sys/prctl.h>
+#include <time.h>
+
+#include "config.h"
+#include "sim.h"
+
+#include "hss_clock.h"
+#include "csr_helper.h"
+#include "mpfs_reg_map.h"
+#include "riscv_atomic.h"
+#include "u54_handle_ipi.h"
+
+bool HSS_U54_HandleIPI(void);	// not in any header, as it is only called from crt.S
+
+// how long an idle hart sleeps between looks at its MSIP word
+#define SIM_IDLE_POLL_NS	20000u
+
+static __thread unsigned int myHartId = HSS_HART_E51;
+static __thread unsigned long csrs[4096];
+static __thread jmp_buf payloadJmpBuf;
+
+static uint64_t clockStartNs;
+static pthread_t u54Threads[MAX_NUM_HARTS];
+static bool u54ThreadStarted[MAX_NUM_HARTS];
+static int stopFlag = 0;
+static size_t numRunning = 0u;
+static size_t numReady = 0u;
+
+//
+// clock
+//
+static uint64_t host_ns_(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000llu + (uint64_t)ts.tv_nsec;
+}
+
+void sim_clock_init(void)
+{
+	clockStartNs = host_ns_();
+}
+
+uint64_t sim_clock_ns(void)
+{
+	return host_ns_() - clockStartNs;
+}
+
+void sim_spin_ns(uint64_t ns)
+{
+	uint64_t const deadline = host_ns_() + ns;
+
+	while (host_ns_() < deadline) { ; }
+}
+
+HSSTicks_t CSR_GetTickCount(void)
+{
+	return sim_clock_ns();
+}
+
+HSSTicks_t CSR_GetTime(void)
+{
+	return sim_clock_ns() / (1000000000llu / TICKS_PER_SEC);
+}
+
+//
+// CLINT
+//
+static volatile uint32_t *clint_msip_(unsigned int hartId)
+{
+	return (volatile uint32_t *)(SIM_CLINT_BASE + CLINT_MSIP_E51_0_OFFSET + 4u * hartId);
+}
+
+static volatile uint64_t *clint_mtimecmp_(unsigned int hartId)
+{
+	return (volatile uint64_t *)(SIM_CLINT_BASE + CLINT_MTIMECMP_E51_0_OFFSET + 8u * hartId);
+}
+
+void CSR_ClearMSIP(void)
+{
+	*clint_msip_(myHartId) = 0u;
+	__sync_synchronize();
+}
+
+//
+// CSRs
+//
+unsigned long HSS_Sim_ReadCSR(unsigned int csr)
+{
+	unsigned long result;
+
+	switch (csr) {
+	case CSR_MHARTID:
+		result = myHartId;
+		break;
+
+	case CSR_MCYCLE:
+	case CSR_MINSTRET:
+		result = sim_clock_ns();
+		break;
+
+	case CSR_TIME:
+		result = CSR_GetTime();
+		break;
+
+	case CSR_MIP:
+		result = *clint_msip_(myHartId) ? MIP_MSIP : 0u;
+		if (CSR_GetTime() >= *clint_mtimecmp_(myHartId)) {
+			result |= MIP_MTIP;
+		}
+		break;
+
+	default:
+		result = csrs[csr & 0xfffu];
+		break;
+	}
+
+	return result;
+}
+
+void HSS_Sim_WriteCSR(unsigned int csr, unsigned long value)
+{
+	csrs[csr & 0xfffu] = value;
+}
+
+void HSS_Sim_WFI(void)
+{
+	unsigned long const mie = csrs[CSR_MIE];
+	struct timespec const idle = { 0, SIM_IDLE_POLL_NS };
+
+	while (!(HSS_Sim_ReadCSR(CSR_MIP) & mie)) {
+		nanosleep(&idle, NULL);
+	}
+}
+
+//
+// atomics, as provided by OpenSBI on the target
+//
+long atomic_read(atomic_t *atom)
+{
+	return __atomic_load_n(&atom->counter, __ATOMIC_SEQ_CST);
+}
+
+void atomic_write(atomic_t *atom, long value)
+{
+	__atomic_store_n(&atom->counter, value, __ATOMIC_SEQ_CST);
+}
+
+long atomic_add_return(atomic_t *atom, long value)
+{
+	return __atomic_add_fetch(&atom->counter, value, __ATOMIC_SEQ_CST);
+}
+
+long atomic_sub_return(atomic_t *atom, long value)
+{
+	return __atomic_sub_fetch(&atom->counter, value, __ATOMIC_SEQ_CST);
+}
+
+long atomic_cmpxchg(atomic_t *atom, long oldval, long newval)
+{
+	__atomic_compare_exchange_n(&atom->counter, &oldval, newval, false, __ATOMIC_SEQ_CST,
+		__ATOMIC_SEQ_CST);
+	return oldval;
+}
+
+long atomic_xchg(atomic_t *atom, long newval)
+{
+	return __atomic_exchange_n(&atom->counter, newval, __ATOMIC_SEQ_CST);
+}
+
+unsigned int atomic_raw_xchg_uint(volatile unsigned int *ptr, unsigned int newval)
+{
+	return __atomic_exchange_n(ptr, newval, __ATOMIC_SEQ_CST);
+}
+
+unsigned long atomic_raw_xchg_ulong(volatile unsigned long *ptr, unsigned long newval)
+{
+	return __atomic_exchange_n(ptr, newval, __ATOMIC_SEQ_CST);
+}
+
+int atomic_raw_set_bit(int nr, volatile unsigned long *addr)
+{
+	unsigned long const mask = BIT_MASK((unsigned)nr);
+	unsigned long const old = __atomic_fetch_or(&addr[BIT_WORD((unsigned)nr)], mask,
+		__ATOMIC_SEQ_CST);
+
+	return (old & mask) ? 1 : 0;
+}
+
+int atomic_raw_clear_bit(int nr, volatile unsigned long *addr)
+{
+	unsigned long const mask = BIT_MASK((unsigned)nr);
+	unsigned long const old = __atomic_fetch_and(&addr[BIT_WORD((unsigned)nr)], ~mask,
+		__ATOMIC_SEQ_CST);
+
+	return (old & mask) ? 1 : 0;
+}
+
+int atomic_set_bit(int nr, atomic_t *atom)
+{
+	return atomic_raw_set_bit(nr, (volatile unsigned long *)&atom->counter);
+}
+
+int atomic_clear_bit(int nr, atomic_t *atom)
+{
+	return atomic_raw_clear_bit(nr, (volatile unsigned long *)&atom->counter);
+}
+
+//
+// U54 threads
+//
+static void *u54_thread_(void *arg)
+{
+	myHartId = (unsigned int)(uintptr_t)arg;
+
+	// a hart that is handed over to its payload comes back here, and finishes
+	if (setjmp(payloadJmpBuf)) {
+		return NULL;
+	}
+
+	HSS_U54_Banner();
+	__atomic_add_fetch(&numReady, 1u, __ATOMIC_RELEASE);
+
+	volatile uint32_t * const pMsip = clint_msip_(myHartId);
+	struct timespec const idle = { 0, SIM_IDLE_POLL_NS };
+
+	while (!__atomic_load_n(&stopFlag, __ATOMIC_ACQUIRE)) {
+		if (*pMsip) {
+			// MSIP is cleared on taking the interrupt, as OpenSBI does
+			CSR_ClearMSIP();
+			__atomic_add_fetch(&simStats.u54Wakes, 1u, __ATOMIC_RELAXED);
+
+			(void)HSS_U54_HandleIPI();
+		} else {
+			nanosleep(&idle, NULL);
+		}
+	}
+
+	__atomic_sub_fetch(&numRunning, 1u, __ATOMIC_RELEASE);
+	return NULL;
+}
+
+bool sim_harts_start(void)
+{
+	bool result = true;
+
+	// nanosleep() is used for idle harts, so don't let the kernel stretch it
+	(void)prctl(PR_SET_TIMERSLACK, 1ul, 0ul, 0ul, 0ul);
+
+	for (unsigned int hartId = HSS_HART_U54_1; hartId < MAX_NUM_HARTS; hartId++) {
+		__atomic_add_fetch(&numRunning, 1u, __ATOMIC_RELEASE);
+
+		if (pthread_create(&u54Threads[hartId], NULL, u54_thread_, (void *)(uintptr_t)hartId)) {
+			fprintf(stderr, "hss-boot-sim: cannot start u54_%u\n", hartId);
+			__atomic_sub_fetch(&numRunning, 1u, __ATOMIC_RELEASE);
+			result = false;
+			break;
+		}
+		u54ThreadStarted[hartId] = true;
+	}
+
+	// wait for each U54 to reach Idle, as the E51 will only boot idle harts
+	while (result && (__atomic_load_n(&numReady, __ATOMIC_ACQUIRE) < (MAX_NUM_HARTS - 1u))) {
+		struct timespec const idle = { 0, SIM_IDLE_POLL_NS };
+		nanosleep(&idle, NULL);
+	}
+
+	return result;
+}
+
+void sim_harts_stop(void)
+{
+	__atomic_store_n(&stopFlag, 1, __ATOMIC_RELEASE);
+
+	for (unsigned int hartId = HSS_HART_U54_1; hartId < MAX_NUM_HARTS; hartId++) {
+		if (u54ThreadStarted[hartId]) {
+			pthread_join(u54Threads[hartId], NULL);
+			u54ThreadStarted[hartId] = false;
+		}
+	}
+}
+
+size_t sim_harts_running(void)
+{
+	return __atomic_load_n(&numRunning, __ATOMIC_ACQUIRE);
+}
+
+void sim_hart_enter_payload(void)
+{
+	__atomic_sub_fetch(&numRunning, 1u, __ATOMIC_RELEASE);
+	longjmp(payloadJmpBuf, 1);
+}
@@ -0,0 +1,440 @@
+/******************************************************************************************
+ *
+ * MPFS HSS Embedded Software - tools/hss-boot-sim
+ *
+ * Copyright 2019-2025 Microchip FPGA Embedded Systems Solutions.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/*
+ * Host boot simulator
+ *
+ * Boots an HSS payload (as built by hss-payload-generator) through the real HSS boot
+ * path on Linux, from fabric or from simulated boot storage, and reports the superloop
+ * iterations and time taken, overall and per boot phase. Exits non-zero if the boot
+ * fails, if any payload does not arrive intact, or if a loop or time budget is
+ * exceeded, so that it can gate CI.
+ */
+
+#include <getopt.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "config.h"
+#include "sim.h"
+
+#include "hss_boot_init.h"
+#include "hss_clock.h"
+#include "ssmb_ipi.h"
+#include "hss_state_machine.h"
+#include "hss_registry.h"
+#include "hss_timeline.h"
+#include "hss_trigger.h"
+#include "startup_service.h"
+
+extern struct HSS_BootImage *pBootImage;
+
+struct Sim_Options simOptions = {
+	.ddrSize = 2048u * 1024u * 1024u,
+	.timeoutMs = 10000u,
+};
+
+static void print_usage(char **argv) __attribute__((nonnull));
+static void print_usage(char **argv)
+{
+	printf("Usage: %s [options] <payload.bin>\n"
+		"       %s [options] -s <model>[:<image>]\n"
+		"       %s -s <model> -P <trace>\n"
+		"\n"
+		"Boots a payload through the HSS boot path, with simulated hardware. The payload\n"
+		"is either in fabric, or on simulated boot storage, loaded from a disk image.\n"
+		"\n"
+		"Options:\n"
+		"\t-d <MiB>   DDR size (default %zu)\n"
+		"\t-D <ms>    simulated DDR training time (default 0)\n"
+		"\t-p <MB/s>  simulated PDMA throughput (default 0, unthrottled)\n"
+		"\t-u <baud>  simulated UART rate (default 0, unthrottled)\n"
+		"\t-l <n>     fail if the boot takes more than <n> superloop iterations\n"
+		"\t-m <ms>    fail if the boot takes more than <ms> milliseconds\n"
+		"\t-t <ms>    give up if the boot has not completed after <ms> (default %u)\n"
+		"\t-T <file>  write the boot timeline to <file>, for tools/profiling/gen-boot-trace.py\n"
+		"\t-s <model>[:<image>]\n"
+		"\t           boot from simulated storage: sd, emmc, qspi-nand or spi, loaded from\n"
+		"\t           <image> if given, otherwise blank\n"
+		"\t-M <key>=<value>\n"
+		"\t           override a storage model parameter: size-mib, erase-size, init-us,\n"
+		"\t           cmd-us, read-mbps, write-mbps, erase-us, or bad=<block>[,<block>...]\n"
+		"\t-w <file>[@<offset>]\n"
+		"\t           first write <file> to the storage, as the USB mass storage service does\n"
+		"\t-r <file>  record the storage accesses to <file>\n"
+		"\t-P <file>  replay recorded storage accesses against the model, instead of booting\n"
+		"\t-S <file>@<addr>:<bytes>\n"
+		"\t           fill <bytes> of DDR from <addr> with 0xA5 before the boot, and write\n"
+		"\t           them to <file> after it\n"
+		"\t-v         show the HSS console\n"
+		"\t-h         display this help\n",
+		argv[0], argv[0], argv[0], simOptions.ddrSize / (1024u * 1024u), simOptions.timeoutMs);
+}
+
+static bool parse_u64_(char const *arg, uint64_t *pValue)
+{
+	char *end;
+	unsigned long long value = strtoull(arg, &end, 0);
+
+	*pValue = value;
+	return (*arg != '\0') && (*end == '\0');
+}
+
+static bool parse_args_(int argc, char **argv)
+{
+	bool result = true;
+	int opt;
+
+	while (result && ((opt = getopt(argc, argv, "d:D:p:u:l:m:t:T:s:M:w:r:P:S:vh")) != -1)) {
+		uint64_t value = 0u;
+
+		switch (opt) {
+		case 'd':
+			result = parse_u64_(optarg, &value) && (value >= 1024u) && (value <= 65536u);
+			simOptions.ddrSize = (size_t)value * 1024u * 1024u;
+			break;
+		case 'D':
+			result = parse_u64_(optarg, &value) && (value <= UINT32_MAX);
+			simOptions.ddrTrainMs = (uint32_t)value;
+			break;
+		case 'p':
+			result = parse_u64_(optarg, &value) && (value <= UINT32_MAX);
+			simOptions.pdmaMBps = (uint32_t)value;
+			break;
+		case 'u':
+			result = parse_u64_(optarg, &value) && (value <= UINT32_MAX);
+			simOptions.uartBaud = (uint32_t)value;
+			break;
+		case 'l':
+			result = parse_u64_(optarg, &value);
+			simOptions.maxLoops = value;
+			break;
+		case 'm':
+			result = parse_u64_(optarg, &value) && (value <= UINT32_MAX);
+			simOptions.maxMs = (uint32_t)value;
+			break;
+		case 't':
+			result = parse_u64_(optarg, &value) && value && (value <= UINT32_MAX);
+			simOptions.timeoutMs = (uint32_t)value;
+			break;
+		case 'T':
+			simOptions.timelineFilename = optarg;
+			break;
+		case 's':
+			simOptions.storageSpec = optarg;
+			result = sim_storage_select(optarg);
+			break;
+		case 'M':
+			result = sim_storage_set(optarg);
+			break;
+		case 'w':
+			simOptions.usbWriteSpec = optarg;
+			break;
+		case 'r':
+			simOptions.traceFilename = optarg;
+			break;
+		case 'P':
+			simOptions.replayFilename = optarg;
+			break;
+		case 'S':
+			simOptions.snapshotSpec = optarg;
+			break;
+		case 'v':
+			simOptions.verbose = true;
+			break;
+		case 'h':
+			print_usage(argv);
+			exit(EXIT_SUCCESS);
+		default:
+			result = false;
+			break;
+		}
+	}
+
+	if (result && !simOptions.storageSpec && (optind == (argc - 1))) {
+		simOptions.payloadFilename = argv[optind];
+	} else if (result && simOptions.storageSpec && (optind == argc)) {
+		;
+	} else {
+		result = false;
+	}
+
+	if (result && !simOptions.storageSpec
+		&& (simOptions.usbWriteSpec || simOptions.traceFilename || simOptions.replayFilename)) {
+		result = false;
+	}
+
+	if (!result) {
+		print_usage(argv);
+	}
+
+	return result;
+}
+
+//
+// A hart is expected to be handed over to a payload if it has an entry point, and
+// the hart whose chunks make up that payload is not marked to skip autoboot.
+//
+static bool is_hart_expected_(enum HSSHartId hartId)
+{
+	bool result = false;
+	uintptr_t const entryPoint = pBootImage->hart[hartId-1].entryPoint;
+
+	for (unsigned int i = 0u; entryPoint && (i < (MAX_NUM_HARTS - 1u)); i++) {
+		if ((pBootImage->hart[i].entryPoint == entryPoint) && pBootImage->hart[i].numChunks
+			&& !(pBootImage->hart[i].flags & BOOT_FLAG_SKIP_AUTOBOOT)) {
+			result = true;
+		}
+	}
+
+	return result;
+}
+
+static bool wait_for_harts_(uint64_t deadlineNs)
+{
+	bool result = true;
+
+	for (unsigned int hartId = HSS_HART_U54_1; hartId < MAX_NUM_HARTS; hartId++) {
+		if (!is_hart_expected_(hartId)) {
+			continue;
+		}
+
+		while (!__atomic_load_n(&simHartResult[hartId].entered, __ATOMIC_ACQUIRE)
+			&& (sim_clock_ns() < deadlineNs)) {
+			struct timespec const idle = { 0, 100000 };
+			nanosleep(&idle, NULL);
+		}
+
+		result = result && simHartResult[hartId].entered;
+	}
+
+	return result;
+}
+
+static bool report_harts_(uint64_t startNs)
+{
+	bool result = true;
+
+	for (unsigned int hartId = HSS_HART_U54_1; hartId < MAX_NUM_HARTS; hartId++) {
+		struct Sim_HartResult const * const pResult = &simHartResult[hartId];
+		bool const expected = is_hart_expected_(hartId);
+
+		printf("u54_%u: ", hartId);
+
+		if (!pResult->entered) {
+			printf("%s\n", expected ? "FAILED, not handed over to payload" : "idle");
+			result = result && !expected;
+			continue;
+		}
+
+		bool const ok = expected && pResult->entryLoaded && !pResult->chunksBad;
+
+		printf("%s 0x%lx (mode %u, arg1 0x%lx) at %.3f ms",
+			pResult->viaOpenSBI ? "OpenSBI" : "goto", (unsigned long)pResult->entryPoint,
+			pResult->privMode, (unsigned long)pResult->arg1,
+			(double)(pResult->entryTimeNs - startNs) / 1e6);
+
+		if (pBootImage->hart[hartId-1].numChunks) {
+			printf(", \"%s\", %zu chunk%s ok", pBootImage->hart[hartId-1].name,
+				pResult->chunksGood, pResult->chunksGood == 1u ? "" : "s");
+		} else {
+			printf(", secondary");
+		}
+
+		if (pResult->chunksBad) {
+			printf(", %zu BAD", pResult->chunksBad);
+		}
+		if (!pResult->entryLoaded) {
+			printf(", entry point NOT LOADED");
+		}
+		if (!expected) {
+			printf(", NOT EXPECTED");
+		}
+		printf("\n");
+
+		result = result && ok;
+	}
+
+	return result;
+}
+
+static void report_phases_(void)
+{
+	for (int phase = 0; phase < TIMELINE_NUM_PHASES; phase++) {
+		uint32_t const ticks = HSS_Timeline_GetPhaseTicks((enum HSS_Timeline_Phase)phase);
+
+		if (ticks) {
+			printf("  %-20s %10.3f ms\n", HSS_Timeline_GetPhaseName((enum HSS_Timeline_Phase)phase),
+				(double)ticks * 1000.0 / (double)TICKS_PER_SEC);
+		}
+	}
+}
+
+static bool write_timeline_(char const *filename)
+{
+	// the timeline dump goes to the HSS console, so capture it from there
+	FILE *pFile = freopen(filename, "w", stdout);
+	bool const verbose = simOptions.verbose;
+
+	if (!pFile) {
+		perror(filename);
+		return false;
+	}
+
+	sim_console_flush();
+	simOptions.verbose = true;
+	HSS_Timeline_Dump();
+	sim_console_flush();
+	simOptions.verbose = verbose;
+
+	fclose(pFile);
+	return true;
+}
+
+int main(int argc, char **argv)
+{
+	size_t payloadSize = 0u;
+
+	if (!parse_args_(argc, argv)) {
+		return EXIT_FAILURE;
+	}
+
+	if (simOptions.replayFilename) {
+		return sim_storage_replay(simOptions.replayFilename) ? EXIT_SUCCESS : EXIT_FAILURE;
+	}
+
+	sim_clock_init();
+
+	if (!sim_memory_init(simOptions.ddrSize)
+		|| (simOptions.snapshotSpec && !sim_memory_snapshot_begin(simOptions.snapshotSpec))) {
+		return EXIT_FAILURE;
+	}
+
+	if (simOptions.storageSpec) {
+		if (!sim_storage_init(simOptions.traceFilename) || !sim_harts_start()) {
+			return EXIT_FAILURE;
+		}
+
+		sim_storage_select_boot_source();
+
+		if (simOptions.usbWriteSpec && !sim_storage_usb_write(simOptions.usbWriteSpec)) {
+			sim_harts_stop();
+			return EXIT_FAILURE;
+		}
+	} else {
+		if (!sim_memory_load_payload(simOptions.payloadFilename,
+				CONFIG_SERVICE_BOOT_USE_PAYLOAD_IN_FABRIC_ADDRESS, &payloadSize)
+			|| !sim_harts_start()) {
+			return EXIT_FAILURE;
+		}
+
+		HSS_BootSelectPayload();
+	}
+
+	//
+	// the E51 superloop, as in hss_main()
+	//
+	uint64_t const startNs = sim_clock_ns();
+	uint64_t const deadlineNs = startNs + (uint64_t)simOptions.timeoutMs * 1000000u;
+	bool booted = false;
+
+	while (sim_clock_ns() < deadlineNs) {
+		RunStateMachines(spanOfPGlobalStateMachines, pGlobalStateMachines);
+
+		if (HSS_Trigger_IsNotified(EVENT_BOOT_COMPLETE)) {
+			booted = true;
+			break;
+		}
+
+		// once the startup service is idle without a boot image, nothing more will happen
+		if (!pBootImage && (startup_service.state == startup_service.numStates - 1u)) {
+			booted = true;
+			break;
+		}
+	}
+
+	uint64_t const bootNs = sim_clock_ns() - startNs;
+	uint64_t const loops = GetStateMachinesExecutionCount();
+
+	bool const handedOver = booted && pBootImage && wait_for_harts_(deadlineNs);
+	sim_harts_stop();
+	sim_console_flush();
+
+	if (simOptions.storageSpec) {
+		sim_storage_report();
+	} else {
+		printf("payload:    %s (%zu bytes)\n", simOptions.payloadFilename, payloadSize);
+	}
+
+	bool result = booted && pBootImage;
+	if (!booted) {
+		printf("boot:       FAILED, not complete after %u ms\n", simOptions.timeoutMs);
+	} else if (!pBootImage) {
+		printf("boot:       FAILED, no boot image\n");
+	} else {
+		printf("boot:       %s, \"%s\"\n", handedOver ? "complete" : "incomplete",
+			pBootImage->set_name);
+		result = report_harts_(startNs) && handedOver;
+	}
+
+	printf("superloop:  %" PRIu64 " iterations\n", loops);
+	printf("wall time:  %.3f ms\n", (double)bootNs / 1e6);
+	report_phases_();
+	printf("pdma:       %" PRIu64 " transfers, %" PRIu64 " bytes, %.3f ms\n",
+		simStats.pdmaCalls, simStats.pdmaBytes, (double)simStats.pdmaNs / 1e6);
+	printf("uart:       %" PRIu64 " bytes\n", simStats.uartBytes);
+	printf("u54 wakes:  %" PRIu64 "\n", simStats.u54Wakes);
+
+	if (simOptions.maxLoops && (loops > simOptions.maxLoops)) {
+		printf("REGRESSION: %" PRIu64 " superloop iterations, budget is %" PRIu64 "\n", loops,
+			simOptions.maxLoops);
+		result = false;
+	}
+
+	if (simOptions.maxMs && (bootNs > (uint64_t)simOptions.maxMs * 1000000u)) {
+		printf("REGRESSION: boot took %.3f ms, budget is %u ms\n", (double)bootNs / 1e6,
+			simOptions.maxMs);
+		result = false;
+	}
+
+	if (simOptions.timelineFilename) {
+		fflush(stdout);
+		result = write_timeline_(simOptions.timelineFilename) && result;
+	}
+
+	if (simOptions.snapshotSpec) {
+		result = sim_memory_snapshot_end() && result;
+	}
+
+	sim_storage_exit();
+	sim_memory_exit();
+
+	return result ? EXIT_SUCCESS : EXIT_FAILURE;
+}
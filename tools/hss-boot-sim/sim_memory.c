@@ -0,0 +1,229 @@
+/******************************************************************************************
+ *
+ * MPFS HSS Embedded Software - tools/hss-boot-sim
+ *
+ * Copyright 2019-2025 Microchip FPGA Embedded Systems Solutions.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/*
+ * Simulated physical memory
+ *
+ * The HSS addresses hardware and memory by physical address, so the simulator maps
+ * host memory at the same addresses. DDR is a single memfd, mapped both at its
+ * 64-bit (DDR hi) address and, for its first GiB, at its 32-bit address, so that the
+ * two windows alias as they do on the SoC.
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "sim.h"
+
+#ifndef MAP_FIXED_NOREPLACE
+#	define MAP_FIXED_NOREPLACE 0x100000
+#endif
+
+struct Sim_Region {
+	char const *name;
+	uintptr_t base;
+	size_t size;
+};
+
+static struct Sim_Region regions[8];
+static size_t numRegions = 0u;
+static size_t ddrSize_ = 0u;
+
+//
+// A snapshot window is filled with this before the boot, so that the bytes the boot
+// leaves untouched can be told apart from those it zeroes
+//
+#define SIM_SNAPSHOT_POISON	0xA5u
+
+static struct {
+	char filename[4096];
+	uintptr_t base;
+	size_t size;
+} snapshot;
+
+static bool map_region_(char const *name, uintptr_t base, size_t size, int prot, int flags,
+	int fd, off_t offset)
+{
+	if (numRegions >= ARRAY_SIZE(regions)) {
+		fprintf(stderr, "hss-boot-sim: too many memory regions\n");
+		return false;
+	}
+
+	void *p = mmap((void *)base, size, prot, flags | MAP_FIXED_NOREPLACE, fd, offset);
+
+	if (p == MAP_FAILED) {
+		fprintf(stderr, "hss-boot-sim: cannot map %s at 0x%lx (%zu bytes): %s\n", name,
+			(unsigned long)base, size, strerror(errno));
+		return false;
+	} else if (p != (void *)base) {
+		// older kernels ignore MAP_FIXED_NOREPLACE and treat the address as a hint
+		fprintf(stderr, "hss-boot-sim: %s address 0x%lx is in use\n", name, (unsigned long)base);
+		munmap(p, size);
+		return false;
+	}
+
+	regions[numRegions].name = name;
+	regions[numRegions].base = base;
+	regions[numRegions].size = size;
+	numRegions++;
+
+	return true;
+}
+
+bool sim_memory_init(size_t ddrSize)
+{
+	int const prot = PROT_READ | PROT_WRITE;
+	int const anon = MAP_PRIVATE | MAP_ANONYMOUS;
+
+	bool result = map_region_("CLINT", SIM_CLINT_BASE, SIM_CLINT_SIZE, prot, anon, -1, 0)
+		&& map_region_("SYSREG", SIM_SYSREG_BASE, SIM_SYSREG_SIZE, prot, anon, -1, 0);
+
+	ddrSize_ = ddrSize;
+
+	if (result) {
+		int fd = memfd_create("hss-boot-sim-ddr", 0);
+
+		if ((fd < 0) || ftruncate(fd, (off_t)ddrSize)) {
+			fprintf(stderr, "hss-boot-sim: cannot create DDR: %s\n", strerror(errno));
+			result = false;
+		} else {
+			size_t const ddrLoSize = MIN(ddrSize, SIM_DDR_LO_SIZE);
+
+			result = map_region_("DDR", SIM_DDR_HI_BASE, ddrSize, prot,
+					MAP_SHARED | MAP_NORESERVE, fd, 0)
+				&& map_region_("DDR (32-bit)", SIM_DDR_LO_BASE, ddrLoSize, prot,
+					MAP_SHARED | MAP_NORESERVE, fd, 0);
+		}
+
+		if (fd >= 0) {
+			close(fd);
+		}
+	}
+
+	return result;
+}
+
+bool sim_memory_load_payload(char const *filename, uintptr_t physAddr, size_t *pSize)
+{
+	bool result = false;
+	int fd = open(filename, O_RDONLY);
+	struct stat st;
+
+	if (fd < 0) {
+		fprintf(stderr, "hss-boot-sim: cannot open %s: %s\n", filename, strerror(errno));
+	} else if (fstat(fd, &st) || (st.st_size <= 0)) {
+		fprintf(stderr, "hss-boot-sim: %s is empty\n", filename);
+	} else {
+		size_t const size = (size_t)st.st_size;
+
+		// private and pre-faulted, so that page faults are not measured as part of the boot
+		result = map_region_("payload", physAddr, size, PROT_READ | PROT_WRITE,
+			MAP_PRIVATE | MAP_POPULATE, fd, 0);
+		if (result) {
+			*pSize = size;
+		}
+	}
+
+	if (fd >= 0) {
+		close(fd);
+	}
+
+	return result;
+}
+
+static bool is_ddr_(uintptr_t base, size_t size)
+{
+	size_t const ddrLoSize = MIN(ddrSize_, SIM_DDR_LO_SIZE);
+
+	return ((base >= SIM_DDR_LO_BASE) && (size <= ddrLoSize) && ((base - SIM_DDR_LO_BASE) <= (ddrLoSize - size)))
+		|| ((base >= SIM_DDR_HI_BASE) && (size <= ddrSize_) && ((base - SIM_DDR_HI_BASE) <= (ddrSize_ - size)));
+}
+
+bool sim_memory_snapshot_begin(char const *spec)
+{
+	bool result = false;
+	char const *at = strrchr(spec, '@');
+	size_t const nameLen = at ? (size_t)(at - spec) : 0u;
+
+	if (at && nameLen && (nameLen < sizeof(snapshot.filename))) {
+		char *colon, *end;
+		uint64_t const base = strtoull(at + 1, &colon, 0);
+
+		if ((colon != (at + 1)) && (*colon == ':')) {
+			uint64_t const size = strtoull(colon + 1, &end, 0);
+
+			result = (colon[1] != '\0') && (*end == '\0') && size
+				&& is_ddr_((uintptr_t)base, (size_t)size);
+			snapshot.base = (uintptr_t)base;
+			snapshot.size = (size_t)size;
+		}
+	}
+
+	if (!result) {
+		fprintf(stderr, "hss-boot-sim: bad snapshot '%s', expected <file>@<addr>:<bytes> within DDR\n",
+			spec);
+	} else {
+		memcpy(snapshot.filename, spec, nameLen);
+		snapshot.filename[nameLen] = '\0';
+		memset((void *)snapshot.base, SIM_SNAPSHOT_POISON, snapshot.size);
+	}
+
+	return result;
+}
+
+bool sim_memory_snapshot_end(void)
+{
+	FILE *pFile = fopen(snapshot.filename, "wb");
+	bool result = false;
+
+	if (!pFile) {
+		perror(snapshot.filename);
+	} else {
+		result = (fwrite((void const *)snapshot.base, 1u, snapshot.size, pFile) == snapshot.size);
+		result = !fclose(pFile) && result;
+
+		if (!result) {
+			perror(snapshot.filename);
+		}
+	}
+
+	return result;
+}
+
+void sim_memory_exit(void)
+{
+	while (numRegions) {
+		numRegions--;
+		munmap((void *)regions[numRegions].base, regions[numRegions].size);
+	}
+}
@@ -0,0 +1,376 @@
+/******************************************************************************************
+ *
+ * MPFS HSS Embedded Software - tools/hss-boot-sim
+ *
+ * Copyright 2019-2025 Microchip FPGA Embedded Systems Solutions.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/*
+ * Simulated platform back-ends
+ *
+ * Stand-ins for the parts of the HSS that drive hardware (PDMA, DDR controller, UART,
+ * PMP and APB configuration) and for OpenSBI. The OPENSBI_INIT and GOTO handlers
+ * follow the real services up to the point of jumping into the payload: there, the
+ * hart instead checks that the payload's chunks arrived intact and leaves the
+ * simulation.
+ */
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "config.h"
+#include "sim.h"
+
+#include "hss_debug.h"
+#include "hss_clock.h"
+#include "hss_crc32.h"
+#include "hss_init.h"
+#include "hss_memcpy_via_pdma.h"
+#include "hss_timeline.h"
+#include "hss_trigger.h"
+#include "csr_helper.h"
+#include "ddr_service.h"
+#include "goto_service.h"
+#include "opensbi_service.h"
+#include "ssmb_ipi.h"
+#include "u54_state.h"
+#include "uart_helper.h"
+#include "common/mss_peripherals.h"
+#include "system_startup.h"
+
+struct Sim_HartResult simHartResult[MAX_NUM_HARTS];
+struct Sim_Stats simStats;
+
+extern struct HSS_BootImage *pBootImage;
+
+//
+// UART
+//
+static char consoleBuffer[4096];
+static size_t consoleLen = 0u;
+
+void sim_console_flush(void)
+{
+	if (consoleLen) {
+		if (simOptions.verbose) {
+			(void)!write(STDOUT_FILENO, consoleBuffer, consoleLen);
+		}
+		consoleLen = 0u;
+	}
+}
+
+static void console_write_(char const *p, size_t len)
+{
+	__atomic_add_fetch(&simStats.uartBytes, len, __ATOMIC_RELAXED);
+
+	if (simOptions.uartBaud) {
+		// 8N1, so ten bits per character
+		sim_spin_ns((uint64_t)len * 10u * 1000000000llu / simOptions.uartBaud);
+	}
+
+	if (!simOptions.verbose) {
+		return;
+	}
+
+	// all harts share the console, as they do the UART on the target
+	static int lock = 0;
+	while (__atomic_exchange_n(&lock, 1, __ATOMIC_ACQUIRE)) { ; }
+
+	while (len) {
+		size_t const n = MIN(len, sizeof(consoleBuffer) - consoleLen);
+
+		memcpy(consoleBuffer + consoleLen, p, n);
+		consoleLen += n;
+		p += n;
+		len -= n;
+
+		if ((consoleLen == sizeof(consoleBuffer)) || memchr(consoleBuffer, '\n', consoleLen)) {
+			sim_console_flush();
+		}
+	}
+
+	__atomic_store_n(&lock, 0, __ATOMIC_RELEASE);
+}
+
+int sbi_printf(const char *fmt, ...)
+{
+	char buffer[512];
+	va_list args;
+
+	va_start(args, fmt);
+	int result = vsnprintf(buffer, sizeof(buffer), fmt, args);
+	va_end(args);
+
+	if (result > 0) {
+		console_write_(buffer, MIN((size_t)result, sizeof(buffer) - 1u));
+	}
+
+	return result;
+}
+
+void sbi_puts(const char *buf)
+{
+	console_write_(buf, strlen(buf));
+}
+
+void sbi_putc(char c)
+{
+	console_write_(&c, 1u);
+}
+
+bool uart_getchar(uint8_t *pbuf, int32_t timeout_sec, bool do_sec_tick)
+{
+	// nobody is at the keyboard
+	(void)pbuf;
+	(void)timeout_sec;
+	(void)do_sec_tick;
+
+	return false;
+}
+
+void HSS_Sim_Restart(void);
+void HSS_Sim_Restart(void)
+{
+	sim_console_flush();
+	fprintf(stderr, "hss-boot-sim: HSS requested a restart\n");
+	exit(EXIT_FAILURE);
+}
+
+//
+// PDMA
+//
+void *memcpy_via_pdma(void *dest, void const *src, size_t num_bytes)
+{
+	uint64_t const start = sim_clock_ns();
+
+	memcpy(dest, src, num_bytes);
+
+	if (simOptions.pdmaMBps) {
+		uint64_t const modelNs = (uint64_t)num_bytes * 1000u / simOptions.pdmaMBps;
+		uint64_t const elapsedNs = sim_clock_ns() - start;
+
+		if (modelNs > elapsedNs) {
+			sim_spin_ns(modelNs - elapsedNs);
+		}
+	}
+
+	simStats.pdmaCalls++;
+	simStats.pdmaBytes += num_bytes;
+	simStats.pdmaNs += sim_clock_ns() - start;
+
+	return dest;
+}
+
+//
+// DDR
+//
+uintptr_t HSS_DDR_GetStart(void)
+{
+	return SIM_DDR_LO_BASE;
+}
+
+size_t HSS_DDR_GetSize(void)
+{
+	return MIN(simOptions.ddrSize, SIM_DDR_LO_SIZE);
+}
+
+uintptr_t HSS_DDRHi_GetStart(void)
+{
+	return SIM_DDR_HI_BASE;
+}
+
+size_t HSS_DDRHi_GetSize(void)
+{
+	return simOptions.ddrSize;
+}
+
+bool HSS_DDR_IsAddrInDDR(uintptr_t addr)
+{
+	bool result = (addr >= HSS_DDR_GetStart())
+		&& (addr <= (HSS_DDR_GetStart() + HSS_DDR_GetSize()));
+
+	result |= (addr >= HSS_DDRHi_GetStart())
+		&& (addr <= (HSS_DDRHi_GetStart() + HSS_DDRHi_GetSize()));
+
+	return result;
+}
+
+bool HSS_DDRInit(void)
+{
+	HSS_Timeline_Begin(TIMELINE_DDR_TRAINING, HSS_HART_E51);
+	sim_spin_ns((uint64_t)simOptions.ddrTrainMs * 1000000u);
+	HSS_Timeline_End(TIMELINE_DDR_TRAINING, HSS_HART_E51);
+
+	HSS_Trigger_Notify(EVENT_DDR_TRAINED);
+
+	return true;
+}
+
+enum IPIStatusCode HSS_DDR_Train_IPIHandler(TxId_t transaction_id, enum HSSHartId source,
+	uint32_t immediate_arg, void *p_extended_buffer_in_ddr, void *p_ancilliary_buffer_in_ddr)
+{
+	(void)transaction_id;
+	(void)source;
+	(void)immediate_arg;
+	(void)p_extended_buffer_in_ddr;
+	(void)p_ancilliary_buffer_in_ddr;
+
+	(void)HSS_DDRInit();
+
+	return IPI_IDLE;
+}
+
+//
+// MSS HAL and OpenSBI domains
+//
+uint8_t init_pmp(uint8_t hart_id)
+{
+	(void)hart_id;
+	return 0u;
+}
+
+void mss_set_apb_bus_cr(uint32_t reg_value)
+{
+	(void)reg_value;
+}
+
+uint8_t mss_config_clk_rst(mss_peripherals peripheral, uint8_t hart, PERIPH_RESET_STATE req_state)
+{
+	(void)peripheral;
+	(void)hart;
+	(void)req_state;
+	return 0u;
+}
+
+void clear_bootup_cache_ways(void);
+void clear_bootup_cache_ways(void)
+{
+}
+
+void mpfs_domains_register_hart(int hartid, int boot_hartid)
+{
+	(void)hartid;
+	(void)boot_hartid;
+}
+
+void mpfs_domains_deregister_hart(int hartid)
+{
+	(void)hartid;
+}
+
+void mpfs_domains_register_boot_hart(char *pName, u32 hartMask, int boot_hartid, u32 privMode,
+	void *entryPoint, void *pArg1, bool allow_cold_reboot, bool allow_warm_reboot)
+{
+	(void)pName;
+	(void)hartMask;
+	(void)boot_hartid;
+	(void)privMode;
+	(void)entryPoint;
+	(void)pArg1;
+	(void)allow_cold_reboot;
+	(void)allow_warm_reboot;
+}
+
+//
+// payload hand-over
+//
+static void check_payload_(enum HSSHartId hartId, struct Sim_HartResult *pResult)
+{
+	struct HSS_BootChunkDesc const *pChunk =
+		(struct HSS_BootChunkDesc const *)((char const *)pBootImage + pBootImage->chunkTableOffset);
+
+	for (; pChunk->size; pChunk++) {
+		if ((pResult->entryPoint >= pChunk->execAddr)
+			&& (pResult->entryPoint < (pChunk->execAddr + pChunk->size))) {
+			pResult->entryLoaded = true;
+		}
+
+		if ((pChunk->owner & ~BOOT_FLAG_ANCILLIARY_DATA) == hartId) {
+			if (CRC32_calculate((uint8_t const *)pChunk->execAddr, pChunk->size) == pChunk->crc32) {
+				pResult->chunksGood++;
+			} else {
+				pResult->chunksBad++;
+			}
+		}
+	}
+}
+
+static enum IPIStatusCode enter_payload_(TxId_t transaction_id, enum HSSHartId source,
+	uint32_t immediate_arg, void *p_extended_buffer, void *p_ancilliary_buffer_in_ddr,
+	bool viaOpenSBI)
+{
+	enum IPIStatusCode result = IPI_FAIL;
+	enum HSSHartId const hartId = current_hartid();
+
+	if (source != HSS_HART_E51) { // prohibited by policy
+		mHSS_DEBUG_PRINTF(LOG_ERROR, "u54_%d: request from source %d prohibited by policy\n",
+			hartId, source);
+	} else {
+		// we ain't coming back, so need to ACK here...
+		IPI_Send(source, IPI_MSG_ACK_COMPLETE, transaction_id, IPI_SUCCESS, NULL, NULL);
+		IPI_MessageUpdateStatus(transaction_id, IPI_IDLE); // free the IPI
+
+		struct IPI_Outbox_Msg *pMsg = IPI_DirectionToFirstMsgInQueue(source, hartId);
+
+		for (size_t i = 0u; i < IPI_MAX_NUM_QUEUE_MESSAGES; i++) {
+			if (pMsg->transaction_id == transaction_id) { break; }
+			pMsg++;
+		}
+
+		if (pMsg->transaction_id == transaction_id) {
+			pMsg->msg_type = IPI_MSG_NO_MESSAGE;
+
+			struct Sim_HartResult *pResult = &simHartResult[hartId];
+
+			pResult->viaOpenSBI = viaOpenSBI;
+			pResult->entryPoint = (uintptr_t)p_extended_buffer;
+			pResult->privMode = immediate_arg;
+			pResult->arg1 = (uintptr_t)p_ancilliary_buffer_in_ddr;
+			pResult->entryTimeNs = sim_clock_ns();
+			check_payload_(hartId, pResult);
+			__atomic_store_n(&pResult->entered, true, __ATOMIC_RELEASE);
+
+			HSS_U54_SetState(HSS_State_Running);
+			sim_hart_enter_payload();
+		}
+	}
+
+	return result;
+}
+
+enum IPIStatusCode HSS_OpenSBI_IPIHandler(TxId_t transaction_id, enum HSSHartId source,
+	uint32_t immediate_arg, void *p_extended_buffer, void *p_ancilliary_buffer_in_ddr)
+{
+	return enter_payload_(transaction_id, source, immediate_arg, p_extended_buffer,
+		p_ancilliary_buffer_in_ddr, true);
+}
+
+enum IPIStatusCode HSS_GOTO_IPIHandler(TxId_t transaction_id, enum HSSHartId source,
+	uint32_t immediate_arg, void *p_extended_buffer, void *p_ancilliary_buffer_in_ddr)
+{
+	return enter_payload_(transaction_id, source, immediate_arg, p_extended_buffer,
+		p_ancilliary_buffer_in_ddr, false);
+}
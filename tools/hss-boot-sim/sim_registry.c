@@ -0,0 +1,107 @@
+/******************************************************************************************
+ *
+ * MPFS HSS Embedded Software - tools/hss-boot-sim
+ *
+ * Copyright 2019-2025 Microchip FPGA Embedded Systems Solutions.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/*
+ * Simulator registry
+ *
+ * The simulator's equivalent of application/hart0/hss_registry.c: the IPI handlers,
+ * state machines and init functions making up the simulated HSS. Only the services
+ * on the boot path are built in.
+ */
+
+#include "config.h"
+#include "hss_types.h"
+
+#include "ssmb_ipi.h"
+#include "ipi_poll_service.h"
+#include "hss_boot_service.h"
+#include "ddr_service.h"
+#include "goto_service.h"
+#include "opensbi_service.h"
+#include "startup_service.h"
+
+#include "hss_debug.h"
+#include "hss_registry.h"
+#include "hss_init.h"
+#include "hss_boot_pmp.h"
+
+static enum IPIStatusCode HSS_Null_IPIHandler(TxId_t transaction_id, enum HSSHartId source,
+	uint32_t immediate_arg, void *p_extended_buffer_in_ddr, void *p_ancilliary_buffer_in_ddr)
+{
+	(void)transaction_id;
+	(void)source;
+	(void)immediate_arg;
+	(void)p_extended_buffer_in_ddr;
+	(void)p_ancilliary_buffer_in_ddr;
+
+	mHSS_DEBUG_PRINTF(LOG_NORMAL, "%s() called -- ignoring\n", __func__);
+	return IPI_SUCCESS;
+}
+
+// indexed by message type, so must be in the same order as enum IPIMessagesEnum
+const struct IPI_Handler ipiRegistry[] = {
+	{ IPI_MSG_NO_MESSAGE,        HSS_Null_IPIHandler },
+	{ IPI_MSG_BOOT_REQUEST,      HSS_Boot_IPIHandler },
+	{ IPI_MSG_PMP_SETUP,         HSS_Boot_PMPSetupHandler },
+	{ IPI_MSG_SPI_XFER,          HSS_Null_IPIHandler },
+	{ IPI_MSG_NET_RXPOLL,        HSS_Null_IPIHandler },
+	{ IPI_MSG_NET_TX,            HSS_Null_IPIHandler },
+	{ IPI_MSG_SCATTERGATHER_DMA, HSS_Null_IPIHandler },
+	{ IPI_MSG_WDOG_INIT,         HSS_Null_IPIHandler },
+	{ IPI_MSG_GPIO_SET,          HSS_Null_IPIHandler },
+	{ IPI_MSG_UART_TX,           HSS_Null_IPIHandler },
+	{ IPI_MSG_UART_POLL_RX,      HSS_Null_IPIHandler },
+	{ IPI_MSG_POWERMODE,         HSS_Null_IPIHandler },
+	{ IPI_MSG_ACK_PENDING,       IPI_ACK_IPIHandler },
+	{ IPI_MSG_ACK_COMPLETE,      IPI_ACK_IPIHandler },
+	{ IPI_MSG_HALT,              HSS_Null_IPIHandler },
+	{ IPI_MSG_CONTINUE,          HSS_Null_IPIHandler },
+	{ IPI_MSG_GOTO,              HSS_GOTO_IPIHandler },
+	{ IPI_MSG_OPENSBI_INIT,      HSS_OpenSBI_IPIHandler },
+	{ IPI_MSG_SCRUB,             HSS_Null_IPIHandler },
+	{ IPI_MSG_DDR_TRAIN,         HSS_DDR_Train_IPIHandler },
+	{ IPI_MSG_MEMTEST,           HSS_Null_IPIHandler },
+};
+const size_t spanOfIpiRegistry = ARRAY_SIZE(ipiRegistry);
+
+struct StateMachine /*@null@*/ * const pGlobalStateMachines[] = {
+	&ipi_poll_service,
+	&boot_service1,
+	&boot_service2,
+	&boot_service3,
+	&boot_service4,
+	&startup_service,
+};
+const size_t spanOfPGlobalStateMachines = ARRAY_SIZE(pGlobalStateMachines);
+
+const struct InitFunction /*@null@*/ globalInitFunctions[] = {
+	// Name                            FunctionPointer                Halt   Restart
+	{ "IPI_QueuesInit",                IPI_QueuesInit,                false, false },
+	{ "HSS_PMP_Init",                  HSS_PMP_Init,                  false, false },
+	{ "HSS_DDRInit",                   HSS_DDRInit,                   false, false },
+};
+const size_t spanOfGlobalInitFunctions = ARRAY_SIZE(globalInitFunctions);
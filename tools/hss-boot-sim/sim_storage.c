@@ -0,0 +1,988 @@
+/******************************************************************************************
+ *
+ * MPFS HSS Embedded Software - tools/hss-boot-sim
+ *
+ * Copyright 2019-2025 Microchip FPGA Embedded Systems Solutions.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+
+/*
+ * Simulated boot storage
+ *
+ * File-backed models of the devices behind the HSS boot sources: an SD card or eMMC
+ * behind the MSS MMC driver, a QSPI NAND behind the Winbond W25N01GV driver, and the
+ * system controller's SPI flash behind its SPI copy service. The real MMC, QSPI and
+ * GPT code drives them, so that the boot loader, partition table parsing and the QSPI
+ * cache run as they do on target.
+ *
+ * A device's contents are loaded from a disk image, which is never written back. Each
+ * command costs a fixed latency plus its transfer time at the model's throughput, and
+ * each erase block erased costs a fixed time. Erase blocks can be marked bad. Every
+ * command can be recorded to a trace, and a trace replayed against another model to
+ * see what the same accesses would cost there.
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "config.h"
+#include "sim.h"
+
+#include "hss_boot_init.h"
+#include "mss_io_config.h"
+#include "mss_mmc.h"
+#include "mss_sys_services.h"
+#include "winbond_w25n01gv.h"
+
+// the generic storage API used by the USB mass storage service, in hss_boot_init.c
+bool HSS_Storage_Init(void);
+bool HSS_Storage_ReadBlock(void *pDest, size_t srcOffset, size_t byteCount);
+bool HSS_Storage_WriteBlock(size_t dstOffset, void *pSrc, size_t byteCount);
+void HSS_Storage_GetInfo(uint32_t *pBlockSize, uint32_t *pEraseSize, uint32_t *pBlockCount);
+void HSS_Storage_FlushWriteBuffer(void);
+
+enum Sim_StorageType {
+	SIM_STORAGE_MMC,
+	SIM_STORAGE_QSPI_NAND,
+	SIM_STORAGE_SPI,
+};
+
+struct Sim_StorageModel {
+	char const *name;
+	enum Sim_StorageType type;
+	uint8_t cardType;		// MMC only, the card type the MMC service must ask for
+	uint8_t erased;			// value of erased, or never written, bytes
+	bool fixedGeometry;		// the HSS identifies the part, and knows its geometry
+	uint32_t pageSize;		// flash read and program unit, one command each
+	uint32_t eraseSize;
+	uint32_t sizeMiB;
+	uint32_t initUs;
+	uint32_t cmdUs;
+	uint32_t readMBps;
+	uint32_t writeMBps;
+	uint32_t eraseUs;		// per erase block, and for MMC per erase block written
+};
+
+//
+// Rough figures for typical parts, to be overridden with -M where better ones are known:
+// a high speed SD card, an HS200 eMMC, the W25N01GV (tRD 60us, tPROG 250us, tBERS 2ms)
+// and a NOR flash read through the system controller's mailbox.
+//
+static struct Sim_StorageModel const models[] = {
+	// name       type                   card type             erased fixed  page   erase        MiB   init    cmd   read write erase
+	{ "sd",        SIM_STORAGE_MMC,       MSS_MMC_CARD_TYPE_SD,  0x00u, false, 512u,  4u << 20,   64u,  20000u, 100u, 20u,  10u,  0u },
+	{ "emmc",      SIM_STORAGE_MMC,       MSS_MMC_CARD_TYPE_MMC, 0x00u, false, 512u,  512u << 10, 64u,  10000u, 50u,  150u, 40u,  0u },
+	{ "qspi-nand", SIM_STORAGE_QSPI_NAND, 0u,                    0xFFu, true,  2048u, 128u << 10, 128u, 1000u,  60u,  40u,  8u,   2000u },
+	{ "spi",       SIM_STORAGE_SPI,       0u,                    0xFFu, false, 256u,  4u << 10,   16u,  0u,     500u, 5u,   1u,   45000u },
+};
+
+enum Sim_StorageOp {
+	SIM_STORAGE_OP_INIT,
+	SIM_STORAGE_OP_READ,
+	SIM_STORAGE_OP_WRITE,
+	SIM_STORAGE_OP_ERASE,
+	SIM_STORAGE_OP_SCAN,
+	SIM_STORAGE_NUM_OPS
+};
+
+static char const * const opNames[SIM_STORAGE_NUM_OPS] = {
+	"init", "read", "write", "erase", "scan"
+};
+
+struct Sim_StorageOpStats {
+	uint64_t count;
+	uint64_t bytes;
+	uint64_t ns;
+};
+
+#define SIM_STORAGE_MAX_PARAMS		16u
+#define SIM_STORAGE_MAX_BAD_BLOCKS	64u
+#define SIM_MMC_SECTOR_SIZE		512u
+#define SIM_MMC_MAX_TRANSFER		((32u << 20) - SIM_MMC_SECTOR_SIZE) // as the MSS MMC driver
+#define SIM_USB_TRANSFER_SIZE		32768u // SD_RD_WR_SIZE in the USB mass storage service
+
+static struct {
+	char const *spec;
+	char const *params[SIM_STORAGE_MAX_PARAMS];
+	size_t numParams;
+	bool configured;
+
+	struct Sim_StorageModel model;
+	char const *imageFilename;
+	size_t imageSize;
+	uint8_t *pData;
+	size_t size;
+
+	uint32_t badBlocks[SIM_STORAGE_MAX_BAD_BLOCKS];
+	size_t numBadBlocks;
+
+	FILE *pTrace;
+	struct Sim_StorageOpStats stats[SIM_STORAGE_NUM_OPS];
+
+	// MMC: the MSS MMC driver's transfer state, and the transfer in flight
+	bool mmcInitialized;
+	mss_mmc_status_t mmcState;
+	struct {
+		uint8_t *pMemory;
+		uint64_t offset;
+		size_t size;
+		bool write;
+		bool fail;
+		uint64_t doneNs;
+	} mmcTransfer;
+} storage = {
+	.mmcState = MSS_MMC_NOT_INITIALISED,
+};
+
+//
+// cost model
+//
+static uint64_t transfer_ns_(uint64_t bytes, uint32_t mbps)
+{
+	return mbps ? (bytes * 1000u / mbps) : 0u;
+}
+
+static uint64_t blocks_touched_(uint64_t offset, uint64_t size, uint32_t blockSize)
+{
+	return size ? ((offset + size - 1u) / blockSize - offset / blockSize + 1u) : 0u;
+}
+
+static uint64_t cost_ns_(struct Sim_StorageModel const *pModel, enum Sim_StorageOp op,
+	uint64_t offset, uint64_t size)
+{
+	uint64_t const cmdNs = (uint64_t)pModel->cmdUs * 1000u;
+	uint64_t const eraseNs = (uint64_t)pModel->eraseUs * 1000u;
+
+	// NAND reads and programs one page per command, the others a whole transfer
+	uint64_t const commands = (pModel->type == SIM_STORAGE_QSPI_NAND) ?
+		blocks_touched_(offset, size, pModel->pageSize) : 1u;
+	uint64_t result = 0u;
+
+	switch (op) {
+	case SIM_STORAGE_OP_INIT:
+		result = (uint64_t)pModel->initUs * 1000u;
+		break;
+
+	case SIM_STORAGE_OP_READ:
+		result = commands * cmdNs + transfer_ns_(size, pModel->readMBps);
+		break;
+
+	case SIM_STORAGE_OP_WRITE:
+		result = commands * cmdNs + transfer_ns_(size, pModel->writeMBps);
+		if (pModel->type == SIM_STORAGE_MMC) { // cards erase as they write
+			result += blocks_touched_(offset, size, pModel->eraseSize) * eraseNs;
+		}
+		break;
+
+	case SIM_STORAGE_OP_ERASE:
+		result = blocks_touched_(offset, size, pModel->eraseSize) * eraseNs;
+		break;
+
+	case SIM_STORAGE_OP_SCAN: // reads the bad block marker of each block
+		result = blocks_touched_(offset, size, pModel->eraseSize) * cmdNs;
+		break;
+
+	default:
+		break;
+	}
+
+	return result;
+}
+
+static uint64_t account_(enum Sim_StorageOp op, uint64_t offset, uint64_t size)
+{
+	uint64_t const costNs = cost_ns_(&storage.model, op, offset, size);
+
+	storage.stats[op].count++;
+	storage.stats[op].bytes += size;
+	storage.stats[op].ns += costNs;
+
+	if (storage.pTrace) {
+		fprintf(storage.pTrace, "%" PRIu64 " %s 0x%" PRIx64 " %" PRIu64 " %" PRIu64 "\n",
+			sim_clock_ns(), opNames[op], offset, size, costNs);
+	}
+
+	return costNs;
+}
+
+static void spin_until_(uint64_t startNs, uint64_t costNs)
+{
+	uint64_t const elapsedNs = sim_clock_ns() - startNs;
+
+	if (costNs > elapsedNs) {
+		sim_spin_ns(costNs - elapsedNs);
+	}
+}
+
+static bool in_range_(uint64_t offset, uint64_t size)
+{
+	return (offset <= storage.size) && (size <= (storage.size - offset));
+}
+
+static bool is_bad_(uint64_t offset, uint64_t size)
+{
+	bool result = false;
+
+	for (size_t i = 0u; size && (i < storage.numBadBlocks); i++) {
+		uint64_t const badOffset = (uint64_t)storage.badBlocks[i] * storage.model.eraseSize;
+
+		if ((badOffset < (offset + size)) && (offset < (badOffset + storage.model.eraseSize))) {
+			result = true;
+		}
+	}
+
+	return result;
+}
+
+static bool is_model_(enum Sim_StorageType type)
+{
+	return storage.pData && (storage.model.type == type);
+}
+
+//
+// configuration
+//
+bool sim_storage_select(char const *spec)
+{
+	storage.spec = spec;
+
+	return true;
+}
+
+bool sim_storage_set(char const *param)
+{
+	bool result = storage.numParams < SIM_STORAGE_MAX_PARAMS;
+
+	if (result) {
+		storage.params[storage.numParams] = param;
+		storage.numParams++;
+	} else {
+		fprintf(stderr, "hss-boot-sim: too many storage parameters\n");
+	}
+
+	return result;
+}
+
+static bool parse_u32_(char const *arg, uint32_t *pValue)
+{
+	char *end;
+	unsigned long long value = strtoull(arg, &end, 0);
+
+	*pValue = (uint32_t)value;
+	return (*arg != '\0') && (*end == '\0') && (value <= UINT32_MAX);
+}
+
+static bool parse_bad_blocks_(char const *list)
+{
+	bool result = true;
+	char const *p = list;
+
+	while (result && *p) {
+		char *end;
+		unsigned long long value = strtoull(p, &end, 0);
+
+		result = (end != p) && ((*end == ',') || (*end == '\0')) && (value <= UINT32_MAX)
+			&& (storage.numBadBlocks < SIM_STORAGE_MAX_BAD_BLOCKS);
+		if (result) {
+			storage.badBlocks[storage.numBadBlocks] = (uint32_t)value;
+			storage.numBadBlocks++;
+			p = (*end == ',') ? (end + 1) : end;
+		}
+	}
+
+	return result;
+}
+
+static bool apply_param_(char const *param)
+{
+	static const struct {
+		char const *key;
+		size_t offset;
+		bool geometry;
+	} keys[] = {
+		{ "size-mib",   offsetof(struct Sim_StorageModel, sizeMiB),   true },
+		{ "erase-size", offsetof(struct Sim_StorageModel, eraseSize), true },
+		{ "init-us",    offsetof(struct Sim_StorageModel, initUs),    false },
+		{ "cmd-us",     offsetof(struct Sim_StorageModel, cmdUs),     false },
+		{ "read-mbps",  offsetof(struct Sim_StorageModel, readMBps),  false },
+		{ "write-mbps", offsetof(struct Sim_StorageModel, writeMBps), false },
+		{ "erase-us",   offsetof(struct Sim_StorageModel, eraseUs),   false },
+	};
+
+	bool result = false;
+	char const *value = strchr(param, '=');
+	size_t const keyLen = value ? (size_t)(value - param) : 0u;
+
+	if (value && (keyLen == 3u) && !strncmp(param, "bad", keyLen)) {
+		result = parse_bad_blocks_(value + 1);
+	} else if (value) {
+		for (size_t i = 0u; i < ARRAY_SIZE(keys); i++) {
+			if ((strlen(keys[i].key) == keyLen) && !strncmp(param, keys[i].key, keyLen)) {
+				if (keys[i].geometry && storage.model.fixedGeometry) {
+					fprintf(stderr, "hss-boot-sim: %s geometry is fixed\n", storage.model.name);
+				} else {
+					result = parse_u32_(value + 1,
+						(uint32_t *)((char *)&storage.model + keys[i].offset));
+				}
+				break;
+			}
+		}
+	}
+
+	if (!result) {
+		fprintf(stderr, "hss-boot-sim: bad storage parameter '%s'\n", param);
+	}
+
+	return result;
+}
+
+static bool configure_(void)
+{
+	if (storage.configured) {
+		return true;
+	}
+
+	bool result = false;
+	char const *colon = strchr(storage.spec, ':');
+	size_t const nameLen = colon ? (size_t)(colon - storage.spec) : strlen(storage.spec);
+
+	for (size_t i = 0u; i < ARRAY_SIZE(models); i++) {
+		if ((strlen(models[i].name) == nameLen) && !strncmp(storage.spec, models[i].name, nameLen)) {
+			storage.model = models[i];
+			result = true;
+		}
+	}
+
+	if (!result) {
+		fprintf(stderr, "hss-boot-sim: unknown storage model in '%s'\n", storage.spec);
+	}
+
+	for (size_t i = 0u; result && (i < storage.numParams); i++) {
+		result = apply_param_(storage.params[i]);
+	}
+
+	if (result && (!storage.model.eraseSize || (storage.model.eraseSize % storage.model.pageSize))) {
+		fprintf(stderr, "hss-boot-sim: erase size must be a multiple of %u\n",
+			storage.model.pageSize);
+		result = false;
+	}
+
+	storage.imageFilename = (colon && colon[1]) ? (colon + 1) : NULL;
+	storage.configured = result;
+
+	return result;
+}
+
+static bool load_image_(void)
+{
+	bool result = true;
+	int fd = -1;
+	struct stat st;
+
+	storage.size = (size_t)storage.model.sizeMiB << 20;
+
+	if (storage.imageFilename) {
+		fd = open(storage.imageFilename, O_RDONLY);
+
+		if ((fd < 0) || fstat(fd, &st)) {
+			fprintf(stderr, "hss-boot-sim: cannot open %s: %s\n", storage.imageFilename,
+				strerror(errno));
+			result = false;
+		} else {
+			storage.imageSize = (size_t)st.st_size;
+
+			if (storage.imageSize > storage.size) {
+				if (storage.model.fixedGeometry) {
+					fprintf(stderr, "hss-boot-sim: %s is larger than the %u MiB %s\n",
+						storage.imageFilename, storage.model.sizeMiB, storage.model.name);
+					result = false;
+				} else { // a bigger card
+					storage.size = (storage.imageSize + storage.model.eraseSize - 1u)
+						/ storage.model.eraseSize * storage.model.eraseSize;
+				}
+			}
+		}
+	}
+
+	if (result) {
+		storage.pData = mmap(NULL, storage.size, PROT_READ | PROT_WRITE,
+			MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+
+		if (storage.pData == MAP_FAILED) {
+			fprintf(stderr, "hss-boot-sim: cannot allocate %zu bytes of %s: %s\n", storage.size,
+				storage.model.name, strerror(errno));
+			storage.pData = NULL;
+			result = false;
+		} else if (storage.model.erased) {
+			memset(storage.pData, storage.model.erased, storage.size);
+		}
+	}
+
+	for (size_t loaded = 0u; result && (loaded < storage.imageSize); ) {
+		ssize_t const n = read(fd, storage.pData + loaded, storage.imageSize - loaded);
+
+		if (n <= 0) {
+			fprintf(stderr, "hss-boot-sim: cannot read %s: %s\n", storage.imageFilename,
+				n ? strerror(errno) : "unexpected end of file");
+			result = false;
+		} else {
+			loaded += (size_t)n;
+		}
+	}
+
+	if (fd >= 0) {
+		close(fd);
+	}
+
+	return result;
+}
+
+bool sim_storage_init(char const *traceFilename)
+{
+	bool result = configure_() && load_image_();
+
+	for (size_t i = 0u; result && (i < storage.numBadBlocks); i++) {
+		if (storage.badBlocks[i] >= (storage.size / storage.model.eraseSize)) {
+			fprintf(stderr, "hss-boot-sim: bad block %u is beyond the end of the %s\n",
+				storage.badBlocks[i], storage.model.name);
+			result = false;
+		}
+	}
+
+	if (result && traceFilename) {
+		storage.pTrace = fopen(traceFilename, "w");
+
+		if (!storage.pTrace) {
+			perror(traceFilename);
+			result = false;
+		} else {
+			fprintf(storage.pTrace, "# hss-boot-sim storage trace: %s, %s\n", storage.model.name,
+				storage.imageFilename ? storage.imageFilename : "blank");
+			fprintf(storage.pTrace, "# time-ns op offset bytes cost-ns\n");
+		}
+	}
+
+	return result;
+}
+
+void sim_storage_select_boot_source(void)
+{
+	switch (storage.model.type) {
+	case SIM_STORAGE_MMC:
+		if (storage.model.cardType == MSS_MMC_CARD_TYPE_SD) {
+			HSS_BootSelectSDCARD();
+		} else {
+			HSS_BootSelectEMMC();
+		}
+		break;
+
+	case SIM_STORAGE_QSPI_NAND:
+		HSS_BootSelectQSPI();
+		break;
+
+	case SIM_STORAGE_SPI:
+		HSS_BootSelectSPI();
+		break;
+
+	default:
+		break;
+	}
+}
+
+void sim_storage_exit(void)
+{
+	if (storage.pTrace) {
+		fclose(storage.pTrace);
+		storage.pTrace = NULL;
+	}
+
+	if (storage.pData) {
+		munmap(storage.pData, storage.size);
+		storage.pData = NULL;
+	}
+}
+
+//
+// MSS MMC driver
+//
+mss_mmc_status_t MSS_MMC_init(const mss_mmc_cfg_t *cfg)
+{
+	uint64_t const startNs = sim_clock_ns();
+	mss_mmc_status_t result = MSS_MMC_INIT_FAILURE;
+
+	storage.mmcInitialized = false;
+
+	// only a card of the type asked for answers
+	if (is_model_(SIM_STORAGE_MMC) && (cfg->card_type == storage.model.cardType)) {
+		spin_until_(startNs, account_(SIM_STORAGE_OP_INIT, 0u, 0u));
+
+		storage.mmcInitialized = true;
+		storage.mmcState = MSS_MMC_TRANSFER_SUCCESS;
+		result = MSS_MMC_INIT_SUCCESS;
+	}
+
+	return result;
+}
+
+void MSS_MMC_get_info(uint16_t *sector_size, uint32_t *sector_count)
+{
+	*sector_size = SIM_MMC_SECTOR_SIZE;
+	*sector_count = (uint32_t)(storage.size / SIM_MMC_SECTOR_SIZE);
+}
+
+static mss_mmc_status_t mmc_start_transfer_(uint8_t *pMemory, uint32_t sector, uint32_t size,
+	bool write)
+{
+	mss_mmc_status_t result;
+
+	if (!storage.mmcInitialized) {
+		result = MSS_MMC_NOT_INITIALISED;
+	} else if (storage.mmcState == MSS_MMC_TRANSFER_IN_PROGRESS) {
+		result = MSS_MMC_TRANSFER_IN_PROGRESS;
+	} else if (!size || (size % SIM_MMC_SECTOR_SIZE) || (size > SIM_MMC_MAX_TRANSFER) || !pMemory) {
+		result = storage.mmcState = MSS_MMC_INVALID_PARAMETER;
+	} else {
+		uint64_t const offset = (uint64_t)sector * SIM_MMC_SECTOR_SIZE;
+		uint64_t const startNs = sim_clock_ns();
+
+		storage.mmcTransfer.pMemory = pMemory;
+		storage.mmcTransfer.offset = offset;
+		storage.mmcTransfer.size = size;
+		storage.mmcTransfer.write = write;
+		storage.mmcTransfer.fail = !in_range_(offset, size) || is_bad_(offset, size);
+		storage.mmcTransfer.doneNs = startNs
+			+ account_(write ? SIM_STORAGE_OP_WRITE : SIM_STORAGE_OP_READ, offset, size);
+
+		result = storage.mmcState = MSS_MMC_TRANSFER_IN_PROGRESS;
+	}
+
+	return result;
+}
+
+uint8_t PLIC_mmc_main_IRQHandler(void)
+{
+	// the data moves when the transfer completes, as with the controller's DMA
+	if ((storage.mmcState == MSS_MMC_TRANSFER_IN_PROGRESS)
+		&& (sim_clock_ns() >= storage.mmcTransfer.doneNs)) {
+		if (storage.mmcTransfer.fail) {
+			storage.mmcState = MSS_MMC_TRANSFER_FAIL;
+		} else {
+			uint8_t *pDevice = storage.pData + storage.mmcTransfer.offset;
+
+			if (storage.mmcTransfer.write) {
+				memcpy(pDevice, storage.mmcTransfer.pMemory, storage.mmcTransfer.size);
+			} else {
+				memcpy(storage.mmcTransfer.pMemory, pDevice, storage.mmcTransfer.size);
+			}
+			storage.mmcState = MSS_MMC_TRANSFER_SUCCESS;
+		}
+	}
+
+	return (uint8_t)storage.mmcState;
+}
+
+mss_mmc_status_t MSS_MMC_get_transfer_status(void)
+{
+	return storage.mmcState;
+}
+
+mss_mmc_status_t MSS_MMC_sdma_read(uint32_t src, uint8_t *dest, uint32_t size)
+{
+	return mmc_start_transfer_(dest, src, size, false);
+}
+
+mss_mmc_status_t MSS_MMC_sdma_write(const uint8_t *src, uint32_t dest, uint32_t size)
+{
+	return mmc_start_transfer_((uint8_t *)src, dest, size, true);
+}
+
+mss_mmc_status_t MSS_MMC_single_block_write(const uint32_t *src_addr, uint32_t dst_addr)
+{
+	mss_mmc_status_t result = mmc_start_transfer_((uint8_t *)src_addr, dst_addr,
+		SIM_MMC_SECTOR_SIZE, true);
+
+	while (result == MSS_MMC_TRANSFER_IN_PROGRESS) {
+		result = PLIC_mmc_main_IRQHandler();
+	}
+
+	return result;
+}
+
+uint8_t mss_does_xml_ver_support_switch(void)
+{
+	return 1u;
+}
+
+uint8_t switch_mssio_config(MSS_IO_OPTIONS option)
+{
+	(void)option;
+	return 1u;
+}
+
+uint8_t switch_demux_using_fabric_ip(MSS_IO_OPTIONS option)
+{
+	(void)option;
+	return 1u;
+}
+
+//
+// Winbond W25N01GV QSPI NAND driver
+//
+void Flash_init(mss_qspi_io_format io_format)
+{
+	(void)io_format;
+}
+
+void Flash_readid(uint8_t *buf)
+{
+	static uint8_t const jedecId[] = { 0xEFu, 0xAAu, 0x21u };
+
+	if (is_model_(SIM_STORAGE_QSPI_NAND)) {
+		uint64_t const startNs = sim_clock_ns();
+
+		memcpy(buf, jedecId, sizeof(jedecId));
+		spin_until_(startNs, account_(SIM_STORAGE_OP_INIT, 0u, 0u));
+	} else { // nothing on the bus
+		memset(buf, 0xFF, sizeof(jedecId));
+	}
+}
+
+uint8_t Flash_read(uint8_t *buf, uint32_t addr, uint32_t len)
+{
+	uint64_t const startNs = sim_clock_ns();
+	uint8_t result = 1u;
+
+	if (is_model_(SIM_STORAGE_QSPI_NAND) && in_range_(addr, len)) {
+		memcpy(buf, storage.pData + addr, len);
+		spin_until_(startNs, account_(SIM_STORAGE_OP_READ, addr, len));
+		result = 0u;
+	}
+
+	return result;
+}
+
+uint8_t Flash_program(uint8_t *buf, uint32_t addr, uint32_t len)
+{
+	uint64_t const startNs = sim_clock_ns();
+	uint8_t result = 1u;
+
+	if (is_model_(SIM_STORAGE_QSPI_NAND) && in_range_(addr, len)) {
+		uint64_t const costNs = account_(SIM_STORAGE_OP_WRITE, addr, len);
+
+		if (!is_bad_(addr, len)) {
+			// programming can only clear bits, so unerased pages end up corrupt
+			for (uint32_t i = 0u; i < len; i++) {
+				storage.pData[addr + i] &= buf[i];
+			}
+			result = 0u;
+		}
+		spin_until_(startNs, costNs);
+	}
+
+	return result;
+}
+
+uint8_t Flash_erase_block(uint16_t block_nb)
+{
+	uint64_t const startNs = sim_clock_ns();
+	uint64_t const offset = (uint64_t)block_nb * storage.model.eraseSize;
+	uint8_t result = 1u;
+
+	if (is_model_(SIM_STORAGE_QSPI_NAND) && in_range_(offset, storage.model.eraseSize)) {
+		uint64_t const costNs = account_(SIM_STORAGE_OP_ERASE, offset, storage.model.eraseSize);
+
+		if (!is_bad_(offset, storage.model.eraseSize)) {
+			memset(storage.pData + offset, storage.model.erased, storage.model.eraseSize);
+			result = 0u;
+		}
+		spin_until_(startNs, costNs);
+	}
+
+	return result;
+}
+
+uint8_t Flash_erase(void)
+{
+	uint8_t result = 1u;
+
+	if (is_model_(SIM_STORAGE_QSPI_NAND)) {
+		result = 0u;
+		for (size_t block = 0u; block < (storage.size / storage.model.eraseSize); block++) {
+			result |= Flash_erase_block((uint16_t)block);
+		}
+	}
+
+	return result;
+}
+
+uint32_t Flash_scan_for_bad_blocks(uint16_t *buf)
+{
+	uint32_t result = 0u;
+
+	if (is_model_(SIM_STORAGE_QSPI_NAND)) {
+		uint64_t const startNs = sim_clock_ns();
+
+		// in ascending order, as the QSPI service expects
+		for (uint32_t block = 0u; block < (storage.size / storage.model.eraseSize); block++) {
+			if (is_bad_((uint64_t)block * storage.model.eraseSize, 1u)) {
+				buf[result] = (uint16_t)block;
+				result++;
+			}
+		}
+
+		spin_until_(startNs, account_(SIM_STORAGE_OP_SCAN, 0u, storage.size));
+	}
+
+	return result;
+}
+
+//
+// system controller SPI copy service
+//
+void MSS_SYS_select_service_mode(uint8_t sys_service_mode,
+	mss_sys_service_handler_t mss_sys_service_interrupt_handler)
+{
+	(void)sys_service_mode;
+	(void)mss_sys_service_interrupt_handler;
+}
+
+uint16_t MSS_SYS_spi_copy(uint64_t mss_dest_addr, uint32_t mss_spi_flash, uint32_t n_bytes,
+	uint8_t options, uint16_t mb_offset)
+{
+	uint64_t const startNs = sim_clock_ns();
+	uint16_t result = 1u;
+
+	(void)options;
+	(void)mb_offset;
+
+	if (is_model_(SIM_STORAGE_SPI)) {
+		uint64_t const costNs = account_(SIM_STORAGE_OP_READ, mss_spi_flash, n_bytes);
+
+		if (in_range_(mss_spi_flash, n_bytes) && !is_bad_(mss_spi_flash, n_bytes)) {
+			memcpy((void *)(uintptr_t)mss_dest_addr, storage.pData + mss_spi_flash, n_bytes);
+			result = 0u;
+		}
+		spin_until_(startNs, costNs);
+	}
+
+	return result;
+}
+
+//
+// USB mass storage: writes a file to the boot device as a USB host would through the
+// HSS's USB mass storage service, in the same transfers, and reads it back to check
+//
+bool sim_storage_usb_write(char const *spec)
+{
+	bool result = true;
+	char filename[4096];
+	uint64_t offset = 0u;
+	char const *at = strrchr(spec, '@');
+	size_t const nameLen = at ? (size_t)(at - spec) : strlen(spec);
+
+	if (nameLen >= sizeof(filename)) {
+		result = false;
+	} else {
+		memcpy(filename, spec, nameLen);
+		filename[nameLen] = '\0';
+	}
+
+	if (result && at) {
+		char *end;
+
+		offset = strtoull(at + 1, &end, 0);
+		result = (at[1] != '\0') && (*end == '\0');
+	}
+
+	if (!result) {
+		fprintf(stderr, "hss-boot-sim: bad write '%s', expected <file>[@<offset>]\n", spec);
+		return false;
+	}
+
+	if (storage.model.type == SIM_STORAGE_SPI) {
+		fprintf(stderr, "hss-boot-sim: the %s boot source cannot be written\n", storage.model.name);
+		return false;
+	}
+
+	FILE *pFile = fopen(filename, "rb");
+	if (!pFile) {
+		perror(filename);
+		return false;
+	}
+
+	static uint8_t buffer[SIM_USB_TRANSFER_SIZE] __attribute__((aligned(8)));
+	static uint8_t readBack[SIM_USB_TRANSFER_SIZE] __attribute__((aligned(8)));
+	uint32_t blockSize = 0u, eraseSize = 0u, blockCount = 0u;
+	uint64_t const startNs = sim_clock_ns();
+
+	result = HSS_Storage_Init();
+	if (result) {
+		HSS_Storage_GetInfo(&blockSize, &eraseSize, &blockCount);
+		result = blockSize && !(offset % blockSize);
+	}
+
+	// the host writes whole blocks, so pad the last one
+	size_t total = 0u;
+	size_t n;
+	while (result && (n = fread(buffer, 1u, sizeof(buffer), pFile))) {
+		size_t const padded = (n + blockSize - 1u) / blockSize * blockSize;
+
+		memset(buffer + n, 0, padded - n);
+		result = ((offset + total + padded) <= ((uint64_t)blockSize * blockCount))
+			&& HSS_Storage_WriteBlock((size_t)(offset + total), buffer, padded);
+		total += n;
+	}
+	if (result) {
+		HSS_Storage_FlushWriteBuffer(); // when the host releases the device
+	}
+	uint64_t const writeNs = sim_clock_ns() - startNs;
+
+	rewind(pFile);
+	size_t checked = 0u;
+	while (result && (n = fread(buffer, 1u, sizeof(buffer), pFile))) {
+		result = HSS_Storage_ReadBlock(readBack, (size_t)(offset + checked), n)
+			&& !memcmp(buffer, readBack, n);
+		checked += n;
+	}
+	fclose(pFile);
+
+	printf("usb write:  %s, %zu bytes at 0x%" PRIx64 ", %.3f ms, %s\n", filename, total, offset,
+		(double)writeNs / 1e6, result ? "verified" : "FAILED");
+
+	// the storage report covers the boot only, while the trace has both
+	memset(storage.stats, 0, sizeof(storage.stats));
+
+	return result;
+}
+
+//
+// reporting and replay
+//
+static void report_ops_(struct Sim_StorageOpStats const *pStats,
+	struct Sim_StorageOpStats const *pModelled)
+{
+	for (int op = 0; op < SIM_STORAGE_NUM_OPS; op++) {
+		if (!pStats[op].count) {
+			continue;
+		}
+
+		printf("  %-6s %10" PRIu64 " commands %12" PRIu64 " bytes %10.3f ms", opNames[op],
+			pStats[op].count, pStats[op].bytes, (double)pStats[op].ns / 1e6);
+		if (pModelled) {
+			printf(" -> %10.3f ms", (double)pModelled[op].ns / 1e6);
+		}
+		printf("\n");
+	}
+}
+
+static void print_model_(void)
+{
+	printf("storage:    %s, %s", storage.model.name,
+		storage.imageFilename ? storage.imageFilename : "blank");
+	if (storage.pData) {
+		printf(" (%zu bytes of %zu MiB)", storage.imageSize, storage.size >> 20);
+	}
+	if (storage.numBadBlocks) {
+		printf(", %zu bad block%s", storage.numBadBlocks, storage.numBadBlocks == 1u ? "" : "s");
+	}
+	printf("\n");
+}
+
+void sim_storage_report(void)
+{
+	print_model_();
+	report_ops_(storage.stats, NULL);
+}
+
+bool sim_storage_replay(char const *filename)
+{
+	if (!configure_()) {
+		return false;
+	}
+
+	FILE *pFile = fopen(filename, "r");
+	if (!pFile) {
+		perror(filename);
+		return false;
+	}
+
+	struct Sim_StorageOpStats recorded[SIM_STORAGE_NUM_OPS] = { 0 };
+	struct Sim_StorageOpStats modelled[SIM_STORAGE_NUM_OPS] = { 0 };
+	bool result = true;
+	char line[256];
+	unsigned int lineNum = 0u;
+
+	while (result && fgets(line, sizeof(line), pFile)) {
+		unsigned long long timeNs, offset, size, costNs;
+		char opName[16];
+		int op = 0;
+
+		lineNum++;
+		if (line[0] == '#') {
+			continue;
+		}
+
+		result = (sscanf(line, "%llu %15s %llx %llu %llu", &timeNs, opName, &offset, &size,
+			&costNs) == 5);
+		while (result && (op < SIM_STORAGE_NUM_OPS) && strcmp(opName, opNames[op])) {
+			op++;
+		}
+		result = result && (op < SIM_STORAGE_NUM_OPS);
+
+		if (!result) {
+			fprintf(stderr, "hss-boot-sim: %s:%u: bad trace line\n", filename, lineNum);
+		} else {
+			recorded[op].count++;
+			recorded[op].bytes += size;
+			recorded[op].ns += costNs;
+			modelled[op].count++;
+			modelled[op].bytes += size;
+			modelled[op].ns += cost_ns_(&storage.model, (enum Sim_StorageOp)op, offset, size);
+		}
+	}
+	fclose(pFile);
+
+	if (result) {
+		uint64_t recordedNs = 0u, modelledNs = 0u;
+
+		for (int op = 0; op < SIM_STORAGE_NUM_OPS; op++) {
+			recordedNs += recorded[op].ns;
+			modelledNs += modelled[op].ns;
+		}
+
+		printf("replay:     %s\n", filename);
+		print_model_();
+		report_ops_(recorded, modelled);
+		printf("total:      %.3f ms recorded, %.3f ms on %s\n", (double)recordedNs / 1e6,
+			(double)modelledNs / 1e6, storage.model.name);
+	}
+
+	return result;
+}
@@ -0,0 +1,95 @@
+#!/bin/bash
+#
+# MPFS HSS Embedded Software - tools/hss-boot-sim
+#
+# Copyright 2019-2025 Microchip FPGA Embedded Systems Solutions.
+#
+# SPDX-License-Identifier: MIT
+#
+# Boot simulator storage fuzzer
+#
+# Builds a synthetic payload with hss-payload-generator, puts it on a GPT disk image
+# with test/mkdisk.py, and boots each of a series of seeded mutations of the GPT and
+# boot image header through the simulator's SD card model. A mutation may legitimately
+# fail to boot; what is reported is a crash, a hang, or (for a simulator built with
+# SANITIZE=1) undefined behaviour. The failing disk images are kept for replay.
+#
+# Usage: test/fuzz.sh [<simulator>] [<generator>]
+#
+# Environment:
+#   FUZZ_RUNS     number of mutations to try (default 200)
+#   FUZZ_SEED     first seed (default 1), so that a finding can be reproduced with
+#                 FUZZ_SEED=<seed> FUZZ_RUNS=1
+#   FUZZ_TIMEOUT  seconds after which the simulator is deemed to have hung, rather than
+#                 giving up on an incomplete boot after 2 s (default 30)
+#   FUZZ_KEEP     directory in which to keep failing disk images (default fuzz-findings)
+#
+
+set -e
+
+cd "$(dirname "$0")/.."
+
+SIM=$(realpath "${1:-./hss-boot-sim}")
+GENERATOR=$(realpath "${2:-../hss-payload-generator/hss-payload-generator}")
+GENERATOR_DIR=$(realpath ../hss-payload-generator)
+FUZZ_RUNS=${FUZZ_RUNS:-200}
+FUZZ_SEED=${FUZZ_SEED:-1}
+FUZZ_TIMEOUT=${FUZZ_TIMEOUT:-30}
+FUZZ_KEEP=${FUZZ_KEEP:-fuzz-findings}
+
+WORK_DIR=$(mktemp -d)
+trap 'rm -rf "$WORK_DIR"' EXIT
+
+head -c 200003 /dev/urandom >"$WORK_DIR/u-boot.bin"
+head -c 10001 /dev/urandom >"$WORK_DIR/board.dtb"
+cat >"$WORK_DIR/fuzz.yaml" <<EOT
+set-name: 'PolarFire-SoC-HSS::BootSimFuzz'
+hart-entry-points: {u54_1: '0x80200000', u54_2: '0x80200000', u54_3: '0x80200000', u54_4: '0x80200000'}
+payloads:
+  $WORK_DIR/u-boot.bin: {exec-addr: '0x80200000', owner-hart: u54_1, secondary-hart: u54_2, secondary-hart: u54_3, secondary-hart: u54_4, priv-mode: prv_s, ancilliary-data: $WORK_DIR/board.dtb, payload-name: 'u-boot'}
+EOT
+
+if ! (cd "$GENERATOR_DIR" && "$GENERATOR" -c "$WORK_DIR/fuzz.yaml" "$WORK_DIR/fuzz.bin") \
+		>"$WORK_DIR/log" 2>&1; then
+	printf "generator failed:\n"
+	sed 's/^/    /' "$WORK_DIR/log"
+	exit 1
+fi
+
+echo "Simulator: $SIM"
+echo "Seeds:     $FUZZ_SEED to $((FUZZ_SEED + FUZZ_RUNS - 1))"
+echo
+
+findings=0
+booted=0
+for ((seed = FUZZ_SEED; seed < FUZZ_SEED + FUZZ_RUNS; seed++)); do
+	mutation=$(./test/mkdisk.py --mutate "$seed" "$WORK_DIR/disk.img" "$WORK_DIR/fuzz.bin")
+
+	rc=0
+	timeout "$FUZZ_TIMEOUT" "$SIM" -v -t 2000 -s "sd:$WORK_DIR/disk.img" \
+		>"$WORK_DIR/log" 2>&1 || rc=$?
+
+	finding=
+	if [ "$rc" -eq 124 ]; then
+		finding="hang"
+	elif [ "$rc" -gt 128 ]; then
+		finding="signal $((rc - 128))"
+	elif grep -q "runtime error" "$WORK_DIR/log"; then
+		finding="undefined behaviour"
+	elif [ "$rc" -eq 0 ]; then
+		booted=$((booted + 1))
+	fi
+
+	if [ -n "$finding" ]; then
+		printf "%-24s %s (%s)\n" "seed $seed" "$finding" "${mutation#mutation *: }"
+		grep "runtime error" "$WORK_DIR/log" | sed 's/^/    /' || true
+		mkdir -p "$FUZZ_KEEP"
+		cp "$WORK_DIR/disk.img" "$FUZZ_KEEP/seed-$seed.img"
+		cp "$WORK_DIR/log" "$FUZZ_KEEP/seed-$seed.log"
+		findings=$((findings + 1))
+	fi
+done
+
+echo
+printf "%d mutations, %d booted, %d findings\n" "$FUZZ_RUNS" "$booted" "$findings"
+[ "$findings" -eq 0 ]
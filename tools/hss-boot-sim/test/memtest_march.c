@@ -0,0 +1,245 @@
+/******************************************************************************************
+ *
+ * MPFS HSS Embedded Software - tools/hss-boot-sim
+ *
+ * Copyright 2019-2025 Microchip FPGA Embedded Systems Solutions.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+
+/*
+ * March memory test engine host test
+ *
+ * Builds the engine in modules/misc/hss_memtest_march.c with its memory accesses
+ * routed through a simulated memory, into which single cell faults are injected:
+ * stuck-at faults, transition faults, and idempotent and inversion coupling faults
+ * with the aggressor both below and above the victim. Each fault is placed at the
+ * start, middle and end of the memory and on low, middle and high bits, and March C-
+ * and March SS must each detect it, reporting only the victim word and bit.
+ *
+ * Exits non-zero if any fault is missed or misreported, or if a fault-free memory
+ * fails any algorithm.
+ */
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "hss_types.h"
+
+static uint64_t faulty_read_(volatile uint64_t *pAddr);
+static void faulty_write_(volatile uint64_t *pAddr, uint64_t value);
+
+#define mMEMTEST_READ(pAddr)         faulty_read_(pAddr)
+#define mMEMTEST_WRITE(pAddr, value) faulty_write_((pAddr), (value))
+
+#include "hss_memtest_march.c"
+
+#define NUM_WORDS 64u
+
+enum FaultType {
+	FAULT_NONE,
+	FAULT_STUCK_AT,		// victim bit always reads as value
+	FAULT_TRANSITION,	// victim bit cannot make the up (0 to 1) or down transition
+	FAULT_COUPLING_IDEMPOTENT,	// an aggressor bit transition forces the victim bit to value
+	FAULT_COUPLING_INVERSION,	// an aggressor bit transition inverts the victim bit
+};
+
+struct Fault {
+	enum FaultType type;
+	size_t victim;
+	unsigned int victimBit;
+	size_t aggressor;
+	unsigned int aggressorBit;
+	bool up;			// transition fault or aggressor transition direction
+	bool value;			// stuck-at or coupled value
+};
+
+static uint64_t memory[NUM_WORDS];
+static struct Fault fault;
+
+static inline uint64_t force_bit_(uint64_t word, unsigned int bit, bool value)
+{
+	return value ? (word | (1llu << bit)) : (word & ~(1llu << bit));
+}
+
+static inline bool get_bit_(uint64_t word, unsigned int bit)
+{
+	return (word >> bit) & 1u;
+}
+
+static uint64_t faulty_read_(volatile uint64_t *pAddr)
+{
+	size_t const index = (size_t)(pAddr - memory);
+	uint64_t value = memory[index];
+
+	if ((fault.type == FAULT_STUCK_AT) && (index == fault.victim)) {
+		value = force_bit_(value, fault.victimBit, fault.value);
+	}
+
+	return value;
+}
+
+static void faulty_write_(volatile uint64_t *pAddr, uint64_t value)
+{
+	size_t const index = (size_t)(pAddr - memory);
+	uint64_t const old = memory[index];
+
+	if (index == fault.victim) {
+		if (fault.type == FAULT_STUCK_AT) {
+			value = force_bit_(value, fault.victimBit, fault.value);
+		} else if ((fault.type == FAULT_TRANSITION)
+				&& (get_bit_(old, fault.victimBit) != fault.up)
+				&& (get_bit_(value, fault.victimBit) == fault.up)) {
+			value = force_bit_(value, fault.victimBit, !fault.up);
+		}
+	}
+
+	memory[index] = value;
+
+	if (((fault.type == FAULT_COUPLING_IDEMPOTENT) || (fault.type == FAULT_COUPLING_INVERSION))
+			&& (index == fault.aggressor)
+			&& (get_bit_(old, fault.aggressorBit) != fault.up)
+			&& (get_bit_(value, fault.aggressorBit) == fault.up)) {
+		bool const victimValue = (fault.type == FAULT_COUPLING_INVERSION)
+			? !get_bit_(memory[fault.victim], fault.victimBit) : fault.value;
+
+		memory[fault.victim] = force_bit_(memory[fault.victim], fault.victimBit, victimValue);
+	}
+}
+
+static char const * const faultNames[] = {
+	[ FAULT_NONE ]                = "none",
+	[ FAULT_STUCK_AT ]            = "stuck-at",
+	[ FAULT_TRANSITION ]          = "transition",
+	[ FAULT_COUPLING_IDEMPOTENT ] = "idempotent coupling",
+	[ FAULT_COUPLING_INVERSION ]  = "inversion coupling",
+};
+
+static inline ptrdiff_t word_index_(uintptr_t addr)
+{
+	return ((ptrdiff_t)addr - (ptrdiff_t)memory) / (ptrdiff_t)sizeof(uint64_t);
+}
+
+static unsigned int numCases = 0u;
+static unsigned int numFailures = 0u;
+
+static void check_(enum HSS_MemTest_Algorithm algorithm, uint64_t background)
+{
+	struct HSS_MemTest_Stats stats;
+	uintptr_t const victimAddr = (uintptr_t)&memory[fault.victim];
+
+	HSS_MemTest_ResetStats(&stats);
+	for (size_t i = 0u; i < NUM_WORDS; i++) {
+		memory[i] = (uint64_t)rand();
+	}
+
+	bool const passed = HSS_MemTest_Run(algorithm, background, memory, NUM_WORDS, &stats, NULL, NULL);
+	char const *pProblem = NULL;
+
+	if (fault.type == FAULT_NONE) {
+		if (!passed || stats.errorCount) {
+			pProblem = "errors reported in fault-free memory";
+		}
+	} else if (passed || !stats.errorCount) {
+		pProblem = "fault not detected";
+	} else if ((stats.firstErrorAddr != victimAddr) || (stats.lowestErrorAddr != victimAddr)
+			|| (stats.highestErrorAddr != victimAddr)) {
+		pProblem = "errors reported away from the victim word";
+	} else if (stats.failingBits != (1llu << fault.victimBit)) {
+		pProblem = "wrong failing bits reported";
+	}
+
+	numCases++;
+	if (pProblem) {
+		numFailures++;
+		printf("FAILED: %s, background 0x%016" PRIx64 ", %s fault (%s) on word %zu bit %u"
+			" (aggressor word %zu bit %u): %s\n",
+			HSS_MemTest_GetAlgorithmName(algorithm), background, faultNames[fault.type],
+			fault.up ? "up" : "down", fault.victim, fault.victimBit, fault.aggressor,
+			fault.aggressorBit, pProblem);
+
+		if (stats.errorCount) {
+			printf("    %zu errors, first at word %td, words %td-%td, failing bits 0x%016" PRIx64 "\n",
+				stats.errorCount, word_index_(stats.firstErrorAddr), word_index_(stats.lowestErrorAddr),
+				word_index_(stats.highestErrorAddr), stats.failingBits);
+		}
+	}
+}
+
+static void check_marches_(void)
+{
+	for (size_t i = 0u; i < HSS_MemTest_NumPatterns; i++) {
+		check_(MEMTEST_MARCH_C_MINUS, HSS_MemTest_Patterns[i].background);
+		check_(MEMTEST_MARCH_SS, HSS_MemTest_Patterns[i].background);
+	}
+}
+
+int main(void)
+{
+	static size_t const words[] = { 0u, NUM_WORDS / 2u, NUM_WORDS - 1u };
+	static unsigned int const bits[] = { 0u, 37u, 63u };
+
+	srand(1u);
+
+	fault = (struct Fault) { .type = FAULT_NONE, .victim = NUM_WORDS };
+	check_marches_();
+	check_(MEMTEST_WALKING_ONES_BURST, 0u);
+
+	for (size_t w = 0u; w < ARRAY_SIZE(words); w++) {
+		for (size_t b = 0u; b < ARRAY_SIZE(bits); b++) {
+			for (unsigned int polarity = 0u; polarity < 2u; polarity++) {
+				fault = (struct Fault) { .type = FAULT_STUCK_AT, .victim = words[w],
+					.victimBit = bits[b], .aggressor = NUM_WORDS, .value = polarity };
+				check_marches_();
+
+				fault = (struct Fault) { .type = FAULT_TRANSITION, .victim = words[w],
+					.victimBit = bits[b], .aggressor = NUM_WORDS, .up = polarity };
+				check_marches_();
+
+				// aggressors below and above the victim, on a different bit
+				for (size_t a = 0u; a < ARRAY_SIZE(words); a++) {
+					if (words[a] == words[w]) {
+						continue;
+					}
+
+					for (unsigned int value = 0u; value < 2u; value++) {
+						fault = (struct Fault) { .type = FAULT_COUPLING_IDEMPOTENT,
+							.victim = words[w], .victimBit = bits[b], .aggressor = words[a],
+							.aggressorBit = bits[(b + 1u) % ARRAY_SIZE(bits)], .up = polarity,
+							.value = value };
+						check_marches_();
+					}
+
+					fault = (struct Fault) { .type = FAULT_COUPLING_INVERSION,
+						.victim = words[w], .victimBit = bits[b], .aggressor = words[a],
+						.aggressorBit = bits[(b + 1u) % ARRAY_SIZE(bits)], .up = polarity };
+					check_marches_();
+				}
+			}
+		}
+	}
+
+	printf("memtest-march: %u cases, %u failed\n", numCases, numFailures);
+
+	return numFailures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
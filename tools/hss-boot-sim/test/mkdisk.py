@@ -0,0 +1,221 @@
+#!/usr/bin/env python3
+
+"""
+MPFS HSS Boot Simulator disk image tool
+
+This script builds a GPT-partitioned disk image for the boot simulator's MMC
+models (-s sd/emmc), with the payload in a partition of the type the HSS
+looks for, and the primary and backup GPT headers and partition entry arrays
+around it. Other partitions, e.g. for a rootfs, can be added with --partition.
+
+With --mutate, the GPT and the boot image header are then corrupted in a way
+chosen by the seed, for fuzzing. GPT fields are usually mutated with their
+CRCs fixed up, so that the mutation gets past the header checks.
+
+"""
+
+#
+#
+# MPFS HSS Boot Simulator disk image tool
+#
+# Copyright 2019-2025 Microchip FPGA Embedded Systems Solutions.
+#
+# SPDX-License-Identifier: MIT
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to
+# deal in the Software without restriction, including without limitation the
+# rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+# sell copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in
+# all copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+# FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+# IN THE SOFTWARE.
+#
+#
+#
+
+import argparse
+import random
+import struct
+import sys
+import uuid
+import zlib
+
+LBA_SIZE = 512
+NUM_ENTRIES = 128
+ENTRY_SIZE = 128
+ENTRIES_LBAS = NUM_ENTRIES * ENTRY_SIZE // LBA_SIZE
+FIRST_USABLE_LBA = 2 + ENTRIES_LBAS
+PARTITION_ALIGN_LBAS = 2048
+
+# the partition type the HSS boots from (services/boot/gpt.c)
+HSS_BOOT_TYPE = uuid.UUID('21686148-6449-6e6f-744e-656564454649')
+LINUX_DATA_TYPE = uuid.UUID('0fc63daf-8483-4772-8e79-3d69d8477de4')
+
+HEADER = struct.Struct('<8sIIIIQQQQ16sQIII')
+
+# offsets of the fields of interest in the HSS boot image header (include/hss_types.h)
+BOOT_IMAGE_FIELDS = [(0, 4), (8, 8), (16, 4), (24, 8), (32, 8),
+                     (40, 8), (58, 8), (66, 8), (74, 8)]
+
+INTERESTING = [0, 1, 2, 0x7f, 0x80, 0xff, 0x100, 0x200, 0x1000, 0xffff,
+               0x7fffffff, 0x80000000, 0xffffffff, 0xffffffffffffffff]
+
+
+def align(value: int, alignment: int):
+    '''rounds value up to a multiple of alignment'''
+    return (value + alignment - 1) // alignment * alignment
+
+
+def make_entry(type_guid: uuid.UUID, first_lba: int, last_lba: int, name: str):
+    '''returns a GPT partition entry'''
+    return struct.pack('<16s16sQQQ72s', type_guid.bytes_le, uuid.uuid4().bytes_le,
+                       first_lba, last_lba, 0, name.encode('utf-16-le'))
+
+
+def make_header(current_lba: int, backup_lba: int, last_usable_lba: int,
+                disk_guid: uuid.UUID, entries_lba: int, entries: bytes,
+                num_entries: int = NUM_ENTRIES, entry_size: int = ENTRY_SIZE):
+    '''returns a GPT header, with its CRCs filled in'''
+    fields = [b'EFI PART', 0x00010000, HEADER.size, 0, 0, current_lba,
+              backup_lba, FIRST_USABLE_LBA, last_usable_lba,
+              disk_guid.bytes_le, entries_lba, num_entries, entry_size,
+              zlib.crc32(entries)]
+    fields[3] = zlib.crc32(HEADER.pack(*fields))
+    return HEADER.pack(*fields)
+
+
+def make_mbr(num_lbas: int):
+    '''returns a protective MBR'''
+    mbr = bytearray(LBA_SIZE)
+    mbr[446:462] = struct.pack('<B3sB3sII', 0, b'\x00\x02\x00', 0xee,
+                               b'\xff\xff\xff', 1,
+                               min(num_lbas - 1, 0xffffffff))
+    mbr[510:512] = b'\x55\xaa'
+    return mbr
+
+
+def mutate(disk: bytearray, boot_lba: int, seed: int):
+    '''corrupts the GPT or the boot image header, returning a description'''
+    rng = random.Random(seed)
+    header = list(HEADER.unpack_from(disk, LBA_SIZE))
+    entries_offset = 2 * LBA_SIZE
+    choice = rng.randrange(6)
+
+    if choice == 0:
+        # a header field, with the CRCs fixed up
+        index = rng.choice([5, 6, 7, 8, 10, 11, 12])
+        header[index] = rng.choice(INTERESTING) & \
+            (0xffffffff if index in (11, 12) else 0xffffffffffffffff)
+        what = 'header field %d = 0x%x' % (index, header[index])
+    elif choice == 1:
+        # the boot partition's extent, with the CRCs fixed up
+        entry = entries_offset + rng.randrange(2) * ENTRY_SIZE
+        offset = entry + rng.choice([32, 40])
+        value = rng.choice(INTERESTING + [boot_lba + rng.randrange(-4, 4)])
+        struct.pack_into('<Q', disk, offset, value & 0xffffffffffffffff)
+        what = 'entry field at 0x%x = 0x%x' % (offset, value)
+    elif choice == 2:
+        # random bytes in the partition entries, with the CRCs fixed up
+        for _ in range(rng.randrange(1, 8)):
+            disk[entries_offset + rng.randrange(2 * ENTRY_SIZE)] = rng.randrange(256)
+        what = 'partition entry bytes'
+    elif choice == 3:
+        # random bytes in the header, without fixing up the CRCs
+        for _ in range(rng.randrange(1, 4)):
+            disk[LBA_SIZE + rng.randrange(HEADER.size)] = rng.randrange(256)
+        return 'header bytes, CRC not fixed up'
+    else:
+        # a boot image header field
+        offset, size = rng.choice(BOOT_IMAGE_FIELDS)
+        value = rng.choice(INTERESTING) & ((1 << (8 * size)) - 1)
+        disk[boot_lba * LBA_SIZE + offset:boot_lba * LBA_SIZE + offset + size] = \
+            value.to_bytes(size, 'little')
+        return 'boot image field at 0x%x = 0x%x' % (offset, value)
+
+    entries = bytes(disk[entries_offset:entries_offset + ENTRIES_LBAS * LBA_SIZE])
+    header[3] = 0
+    header[13] = zlib.crc32(entries)
+    header[3] = zlib.crc32(HEADER.pack(*header))
+    HEADER.pack_into(disk, LBA_SIZE, *header)
+    return what
+
+
+def main():
+    '''main function'''
+    parser = argparse.ArgumentParser(
+        description='Build a GPT disk image for the HSS boot simulator')
+    parser.add_argument('--size', type=int, default=0, metavar='MIB',
+                        help='disk size in MiB (default: just big enough)')
+    parser.add_argument('--partition', action='append', default=[],
+                        metavar='MIB', type=int,
+                        help='add an empty Linux data partition of this size')
+    parser.add_argument('--mutate', type=int, metavar='SEED',
+                        help='corrupt the GPT or boot image, for fuzzing')
+    parser.add_argument('image', help='output disk image')
+    parser.add_argument('payload', help='HSS payload (from hss-payload-generator)')
+
+    args = parser.parse_args()
+
+    with open(args.payload, 'rb') as f:
+        payload = f.read()
+
+    # partitions follow the payload, 1 MiB aligned
+    boot_lba = PARTITION_ALIGN_LBAS
+    extents = [(HSS_BOOT_TYPE, boot_lba,
+                boot_lba + align(len(payload), LBA_SIZE) // LBA_SIZE - 1, 'hss')]
+    for number, size in enumerate(args.partition):
+        first = align(extents[-1][2] + 1, PARTITION_ALIGN_LBAS)
+        extents.append((LINUX_DATA_TYPE, first,
+                        first + size * 1024 * 1024 // LBA_SIZE - 1,
+                        'data%d' % number))
+
+    num_lbas = align(extents[-1][2] + 1 + ENTRIES_LBAS + 1, PARTITION_ALIGN_LBAS)
+    if args.size:
+        if args.size * 1024 * 1024 // LBA_SIZE < num_lbas:
+            print('%d MiB is too small for the partitions' % args.size,
+                  file=sys.stderr)
+            sys.exit(1)
+        num_lbas = args.size * 1024 * 1024 // LBA_SIZE
+
+    entries = b''.join(make_entry(*extent) for extent in extents)
+    entries = entries.ljust(ENTRIES_LBAS * LBA_SIZE, b'\0')
+
+    disk_guid = uuid.uuid4()
+    backup_lba = num_lbas - 1
+    last_usable_lba = backup_lba - ENTRIES_LBAS - 1
+
+    disk = bytearray(num_lbas * LBA_SIZE)
+    disk[0:LBA_SIZE] = make_mbr(num_lbas)
+    disk[LBA_SIZE:LBA_SIZE + HEADER.size] = make_header(
+        1, backup_lba, last_usable_lba, disk_guid, 2, entries)
+    disk[2 * LBA_SIZE:(2 + ENTRIES_LBAS) * LBA_SIZE] = entries
+    disk[boot_lba * LBA_SIZE:boot_lba * LBA_SIZE + len(payload)] = payload
+
+    backup_entries_lba = last_usable_lba + 1
+    disk[backup_entries_lba * LBA_SIZE:backup_lba * LBA_SIZE] = entries
+    disk[backup_lba * LBA_SIZE:backup_lba * LBA_SIZE + HEADER.size] = make_header(
+        backup_lba, 1, last_usable_lba, disk_guid, backup_entries_lba, entries)
+
+    if args.mutate is not None:
+        print('mutation %d: %s' % (args.mutate, mutate(disk, boot_lba, args.mutate)))
+
+    with open(args.image, 'wb') as f:
+        f.write(disk)
+
+
+#
+#
+#
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,219 @@
+#!/bin/bash
+#
+# MPFS HSS Embedded Software - tools/hss-boot-sim
+#
+# Copyright 2019-2025 Microchip FPGA Embedded Systems Solutions.
+#
+# SPDX-License-Identifier: MIT
+#
+# Boot simulator regression test
+#
+# Builds payloads with hss-payload-generator, from each of its test/*.yaml
+# configurations whose input files are present, and from a synthetic configuration
+# that exercises OpenSBI and non-OpenSBI harts, secondary harts and ancilliary data.
+# Each payload is booted through the simulator, from fabric and then from each of the
+# simulated boot storage devices, and the best superloop iteration count and boot time
+# are checked against the budgets in test/budgets. A payload of scattered blobs is also
+# generated with and without -O, and DDR after booting each is compared.
+#
+# Usage: test/run.sh [<simulator>] [<generator>]
+#
+# Environment:
+#   SIM_RUNS         number of runs per case, the best of which is checked (default 5)
+#   SIM_BUDGET_SCALE percentage to scale the time budgets by, e.g. for slow CI hosts
+#                    (default 100)
+#   SIM_VARIANT      name of the simulator's build variant, if any, appended to each
+#                    case name as <case>+<variant>, for its own budgets
+#
+
+set -e
+
+cd "$(dirname "$0")/.."
+
+SIM=$(realpath "${1:-./hss-boot-sim}")
+GENERATOR=$(realpath "${2:-../hss-payload-generator/hss-payload-generator}")
+GENERATOR_DIR=$(realpath ../hss-payload-generator)
+SIM_RUNS=${SIM_RUNS:-5}
+SIM_BUDGET_SCALE=${SIM_BUDGET_SCALE:-100}
+CASE_SUFFIX=${SIM_VARIANT:+"+$SIM_VARIANT"}
+
+WORK_DIR=$(mktemp -d)
+trap 'rm -rf "$WORK_DIR"' EXIT
+
+failed=0
+
+# budget <case> <column>
+# prints the budget for a case from test/budgets, or 0 for no limit
+budget() {
+	awk -v name="$1" -v column="$2" \
+		'!/^#/ && $1 == name { print $column; found = 1 } END { if (!found) print 0 }' \
+		test/budgets
+}
+
+# run <case> <payload> <args...>
+# the payload is empty when booting from simulated storage
+run() {
+	local name=$1$CASE_SUFFIX payload=$2
+	shift 2
+
+	local bestLoops= bestMs=
+	for ((run = 0; run < SIM_RUNS; run++)); do
+		if ! "$SIM" "$@" ${payload:+"$payload"} >"$WORK_DIR/log" 2>&1; then
+			printf "%-32s FAILED:\n" "$name"
+			sed 's/^/    /' "$WORK_DIR/log"
+			failed=1
+			return 0
+		fi
+
+		local loops ms
+		loops=$(sed -n 's/^superloop: *\([0-9]*\) iterations/\1/p' "$WORK_DIR/log")
+		ms=$(sed -n 's/^wall time: *\([0-9.]*\) ms/\1/p' "$WORK_DIR/log")
+
+		if [ -z "$bestLoops" ] || [ "$loops" -lt "$bestLoops" ]; then
+			bestLoops=$loops
+		fi
+		if [ -z "$bestMs" ] || awk "BEGIN { exit !($ms < $bestMs) }"; then
+			bestMs=$ms
+		fi
+	done
+
+	local maxLoops maxMs
+	maxLoops=$(budget "$name" 2)
+	maxMs=$(budget "$name" 3)
+	maxMs=$((maxMs * SIM_BUDGET_SCALE / 100))
+
+	printf "%-32s %10d loops %10.3f ms" "$name" "$bestLoops" "$bestMs"
+
+	if [ "$maxLoops" -gt 0 ] && [ "$bestLoops" -gt "$maxLoops" ]; then
+		printf "   REGRESSION (budget %d loops)" "$maxLoops"
+		failed=1
+	fi
+	if [ "$maxMs" -gt 0 ] && awk "BEGIN { exit !($bestMs > $maxMs) }"; then
+		printf "   REGRESSION (budget %d ms)" "$maxMs"
+		failed=1
+	fi
+
+	printf "\n"
+}
+
+# layout <case> <window> <payload> <optimized-payload>
+# boots both payloads, snapshotting the <addr>:<bytes> DDR window, and checks that the
+# optimized layout leaves the same memory, bar gaps it has zero-filled
+layout() {
+	local name=$1$CASE_SUFFIX window=$2 payload=$3 optimized=$4
+
+	if ! "$SIM" -S "$WORK_DIR/base.snap@$window" "$payload" >"$WORK_DIR/log" 2>&1 \
+			|| ! "$SIM" -S "$WORK_DIR/opt.snap@$window" "$optimized" >"$WORK_DIR/log" 2>&1; then
+		printf "%-32s FAILED:\n" "$name"
+		sed 's/^/    /' "$WORK_DIR/log"
+		failed=1
+	elif ! cmp -l "$WORK_DIR/base.snap" "$WORK_DIR/opt.snap" >"$WORK_DIR/cmp" \
+			&& ! awk '$2 != 245 || $3 != 0 { exit 1 }' "$WORK_DIR/cmp"; then
+		# 245 is the sim's 0xA5 poison, in octal, as cmp prints it
+		printf "%-32s FAILED: %d bytes differ, first:\n" "$name" "$(wc -l <"$WORK_DIR/cmp")"
+		awk '$2 != 245 || $3 != 0' "$WORK_DIR/cmp" | head -5 | sed 's/^/    /'
+		failed=1
+	else
+		printf "%-32s matches (%d gap bytes zero-filled)\n" "$name" "$(wc -l <"$WORK_DIR/cmp")"
+	fi
+}
+
+# generate <payload> <args...>
+generate() {
+	local payload=$1
+	shift
+
+	if ! (cd "$GENERATOR_DIR" && "$GENERATOR" "$@" "$payload") >"$WORK_DIR/log" 2>&1; then
+		printf "generator failed:\n"
+		sed 's/^/    /' "$WORK_DIR/log"
+		exit 1
+	fi
+}
+
+echo "Simulator: $SIM"
+echo "Generator: $GENERATOR"
+echo "Variant:   ${SIM_VARIANT:-none}"
+echo "Best of $SIM_RUNS runs"
+echo
+
+for config in "$GENERATOR_DIR"/test/*.yaml; do
+	[ "$(basename "$config")" = "broken.yaml" ] && continue
+
+	# the test configurations reference ELF and binary files that are not shipped...
+	missing=
+	for input in $(sed -n -e 's/^  *\([^#: ]*\): *{.*/\1/p' \
+			-e 's/.*ancilliary-data: *\([^ ,}]*\).*/\1/p' "$config"); do
+		[ -f "$GENERATOR_DIR/$input" ] || missing="$missing $input"
+	done
+
+	if [ -n "$missing" ]; then
+		printf "%-32s skipped (missing%s)\n" "$(basename "$config")" "$missing"
+	else
+		generate "$WORK_DIR/$(basename "$config").bin" -c "$config"
+		run "$(basename "$config")" "$WORK_DIR/$(basename "$config").bin"
+	fi
+done
+
+#
+# synthetic configuration: a U-Boot-like payload with a DTB on u54_1, shared by u54_2
+# and u54_4, and a bare metal application on u54_3 that skips OpenSBI
+#
+head -c 1000003 /dev/urandom >"$WORK_DIR/u-boot.bin"
+head -c 40001 /dev/urandom >"$WORK_DIR/board.dtb"
+head -c 300007 /dev/urandom >"$WORK_DIR/baremetal.bin"
+cat >"$WORK_DIR/sim.yaml" <<EOT
+set-name: 'PolarFire-SoC-HSS::BootSim'
+hart-entry-points: {u54_1: '0x80200000', u54_2: '0x80200000', u54_3: '0xB0000000', u54_4: '0x80200000'}
+payloads:
+  $WORK_DIR/u-boot.bin: {exec-addr: '0x80200000', owner-hart: u54_1, secondary-hart: u54_2, secondary-hart: u54_4, priv-mode: prv_s, ancilliary-data: $WORK_DIR/board.dtb, payload-name: 'u-boot'}
+  $WORK_DIR/baremetal.bin: {exec-addr: '0xB0000000', owner-hart: u54_3, priv-mode: prv_m, skip-opensbi: true, payload-name: 'baremetal'}
+EOT
+
+generate "$WORK_DIR/sim.bin" -c "$WORK_DIR/sim.yaml"
+generate "$WORK_DIR/sim-compressed.bin" -c "$WORK_DIR/sim.yaml" -C 6
+
+run synthetic "$WORK_DIR/sim.bin"
+run synthetic-compressed "$WORK_DIR/sim-compressed.bin"
+
+# with DDR training, PDMA and UART times closer to those on target
+run synthetic-modelled "$WORK_DIR/sim-compressed.bin" -D 20 -p 400 -u 115200
+
+#
+# an optimized (-O) layout of scattered blobs: a small gap, which the generator merges
+# across and zero-fills, a large one, which it keeps, and a long zero run it drops and
+# leaves to be zeroed on boot, must leave DDR as the unoptimized layout does. The other
+# harts' payload comes first, as the generator takes a first chunk index of 0 as unset
+#
+{ head -c 100003 /dev/urandom; head -c $((256 * 1024)) /dev/zero; head -c 50001 /dev/urandom; } \
+	>"$WORK_DIR/zeros.bin"
+head -c 20011 /dev/urandom >"$WORK_DIR/near.bin"
+head -c 70001 /dev/urandom >"$WORK_DIR/far.bin"
+cat >"$WORK_DIR/layout.yaml" <<EOT
+set-name: 'PolarFire-SoC-HSS::BootSim'
+hart-entry-points: {u54_1: '0x80200000', u54_2: '0xB0000000', u54_3: '0xB0000000', u54_4: '0xB0000000'}
+payloads:
+  $WORK_DIR/baremetal.bin: {exec-addr: '0xB0000000', owner-hart: u54_2, secondary-hart: u54_3, secondary-hart: u54_4, priv-mode: prv_m, skip-opensbi: true}
+  $WORK_DIR/zeros.bin: {exec-addr: '0x80200000', owner-hart: u54_1, priv-mode: prv_m, skip-opensbi: true}
+  $WORK_DIR/near.bin: {exec-addr: '0x80265000', owner-hart: u54_1, priv-mode: prv_m, skip-opensbi: true}
+  $WORK_DIR/far.bin: {exec-addr: '0x80400000', owner-hart: u54_1, priv-mode: prv_m, skip-opensbi: true}
+EOT
+
+generate "$WORK_DIR/layout.bin" -c "$WORK_DIR/layout.yaml"
+generate "$WORK_DIR/layout-optimized.bin" -c "$WORK_DIR/layout.yaml" -O
+
+layout layout-optimized 0x80100000:0x400000 "$WORK_DIR/layout.bin" "$WORK_DIR/layout-optimized.bin"
+
+#
+# the synthetic payload on each of the boot storage models: an SD card with a GPT disk
+# image, eMMC and QSPI NAND written to as over USB (so without a GPT, and with bad blocks
+# beyond the image), and SPI flash with the payload at its offset
+#
+./test/mkdisk.py "$WORK_DIR/sd.img" "$WORK_DIR/sim.bin"
+{ head -c $((0x400)) /dev/zero; cat "$WORK_DIR/sim.bin"; } >"$WORK_DIR/spi.img"
+
+run storage-sd "" -s "sd:$WORK_DIR/sd.img"
+run storage-emmc "" -s emmc -w "$WORK_DIR/sim.bin"
+run storage-qspi-nand "" -s qspi-nand -w "$WORK_DIR/sim.bin" -M bad=1000,1021
+run storage-spi "" -s "spi:$WORK_DIR/spi.img"
+
+exit $failed
@@ -0,0 +1,356 @@
+/******************************************************************************************
+ *
+ * MPFS HSS Embedded Software - tools/hss-payload-generator
+ *
+ * Copyright 2020-2025 Microchip FPGA Embedded Systems Solutions.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ *
+ */
+
+/*
+ * Compressed payload output
+ *
+ * Produces an HSS_CompressedImage directly from the generated payload. The input is
+ * split into independent blocks which are compressed in parallel, each as raw
+ * deflate ending in a sync flush (so on a byte boundary), and the last with a final
+ * block. Concatenated and wrapped in a zlib header and Adler-32 trailer, these form
+ * a single zlib stream, so the HSS decompresses it with mz_uncompress() as before.
+ *
+ * Blocks don't share a dictionary, so smaller blocks trade some ratio for
+ * parallelism.
+ */
+
+#define _FILE_OFFSET_BITS 64
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <time.h>
+#include <pthread.h>
+
+// must match MINIZ_CFLAGS in the Makefile
+#define MINIZ_NO_ZLIB_COMPATIBLE_NAMES
+#define MINIZ_NO_STDIO
+#define MINIZ_NO_TIME
+#define MINIZ_NO_ARCHIVE_APIS
+#include "miniz.h"
+#include "crc32.h"
+#include "debug_printf.h"
+#include "compress_payload.h"
+
+#ifndef CONFIG_CC_HAS_INTTYPES
+#	define CONFIG_CC_HAS_INTTYPES 1
+#endif
+#ifndef CONFIG_CRYPTO_SIGNING
+#	define CONFIG_CRYPTO_SIGNING 1
+#endif
+
+#include "hss_types.h"
+
+//
+// Without CONFIG_CRYPTO_SIGNING, the HSS has 64 bytes of padding in place of the
+// signature in struct HSS_CompressedImage. Such an HSS only boots unsigned payloads,
+// and one with it only boots signed payloads, so the header layout follows whether
+// or not the payload is signed.
+//
+#define COMPRESSED_HEADER_UNSIGNED_LEN  (offsetof(struct HSS_CompressedImage, signature) + 64u)
+
+//
+// Rough model of decompression on the E51, for the estimate printed at the end.
+// Calibrate against the "Decompress" phase of the boot timeline on real hardware.
+//
+#define TARGET_CPU_MHZ                600u
+#define TARGET_CYCLES_PER_OUTPUT_BYTE 12u
+#define TARGET_CYCLES_PER_INPUT_BYTE  20u
+
+/************************************************************************************/
+
+struct CompressedBlock {
+	uint8_t *pData;
+	size_t len;
+	size_t capacity;
+};
+
+struct CompressJob {
+	uint8_t const *pInput;
+	size_t inputLen;
+	size_t blockSize;
+	size_t numBlocks;
+	size_t nextBlock;               // next block to be claimed by a worker
+	int flags;
+	struct CompressedBlock *pBlocks;
+};
+
+/************************************************************************************/
+
+static mz_bool block_put_buf(const void *pBuf, int len, void *pUser) __attribute__((nonnull));
+static void compress_block(struct CompressJob *pJob, tdefl_compressor *pComp, size_t index) __attribute__((nonnull));
+static void *compress_worker(void *pArg) __attribute__((nonnull));
+static double elapsed_seconds(struct timespec const *pStart) __attribute__((nonnull));
+static void write_or_die(FILE *pFileOut, void const *pData, size_t len) __attribute__((nonnull));
+
+/************************************************************************************/
+
+static mz_bool block_put_buf(const void *pBuf, int len, void *pUser)
+{
+	struct CompressedBlock * const pBlock = pUser;
+
+	if ((pBlock->len + (size_t)len) > pBlock->capacity) {
+		size_t newCapacity = (pBlock->capacity * 2u) + (size_t)len;
+		uint8_t *pTmp = realloc(pBlock->pData, newCapacity);
+		if (!pTmp) {
+			return MZ_FALSE;
+		}
+		pBlock->pData = pTmp;
+		pBlock->capacity = newCapacity;
+	}
+
+	memcpy(pBlock->pData + pBlock->len, pBuf, (size_t)len);
+	pBlock->len += (size_t)len;
+
+	return MZ_TRUE;
+}
+
+static void compress_block(struct CompressJob *pJob, tdefl_compressor *pComp, size_t index)
+{
+	struct CompressedBlock * const pBlock = &pJob->pBlocks[index];
+	size_t const offset = index * pJob->blockSize;
+	size_t const len = ((offset + pJob->blockSize) > pJob->inputLen) ?
+		(pJob->inputLen - offset) : pJob->blockSize;
+	bool const lastBlock = (index == (pJob->numBlocks - 1u));
+
+	pBlock->capacity = len + (len / 8u) + 1024u;
+	pBlock->pData = malloc(pBlock->capacity);
+	assert(pBlock->pData);
+	pBlock->len = 0u;
+
+	tdefl_status status = tdefl_init(pComp, block_put_buf, pBlock, pJob->flags);
+	assert(status == TDEFL_STATUS_OKAY);
+
+	status = tdefl_compress_buffer(pComp, pJob->pInput + offset, len,
+		lastBlock ? TDEFL_FINISH : TDEFL_SYNC_FLUSH);
+	if (status != (lastBlock ? TDEFL_STATUS_DONE : TDEFL_STATUS_OKAY)) {
+		fprintf(stderr, "tdefl_compress_buffer() failed on block %lu - %d\n", index, status);
+		exit(EXIT_FAILURE);
+	}
+
+	debug_printf(4, "\t- Block %lu: %lu => %lu bytes\n", index, len, pBlock->len);
+}
+
+static void *compress_worker(void *pArg)
+{
+	struct CompressJob * const pJob = pArg;
+
+	tdefl_compressor *pComp = tdefl_compressor_alloc();
+	assert(pComp);
+
+	for (;;) {
+		size_t const index = __atomic_fetch_add(&pJob->nextBlock, 1u, __ATOMIC_RELAXED);
+		if (index >= pJob->numBlocks) {
+			break;
+		}
+
+		compress_block(pJob, pComp, index);
+	}
+
+	tdefl_compressor_free(pComp);
+
+	return NULL;
+}
+
+static double elapsed_seconds(struct timespec const *pStart)
+{
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	return (double)(now.tv_sec - pStart->tv_sec) + ((double)(now.tv_nsec - pStart->tv_nsec) / 1e9);
+}
+
+static void write_or_die(FILE *pFileOut, void const *pData, size_t len)
+{
+	if (fwrite(pData, 1u, len, pFileOut) != len) {
+		perror("fwrite()");
+		exit(EXIT_FAILURE);
+	}
+}
+
+/************************************************************************************/
+
+void compress_payload(char const * const filename_output, uint8_t const *pPayload, size_t payloadLen,
+	bool signedLayout, int level, size_t blockSize, unsigned int numThreads)
+{
+	assert(filename_output);
+	assert(pPayload);
+	assert(blockSize);
+	assert((level >= 0) && (level <= MZ_UBER_COMPRESSION));
+
+	struct timespec start;
+	clock_gettime(CLOCK_MONOTONIC, &start);
+
+	struct CompressJob job = {
+		.pInput = pPayload,
+		.inputLen = payloadLen,
+		.blockSize = blockSize,
+		.numBlocks = (payloadLen + blockSize - 1u) / blockSize,
+		.nextBlock = 0u,
+		// negative window bits => raw deflate, we add the zlib wrapper ourselves
+		.flags = (int)tdefl_create_comp_flags_from_zip_params(level, -MZ_DEFAULT_WINDOW_BITS,
+			MZ_DEFAULT_STRATEGY),
+		.pBlocks = NULL,
+	};
+
+	if (!job.numBlocks) {
+		job.numBlocks = 1u; // still need a final block
+	}
+
+	if (numThreads > job.numBlocks) {
+		numThreads = (unsigned int)job.numBlocks;
+	}
+
+	job.pBlocks = calloc(job.numBlocks, sizeof(struct CompressedBlock));
+	assert(job.pBlocks);
+
+	printf("Compressing %lu bytes at level %d, in %lu blocks of %lu KiB on %u threads\n",
+		payloadLen, level, job.numBlocks, blockSize / 1024u, numThreads);
+
+	pthread_t *pThreads = calloc(numThreads, sizeof(pthread_t));
+	assert(pThreads);
+
+	for (unsigned int i = 0u; i < numThreads; i++) {
+		if (pthread_create(&pThreads[i], NULL, compress_worker, &job) != 0) {
+			perror("pthread_create()");
+			exit(EXIT_FAILURE);
+		}
+	}
+
+	// the Adler-32 for the zlib trailer is over the whole input, so do that while we wait
+	uint32_t const adler = (uint32_t)mz_adler32(MZ_ADLER32_INIT, pPayload, payloadLen);
+
+	for (unsigned int i = 0u; i < numThreads; i++) {
+		pthread_join(pThreads[i], NULL);
+	}
+	free(pThreads);
+
+	//
+	// assemble the zlib stream: header, blocks, Adler-32 (big endian)
+	//
+	size_t compressedLen = 2u + 4u;
+	for (size_t i = 0u; i < job.numBlocks; i++) {
+		compressedLen += job.pBlocks[i].len;
+	}
+
+	uint8_t *pCompressed = malloc(compressedLen);
+	assert(pCompressed);
+
+	{
+		uint8_t const cmf = 0x78u; // deflate, 32 KiB window
+		uint8_t flevel = (level < 2) ? 0u : (level < 6) ? 1u : (level == 6) ? 2u : 3u;
+		uint8_t flg = (uint8_t)(flevel << 6);
+		flg = (uint8_t)(flg + (31u - ((((unsigned int)cmf << 8) | flg) % 31u)));
+
+		pCompressed[0] = cmf;
+		pCompressed[1] = flg;
+	}
+
+	size_t offset = 2u;
+	for (size_t i = 0u; i < job.numBlocks; i++) {
+		memcpy(pCompressed + offset, job.pBlocks[i].pData, job.pBlocks[i].len);
+		offset += job.pBlocks[i].len;
+		free(job.pBlocks[i].pData);
+	}
+	free(job.pBlocks);
+
+	pCompressed[offset++] = (uint8_t)(adler >> 24);
+	pCompressed[offset++] = (uint8_t)(adler >> 16);
+	pCompressed[offset++] = (uint8_t)(adler >> 8);
+	pCompressed[offset++] = (uint8_t)adler;
+	assert(offset == compressedLen);
+
+	double const compressSeconds = elapsed_seconds(&start);
+
+	//
+	// check the stream round-trips, as the HSS will decompress it
+	//
+	{
+		uint8_t *pCheck = malloc(payloadLen ? payloadLen : 1u);
+		assert(pCheck);
+
+		mz_ulong checkLen = payloadLen;
+		int status = mz_uncompress(pCheck, &checkLen, pCompressed, compressedLen);
+		if ((status != MZ_OK) || (checkLen != payloadLen) || memcmp(pCheck, pPayload, payloadLen)) {
+			fprintf(stderr, "Compressed payload failed verification - %d\n", status);
+			exit(EXIT_FAILURE);
+		}
+
+		free(pCheck);
+	}
+
+	//
+	// and output the compressed image
+	//
+	struct HSS_CompressedImage imgHdr;
+	size_t const headerLen = signedLayout ? sizeof(struct HSS_CompressedImage) : COMPRESSED_HEADER_UNSIGNED_LEN;
+	assert(headerLen <= sizeof(imgHdr));
+
+	memset(&imgHdr, 0, sizeof(imgHdr));
+	imgHdr.magic = mHSS_COMPRESSED_MAGIC;
+	imgHdr.version = mHSS_COMPRESSED_VERSION_DEFLATE;
+	imgHdr.headerLength = headerLen;
+	imgHdr.compressedCrc = CRC32_calculate(pCompressed, compressedLen);
+	imgHdr.originalCrc = CRC32_calculate(pPayload, payloadLen);
+	imgHdr.compressedImageLen = compressedLen;
+	imgHdr.originalImageLen = payloadLen;
+	imgHdr.headerCrc = CRC32_calculate((uint8_t const *)&imgHdr, headerLen);
+
+	FILE *pFileOut = fopen(filename_output, "w");
+	if (!pFileOut) {
+		perror("fopen()");
+		exit(EXIT_FAILURE);
+	}
+
+	write_or_die(pFileOut, &imgHdr, headerLen);
+	write_or_die(pFileOut, pCompressed, compressedLen);
+
+	if (fclose(pFileOut) != 0) {
+		perror("fclose()");
+		exit(EXIT_FAILURE);
+	}
+
+	free(pCompressed);
+
+	//
+	// report
+	//
+	unsigned long const estimatedMillisecs =
+		(unsigned long)(((payloadLen * TARGET_CYCLES_PER_OUTPUT_BYTE)
+			+ (compressedLen * TARGET_CYCLES_PER_INPUT_BYTE)) / (TARGET_CPU_MHZ * 1000u));
+
+	printf("Compressed payload is %lu bytes (%lu byte header), ratio %.2f:1 (%.1f%% of original), "
+		"in %.2f s\n",
+		headerLen + compressedLen, headerLen,
+		compressedLen ? (double)payloadLen / (double)compressedLen : 0.0,
+		payloadLen ? (100.0 * (double)compressedLen / (double)payloadLen) : 0.0,
+		compressSeconds);
+	printf("Estimated on-target decompress time is ~%lu ms (E51 at %u MHz)\n",
+		estimatedMillisecs, TARGET_CPU_MHZ);
+}
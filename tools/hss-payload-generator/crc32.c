@@ -25,6 +25,8 @@
  * IN THE SOFTWARE.
  */
 
+#include <stdbool.h>
+
 #include "crc32.h"
 
 /*
@@ -90,10 +92,50 @@ static inline uint32_t CRC32_updateByte(uint32_t crc32, const uint8_t byte)
 	return crc32 & CRC32_MASK;
 }
 
+//
+// Slicing-by-8: sliceTable_[n][i] is the CRC of byte i followed by n zero bytes,
+// so that eight input bytes can be folded in per step. Derived from precalcTable_
+// on first use.
+//
+static uint32_t sliceTable_[8][256];
+static bool sliceTableValid_ = false;
+
+static void CRC32_initSliceTable(void)
+{
+	for (size_t i = 0u; i < 256u; i++) {
+		uint32_t crc32 = precalcTable_[i];
+
+		sliceTable_[0][i] = crc32;
+		for (size_t n = 1u; n < 8u; n++) {
+			crc32 = (crc32 >> 8) ^ precalcTable_[crc32 & 0xFF];
+			sliceTable_[n][i] = crc32;
+		}
+	}
+
+	sliceTableValid_ = true;
+}
+
 uint32_t CRC32_calculate_ex(uint32_t seed, uint8_t const *pInput, size_t numBytes)
 {
 	uint32_t crc32 = ~seed;
 
+	if (!sliceTableValid_) {
+		CRC32_initSliceTable();
+	}
+
+	while (numBytes >= 8u) {
+		uint32_t const lo = crc32 ^ ((uint32_t)pInput[0] | ((uint32_t)pInput[1] << 8)
+			| ((uint32_t)pInput[2] << 16) | ((uint32_t)pInput[3] << 24));
+
+		crc32 = sliceTable_[7][lo & 0xFF] ^ sliceTable_[6][(lo >> 8) & 0xFF]
+			^ sliceTable_[5][(lo >> 16) & 0xFF] ^ sliceTable_[4][lo >> 24]
+			^ sliceTable_[3][pInput[4]] ^ sliceTable_[2][pInput[5]]
+			^ sliceTable_[1][pInput[6]] ^ sliceTable_[0][pInput[7]];
+
+		pInput += 8;
+		numBytes -= 8u;
+	}
+
 	while (numBytes--) {
 		crc32 = CRC32_updateByte(crc32, *pInput);
 		++pInput;
@@ -0,0 +1,441 @@
+/******************************************************************************************
+ *
+ * MPFS HSS Embedded Software - tools/hss-payload-generator
+ *
+ * Copyright 2020-2025 Microchip FPGA Embedded Systems Solutions.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ *
+ */
+
+/*
+ * Delta payload generation
+ *
+ * Diffs two payloads chunk by chunk, and emits an HSS_DeltaImage which patches the
+ * base payload into the new one. Chunks which are unchanged at the same offset cost
+ * nothing. Chunks which are unchanged but have moved (e.g. because an earlier chunk
+ * grew) are copied from elsewhere in the base payload. Everything else which differs,
+ * including the header and chunk tables, is carried in the delta itself.
+ *
+ * The HSS applies the records to a copy of the base payload, so the generator does the
+ * same here, and checks the result matches the new payload before writing the delta.
+ */
+
+#define _FILE_OFFSET_BITS 64
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#include "crc32.h"
+#include "debug_printf.h"
+#include "delta_payload.h"
+
+#ifndef CONFIG_CC_HAS_INTTYPES
+#	define CONFIG_CC_HAS_INTTYPES 1
+#endif
+#ifndef CONFIG_CRYPTO_SIGNING
+#	define CONFIG_CRYPTO_SIGNING 1
+#endif
+
+#include "hss_types.h"
+
+#define DELTA_GRANULE         64u    // granularity at which data is compared
+#define DELTA_MERGE_GAP       256u   // changed ranges closer than this are sent as one
+#define DELTA_MIN_MOVED_SIZE  256u   // smaller moved chunks are cheaper to send as data
+#define DELTA_ALIGNMENT       8u
+
+#define ROUNDUP_DELTA(x)      (((x) + DELTA_ALIGNMENT - 1u) & ~((size_t)DELTA_ALIGNMENT - 1u))
+
+struct Payload {
+	uint8_t *pData;
+	size_t len;
+	struct HSS_BootChunkDesc const *pChunks;
+	size_t numChunks;
+};
+
+static struct HSS_DeltaRecord *pRecords = NULL;
+static size_t numRecords = 0u;
+static size_t recordCapacity = 0u;
+
+/************************************************************************************/
+
+static void load_payload(char const * const filename, struct Payload *pPayload) __attribute__((nonnull));
+static void add_record(uint32_t type, size_t dstOffset, size_t srcOffset, size_t size);
+static int compare_chunks(void const *pA, void const *pB) __attribute__((nonnull));
+static struct HSS_BootChunkDesc const *find_moved_chunk(struct Payload const *pBase,
+	struct HSS_BootChunkDesc const **ppSorted, uint8_t const *pData, size_t size, uint32_t crc32)
+	__attribute__((nonnull));
+
+/************************************************************************************/
+
+static void load_payload(char const * const filename, struct Payload *pPayload)
+{
+	FILE *pFileIn = fopen(filename, "rb");
+	if (!pFileIn) {
+		perror("fopen()");
+		exit(EXIT_FAILURE);
+	}
+
+	if (fseek(pFileIn, 0, SEEK_END) != 0) {
+		perror("fseek()");
+		exit(EXIT_FAILURE);
+	}
+
+	long const fileSize = ftell(pFileIn);
+	rewind(pFileIn);
+
+	if (fileSize < (long)sizeof(struct HSS_BootImage)) {
+		fprintf(stderr, "%s: too small to be a payload\n", filename);
+		exit(EXIT_FAILURE);
+	}
+
+	pPayload->len = (size_t)fileSize;
+	pPayload->pData = malloc(pPayload->len);
+	assert(pPayload->pData);
+
+	if (fread(pPayload->pData, 1u, pPayload->len, pFileIn) != pPayload->len) {
+		perror("fread()");
+		exit(EXIT_FAILURE);
+	}
+	fclose(pFileIn);
+
+	struct HSS_BootImage const * const pBootImage = (struct HSS_BootImage const *)pPayload->pData;
+
+	if (pBootImage->magic == mHSS_COMPRESSED_MAGIC) {
+		fprintf(stderr, "%s: compressed payloads are not supported, "
+			"use the uncompressed payloads instead\n", filename);
+		exit(EXIT_FAILURE);
+	} else if (pBootImage->magic != mHSS_BOOT_MAGIC) {
+		fprintf(stderr, "%s: not a payload (expected magic %x, got %x)\n", filename,
+			mHSS_BOOT_MAGIC, pBootImage->magic);
+		exit(EXIT_FAILURE);
+	} else if (pBootImage->bootImageLength != pPayload->len) {
+		fprintf(stderr, "%s: payload length is %lu, but file is %lu bytes\n", filename,
+			pBootImage->bootImageLength, pPayload->len);
+		exit(EXIT_FAILURE);
+	}
+
+	//
+	// the chunk table is terminated by a zero-sized sentinel
+	//
+	size_t const tableOffset = pBootImage->chunkTableOffset;
+	size_t const maxChunks = (tableOffset < pPayload->len) ?
+		((pPayload->len - tableOffset) / sizeof(struct HSS_BootChunkDesc)) : 0u;
+
+	pPayload->pChunks = (struct HSS_BootChunkDesc const *)(pPayload->pData + tableOffset);
+	pPayload->numChunks = 0u;
+
+	while ((pPayload->numChunks < maxChunks) && pPayload->pChunks[pPayload->numChunks].size) {
+		struct HSS_BootChunkDesc const * const pChunk = &pPayload->pChunks[pPayload->numChunks];
+
+		if ((pChunk->loadAddr > pPayload->len) || (pChunk->size > (pPayload->len - pChunk->loadAddr))) {
+			fprintf(stderr, "%s: chunk %lu lies outside the payload\n", filename,
+				pPayload->numChunks);
+			exit(EXIT_FAILURE);
+		}
+
+		pPayload->numChunks++;
+	}
+
+	if (pPayload->numChunks == maxChunks) {
+		fprintf(stderr, "%s: chunk table is not terminated\n", filename);
+		exit(EXIT_FAILURE);
+	}
+
+	debug_printf(1, "%s: %lu bytes, %lu chunks\n", filename, pPayload->len, pPayload->numChunks);
+}
+
+static void add_record(uint32_t type, size_t dstOffset, size_t srcOffset, size_t size)
+{
+	if (numRecords == recordCapacity) {
+		recordCapacity = recordCapacity ? (recordCapacity * 2u) : 64u;
+		pRecords = realloc(pRecords, recordCapacity * sizeof(struct HSS_DeltaRecord));
+		assert(pRecords);
+	}
+
+	pRecords[numRecords].type = type;
+	pRecords[numRecords].reserved = 0u;
+	pRecords[numRecords].dstOffset = dstOffset;
+	pRecords[numRecords].srcOffset = srcOffset;
+	pRecords[numRecords].size = size;
+	numRecords++;
+}
+
+static int compare_chunks(void const *pA, void const *pB)
+{
+	struct HSS_BootChunkDesc const * const pChunkA = *(struct HSS_BootChunkDesc const * const *)pA;
+	struct HSS_BootChunkDesc const * const pChunkB = *(struct HSS_BootChunkDesc const * const *)pB;
+
+	int result = 0;
+
+	if (pChunkA->size != pChunkB->size) {
+		result = (pChunkA->size < pChunkB->size) ? -1 : 1;
+	} else if (pChunkA->crc32 != pChunkB->crc32) {
+		result = (pChunkA->crc32 < pChunkB->crc32) ? -1 : 1;
+	}
+
+	return result;
+}
+
+static struct HSS_BootChunkDesc const *find_moved_chunk(struct Payload const *pBase,
+	struct HSS_BootChunkDesc const **ppSorted, uint8_t const *pData, size_t size, uint32_t crc32)
+{
+	struct HSS_BootChunkDesc const *pResult = NULL;
+
+	// lower bound on (size, crc32)
+	size_t low = 0u, high = pBase->numChunks;
+	while (low < high) {
+		size_t const mid = low + ((high - low) / 2u);
+		struct HSS_BootChunkDesc const * const pChunk = ppSorted[mid];
+
+		if ((pChunk->size < size) || ((pChunk->size == size) && (pChunk->crc32 < crc32))) {
+			low = mid + 1u;
+		} else {
+			high = mid;
+		}
+	}
+
+	for (size_t i = low; !pResult && (i < pBase->numChunks)
+		&& (ppSorted[i]->size == size) && (ppSorted[i]->crc32 == crc32); i++) {
+		if (!memcmp(pBase->pData + ppSorted[i]->loadAddr, pData, size)) {
+			pResult = ppSorted[i];
+		}
+	}
+
+	return pResult;
+}
+
+/************************************************************************************/
+
+void delta_payload(char const * const filename_base, char const * const filename_new,
+	char const * const filename_output)
+{
+	struct Payload base, update;
+
+	assert(filename_base);
+	assert(filename_new);
+	assert(filename_output);
+
+	load_payload(filename_base, &base);
+	load_payload(filename_new, &update);
+
+	//
+	// build the image as the HSS will, starting from the base payload... anything past
+	// the end of the base payload is unknown, so make sure it compares as different
+	//
+	uint8_t *pResult = malloc(update.len);
+	assert(pResult);
+
+	size_t const commonLen = (base.len < update.len) ? base.len : update.len;
+	memcpy(pResult, base.pData, commonLen);
+	for (size_t i = commonLen; i < update.len; i++) {
+		pResult[i] = (uint8_t)~update.pData[i];
+	}
+
+	//
+	// first, chunks which are unchanged but have moved
+	//
+	struct HSS_BootChunkDesc const **ppSorted = calloc(base.numChunks + 1u, sizeof(*ppSorted));
+	assert(ppSorted);
+	for (size_t i = 0u; i < base.numChunks; i++) {
+		ppSorted[i] = &base.pChunks[i];
+	}
+	qsort(ppSorted, base.numChunks, sizeof(*ppSorted), compare_chunks);
+
+	size_t movedChunks = 0u, movedBytes = 0u;
+	for (size_t i = 0u; i < update.numChunks; i++) {
+		struct HSS_BootChunkDesc const * const pChunk = &update.pChunks[i];
+		uint8_t const * const pData = update.pData + pChunk->loadAddr;
+
+		if (((pChunk->loadAddr + pChunk->size) <= base.len)
+			&& !memcmp(base.pData + pChunk->loadAddr, pData, pChunk->size)) {
+			continue; // unchanged in place
+		} else if (pChunk->size < DELTA_MIN_MOVED_SIZE) {
+			continue;
+		}
+
+		struct HSS_BootChunkDesc const * const pBaseChunk = find_moved_chunk(&base, ppSorted,
+			pData, pChunk->size, pChunk->crc32);
+
+		if (pBaseChunk) {
+			debug_printf(1, "Chunk %lu: moved from 0x%lx to 0x%lx (%lu bytes)\n", i,
+				pBaseChunk->loadAddr, pChunk->loadAddr, pChunk->size);
+
+			add_record(DELTA_RECORD_COPY_BASE, pChunk->loadAddr, pBaseChunk->loadAddr, pChunk->size);
+			memcpy(pResult + pChunk->loadAddr, base.pData + pBaseChunk->loadAddr, pChunk->size);
+
+			movedChunks++;
+			movedBytes += pChunk->size;
+		}
+	}
+	free(ppSorted);
+
+	//
+	// then, everything else that still differs... including the header, chunk tables and
+	// changed chunks
+	//
+	size_t const firstDataRecord = numRecords;
+	size_t dataBytes = 0u;
+	size_t runStart = 0u, runEnd = 0u;
+	bool inRun = false;
+
+	for (size_t offset = 0u; offset < update.len; offset += DELTA_GRANULE) {
+		size_t const len = ((update.len - offset) < DELTA_GRANULE) ? (update.len - offset) : DELTA_GRANULE;
+
+		if (!memcmp(pResult + offset, update.pData + offset, len)) {
+			continue;
+		}
+
+		if (inRun && ((offset - runEnd) < DELTA_MERGE_GAP)) {
+			runEnd = offset + len;
+		} else {
+			if (inRun) {
+				add_record(DELTA_RECORD_COPY_DELTA, runStart, 0u, runEnd - runStart);
+			}
+			inRun = true;
+			runStart = offset;
+			runEnd = offset + len;
+		}
+	}
+	if (inRun) {
+		add_record(DELTA_RECORD_COPY_DELTA, runStart, 0u, runEnd - runStart);
+	}
+
+	//
+	// lay out the delta: header, record table, then data for each record
+	//
+	struct HSS_DeltaImage deltaHdr;
+	memset(&deltaHdr, 0, sizeof(deltaHdr));
+
+	deltaHdr.magic = mHSS_DELTA_MAGIC;
+	deltaHdr.version = mHSS_DELTA_VERSION;
+	deltaHdr.headerLength = ROUNDUP_DELTA(sizeof(struct HSS_DeltaImage));
+	deltaHdr.recordTableOffset = deltaHdr.headerLength;
+	deltaHdr.numRecords = numRecords;
+
+	size_t offset = ROUNDUP_DELTA(deltaHdr.recordTableOffset + (numRecords * sizeof(struct HSS_DeltaRecord)));
+	for (size_t i = firstDataRecord; i < numRecords; i++) {
+		pRecords[i].srcOffset = offset;
+		offset = ROUNDUP_DELTA(offset + pRecords[i].size);
+		dataBytes += pRecords[i].size;
+	}
+	deltaHdr.deltaImageLength = offset;
+
+	uint8_t *pDelta = calloc(1u, deltaHdr.deltaImageLength);
+	assert(pDelta);
+
+	memcpy(pDelta + deltaHdr.recordTableOffset, pRecords, numRecords * sizeof(struct HSS_DeltaRecord));
+	for (size_t i = firstDataRecord; i < numRecords; i++) {
+		debug_printf(1, "Data: 0x%lx..0x%lx (%lu bytes)\n", pRecords[i].dstOffset,
+			pRecords[i].dstOffset + pRecords[i].size, pRecords[i].size);
+
+		memcpy(pDelta + pRecords[i].srcOffset, update.pData + pRecords[i].dstOffset, pRecords[i].size);
+		memcpy(pResult + pRecords[i].dstOffset, pDelta + pRecords[i].srcOffset, pRecords[i].size);
+	}
+
+	if (memcmp(pResult, update.pData, update.len)) {
+		fprintf(stderr, "Delta failed verification\n");
+		exit(EXIT_FAILURE);
+	}
+
+	deltaHdr.baseImageLength = base.len;
+	deltaHdr.baseImageCrc = CRC32_calculate(base.pData, base.len);
+	deltaHdr.newImageLength = update.len;
+	deltaHdr.newImageCrc = CRC32_calculate(update.pData, update.len);
+	deltaHdr.bodyCrc = CRC32_calculate(pDelta + deltaHdr.headerLength,
+		deltaHdr.deltaImageLength - deltaHdr.headerLength);
+	deltaHdr.headerCrc = CRC32_calculate((uint8_t const *)&deltaHdr, sizeof(deltaHdr));
+	memcpy(pDelta, &deltaHdr, sizeof(deltaHdr));
+
+	FILE *pFileOut = fopen(filename_output, "wb");
+	if (!pFileOut) {
+		perror("fopen()");
+		exit(EXIT_FAILURE);
+	}
+
+	if ((fwrite(pDelta, 1u, deltaHdr.deltaImageLength, pFileOut) != deltaHdr.deltaImageLength)
+		|| (fclose(pFileOut) != 0)) {
+		perror("fwrite()");
+		exit(EXIT_FAILURE);
+	}
+
+	printf("Base payload: %lu bytes, %lu chunks, CRC 0x%08x\n", base.len, base.numChunks,
+		deltaHdr.baseImageCrc);
+	printf("New payload:  %lu bytes, %lu chunks, CRC 0x%08x\n", update.len, update.numChunks,
+		deltaHdr.newImageCrc);
+	printf("Delta is %lu bytes (%.2f%% of the new payload), with %lu moved chunks (%lu bytes)"
+		" and %lu changed ranges (%lu bytes)\n", deltaHdr.deltaImageLength,
+		(100.0 * (double)deltaHdr.deltaImageLength) / (double)update.len,
+		movedChunks, movedBytes, numRecords - firstDataRecord, dataBytes);
+
+	free(pDelta);
+	free(pResult);
+	free(pRecords);
+	pRecords = NULL;
+	numRecords = recordCapacity = 0u;
+	free(base.pData);
+	free(update.pData);
+}
+
+void delta_dump(void const *pImage, size_t imageLen)
+{
+	struct HSS_DeltaImage const * const pDelta = pImage;
+
+	assert(imageLen >= sizeof(struct HSS_DeltaImage));
+
+	printf("magic:              0x%x\n", pDelta->magic);
+	printf("version:            0x%x\n", pDelta->version);
+	printf("headerLength:       0x%lx\n", pDelta->headerLength);
+	printf("headerCrc:          0x%08x\n", pDelta->headerCrc);
+	printf("bodyCrc:            0x%08x\n", pDelta->bodyCrc);
+	printf("deltaImageLength:   %lu\n", pDelta->deltaImageLength);
+	printf("baseImageLength:    %lu (CRC 0x%08x)\n", pDelta->baseImageLength, pDelta->baseImageCrc);
+	printf("newImageLength:     %lu (CRC 0x%08x)\n", pDelta->newImageLength, pDelta->newImageCrc);
+	printf("recordTableOffset:  0x%lx\n", pDelta->recordTableOffset);
+	printf("numRecords:         %lu\n", pDelta->numRecords);
+
+	if ((pDelta->deltaImageLength > imageLen) || (pDelta->recordTableOffset > imageLen)
+		|| (pDelta->numRecords > ((imageLen - pDelta->recordTableOffset) / sizeof(struct HSS_DeltaRecord)))) {
+		printf("Warning: delta image is truncated\n");
+		return;
+	}
+
+	struct HSS_DeltaImage shadowHdr = *pDelta;
+	shadowHdr.headerCrc = 0u;
+	bool const headerCrcOk = (CRC32_calculate((uint8_t const *)&shadowHdr, sizeof(shadowHdr))
+		== pDelta->headerCrc);
+	bool const bodyCrcOk = (pDelta->headerLength <= pDelta->deltaImageLength)
+		&& (CRC32_calculate((uint8_t const *)pImage + pDelta->headerLength,
+			pDelta->deltaImageLength - pDelta->headerLength) == pDelta->bodyCrc);
+	printf("CRCs:               header %s, body %s\n", headerCrcOk ? "ok" : "BAD",
+		bodyCrcOk ? "ok" : "BAD");
+
+	struct HSS_DeltaRecord const * const pRecord = (struct HSS_DeltaRecord const *)
+		((uint8_t const *)pImage + pDelta->recordTableOffset);
+
+	for (size_t i = 0u; i < pDelta->numRecords; i++) {
+		printf(" - record %lu: 0x%08lx..0x%08lx (%9lu bytes) from %s 0x%lx\n", i,
+			pRecord[i].dstOffset, pRecord[i].dstOffset + pRecord[i].size, pRecord[i].size,
+			(pRecord[i].type == DELTA_RECORD_COPY_BASE) ? "base " : "delta", pRecord[i].srcOffset);
+	}
+}
@@ -44,6 +44,8 @@
 #include "dump_payload.h"
 #include "crc32.h"
 #include "verify_payload.h"
+#include "delta_payload.h"
+#include "merkle.h"
 
 #define PRV_U (0u)
 #define PRV_S (1u)
@@ -107,6 +109,13 @@ void dump_payload(const char *filename_input, const char *public_key_filename)
 		exit(EXIT_FAILURE);
 	}
 
+	if ((fileSize >= sizeof(struct HSS_DeltaImage)) && (pBootImage->magic == mHSS_DELTA_MAGIC)) {
+		delta_dump(raw_image, fileSize);
+		munmap(raw_image, fileSize);
+		close(fdIn);
+		return;
+	}
+
 	if (pBootImage->magic != mHSS_BOOT_MAGIC) {
 		printf("Warning: does not look like a valid boot image"
 			" (expected magic %x, got %x)\n", mHSS_BOOT_MAGIC, pBootImage->magic);
@@ -239,6 +248,25 @@ void dump_payload(const char *filename_input, const char *public_key_filename)
 	printf("ZI Chunks: total of %lu chunk%s found\n", (unsigned long)totalChunkCount,
 		(totalChunkCount != 1u) ? "s":"");
 
+	if (pBootImage->version == mHSS_BOOT_VERSION_MERKLE) {
+		struct HSS_MerkleTable const *pTable = merkle_get_table(pBootImage, fileSize);
+
+		if (!pTable) {
+			printf("Merkle table:       not found\n");
+		} else {
+			printf("Merkle leaves:      %lu at 0x%lx\n", (unsigned long)pTable->numLeaves,
+				(unsigned long)pTable->leafTableOffset);
+			printf("Merkle root:        ");
+			for (size_t i = 0u; i < ARRAY_SIZE(pTable->root); i++) {
+				printf("%02x", pTable->root[i]);
+			}
+			printf("\n");
+
+			bool result = merkle_check_payload(pBootImage, fileSize);
+			printf("Checking chunks against Merkle tree... %s\n", result ? "passed" : "failed");
+		}
+	}
+
 	// skipping binary file array
 
 	if (public_key_filename) {
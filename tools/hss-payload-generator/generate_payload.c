@@ -36,7 +36,10 @@
 #include "crc32.h"
 #include "debug_printf.h"
 #include "verify_payload.h"
+#include "compress_payload.h"
+#include "merkle.h"
 
+#include <openssl/evp.h>
 #include <openssl/ec.h>
 #include <openssl/ecdsa.h>
 #include <openssl/pem.h>
@@ -94,6 +97,15 @@ static_assert(sizeof(void *)==8, "Fatal: this program requires a 64bit compiler"
 
 #define PAD_SIZE  8
 
+// output is staged through a write buffer, and hashed as it is flushed...
+#define WRITE_BUFFER_SIZE  (4u * 1024u * 1024u)
+
+// initial number of entries in the chunk tables, doubled whenever they fill
+#define CHUNK_TABLE_INITIAL_CAPACITY  64u
+
+// zero runs are only split out of chunks on this alignment, to keep copies aligned
+#define ZI_SPLIT_ALIGNMENT  8u
+
 /************************************************************************************/
 
 static struct chunkTableEntry {
@@ -106,21 +118,82 @@ static struct ziChunkTableEntry {
 
 static size_t numChunks = 0;
 static size_t numZIChunks = 0;
-
-off_t bootImagePaddedSize = 0u;
-off_t chunkTablePaddedSize = 0u;
-off_t ziChunkTablePaddedSize = 0u;
+static size_t chunkTableCapacity = 0u;
+static size_t ziChunkTableCapacity = 0u;
+
+static bool optimizeChunks = false;
+static size_t optimizeGapThreshold = 0u;
+static size_t optimizeZIThreshold = 0u;
+
+//
+// The payload is produced in a single sequential pass. The layout is fully known
+// before anything is written, so the header (including its CRC) is finalized up
+// front, and the SHA-384 digest for signing is accumulated as the data is written
+// rather than by reading the payload back in afterwards.
+//
+// The payload can instead be produced in memory, for compression.
+//
+static struct PayloadWriter {
+	FILE *pFile;                    // NULL if writing to memory
+	uint8_t *pMemory;
+	size_t memoryLen;
+	uint8_t *pBuffer;
+	size_t bufferUsed;
+	size_t offset;                  // total bytes written so far, including buffered
+	size_t outputOffset;            // total bytes flushed
+	EVP_MD_CTX *pDigestCtx;         // NULL unless signing
+	size_t digestLen;               // only the first digestLen bytes are hashed
+} writer = { NULL, NULL, 0u, NULL, 0u, 0u, 0u, NULL, SIZE_MAX };
+
+static bool compressPayload = false;
+static int compressLevel = 0;
+static size_t compressBlockSize = 0u;
+static unsigned int compressThreads = 1u;
+
+//
+// For a Merkle payload, the Merkle table goes between the header and the chunk table,
+// and the leaves (one hash per chunk) at the end of the header, outside of the signed
+// region
+//
+static bool merklePayload = false;
+static struct HSS_MerkleTable merkleTable;
+static uint8_t *pMerkleLeaves = NULL;
 
 /************************************************************************************/
 
 static size_t calculate_padding(size_t size, size_t pad);
-static void write_pad(FILE *pFileOut, size_t pad) __attribute__((nonnull));
-static void generate_header(FILE *pFileOut, struct HSS_BootImage *pBootImage) __attribute__((nonnull));
-static void generate_chunks(FILE *pFileOut) __attribute__((nonnull));
-static void generate_ziChunks(FILE *pFileOut) __attribute__((nonnull));
-static void generate_blobs(FILE *pFileOut) __attribute__((nonnull));
-static void sign_payload(FILE *pFileOut, char const * const private_key_filename,
-	char const * const public_key_filename) __attribute__((nonnull(1)));
+static void *grow_table(void *pTable, size_t *pCapacity, size_t entrySize) __attribute__((nonnull(2)));
+static void writer_init_(bool digest);
+static void writer_open(char const * const filename, bool digest) __attribute__((nonnull));
+static void writer_open_memory(size_t size, bool digest);
+static void writer_output_(void const *pData, size_t size) __attribute__((nonnull));
+static void writer_flush(void);
+static void writer_write(void const *pData, size_t size) __attribute__((nonnull));
+static void writer_pad(size_t pad);
+static void writer_close(uint8_t digest[SHA384_DIGEST_LENGTH]);
+static size_t calculate_payload_size(void);
+static bool is_gap_free(uintptr_t start, uintptr_t end, size_t skipFirst, size_t skipLast);
+static size_t find_zero_run(uint8_t const *pBuffer, uintptr_t execAddr, size_t size, size_t start,
+	size_t *pRunLength) __attribute__((nonnull));
+static int compare_ziChunks(void const *pA, void const *pB) __attribute__((nonnull));
+static void coalesce_chunks(size_t *pMergedIndex) __attribute__((nonnull));
+static void add_chunk_piece_(struct HSS_BootChunkDesc const *pChunk, uint8_t const *pBuffer,
+	size_t start, size_t end) __attribute__((nonnull));
+static void split_zero_runs(size_t *pFirstPiece, size_t *pLastPiece) __attribute__((nonnull));
+static void coalesce_ziChunks(void);
+static void optimize_chunks(void);
+static void calculate_layout(void);
+static void calculate_merkle_tree(void);
+static void generate_header(struct HSS_BootImage *pBootImage) __attribute__((nonnull));
+static void generate_chunks(void);
+static void generate_ziChunks(void);
+static void generate_merkle_leaves(void);
+static void generate_blobs(void);
+static void rewrite_header(char const * const filename_output, struct HSS_BootImage *pBootImage) __attribute__((nonnull));
+static void sign_payload(uint8_t digest[SHA384_DIGEST_LENGTH], char const * const private_key_filename)
+	__attribute__((nonnull));
+static void check_payload_signature(char const * const filename_output, uint8_t *pPayload,
+	char const * const public_key_filename) __attribute__((nonnull(1, 3)));
 
 extern struct HSS_BootImage bootImage;
 
@@ -139,89 +212,541 @@ static size_t calculate_padding(size_t size, size_t pad)
 	return result;
 }
 
-static void write_pad(FILE *pFileOut, size_t pad)
+static void *grow_table(void *pTable, size_t *pCapacity, size_t entrySize)
 {
-	assert(pFileOut);
+	size_t newCapacity = *pCapacity ? (*pCapacity * 2u) : CHUNK_TABLE_INITIAL_CAPACITY;
 
-	size_t i;
+	debug_printf(6, "\nAttempting to realloc %lu at %p", newCapacity * entrySize, pTable);
+	void *tmpPtr = realloc(pTable, newCapacity * entrySize);
+	debug_printf(6, " => %p\n", tmpPtr);
+	if (!tmpPtr) {
+		perror("realloc()");
+		exit(EXIT_FAILURE);
+	}
 
-	for (i = 0u; i < pad; i++) {
-		fputc(0, pFileOut);
+	*pCapacity = newCapacity;
+	return tmpPtr;
+}
 
-		if (ferror(pFileOut) || feof(pFileOut)) {
-			perror("fwrite()");
-			exit(EXIT_SUCCESS);
-		}
+static void writer_init_(bool digest)
+{
+	writer.pBuffer = malloc(WRITE_BUFFER_SIZE);
+	assert(writer.pBuffer);
+	writer.bufferUsed = 0u;
+	writer.offset = 0u;
+	writer.outputOffset = 0u;
+	writer.digestLen = merklePayload ? merkleTable.leafTableOffset : SIZE_MAX;
+
+	if (digest) {
+		writer.pDigestCtx = EVP_MD_CTX_new();
+		assert(writer.pDigestCtx != NULL);
+		assert(EVP_DigestInit_ex(writer.pDigestCtx, EVP_sha384(), NULL) == 1);
 	}
 }
 
-static void generate_header(FILE *pFileOut, struct HSS_BootImage *pBootImage)
+static void writer_open(char const * const filename, bool digest)
 {
-	debug_printf(0, "Outputting Payload Header\n");
+	writer.pFile = fopen(filename, "w+");
+	if (!writer.pFile) {
+		perror("fopen()");
+		exit(EXIT_FAILURE);
+	}
 
-	assert(pFileOut);
-	assert(pBootImage);
+	// we do our own buffering...
+	setvbuf(writer.pFile, NULL, _IONBF, 0u);
+
+	writer_init_(digest);
+}
 
-	if (fseek(pFileOut, 0, SEEK_SET) != 0) {
-		perror("fseek()");
-		exit(EXIT_SUCCESS);
+static void writer_open_memory(size_t size, bool digest)
+{
+	writer.pMemory = malloc(size ? size : 1u);
+	if (!writer.pMemory) {
+		perror("malloc()");
+		exit(EXIT_FAILURE);
+	}
+	writer.memoryLen = size;
+
+	writer_init_(digest);
+}
+
+static void writer_output_(void const *pData, size_t size)
+{
+	if ((writer.pDigestCtx) && (writer.outputOffset < writer.digestLen)) {
+		assert(EVP_DigestUpdate(writer.pDigestCtx, pData,
+			MIN(size, writer.digestLen - writer.outputOffset)) == 1);
 	}
 
-	fwrite((char *)pBootImage, sizeof(struct HSS_BootImage), 1, pFileOut);
-	if (ferror(pFileOut) || feof(pFileOut)) {
+	if (writer.pMemory) {
+		assert((writer.outputOffset + size) <= writer.memoryLen);
+		memcpy(writer.pMemory + writer.outputOffset, pData, size);
+	} else if (fwrite(pData, 1u, size, writer.pFile) != size) {
 		perror("fwrite()");
-		exit(EXIT_SUCCESS);
+		exit(EXIT_FAILURE);
 	}
 
-	write_pad(pFileOut,
-		calculate_padding(sizeof(struct HSS_BootImage), PAD_SIZE));
+	writer.outputOffset += size;
+}
 
+static void writer_flush(void)
+{
+	if (writer.bufferUsed) {
+		writer_output_(writer.pBuffer, writer.bufferUsed);
+		writer.bufferUsed = 0u;
+	}
+}
 
-	bootImagePaddedSize = ftello(pFileOut);
+static void writer_write(void const *pData, size_t size)
+{
+	writer.offset += size;
+
+	if (size >= WRITE_BUFFER_SIZE) {
+		// large blobs go straight out, rather than being copied through the buffer
+		writer_flush();
+		writer_output_(pData, size);
+	} else {
+		if ((writer.bufferUsed + size) > WRITE_BUFFER_SIZE) {
+			writer_flush();
+		}
+
+		memcpy(writer.pBuffer + writer.bufferUsed, pData, size);
+		writer.bufferUsed += size;
+	}
 }
 
-static void generate_chunks(FILE *pFileOut)
+static void writer_pad(size_t pad)
 {
-	debug_printf(0, "Outputting Code/Data Chunks\n");
+	static const uint8_t zeros[PAD_SIZE] = { 0u };
 
-	assert(pFileOut);
+	assert(pad < PAD_SIZE);
+	writer_write(zeros, pad);
+}
 
-	bootImage.chunkTableOffset = (size_t)ftello(pFileOut);
+static void writer_close(uint8_t digest[SHA384_DIGEST_LENGTH])
+{
+	writer_flush();
+
+	if (writer.pDigestCtx) {
+		unsigned int digest_len = 0u;
+		assert(EVP_DigestFinal_ex(writer.pDigestCtx, digest, &digest_len) == 1);
+		assert(digest_len == SHA384_DIGEST_LENGTH);
+		EVP_MD_CTX_free(writer.pDigestCtx);
+		writer.pDigestCtx = NULL;
+	}
 
-	// sanity check we are were we expected to be, vis-a-vis file padding
-	assert(bootImage.chunkTableOffset ==
-			sizeof(struct HSS_BootImage)
-			+ calculate_padding(sizeof(struct HSS_BootImage), PAD_SIZE));
+	if (writer.pFile) {
+		if (fclose(writer.pFile) != 0) {
+			perror("fclose()");
+			exit(EXIT_FAILURE);
+		}
+		writer.pFile = NULL;
+	}
 
-	size_t cumulativeBlobSize = 0u;
+	free(writer.pBuffer);
+	writer.pBuffer = NULL;
+}
+
+static size_t calculate_payload_size(void)
+{
+	size_t size = sizeof(struct HSS_BootImage)
+		+ calculate_padding(sizeof(struct HSS_BootImage), PAD_SIZE)
+		+ (sizeof(struct HSS_BootChunkDesc) * (numChunks + 1))
+		+ calculate_padding(sizeof(struct HSS_BootChunkDesc) * (numChunks + 1), PAD_SIZE)
+		+ (sizeof(struct HSS_BootZIChunkDesc) * (numZIChunks + 1))
+		+ calculate_padding(sizeof(struct HSS_BootZIChunkDesc) * (numZIChunks + 1), PAD_SIZE);
+
+	for (size_t i = 0u; i < numChunks; i++) {
+		size += chunkTable[i].chunk.size + calculate_padding(chunkTable[i].chunk.size, PAD_SIZE);
+	}
+
+	return size;
+}
+
+//
+// A gap between two chunks is only zero-filled if no other chunk (of any owner)
+// or ZI chunk lands in it, otherwise we'd overwrite it at boot
+//
+static bool is_gap_free(uintptr_t start, uintptr_t end, size_t skipFirst, size_t skipLast)
+{
+	for (size_t i = 0u; i < numChunks; i++) {
+		if ((i >= skipFirst) && (i <= skipLast)) {
+			continue;
+		}
+
+		uintptr_t const chunkStart = chunkTable[i].chunk.execAddr;
+		if ((chunkStart < end) && ((chunkStart + chunkTable[i].chunk.size) > start)) {
+			return false;
+		}
+	}
+
+	for (size_t i = 0u; i < numZIChunks; i++) {
+		uintptr_t const ziStart = (uintptr_t)ziChunkTable[i].ziChunk.execAddr;
+		if ((ziStart < end) && ((ziStart + ziChunkTable[i].ziChunk.size) > start)) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+//
+// Merge runs of chunks for the same owner that are contiguous, or nearly so, in
+// memory, zero-filling the gaps between them. Ancilliary data is never merged, as
+// its address is passed to the payload.
+//
+static void coalesce_chunks(size_t *pMergedIndex)
+{
+	size_t newNumChunks = 0u;
+
+	for (size_t i = 0u; i < numChunks; ) {
+		struct HSS_BootChunkDesc * const pFirst = &chunkTable[i].chunk;
+		uintptr_t const start = pFirst->execAddr;
+		uintptr_t end = start + pFirst->size;
+		size_t j = i + 1u;
+
+		if (!(pFirst->owner & BOOT_FLAG_ANCILLIARY_DATA)) {
+			while ((j < numChunks)
+				&& (chunkTable[j].chunk.owner == pFirst->owner)
+				&& (chunkTable[j].chunk.execAddr >= end)
+				&& ((chunkTable[j].chunk.execAddr - end) <= optimizeGapThreshold)
+				&& ((chunkTable[j].chunk.execAddr == end)
+					|| is_gap_free(end, chunkTable[j].chunk.execAddr, i, j))) {
+				end = chunkTable[j].chunk.execAddr + chunkTable[j].chunk.size;
+				j++;
+			}
+		}
+
+		if ((j - i) > 1u) {
+			size_t const size = end - start;
+			uint8_t *pBuffer = calloc(1u, size);
+			assert(pBuffer);
+
+			debug_printf(2, "Merging chunks %lu-%lu into 0x%" PRIx64 "-0x%" PRIx64 "\n",
+				i, j - 1u, start, end);
+
+			for (size_t k = i; k < j; k++) {
+				memcpy(pBuffer + (chunkTable[k].chunk.execAddr - start), chunkTable[k].pBuffer,
+					chunkTable[k].chunk.size);
+				free(chunkTable[k].pBuffer);
+			}
+
+			chunkTable[i].pBuffer = pBuffer;
+			pFirst->size = size;
+			pFirst->crc32 = CRC32_calculate(pBuffer, size);
+		}
+
+		for (size_t k = i; k < j; k++) {
+			pMergedIndex[k] = newNumChunks;
+		}
+
+		chunkTable[newNumChunks] = chunkTable[i];
+		newNumChunks++;
+		i = j;
+	}
+
+	numChunks = newNumChunks;
+}
+
+//
+// Find the next run of zero bytes at or after start, aligned in the execution
+// address space. Returns the offset of the run, or size if there is none.
+//
+static size_t find_zero_run(uint8_t const *pBuffer, uintptr_t execAddr, size_t size, size_t start,
+	size_t *pRunLength)
+{
+	size_t offset = start + calculate_padding(execAddr + start, ZI_SPLIT_ALIGNMENT);
+
+	while ((offset + ZI_SPLIT_ALIGNMENT) <= size) {
+		uint64_t word;
+		memcpy(&word, pBuffer + offset, sizeof(word));
+
+		if (!word) {
+			size_t runEnd = offset + ZI_SPLIT_ALIGNMENT;
+
+			while ((runEnd + ZI_SPLIT_ALIGNMENT) <= size) {
+				memcpy(&word, pBuffer + runEnd, sizeof(word));
+				if (word) {
+					break;
+				}
+				runEnd += ZI_SPLIT_ALIGNMENT;
+			}
+
+			*pRunLength = runEnd - offset;
+			return offset;
+		}
+
+		offset += ZI_SPLIT_ALIGNMENT;
+	}
+
+	*pRunLength = 0u;
+	return size;
+}
+
+static void add_chunk_piece_(struct HSS_BootChunkDesc const *pChunk, uint8_t const *pBuffer,
+	size_t start, size_t end)
+{
+	uint8_t *pPiece = malloc(end - start);
+	assert(pPiece);
+	memcpy(pPiece, pBuffer + start, end - start);
+
+	struct HSS_BootChunkDesc chunk = *pChunk;
+	chunk.execAddr += start;
+	chunk.size = end - start;
+	chunk.crc32 = CRC32_calculate(pPiece, chunk.size);
+	generate_add_chunk(chunk, pPiece);
+}
+
+//
+// Split large runs of zeros out of chunks into ZI chunks, which the HSS zeroes
+// at boot rather than copying. Every chunk keeps at least some data, so that the
+// chunk ranges of each hart remain valid.
+//
+static void split_zero_runs(size_t *pFirstPiece, size_t *pLastPiece)
+{
+	struct chunkTableEntry *pOldTable = chunkTable;
+	size_t const oldNumChunks = numChunks;
+
+	chunkTable = NULL;
+	chunkTableCapacity = 0u;
+	numChunks = 0u;
+
+	for (size_t i = 0u; i < oldNumChunks; i++) {
+		struct HSS_BootChunkDesc const * const pChunk = &pOldTable[i].chunk;
+		uint8_t const * const pBuffer = pOldTable[i].pBuffer;
+		size_t const size = pChunk->size;
+		size_t pieceStart = 0u;
+		size_t offset = 0u;
+		size_t runLength = 0u;
+
+		pFirstPiece[i] = numChunks;
+
+		if (!(pChunk->owner & BOOT_FLAG_ANCILLIARY_DATA)) {
+			while ((offset = find_zero_run(pBuffer, pChunk->execAddr, size, offset, &runLength)) < size) {
+				bool const isWholeChunk = (offset == 0u) && (runLength == size);
+
+				if ((runLength >= optimizeZIThreshold) && !isWholeChunk) {
+					if (offset > pieceStart) {
+						add_chunk_piece_(pChunk, pBuffer, pieceStart, offset);
+					}
+
+					struct HSS_BootZIChunkDesc ziChunk = {
+						.owner = pChunk->owner,
+						.execAddr = (void *)(pChunk->execAddr + offset),
+						.size = runLength
+					};
+					generate_add_ziChunk(ziChunk);
+
+					pieceStart = offset + runLength;
+				}
+
+				offset += runLength;
+			}
+		}
+
+		if (!pieceStart) {
+			// nothing split out, so keep the chunk as-is
+			generate_add_chunk(*pChunk, pOldTable[i].pBuffer);
+		} else {
+			if (pieceStart < size) {
+				add_chunk_piece_(pChunk, pBuffer, pieceStart, size);
+			}
+			free(pOldTable[i].pBuffer);
+		}
+
+		pLastPiece[i] = numChunks - 1u;
+	}
+
+	free(pOldTable);
+}
+
+static int compare_ziChunks(void const *pA, void const *pB)
+{
+	struct HSS_BootZIChunkDesc const * const pZiA = &((struct ziChunkTableEntry const *)pA)->ziChunk;
+	struct HSS_BootZIChunkDesc const * const pZiB = &((struct ziChunkTableEntry const *)pB)->ziChunk;
+	int result;
+
+	if (pZiA->owner != pZiB->owner) {
+		result = (pZiA->owner < pZiB->owner) ? -1 : 1;
+	} else if (pZiA->execAddr != pZiB->execAddr) {
+		result = ((uintptr_t)pZiA->execAddr < (uintptr_t)pZiB->execAddr) ? -1 : 1;
+	} else {
+		result = 0;
+	}
+
+	return result;
+}
+
+//
+// ZI chunks are all zeroed before any chunks are downloaded, so their order doesn't
+// matter, and those for the same owner that abut or overlap can be merged
+//
+static void coalesce_ziChunks(void)
+{
+	if (numZIChunks) {
+		qsort(ziChunkTable, numZIChunks, sizeof(struct ziChunkTableEntry), compare_ziChunks);
+
+		size_t newNumZIChunks = 1u;
+
+		for (size_t i = 1u; i < numZIChunks; i++) {
+			struct HSS_BootZIChunkDesc * const pPrev = &ziChunkTable[newNumZIChunks - 1u].ziChunk;
+			struct HSS_BootZIChunkDesc const * const pThis = &ziChunkTable[i].ziChunk;
+			uintptr_t const prevEnd = (uintptr_t)pPrev->execAddr + pPrev->size;
+
+			if ((pThis->owner == pPrev->owner) && ((uintptr_t)pThis->execAddr <= prevEnd)) {
+				uintptr_t const thisEnd = (uintptr_t)pThis->execAddr + pThis->size;
+				if (thisEnd > prevEnd) {
+					pPrev->size = thisEnd - (uintptr_t)pPrev->execAddr;
+				}
+			} else {
+				ziChunkTable[newNumZIChunks] = ziChunkTable[i];
+				newNumZIChunks++;
+			}
+		}
+
+		numZIChunks = newNumZIChunks;
+	}
+}
+
+static void optimize_chunks(void)
+{
+	size_t const origNumChunks = numChunks;
+	size_t const origNumZIChunks = numZIChunks;
+	size_t const origPayloadSize = calculate_payload_size();
+
+	if (!numChunks) {
+		return;
+	}
+
+	size_t *pMergedIndex = malloc(sizeof(size_t) * origNumChunks);
+	size_t *pFirstPiece = malloc(sizeof(size_t) * origNumChunks);
+	size_t *pLastPiece = malloc(sizeof(size_t) * origNumChunks);
+	assert(pMergedIndex && pFirstPiece && pLastPiece);
+
+	coalesce_chunks(pMergedIndex);
+	if (optimizeZIThreshold) {
+		split_zero_runs(pFirstPiece, pLastPiece);
+	} else {
+		for (size_t i = 0u; i < numChunks; i++) {
+			pFirstPiece[i] = pLastPiece[i] = i;
+		}
+	}
+	coalesce_ziChunks();
+
+	// renumber the chunk range of each hart
+	for (size_t i = 0u; i < ARRAY_SIZE(bootImage.hart); i++) {
+		if (bootImage.hart[i].numChunks) {
+			assert(bootImage.hart[i].firstChunk < origNumChunks);
+			assert(bootImage.hart[i].lastChunk < origNumChunks);
+
+			bootImage.hart[i].firstChunk = pFirstPiece[pMergedIndex[bootImage.hart[i].firstChunk]];
+			bootImage.hart[i].lastChunk = pLastPiece[pMergedIndex[bootImage.hart[i].lastChunk]];
+			bootImage.hart[i].numChunks =
+				bootImage.hart[i].lastChunk - bootImage.hart[i].firstChunk + 1u;
+
+			debug_printf(1, "u54_%lu: firstChunk is %lu, lastChunk is %lu, numChunks is %lu\n",
+				i + 1u, bootImage.hart[i].firstChunk, bootImage.hart[i].lastChunk,
+				bootImage.hart[i].numChunks);
+		}
+	}
+
+	free(pMergedIndex);
+	free(pFirstPiece);
+	free(pLastPiece);
+
+	printf("Chunk optimization: %lu chunks, %lu ZI chunks, %lu bytes => "
+		"%lu chunks, %lu ZI chunks, %lu bytes\n",
+		origNumChunks, origNumZIChunks, origPayloadSize,
+		numChunks, numZIChunks, calculate_payload_size());
+}
+
+static void calculate_layout(void)
+{
+	//
+	// header, then chunk table, then ZI chunk table (each with a terminating sentinel
+	// and padded), then the blobs for each chunk in turn (each padded)...
+	//
+	bootImage.chunkTableOffset = sizeof(struct HSS_BootImage)
+		+ calculate_padding(sizeof(struct HSS_BootImage), PAD_SIZE);
+
+	if (merklePayload) {
+		// the HSS expects the Merkle table immediately after the header
+		assert(!calculate_padding(sizeof(struct HSS_BootImage), PAD_SIZE));
+		assert(!calculate_padding(sizeof(struct HSS_MerkleTable), PAD_SIZE));
+		bootImage.chunkTableOffset += sizeof(struct HSS_MerkleTable);
+	}
+
+	bootImage.ziChunkTableOffset = bootImage.chunkTableOffset
+		+ (sizeof(struct HSS_BootChunkDesc) * (numChunks + 1)) // account for sentinel
+		+ calculate_padding(sizeof(struct HSS_BootChunkDesc) * (numChunks + 1), PAD_SIZE);
+
+	bootImage.headerLength = bootImage.ziChunkTableOffset
+		+ (sizeof(struct HSS_BootZIChunkDesc) * (numZIChunks + 1)) // account for sentinel
+		+ calculate_padding(sizeof(struct HSS_BootZIChunkDesc) * (numZIChunks + 1), PAD_SIZE);
+
+	if (merklePayload) {
+		merkleTable.leafTableOffset = bootImage.headerLength;
+		bootImage.headerLength += numChunks * MERKLE_HASH_LEN;
+	}
+	debug_printf(4, "End of header is %lu\n", bootImage.headerLength);
+
+	size_t offset = bootImage.headerLength;
+
+	for (size_t i = 0u; i < numChunks; i++) {
+		chunkTable[i].chunk.loadAddr = offset;
+		offset += chunkTable[i].chunk.size + calculate_padding(chunkTable[i].chunk.size, PAD_SIZE);
+	}
+
+	bootImage.bootImageLength = offset;
+
+	bootImage.headerCrc =
+		CRC32_calculate((const unsigned char *)&bootImage, sizeof(struct HSS_BootImage));
+}
+
+static void calculate_merkle_tree(void)
+{
+	pMerkleLeaves = malloc(numChunks ? (numChunks * MERKLE_HASH_LEN) : 1u);
+	assert(pMerkleLeaves != NULL);
+
+	for (size_t i = 0u; i < numChunks; i++) {
+		merkle_hash_leaf(chunkTable[i].pBuffer, chunkTable[i].chunk.size,
+			pMerkleLeaves + (i * MERKLE_HASH_LEN));
+	}
+
+	merkleTable.magic = mHSS_MERKLE_MAGIC;
+	merkleTable.numLeaves = numChunks;
+	merkle_calculate_root(numChunks, pMerkleLeaves, merkleTable.root);
+
+	debug_printf(1, "Merkle tree: %lu leaves\n", numChunks);
+}
+
+static void generate_header(struct HSS_BootImage *pBootImage)
+{
+	debug_printf(0, "Outputting Payload Header\n");
+
+	assert(pBootImage);
+	assert(writer.offset == 0u);
+
+	writer_write(pBootImage, sizeof(struct HSS_BootImage));
+	writer_pad(calculate_padding(sizeof(struct HSS_BootImage), PAD_SIZE));
+
+	if (merklePayload) {
+		writer_write(&merkleTable, sizeof(struct HSS_MerkleTable));
+	}
+}
+
+static void generate_chunks(void)
+{
+	debug_printf(0, "Outputting Code/Data Chunks\n");
+
+	// sanity check we are were we expected to be, vis-a-vis file padding
+	assert(writer.offset == bootImage.chunkTableOffset);
 
 	for (size_t i = 0u; i < numChunks; i++) {
-		// calculate offset for chunk blob in file:
-		//   = len(header) + len(chunkTable) + len(ziChunkTable) + len(all previous blobs)
-		chunkTable[i].chunk.loadAddr =
-			bootImage.chunkTableOffset
-			+ (numChunks * sizeof(struct HSS_BootChunkDesc))
-			+ sizeof(struct HSS_BootChunkDesc) // account for sentinel
-			+ calculate_padding(sizeof(struct HSS_BootChunkDesc) * (numChunks + 1), PAD_SIZE)
-			+ (numZIChunks * sizeof(struct HSS_BootZIChunkDesc))
-			+ sizeof(struct HSS_BootZIChunkDesc) // account for sentinel
-			+ calculate_padding(sizeof(struct HSS_BootZIChunkDesc) * (numZIChunks +1), PAD_SIZE)
-			+ cumulativeBlobSize
-			+ calculate_padding(cumulativeBlobSize, PAD_SIZE);
-
-		cumulativeBlobSize += chunkTable[i].chunk.size
-			+ calculate_padding(chunkTable[i].chunk.size, PAD_SIZE);
-
-		off_t posn = ftello(pFileOut);
 		debug_printf(4, "\t- Processing chunk %lu (%lu bytes) at file position %lu "
 			"(blob is expected at %lu)\n",
-			i, chunkTable[i].chunk.size, posn, chunkTable[i].chunk.loadAddr);
+			i, chunkTable[i].chunk.size, writer.offset, chunkTable[i].chunk.loadAddr);
 
-		fwrite((char *)&(chunkTable[i].chunk), sizeof(struct HSS_BootChunkDesc), 1, pFileOut);
-		if (ferror(pFileOut) || feof(pFileOut)) {
-			perror("fwrite()");
-			exit(EXIT_SUCCESS);
-		}
+		writer_write(&(chunkTable[i].chunk), sizeof(struct HSS_BootChunkDesc));
 	}
 
 	// terminating sentinel
@@ -233,44 +758,22 @@ static void generate_chunks(FILE *pFileOut)
 		.crc32 = 0u
 	};
 
-	fwrite((char *)&bootChunk, sizeof(struct HSS_BootChunkDesc), 1, pFileOut);
-	if (ferror(pFileOut) || feof(pFileOut)) {
-		perror("fwrite()");
-		exit(EXIT_SUCCESS);
-	}
-
-	write_pad(pFileOut,
-		calculate_padding(sizeof(struct HSS_BootChunkDesc) * (numChunks + 1), PAD_SIZE));
-
-	chunkTablePaddedSize = ftello(pFileOut) - (off_t)bootImage.chunkTableOffset;
+	writer_write(&bootChunk, sizeof(struct HSS_BootChunkDesc));
+	writer_pad(calculate_padding(sizeof(struct HSS_BootChunkDesc) * (numChunks + 1), PAD_SIZE));
 }
 
-static void generate_ziChunks(FILE *pFileOut)
+static void generate_ziChunks(void)
 {
 	debug_printf(0, "Outputting ZI Chunks\n");
 
-	assert(pFileOut);
-
-	bootImage.ziChunkTableOffset = (size_t)ftello(pFileOut);
-
 	// sanity check we are were we expected to be, vis-a-vis file padding
-	assert(bootImage.ziChunkTableOffset ==
-			bootImage.chunkTableOffset
-			+ (numChunks * sizeof(struct HSS_BootChunkDesc))
-			+ sizeof(struct HSS_BootChunkDesc)
-			+ calculate_padding(sizeof(struct HSS_BootChunkDesc) * (numChunks+1), PAD_SIZE));
+	assert(writer.offset == bootImage.ziChunkTableOffset);
 
 	for (size_t i = 0u; i < numZIChunks; i++) {
-		off_t posn = ftello(pFileOut);
 		debug_printf(4, "\t- Processing ziChunk %lu (%lu bytes) at file position %lu\n",
-			i, ziChunkTable[i].ziChunk.size, posn);
+			i, ziChunkTable[i].ziChunk.size, writer.offset);
 
-		fwrite((char *)&ziChunkTable[i].ziChunk,
-			sizeof(struct HSS_BootZIChunkDesc), 1, pFileOut);
-		if (ferror(pFileOut) || feof(pFileOut)) {
-			perror("fwrite()");
-			exit(EXIT_SUCCESS);
-		}
+		writer_write(&ziChunkTable[i].ziChunk, sizeof(struct HSS_BootZIChunkDesc));
 	}
 
 	// terminating sentinel
@@ -280,193 +783,193 @@ static void generate_ziChunks(FILE *pFileOut)
 		.size = 0u
 	};
 
-	fwrite((char *)&ziChunk, sizeof(struct HSS_BootZIChunkDesc), 1, pFileOut);
-	if (ferror(pFileOut) || feof(pFileOut)) {
-		perror("fwrite()");
-		exit(EXIT_SUCCESS);
-	}
+	writer_write(&ziChunk, sizeof(struct HSS_BootZIChunkDesc));
+	writer_pad(calculate_padding(sizeof(struct HSS_BootZIChunkDesc) * (numZIChunks + 1), PAD_SIZE));
+}
+
+static void generate_merkle_leaves(void)
+{
+	debug_printf(0, "Outputting Merkle Leaves\n");
 
-	write_pad(pFileOut,
-		calculate_padding(sizeof(struct HSS_BootZIChunkDesc) * (numZIChunks + 1), PAD_SIZE));
+	// sanity check we are were we expected to be, vis-a-vis file padding
+	assert(writer.offset == merkleTable.leafTableOffset);
+
+	writer_write(pMerkleLeaves, numChunks * MERKLE_HASH_LEN);
 
-	ziChunkTablePaddedSize = ftello(pFileOut) - (off_t)bootImage.ziChunkTableOffset;
+	free(pMerkleLeaves);
+	pMerkleLeaves = NULL;
 }
 
-static void generate_blobs(FILE *pFileOut)
+static void generate_blobs(void)
 {
 	debug_printf(0, "Outputting Binary Data\n");
 
 	// sanity check we are were we expected to be, vis-a-vis file padding
-	assert(chunkTable[0].chunk.loadAddr ==
-			bootImage.ziChunkTableOffset
-			+ (numZIChunks * sizeof(struct HSS_BootZIChunkDesc))
-			+ sizeof(struct HSS_BootZIChunkDesc) // account for sentinel
-			+ calculate_padding(sizeof(struct HSS_BootZIChunkDesc) * (numZIChunks +1), PAD_SIZE));
+	assert(writer.offset == bootImage.headerLength);
 
 	for (size_t i = 0u; i < numChunks; i++) {
-		off_t posn = ftello(pFileOut);
+		assert(writer.offset == chunkTable[i].chunk.loadAddr);
+
 		debug_printf(4, "\t- Processing blob %lu (%lu bytes) at file position %lu\n",
-			i, chunkTable[i].chunk.size, posn);
-		debug_printf(4, "\t\tCRC32: %x\n",
-			CRC32_calculate((uint8_t *)chunkTable[i].pBuffer, chunkTable[i].chunk.size));
-		fflush(stdout);
-
-		fwrite((char *)chunkTable[i].pBuffer, chunkTable[i].chunk.size, 1, pFileOut);
-		if (ferror(pFileOut) || feof(pFileOut)) {
-			perror("fwrite()");
-			exit(EXIT_SUCCESS);
-		}
+			i, chunkTable[i].chunk.size, writer.offset);
+		debug_printf(4, "\t\tCRC32: %x\n", chunkTable[i].chunk.crc32);
+
+		writer_write(chunkTable[i].pBuffer, chunkTable[i].chunk.size);
 
 		free(chunkTable[i].pBuffer);
+		chunkTable[i].pBuffer = NULL;
 
-		write_pad(pFileOut,
-			calculate_padding(chunkTable[i].chunk.size, PAD_SIZE));
+		writer_pad(calculate_padding(chunkTable[i].chunk.size, PAD_SIZE));
 	}
-	assert(pFileOut);
+
+	assert(writer.offset == bootImage.bootImageLength);
 }
 
-static void sign_payload(FILE *pFileOut, char const * const private_key_filename,
-	char const * const public_key_filename)
+static void rewrite_header(char const * const filename_output, struct HSS_BootImage *pBootImage)
 {
-	if (private_key_filename) {
-		//
-		// first compute the SHA384 hash digest of the entire boot image
-		//
-		assert(ARRAY_SIZE(bootImage.signature.digest) == SHA384_DIGEST_LENGTH);
-
-		// read in entire payload to calculate signature...
-		uint8_t *pEntirePayloadBuffer = malloc(bootImage.bootImageLength);
-		assert(pEntirePayloadBuffer != NULL);
-
-		if (fseek(pFileOut, 0, SEEK_SET) != 0) {
-			perror("fseek()");
-			exit(EXIT_SUCCESS);
-		}
+	FILE *pFileOut = fopen(filename_output, "r+");
+	if (!pFileOut) {
+		perror("fopen()");
+		exit(EXIT_FAILURE);
+	}
 
-		size_t fileSize = fread((void *)pEntirePayloadBuffer, 1u, bootImage.bootImageLength, pFileOut);
-		assert(fileSize == bootImage.bootImageLength);
+	if (fwrite((char *)pBootImage, sizeof(struct HSS_BootImage), 1, pFileOut) != 1) {
+		perror("fwrite()");
+		exit(EXIT_FAILURE);
+	}
 
-		//
-		// now compute the ECDSA P-384 signature
-		//
-		// read in the private key, and convert to an EC key
-		FILE *privKeyFileIn = fopen(private_key_filename, "r");
-		assert(privKeyFileIn != NULL);
+	if (fclose(pFileOut) != 0) {
+		perror("fclose()");
+		exit(EXIT_FAILURE);
+	}
+}
 
-		EVP_PKEY *pPrivKey = PEM_read_PrivateKey(privKeyFileIn, NULL, NULL, NULL);
-		assert(pPrivKey != NULL);
-		fclose(privKeyFileIn);
+static void sign_payload(uint8_t digest[SHA384_DIGEST_LENGTH], char const * const private_key_filename)
+{
+	assert(ARRAY_SIZE(bootImage.signature.digest) == SHA384_DIGEST_LENGTH);
 
-		// create the signature by using SHA384 digest and signing with our SECP384r1 private key
-		//
-		EVP_MD_CTX *pCtx = EVP_MD_CTX_new();
-		assert(pCtx != NULL);
+	//
+	// the SHA384 hash digest of the entire boot image (or for a Merkle payload, of
+	// everything up to the leaves) was computed as it was written, so now compute the
+	// ECDSA P-384 signature over that digest
+	//
+	// read in the private key, and convert to an EC key
+	FILE *privKeyFileIn = fopen(private_key_filename, "r");
+	assert(privKeyFileIn != NULL);
 
-		assert(EVP_DigestInit_ex(pCtx, EVP_sha384(), NULL) == 1);
+	EVP_PKEY *pPrivKey = PEM_read_PrivateKey(privKeyFileIn, NULL, NULL, NULL);
+	assert(pPrivKey != NULL);
+	fclose(privKeyFileIn);
 
-		uint8_t digest[EVP_MAX_MD_SIZE];
-		unsigned int digest_len = 0;
-		assert(EVP_DigestUpdate(pCtx, pEntirePayloadBuffer, bootImage.bootImageLength) == 1);
-		assert(EVP_DigestFinal_ex(pCtx, digest, &digest_len) == 1);
+	// create the signature by signing the SHA384 digest with our SECP384r1 private key
+	//
+	EVP_PKEY_CTX *pCtx = EVP_PKEY_CTX_new(pPrivKey, NULL);
+	assert(pCtx != NULL);
 
-		assert(EVP_DigestSignInit(pCtx, NULL, EVP_sha384(), NULL, pPrivKey) == 1);
+	assert(EVP_PKEY_sign_init(pCtx) == 1);
+	assert(EVP_PKEY_CTX_set_signature_md(pCtx, EVP_sha384()) == 1);
 
-		size_t sigLen = 0u;
-		assert(EVP_DigestSign(pCtx, NULL, &sigLen, pEntirePayloadBuffer, bootImage.bootImageLength) == 1);
+	size_t sigLen = 0u;
+	assert(EVP_PKEY_sign(pCtx, NULL, &sigLen, digest, SHA384_DIGEST_LENGTH) == 1);
 
-		unsigned char *pSignatureBuffer = OPENSSL_malloc(sigLen);
-		assert(pSignatureBuffer);
-		assert(EVP_DigestSign(pCtx, pSignatureBuffer, &sigLen, pEntirePayloadBuffer, bootImage.bootImageLength) == 1);
+	unsigned char *pSignatureBuffer = OPENSSL_malloc(sigLen);
+	assert(pSignatureBuffer);
+	assert(EVP_PKEY_sign(pCtx, pSignatureBuffer, &sigLen, digest, SHA384_DIGEST_LENGTH) == 1);
 
-		// copy the signature to the boot image header...
-		// OpenSSL will output the signature is in ASN.1 format, as described in
-		// https://datatracker.ietf.org/doc/html/rfc5480
-		// and in one of the following forms
-		//
-		// Total length is 102 bytes:
-		// -----------------------------------
-		// 0x30 0x64 Ecdsa-Sig-Vale ::= SEQUENCE { (100 bytes)
-		// 0x02 0x30	r	INTEGER (48 bytes),
-		// 0x02 0x30	s	INTEGER (48 bytes) }
-		//
-		// Total length is 103 bytes:
-		// -----------------------------------
-		// 0x30 0x65 Ecdsa-Sig-Vale ::= SEQUENCE { (101 bytes)
-		// 0x02 0x30	r	INTEGER (48 bytes),
-		// 0x02 0x31	s	INTEGER (0x0 followed by 48 bytes) }
-		//
-		// 0x30 0x65 Ecdsa-Sig-Vale ::= SEQUENCE { (101 bytes)
-		// 0x02 0x31	r	INTEGER (0x0 followed by 48 bytes),
-		// 0x02 0x30	s	INTEGER (48 bytes) }
-		//
-		// Total length is 104 bytes:
-		// -----------------------------------
-		// 0x30 0x66 Ecdsa-Sig-Vale ::= SEQUENCE { (102 bytes)
-		// 0x02 0x31	r	INTEGER (0x0 followed by 48 bytes),
-		// 0x02 0x31	s	INTEGER (0x0 followed by 48 bytes) }
-		//
-		// we just want raw 48-byte r and s values for the boot image header
-		//
-		assert((sigLen == 102u) || (sigLen == 103u) || (sigLen == 104u));
+	// copy the signature to the boot image header...
+	// OpenSSL will output the signature is in ASN.1 format, as described in
+	// https://datatracker.ietf.org/doc/html/rfc5480
+	// and in one of the following forms
+	//
+	// Total length is 102 bytes:
+	// -----------------------------------
+	// 0x30 0x64 Ecdsa-Sig-Vale ::= SEQUENCE { (100 bytes)
+	// 0x02 0x30	r	INTEGER (48 bytes),
+	// 0x02 0x30	s	INTEGER (48 bytes) }
+	//
+	// Total length is 103 bytes:
+	// -----------------------------------
+	// 0x30 0x65 Ecdsa-Sig-Vale ::= SEQUENCE { (101 bytes)
+	// 0x02 0x30	r	INTEGER (48 bytes),
+	// 0x02 0x31	s	INTEGER (0x0 followed by 48 bytes) }
+	//
+	// 0x30 0x65 Ecdsa-Sig-Vale ::= SEQUENCE { (101 bytes)
+	// 0x02 0x31	r	INTEGER (0x0 followed by 48 bytes),
+	// 0x02 0x30	s	INTEGER (48 bytes) }
+	//
+	// Total length is 104 bytes:
+	// -----------------------------------
+	// 0x30 0x66 Ecdsa-Sig-Vale ::= SEQUENCE { (102 bytes)
+	// 0x02 0x31	r	INTEGER (0x0 followed by 48 bytes),
+	// 0x02 0x31	s	INTEGER (0x0 followed by 48 bytes) }
+	//
+	// we just want raw 48-byte r and s values for the boot image header
+	//
+	assert((sigLen == 102u) || (sigLen == 103u) || (sigLen == 104u));
 
-		const unsigned char *sig_ptr = pSignatureBuffer;
-		ECDSA_SIG *pSig = d2i_ECDSA_SIG(NULL, &sig_ptr, (long)sigLen);
-		assert(pSig != NULL);
+	const unsigned char *sig_ptr = pSignatureBuffer;
+	ECDSA_SIG *pSig = d2i_ECDSA_SIG(NULL, &sig_ptr, (long)sigLen);
+	assert(pSig != NULL);
 
-		// the signature is in an opaque ECDSA_SIG structure, which contains two
-		// BIGNUMs, r and s.  These are max half the curve size in bytes
-		// => 384 / (8*2) = 48 bytes each... but they may be less, and need to be
-		// zero padded, so extract separately...
-		const BIGNUM *pR = NULL;
-		const BIGNUM *pS = NULL;
-		ECDSA_SIG_get0(pSig, &pR, &pS);
+	// the signature is in an opaque ECDSA_SIG structure, which contains two
+	// BIGNUMs, r and s.  These are max half the curve size in bytes
+	// => 384 / (8*2) = 48 bytes each... but they may be less, and need to be
+	// zero padded, so extract separately...
+	const BIGNUM *pR = NULL;
+	const BIGNUM *pS = NULL;
+	ECDSA_SIG_get0(pSig, &pR, &pS);
 
-		const int rBytes = BN_num_bytes(pR);
-		const int sBytes = BN_num_bytes(pS);
+	const int rBytes = BN_num_bytes(pR);
+	const int sBytes = BN_num_bytes(pS);
 
-		assert(rBytes == sBytes);
-		assert(rBytes == 48);
+	assert(rBytes == sBytes);
+	assert(rBytes == 48);
 
-		memset(pSignatureBuffer, 0, 96);
-		BN_bn2bin(pR, pSignatureBuffer + 48 - rBytes);
-		BN_bn2bin(pS, pSignatureBuffer + 96 - sBytes);
-		//
+	memset(pSignatureBuffer, 0, 96);
+	BN_bn2bin(pR, pSignatureBuffer + 48 - rBytes);
+	BN_bn2bin(pS, pSignatureBuffer + 96 - sBytes);
+	//
 
-		memcpy(bootImage.signature.digest, digest, 48u);
-		memcpy(bootImage.signature.ecdsaSig, pSignatureBuffer, 48u);
-		memcpy(bootImage.signature.ecdsaSig + 48u, pSignatureBuffer + 48u, 48u);
+	memcpy(bootImage.signature.digest, digest, 48u);
+	memcpy(bootImage.signature.ecdsaSig, pSignatureBuffer, 48u);
+	memcpy(bootImage.signature.ecdsaSig + 48u, pSignatureBuffer + 48u, 48u);
 
-		{
-			char *hexString = OPENSSL_buf2hexstr(pSignatureBuffer, (long)sigLen);
-			debug_printf(5, "P-384 Signature: %s\n", hexString);
-			OPENSSL_free(hexString);
-		}
+	{
+		char *hexString = OPENSSL_buf2hexstr(pSignatureBuffer, (long)sigLen);
+		debug_printf(5, "P-384 Signature: %s\n", hexString);
+		OPENSSL_free(hexString);
+	}
 
-		generate_header(pFileOut, &bootImage); // rewrite header for signing...
+	ECDSA_SIG_free(pSig);
+	EVP_PKEY_CTX_free(pCtx);
+	EVP_PKEY_free(pPrivKey);
+	OPENSSL_free(pSignatureBuffer);
+}
 
-		EVP_MD_CTX_free(pCtx);
-		EVP_PKEY_free(pPrivKey);
-		OPENSSL_free(pSignatureBuffer);
+static void check_payload_signature(char const * const filename_output, uint8_t *pPayload,
+	char const * const public_key_filename)
+{
+	uint8_t *pEntirePayloadBuffer = pPayload;
 
-		// if a public key was provided, we'll cross-check the signature against it
-		//
-		if (public_key_filename) {
-			// refresh payload from file, as we just rewrote the header to include the signature
-			if (fseek(pFileOut, 0, SEEK_SET) != 0) {
-				perror("fseek()");
-				exit(EXIT_SUCCESS);
-			}
+	if (!pEntirePayloadBuffer) {
+		// read back the payload, as we just rewrote the header to include the signature
+		pEntirePayloadBuffer = malloc(bootImage.bootImageLength);
+		assert(pEntirePayloadBuffer != NULL);
 
-			fileSize = fread((void *)pEntirePayloadBuffer, 1u, bootImage.bootImageLength, pFileOut);
-			assert(fileSize == bootImage.bootImageLength);
+		FILE *pFileIn = fopen(filename_output, "r");
+		assert(pFileIn != NULL);
 
-			// now perform the cross-check
-			bool result = HSS_Boot_Secure_CheckCodeSigning((struct HSS_BootImage *)pEntirePayloadBuffer, public_key_filename);
+		size_t fileSize = fread((void *)pEntirePayloadBuffer, 1u, bootImage.bootImageLength, pFileIn);
+		assert(fileSize == bootImage.bootImageLength);
+		fclose(pFileIn);
+	}
 
-			printf("Signature validation using public key ... %s\n\n", result ? "passed":"failed");
+	// now perform the cross-check
+	bool result = HSS_Boot_Secure_CheckCodeSigning((struct HSS_BootImage *)pEntirePayloadBuffer, public_key_filename);
 
-		}
+	printf("Signature validation using public key ... %s\n\n", result ? "passed":"failed");
 
+	if (!pPayload) {
 		free(pEntirePayloadBuffer);
 	}
 }
@@ -482,34 +985,55 @@ void generate_payload(char const * const filename_output, char const * const pri
 		printf("public_key_filename is >>%s<<\n", public_key_filename);
 	}
 
-	FILE *pFileOut = fopen(filename_output, "w+");
-	if (!pFileOut) {
-		perror("fopen()");
-		exit(EXIT_FAILURE);
+	if (optimizeChunks) {
+		optimize_chunks();
 	}
 
-	generate_header(pFileOut, &bootImage);
-	generate_chunks(pFileOut);
-	generate_ziChunks(pFileOut);
+	calculate_layout();
+	if (merklePayload) {
+		calculate_merkle_tree();
+	}
 
-	bootImage.headerLength = (size_t)ftello(pFileOut);
-	assert(bootImage.headerLength ==
-		bootImagePaddedSize + chunkTablePaddedSize + ziChunkTablePaddedSize);
-	debug_printf(4, "End of header is %lu\n", bootImage.headerLength);
+	uint8_t digest[SHA384_DIGEST_LENGTH];
+	if (compressPayload) {
+		writer_open_memory(bootImage.bootImageLength, private_key_filename != NULL);
+	} else {
+		writer_open(filename_output, private_key_filename != NULL);
+	}
+
+	generate_header(&bootImage);
+	generate_chunks();
+	generate_ziChunks();
+	if (merklePayload) {
+		generate_merkle_leaves();
+	}
+	generate_blobs();
 
-	generate_blobs(pFileOut);
-	bootImage.bootImageLength = (size_t)ftello(pFileOut);
+	writer_close(digest);
 
-	bootImage.headerCrc =
-		CRC32_calculate((const unsigned char *)&bootImage, sizeof(struct HSS_BootImage));
+	if (private_key_filename) {
+		sign_payload(digest, private_key_filename);
 
-	generate_header(pFileOut, &bootImage); // rewrite header for CRC...
+		// rewrite header for signing...
+		if (writer.pMemory) {
+			memcpy(writer.pMemory, &bootImage, sizeof(struct HSS_BootImage));
+		} else {
+			rewrite_header(filename_output, &bootImage);
+		}
 
-	sign_payload(pFileOut, private_key_filename, public_key_filename);
+		// if a public key was provided, we'll cross-check the signature against it
+		//
+		if (public_key_filename) {
+			check_payload_signature(filename_output, writer.pMemory, public_key_filename);
+		}
+	}
 
-	if (fclose(pFileOut) != 0) {
-		perror("fclose()");
-		exit(EXIT_FAILURE);
+	if (compressPayload) {
+		compress_payload(filename_output, writer.pMemory, bootImage.bootImageLength,
+			private_key_filename != NULL, compressLevel, compressBlockSize, compressThreads);
+
+		free(writer.pMemory);
+		writer.pMemory = NULL;
 	}
 }
 
@@ -517,26 +1041,17 @@ size_t generate_add_chunk(struct HSS_BootChunkDesc chunk, void *pBuffer)
 {
 	if (chunk.size) {
 		assert(pBuffer);
-		numChunks++;
-
-		debug_printf(6, "\nAttempting to realloc %lu at %p",
-			numChunks * sizeof(struct chunkTableEntry), chunkTable);
-		void *tmpPtr = realloc(chunkTable, numChunks * sizeof(struct chunkTableEntry));
-		debug_printf(6, " => %p\n", tmpPtr);
-		if (!tmpPtr) {
-			perror("realloc()");
-			exit(EXIT_FAILURE);
-		} else {
-			chunkTable = tmpPtr;
+		if (numChunks == chunkTableCapacity) {
+			chunkTable = grow_table(chunkTable, &chunkTableCapacity, sizeof(struct chunkTableEntry));
 		}
+		numChunks++;
 
 		memset(&chunkTable[numChunks-1], 0, sizeof(struct chunkTableEntry));
 		chunkTable[numChunks-1].chunk = chunk;
 		chunkTable[numChunks-1].pBuffer = pBuffer;
 
 		debug_printf(4, "chunk: execAddr = 0x%.16" PRIx64 ", size = 0x%.16" PRIx64 ", CRC32=%x\n",
-			chunk.execAddr, chunk.size,
-			CRC32_calculate((const unsigned char *)pBuffer, chunk.size));
+			chunk.execAddr, chunk.size, chunk.crc32);
 	} else {
 		debug_printf(4, "chunk: execAddr = 0x%.16" PRIx64 ", size = 0 => Skipping\n", chunk.execAddr);
 	}
@@ -546,18 +1061,10 @@ size_t generate_add_chunk(struct HSS_BootChunkDesc chunk, void *pBuffer)
 
 size_t generate_add_ziChunk(struct HSS_BootZIChunkDesc ziChunk)
 {
-	numZIChunks++;
-
-	debug_printf(6, "\nAttempting to realloc %lu at %p",
-		numZIChunks * sizeof(struct ziChunkTableEntry), ziChunkTable);
-	void *tmpPtr = realloc(ziChunkTable, numZIChunks * sizeof(struct ziChunkTableEntry));
-	debug_printf(6, " => %p\n", tmpPtr);
-	if (!tmpPtr) {
-		perror("realloc()");
-		exit(EXIT_FAILURE);
-	} else {
-		ziChunkTable = tmpPtr;
+	if (numZIChunks == ziChunkTableCapacity) {
+		ziChunkTable = grow_table(ziChunkTable, &ziChunkTableCapacity, sizeof(struct ziChunkTableEntry));
 	}
+	numZIChunks++;
 
 	ziChunkTable[numZIChunks-1].ziChunk = ziChunk;
 
@@ -567,6 +1074,27 @@ size_t generate_add_ziChunk(struct HSS_BootZIChunkDesc ziChunk)
 	return numZIChunks;
 }
 
+void generate_set_optimization(size_t gapThreshold, size_t ziThreshold)
+{
+	optimizeChunks = true;
+	optimizeGapThreshold = gapThreshold;
+	optimizeZIThreshold = ziThreshold;
+}
+
+void generate_set_compression(int level, size_t blockSize, unsigned int numThreads)
+{
+	compressPayload = true;
+	compressLevel = level;
+	compressBlockSize = blockSize;
+	compressThreads = numThreads;
+}
+
+void generate_set_merkle(void)
+{
+	merklePayload = true;
+	bootImage.version = mHSS_BOOT_VERSION_MERKLE;
+}
+
 void generate_init(void)
 {
 	bootImage.magic = mHSS_BOOT_MAGIC;
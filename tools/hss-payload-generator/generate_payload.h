@@ -36,6 +36,9 @@
 
 void generate_payload(char const * const filename_output, char const * const private_key_filename, char const * const public_key_filename);
 void generate_init(void);
+void generate_set_optimization(size_t gapThreshold, size_t ziThreshold);
+void generate_set_compression(int level, size_t blockSize, unsigned int numThreads);
+void generate_set_merkle(void);
 
 size_t generate_add_chunk(struct HSS_BootChunkDesc chunk, void *buffer) __attribute__((nonnull));
 size_t generate_add_ziChunk(struct HSS_BootZIChunkDesc ziChunk);
@@ -29,6 +29,7 @@
 #include <stdlib.h>
 #include <stdbool.h>
 #include <getopt.h>
+#include <unistd.h>
 
 #ifndef CONFIG_CRYPTO_SIGNING
 #	define CONFIG_CRYPTO_SIGNING
@@ -39,10 +40,19 @@
 #include "yaml_parser.h"
 #include "generate_payload.h"
 #include "dump_payload.h"
+#include "delta_payload.h"
 #include "debug_printf.h"
 
 #define GEN_VERSION_STRING "0.99.44"
 
+// defaults for chunk optimization (-O)
+#define DEFAULT_GAP_THRESHOLD  4096u
+#define DEFAULT_ZI_THRESHOLD   (64u * 1024u)
+
+// defaults for compression (-C)
+#define DEFAULT_COMPRESSION_BLOCK_KIB  1024u
+#define MAX_COMPRESSION_LEVEL          10
+
 struct HSS_BootImage bootImage;
 struct HSS_BootChunkDesc *pChunkDescs;
 
@@ -62,16 +72,24 @@ static void intro_banner(void)
 
 static void print_usage(char **argv)
 {
-	printf("Usage: %s [-v] [-w] [-h] [[-c <configfile.yaml> <output.bin>] [-p <private-key.pem>] ] [-d <output.bin> [-u <public-key.pem>]\n\n", argv[0]);
+	printf("Usage: %s [-v] [-w] [-h] [[-c <configfile.yaml> <output.bin>] [-p <private-key.pem> [-m]] [-O] [-g <bytes>] [-z <bytes>] [-C <level> [-b <KiB>] [-j <threads>]] ] [-d <output.bin> [-u <public-key.pem>]] [-D <base.bin> <new.bin> <delta.bin>]\n\n", argv[0]);
 	printf("\nMultiple '-v' arguments increases verbosity of output.\n\n");
 
+	printf(" -b		compression block size in KiB (default %u)\n", DEFAULT_COMPRESSION_BLOCK_KIB);
+	printf(" -C		output a compressed payload, at level 0 (none) to %d (best)\n", MAX_COMPRESSION_LEVEL);
 	printf(" -c		Run generator and specify path to configuration YAML\n");
 	printf(" -d		Run analyzer and specify path to payload binary\n");
+	printf(" -D		Run delta generator and specify path to base payload binary\n");
+	printf(" -g		merge chunks for the same hart separated by up to this many bytes (implies -O, default %u)\n", DEFAULT_GAP_THRESHOLD);
 	printf(" -h		print this help\n");
+	printf(" -j		number of compression threads (default is one per CPU)\n");
+	printf(" -m		sign a Merkle tree of per-chunk hashes, so each chunk can be verified as it is loaded (only valid with -p)\n");
+	printf(" -O		optimize chunk layout, by merging nearby chunks and converting zero runs to ZI chunks\n");
 	printf(" -p		enabled secure boot and specify private key\n");
 	printf(" -u		specify public key (only valid with -p or -d)\n");
 	printf(" -v		Increase verbosity of output\n");
-	printf(" -w		Extra-wide output (used with verbosity)\n\n");
+	printf(" -w		Extra-wide output (used with verbosity)\n");
+	printf(" -z		convert zero runs of at least this many bytes to ZI chunks, 0 to disable (implies -O, default %u)\n\n", DEFAULT_ZI_THRESHOLD);
 
 	exit(1);
 }
@@ -91,23 +109,60 @@ int main(int argc, char **argv)
 	int opt;
 	char *config_filename = NULL;
 	char *dump_payload_filename = NULL;
+	char *delta_base_filename = NULL;
 	char *private_key_filename = NULL;
 	char *public_key_filename = NULL;
-	while ((opt = getopt(argc, argv, (const char *)"c:d:hp:u:vw")) != -1) {
+	bool optimize_chunks = false;
+	bool merkle_tree = false;
+	size_t gap_threshold = DEFAULT_GAP_THRESHOLD;
+	size_t zi_threshold = DEFAULT_ZI_THRESHOLD;
+	int compression_level = -1;
+	size_t compression_block_kib = DEFAULT_COMPRESSION_BLOCK_KIB;
+	long compression_threads = 0;
+	while ((opt = getopt(argc, argv, (const char *)"b:C:c:D:d:g:hj:mOp:u:vwz:")) != -1) {
 		switch (opt) {
+		case 'b':
+			compression_block_kib = strtoul(optarg, NULL, 0);
+			break;
+
+		case 'C':
+			compression_level = (int)strtol(optarg, NULL, 0);
+			break;
+
 		case 'c':
 			config_filename = optarg;
 			break;
 
+		case 'D':
+			delta_base_filename = optarg;
+			break;
+
 		case 'd':
 			dump_payload_filename = optarg;
 			break;
 
+		case 'g':
+			gap_threshold = strtoul(optarg, NULL, 0);
+			optimize_chunks = true;
+			break;
+
 		case 'h':
 			print_usage(argv);
 			exit(EXIT_SUCCESS);
 			break;
 
+		case 'j':
+			compression_threads = strtol(optarg, NULL, 0);
+			break;
+
+		case 'm':
+			merkle_tree = true;
+			break;
+
+		case 'O':
+			optimize_chunks = true;
+			break;
+
 		case 'p':
 			private_key_filename = optarg;
 			break;
@@ -124,6 +179,11 @@ int main(int argc, char **argv)
 			wide_output = true;
 			break;
 
+		case 'z':
+			zi_threshold = strtoul(optarg, NULL, 0);
+			optimize_chunks = true;
+			break;
+
 		default:
 			print_usage(argv);
 			break;
@@ -135,8 +195,19 @@ int main(int argc, char **argv)
 		exit(EXIT_FAILURE);
 	}
 
-	if ((config_filename) && (dump_payload_filename)) {
-		fprintf(stderr, "%s: Only one of -c or -d allowed\n\n", argv[0]);
+	if ((merkle_tree) && (!private_key_filename)) {
+		fprintf(stderr, "%s: -m only allowed in conjunction with -p\n\n", argv[0]);
+		exit(EXIT_FAILURE);
+	}
+
+	if ((compression_level > MAX_COMPRESSION_LEVEL) || (compression_level < -1)
+		|| (!compression_block_kib) || (compression_threads < 0)) {
+		fprintf(stderr, "%s: invalid compression level, block size or thread count\n\n", argv[0]);
+		exit(EXIT_FAILURE);
+	}
+
+	if (((config_filename != NULL) + (dump_payload_filename != NULL) + (delta_base_filename != NULL)) > 1) {
+		fprintf(stderr, "%s: Only one of -c, -d or -D allowed\n\n", argv[0]);
 		exit(EXIT_FAILURE);
 	}
 
@@ -144,10 +215,34 @@ int main(int argc, char **argv)
 	// now that we know what we are about, let's go to work...
 	//
 	if ((config_filename) && (argc > optind)) {
+		if (optimize_chunks) {
+			generate_set_optimization(gap_threshold, zi_threshold);
+		}
+
+		if (merkle_tree) {
+			generate_set_merkle();
+		}
+
+		if (compression_level >= 0) {
+#ifdef _SC_NPROCESSORS_ONLN
+			if (!compression_threads) {
+				compression_threads = sysconf(_SC_NPROCESSORS_ONLN);
+			}
+#endif
+			if (compression_threads < 1) {
+				compression_threads = 1;
+			}
+
+			generate_set_compression(compression_level, compression_block_kib * 1024u,
+				(unsigned int)compression_threads);
+		}
+
 		yaml_parser(config_filename);
 		generate_payload(argv[optind], private_key_filename, public_key_filename);
 	} else if (dump_payload_filename) {
 		dump_payload(dump_payload_filename, public_key_filename);
+	} else if ((delta_base_filename) && ((argc - optind) == 2)) {
+		delta_payload(delta_base_filename, argv[optind], argv[optind + 1]);
 	} else {
 		print_usage(argv);
 		exit(EXIT_FAILURE);
@@ -0,0 +1,197 @@
+/******************************************************************************************
+ *
+ * MPFS HSS Embedded Software - tools/hss-payload-generator
+ *
+ * Copyright 2020-2025 Microchip FPGA Embedded Systems Solutions.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/*
+ * Merkle-tree authenticated payloads
+ *
+ * A payload with a Merkle table (see struct HSS_MerkleTable in hss_types.h) carries a
+ * SHA-384 hash per chunk, and the root of a hash tree over them. Only the header
+ * region up to the leaves is signed, so that the HSS can verify the signature and the
+ * root up front, and then verify each chunk as it is copied into place.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#include <openssl/evp.h>
+
+#ifndef CONFIG_CC_HAS_INTTYPES
+#	define CONFIG_CC_HAS_INTTYPES 1
+#endif
+#ifndef CONFIG_CRYPTO_SIGNING
+#	define CONFIG_CRYPTO_SIGNING 1
+#endif
+
+#include "hss_types.h"
+#include "debug_printf.h"
+#include "merkle.h"
+
+static void merkle_hash_(uint8_t prefix, uint8_t const *pData1, size_t size1,
+	uint8_t const *pData2, size_t size2, uint8_t *pHash)
+{
+	EVP_MD_CTX *pCtx = EVP_MD_CTX_new();
+	assert(pCtx != NULL);
+
+	unsigned int hashLen = 0u;
+	assert(EVP_DigestInit_ex(pCtx, EVP_sha384(), NULL) == 1);
+	assert(EVP_DigestUpdate(pCtx, &prefix, 1u) == 1);
+	if (size1) {
+		assert(EVP_DigestUpdate(pCtx, pData1, size1) == 1);
+	}
+	if (size2) {
+		assert(EVP_DigestUpdate(pCtx, pData2, size2) == 1);
+	}
+	assert(EVP_DigestFinal_ex(pCtx, pHash, &hashLen) == 1);
+	assert(hashLen == MERKLE_HASH_LEN);
+
+	EVP_MD_CTX_free(pCtx);
+}
+
+void merkle_hash_leaf(uint8_t const *pData, size_t size, uint8_t *pLeaf)
+{
+	merkle_hash_(MERKLE_LEAF_PREFIX, pData, size, NULL, 0u, pLeaf);
+}
+
+void merkle_calculate_root(size_t numLeaves, uint8_t const *pLeaves, uint8_t *pRoot)
+{
+	if (!numLeaves) {
+		// nothing to authenticate
+		memset(pRoot, 0, MERKLE_HASH_LEN);
+	} else {
+		uint8_t *pLevel = malloc(numLeaves * MERKLE_HASH_LEN);
+		assert(pLevel != NULL);
+		memcpy(pLevel, pLeaves, numLeaves * MERKLE_HASH_LEN);
+
+		// combine pairs of nodes in place, carrying any odd node up unchanged,
+		// until only the root is left
+		size_t numNodes = numLeaves;
+		while (numNodes > 1u) {
+			size_t i;
+			for (i = 0u; (i + 1u) < numNodes; i += 2u) {
+				merkle_hash_(MERKLE_NODE_PREFIX,
+					pLevel + (i * MERKLE_HASH_LEN), MERKLE_HASH_LEN,
+					pLevel + ((i + 1u) * MERKLE_HASH_LEN), MERKLE_HASH_LEN,
+					pLevel + ((i / 2u) * MERKLE_HASH_LEN));
+			}
+
+			if (i < numNodes) {
+				memmove(pLevel + ((i / 2u) * MERKLE_HASH_LEN), pLevel + (i * MERKLE_HASH_LEN),
+					MERKLE_HASH_LEN);
+			}
+
+			numNodes = (numNodes + 1u) / 2u;
+		}
+
+		memcpy(pRoot, pLevel, MERKLE_HASH_LEN);
+		free(pLevel);
+	}
+}
+
+struct HSS_MerkleTable const *merkle_get_table(struct HSS_BootImage const *pBootImage, size_t imageLen)
+{
+	struct HSS_MerkleTable const *pTable = NULL;
+	size_t const tableOffset = sizeof(struct HSS_BootImage);
+
+	if ((imageLen >= sizeof(struct HSS_BootImage))
+		&& (pBootImage->version == mHSS_BOOT_VERSION_MERKLE)
+		&& (pBootImage->headerLength <= imageLen)
+		&& ((tableOffset + sizeof(struct HSS_MerkleTable)) <= pBootImage->headerLength)) {
+		pTable = (struct HSS_MerkleTable const *)((char const *)pBootImage + tableOffset);
+
+		if ((pTable->magic != mHSS_MERKLE_MAGIC)
+			|| (pTable->leafTableOffset < (tableOffset + sizeof(struct HSS_MerkleTable)))
+			|| (pTable->leafTableOffset > pBootImage->headerLength)
+			|| (pTable->numLeaves > ((pBootImage->headerLength - pTable->leafTableOffset)
+				/ MERKLE_HASH_LEN))) {
+			printf("Merkle table is invalid\n");
+			pTable = NULL;
+		}
+	}
+
+	return pTable;
+}
+
+bool merkle_check_payload(struct HSS_BootImage const *pBootImage, size_t imageLen)
+{
+	bool result = false;
+	struct HSS_MerkleTable const *pTable = merkle_get_table(pBootImage, imageLen);
+
+	if (pTable) {
+		uint8_t const *pImage = (uint8_t const *)pBootImage;
+		uint8_t const *pLeaves = pImage + pTable->leafTableOffset;
+		uint8_t hash[MERKLE_HASH_LEN];
+
+		result = true;
+
+		merkle_calculate_root(pTable->numLeaves, pLeaves, hash);
+		if (memcmp(hash, pTable->root, MERKLE_HASH_LEN)) {
+			printf("Merkle root does not match leaves\n");
+			result = false;
+		}
+
+		// every chunk needs a leaf, and every leaf a chunk...
+		size_t chunkIndex = 0u;
+		size_t chunkOffset = pBootImage->chunkTableOffset;
+		while ((chunkOffset + sizeof(struct HSS_BootChunkDesc)) <= pTable->leafTableOffset) {
+			struct HSS_BootChunkDesc chunk;
+			memcpy(&chunk, pImage + chunkOffset, sizeof(struct HSS_BootChunkDesc));
+
+			if (!chunk.size) {
+				break;
+			}
+
+			if (chunkIndex >= pTable->numLeaves) {
+				printf("Merkle: chunk %lu has no leaf\n", (unsigned long)chunkIndex);
+				result = false;
+			} else if ((chunk.loadAddr > imageLen) || (chunk.size > (imageLen - chunk.loadAddr))) {
+				printf("Merkle: chunk %lu is outside the image\n", (unsigned long)chunkIndex);
+				result = false;
+			} else {
+				merkle_hash_leaf(pImage + chunk.loadAddr, chunk.size, hash);
+				if (memcmp(hash, pLeaves + (chunkIndex * MERKLE_HASH_LEN), MERKLE_HASH_LEN)) {
+					printf("Merkle: chunk %lu does not match its leaf\n", (unsigned long)chunkIndex);
+					result = false;
+				} else {
+					debug_printf(4, "Merkle: chunk %lu matches its leaf\n", chunkIndex);
+				}
+			}
+
+			chunkOffset += sizeof(struct HSS_BootChunkDesc);
+			chunkIndex++;
+		}
+
+		if (chunkIndex != pTable->numLeaves) {
+			printf("Merkle: %lu leaves for %lu chunks\n", (unsigned long)pTable->numLeaves,
+				(unsigned long)chunkIndex);
+			result = false;
+		}
+	}
+
+	return result;
+}
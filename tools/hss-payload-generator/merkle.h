@@ -0,0 +1,48 @@
+#ifndef MERKLE_H
+#define MERKLE_H
+
+/******************************************************************************************
+ *
+ * MPFS HSS Embedded Software - tools/hss-payload-generator
+ *
+ * Copyright 2020-2025 Microchip FPGA Embedded Systems Solutions.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+struct HSS_BootImage;
+struct HSS_MerkleTable;
+
+//
+// Hashes are MERKLE_HASH_LEN (SHA-384) bytes, and leaves are stored contiguously
+//
+void merkle_hash_leaf(uint8_t const *pData, size_t size, uint8_t *pLeaf) __attribute__((nonnull(3)));
+void merkle_calculate_root(size_t numLeaves, uint8_t const *pLeaves, uint8_t *pRoot) __attribute__((nonnull(3)));
+
+struct HSS_MerkleTable const *merkle_get_table(struct HSS_BootImage const *pBootImage, size_t imageLen)
+	__attribute__((nonnull));
+bool merkle_check_payload(struct HSS_BootImage const *pBootImage, size_t imageLen) __attribute__((nonnull));
+
+#endif
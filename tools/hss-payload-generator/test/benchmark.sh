@@ -0,0 +1,149 @@
+#!/bin/bash
+#
+# MPFS HSS Embedded Software - tools/hss-payload-generator
+#
+# Copyright 2020-2025 Microchip FPGA Embedded Systems Solutions.
+#
+# SPDX-License-Identifier: MIT
+#
+# Payload generator benchmark
+#
+# Times the generator against each of the test/*.yaml configurations whose input
+# files are present, and against a synthetic configuration with a large rootfs-like
+# blob: unsigned, signed (in full, and with a Merkle tree, -m), and compressed (-C).
+#
+# Usage: test/benchmark.sh [<generator>] [<baseline-generator>]
+#
+# If a baseline generator is given, it is timed too, and the unsigned payloads from
+# both are checked to be byte-identical.
+#
+# Environment:
+#   BENCH_SIZE_MB  size of the synthetic rootfs blob in MiB (default 256)
+#   BENCH_RUNS     number of runs per case, the best of which is reported (default 3)
+#
+
+set -e
+
+cd "$(dirname "$0")/.."
+
+GENERATOR=$(realpath "${1:-./hss-payload-generator}")
+BASELINE=${2:+$(realpath "$2")}
+BENCH_SIZE_MB=${BENCH_SIZE_MB:-256}
+BENCH_RUNS=${BENCH_RUNS:-3}
+
+WORK_DIR=$(mktemp -d)
+trap 'rm -rf "$WORK_DIR"' EXIT
+
+# best_of <generator> <output> <args...>
+# prints the best wall-clock time in milliseconds, or nothing if the generator failed
+best_of() {
+	local generator=$1 output=$2
+	shift 2
+
+	local best=
+	for ((run = 0; run < BENCH_RUNS; run++)); do
+		local start end
+		start=$(date +%s%N)
+		if ! "$generator" "$@" "$output" >"$WORK_DIR/log" 2>&1; then
+			return 0
+		fi
+		end=$(date +%s%N)
+
+		local ms=$(((end - start) / 1000000))
+		if [ -z "$best" ] || [ "$ms" -lt "$best" ]; then
+			best=$ms
+		fi
+	done
+
+	echo "$best"
+}
+
+# bench <name> <args...>
+bench() {
+	local name=$1
+	shift
+
+	local ms
+	ms=$(best_of "$GENERATOR" "$WORK_DIR/new.bin" "$@")
+	if [ -z "$ms" ]; then
+		printf "%-24s generator failed:\n" "$name"
+		sed 's/^/    /' "$WORK_DIR/log"
+		exit 1
+	fi
+
+	local bytes mbps
+	bytes=$(stat -c %s "$WORK_DIR/new.bin")
+	mbps=$(awk "BEGIN { printf \"%.1f\", ($bytes / 1048576) / (($ms + 0.5) / 1000) }")
+	printf "%-24s %10d bytes %8d ms %10s MiB/s" "$name" "$bytes" "$ms" "$mbps"
+
+	if [ -n "$BASELINE" ]; then
+		local baseMs
+		baseMs=$(best_of "$BASELINE" "$WORK_DIR/base.bin" "$@")
+		if [ -n "$baseMs" ]; then
+			printf "   baseline %8d ms (%sx)" "$baseMs" \
+				"$(awk "BEGIN { printf \"%.2f\", ($baseMs + 0.5) / ($ms + 0.5) }")"
+
+			# signatures are randomized, so only unsigned payloads can be compared
+			case " $* " in
+			*" -p "*)
+				;;
+			*)
+				if ! cmp -s "$WORK_DIR/new.bin" "$WORK_DIR/base.bin"; then
+					printf "   OUTPUT MISMATCH\n"
+					exit 1
+				fi
+				printf "   identical"
+				;;
+			esac
+		fi
+	fi
+
+	printf "\n"
+}
+
+echo "Generator: $GENERATOR"
+[ -n "$BASELINE" ] && echo "Baseline:  $BASELINE"
+echo "Best of $BENCH_RUNS runs"
+echo
+
+for config in test/*.yaml; do
+	[ "$config" = "test/broken.yaml" ] && continue
+
+	# the test configurations reference ELF and binary files that are not shipped...
+	missing=
+	for input in $(sed -n -e 's/^  *\([^#: ]*\): *{.*/\1/p' \
+			-e 's/.*ancilliary-data: *\([^ ,}]*\).*/\1/p' "$config"); do
+		[ -f "$input" ] || missing="$missing $input"
+	done
+
+	if [ -n "$missing" ]; then
+		printf "%-24s skipped (missing%s)\n" "$(basename "$config")" "$missing"
+	else
+		bench "$(basename "$config")" -c "$config"
+	fi
+done
+
+#
+# synthetic configuration, loosely modelled on a U-Boot + DTB + large rootfs payload
+#
+head -c $((BENCH_SIZE_MB * 1024 * 1024 + 5)) /dev/urandom >"$WORK_DIR/rootfs.bin"
+head -c 1000003 /dev/urandom >"$WORK_DIR/u-boot.bin"
+head -c 40001 /dev/urandom >"$WORK_DIR/board.dtb"
+cat >"$WORK_DIR/bench.yaml" <<EOF
+set-name: 'PolarFire-SoC-HSS::Benchmark'
+hart-entry-points: {u54_1: '0x80200000', u54_2: '0x80200000', u54_3: '0x80200000', u54_4: '0x80200000'}
+payloads:
+  $WORK_DIR/u-boot.bin: {exec-addr: '0x80200000', owner-hart: u54_1, secondary-hart: u54_2, secondary-hart: u54_3, secondary-hart: u54_4, priv-mode: prv_s, ancilliary-data: $WORK_DIR/board.dtb, payload-name: 'u-boot'}
+  $WORK_DIR/rootfs.bin: {exec-addr: '0x90000000', owner-hart: u54_1, priv-mode: prv_s, payload-name: 'rootfs', skip-autoboot: true}
+EOF
+
+bench "synthetic (${BENCH_SIZE_MB} MiB)" -c "$WORK_DIR/bench.yaml"
+
+if command -v openssl >/dev/null; then
+	openssl ecparam -genkey -name secp384r1 -param_enc named_curve -noout \
+		-out "$WORK_DIR/private.pem" 2>/dev/null
+	bench "synthetic, signed" -c "$WORK_DIR/bench.yaml" -p "$WORK_DIR/private.pem"
+	bench "synthetic, Merkle" -c "$WORK_DIR/bench.yaml" -p "$WORK_DIR/private.pem" -m
+fi
+
+bench "synthetic, compressed" -c "$WORK_DIR/bench.yaml" -C 6
@@ -36,6 +36,7 @@
 #include "crc32.h"
 #include "debug_printf.h"
 #include "verify_payload.h"
+#include "merkle.h"
 
 #include <openssl/evp.h>
 #include <openssl/ec.h>
@@ -220,8 +221,27 @@ bool HSS_Boot_Secure_CheckCodeSigning(struct HSS_BootImage *pBootImage, char con
 
 	assert(ARRAY_SIZE(pRWBootImage->signature.digest) == SHA384_DIGEST_LENGTH);
 
-	result = Verify_ECDSA_P384((size_t)der_len, der, pRWBootImage->bootImageLength, (uint8_t *)pRWBootImage, public_key_filename);
+	size_t signedLen = pRWBootImage->bootImageLength;
+	bool merkleResult = true;
+
+	if (pRWBootImage->version == mHSS_BOOT_VERSION_MERKLE) {
+		// only the image up to the Merkle leaves is signed, and the leaves (and so the
+		// chunks) are authenticated by the root within that
+		struct HSS_MerkleTable const *pTable = merkle_get_table(pRWBootImage, pRWBootImage->bootImageLength);
+
+		if (pTable) {
+			signedLen = pTable->leafTableOffset;
+			merkleResult = merkle_check_payload(pRWBootImage, pRWBootImage->bootImageLength);
+		} else {
+			merkleResult = false;
+		}
+	}
+
+	result = Verify_ECDSA_P384((size_t)der_len, der, signedLen, (uint8_t *)pRWBootImage, public_key_filename)
+		&& merkleResult;
 
-	return result;
 	OPENSSL_free(der);
+	free(pRWBootImage);
+
+	return result;
 }
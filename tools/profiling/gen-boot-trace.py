@@ -0,0 +1,167 @@
+#!/usr/bin/env python3
+
+"""
+MPFS HSS Boot Timeline to Chrome Trace tool
+
+This script takes the output of the HSS console DEBUG TIMELINE command,
+and converts it into Chrome trace_event JSON, which can be loaded into
+Perfetto (https://ui.perfetto.dev) or chrome://tracing.
+
+Each hart is shown as a separate thread. Phases such as chunk download and
+OpenSBI init are recorded against the hart being booted, even though the
+E51 performs them. Timestamps come from mtime, which is common to all
+harts, and the mcycle duration of each phase is attached as an argument.
+
+"""
+
+#
+#
+# MPFS HSS Boot Timeline to Chrome Trace tool
+#
+# Copyright 2025 Microchip Corporation.
+#
+# SPDX-License-Identifier: MIT
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to
+# deal in the Software without restriction, including without limitation the
+# rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+# sell copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in
+# all copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+# FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+# IN THE SOFTWARE.
+#
+#
+#
+
+import argparse
+import csv
+import json
+import sys
+
+HART_NAMES = ['E51', 'U54_1', 'U54_2', 'U54_3', 'U54_4']
+
+MTIME_WRAP = 1 << 32
+
+
+def load_events(dumpfile: str):
+    '''loads timeline events, and the mtime tick rate, from a console dump'''
+    events = []
+    ticks_per_sec = 1000000
+    mtime_base = 0
+    last_mtime = None
+
+    with open(dumpfile, newline='') as f:
+        lines = []
+        for line in f:
+            if line.startswith('# ') and 'ticks per second' in line:
+                ticks_per_sec = int(line.split(',')[-1].split()[0])
+            elif line.startswith('T,'):
+                lines.append(line)
+
+        for row in csv.reader(lines, skipinitialspace=True):
+            _, kind, phase, hart, mtime, mcycle = row
+            mtime = int(mtime)
+            # mtime is recorded as 32 bits, so unwrap it
+            if last_mtime is not None and mtime < last_mtime:
+                mtime_base += MTIME_WRAP
+            last_mtime = mtime
+            events.append((kind, phase, int(hart), mtime_base + mtime,
+                           int(mcycle)))
+
+    return events, ticks_per_sec
+
+
+def build_trace(events, ticks_per_sec: int):
+    '''converts begin/end events into complete (X) trace events'''
+    trace = []
+    harts = sorted({hart for _, _, hart, _, _ in events})
+    for hart in harts:
+        trace.append({'name': 'thread_name', 'ph': 'M', 'pid': 0,
+                      'tid': hart, 'args': {'name': HART_NAMES[hart]
+                                            if hart < len(HART_NAMES)
+                                            else 'hart%d' % hart}})
+
+    def to_us(ticks):
+        return ticks * 1000000.0 / ticks_per_sec
+
+    open_phases = {}
+    for kind, phase, hart, mtime, mcycle in events:
+        key = (phase, hart)
+        if kind == 'B':
+            open_phases.setdefault(key, []).append((mtime, mcycle))
+        elif open_phases.get(key):
+            start, start_cycles = open_phases[key].pop()
+            trace.append({'name': phase, 'cat': 'boot', 'ph': 'X',
+                          'pid': 0, 'tid': hart, 'ts': to_us(start),
+                          'dur': to_us(mtime - start),
+                          'args': {'mcycles': mcycle - start_cycles}})
+        else:
+            print('warning: end of %s for hart %d without a begin' %
+                  (phase, hart), file=sys.stderr)
+
+    # phases that never ended (e.g. a boot error) are shown as begin only
+    for (phase, hart), starts in open_phases.items():
+        for start, _ in starts:
+            trace.append({'name': phase, 'cat': 'boot', 'ph': 'B',
+                          'pid': 0, 'tid': hart, 'ts': to_us(start)})
+
+    return trace
+
+
+def print_summary(trace):
+    '''prints phase durations, in start order'''
+    print('# phase, hart, start ms, duration ms, mcycles', file=sys.stderr)
+    for event in sorted((e for e in trace if e['ph'] == 'X'),
+                        key=lambda e: e['ts']):
+        print('%s, %d, %.3f, %.3f, %d' %
+              (event['name'], event['tid'], event['ts'] / 1000.0,
+               event['dur'] / 1000.0, event['args']['mcycles']),
+              file=sys.stderr)
+
+
+def main():
+    '''main function'''
+    parser = argparse.ArgumentParser(
+        description='Convert HSS Boot Timeline to Chrome Trace JSON')
+    parser.add_argument('--summary', '-s', action='store_true',
+                        help='print phase durations to stderr')
+    parser.add_argument('--output', '-o', metavar='FILE',
+                        help='output JSON file (default stdout)')
+    parser.add_argument('dumpfile')
+
+    args = parser.parse_args()
+
+    events, ticks_per_sec = load_events(args.dumpfile)
+    if not events:
+        print('No timeline events found', file=sys.stderr)
+        sys.exit(1)
+
+    trace = build_trace(events, ticks_per_sec)
+    if args.summary:
+        print_summary(trace)
+
+    document = {'traceEvents': trace, 'displayTimeUnit': 'ms'}
+    if args.output:
+        with open(args.output, 'w') as f:
+            json.dump(document, f, indent=1)
+    else:
+        json.dump(document, sys.stdout, indent=1)
+        print()
+
+
+#
+#
+#
+
+if __name__ == "__main__":
+    main()
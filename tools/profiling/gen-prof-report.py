@@ -7,6 +7,13 @@ This script takes the CSV profiling output from the HSS console
 which contains function addresses, and tick counts, and converts
 the function addresses into function names.
 
+The profile contains per-hart function rows (F) with call counts and
+inclusive and self tick counts, and caller->callee edge rows (E). As
+well as the default text report, it can write the call graph in
+callgrind format (for kcachegrind/qcachegrind) or as folded stacks
+(for flamegraph.pl). Folded stacks are reconstructed from the edges,
+so time is split between callers in proportion to their edge times.
+
 """
 
 #
@@ -72,42 +79,129 @@ def build_symbol_cache(elf_filepath: str):
             symbol_cache[symbol['st_value']] = symbol.name
 
 
-def process_csv(csvfile):
-    '''process input CSV'''
-    if args.verbose:
-        print('Loading sorted CSV', file=sys.stderr)
+class Profile:
+    '''function and call graph statistics for one hart'''
+    def __init__(self):
+        self.functions = {}  # addr -> [calls, inclusive, self]
+        self.edges = {}      # (caller, callee) -> [calls, inclusive]
 
-    with open(csvfile, newline='') as csvfile:
-        filtered = (line for line in csvfile if not line.startswith("#"))
-        reader = csv.reader(filtered)
-        rows = list(reader)
-        rows.sort(key=lambda row: int(row[1]), reverse=True)
 
-        if args.verbose:
-            print('Searching for function names in symbol cache',
-                  file=sys.stderr)
+def symbol_name(funcaddr: int) -> str:
+    '''returns the symbol name for a function address'''
+    return symbol_cache.get(funcaddr, '0x%x' % funcaddr)
 
-        for row in rows:
-            process_row(row)
 
+def process_csv(csvfile):
+    '''load profile CSV into per-hart profiles'''
+    if args.verbose:
+        print('Loading CSV', file=sys.stderr)
 
-def process_row(row):
-    '''takes a tuple (function address, tick count) and replaces the
-    function address with its function name'''
-    funcaddr = int(row[0], 16)
-    tickcount = int(row[1])
-
-    if funcaddr in symbol_cache:
-        print(symbol_cache[funcaddr], tickcount, sep=', ')
-    else:
-        print(funcaddr, tickcount, sep=', ')
-        pass
+    profiles = {}
+    with open(csvfile, newline='') as csvfile:
+        filtered = (line for line in csvfile if not line.startswith("#"))
+        reader = csv.reader(filtered, skipinitialspace=True)
+        for row in reader:
+            if not row:
+                continue
+            if row[0] == 'F':
+                profile = profiles.setdefault(int(row[1]), Profile())
+                profile.functions[int(row[2], 16)] = \
+                    [int(row[3]), int(row[4]), int(row[5])]
+            elif row[0] == 'E':
+                profile = profiles.setdefault(int(row[1]), Profile())
+                profile.edges[(int(row[2], 16), int(row[3], 16))] = \
+                    [int(row[4]), int(row[5])]
+            elif len(row) == 2:
+                # older format: function address, inclusive tick count
+                profile = profiles.setdefault(0, Profile())
+                profile.functions[int(row[0], 16)] = \
+                    [0, int(row[1]), int(row[1])]
+
+    if args.hart is not None:
+        profiles = {args.hart: profiles.get(args.hart, Profile())}
+
+    return profiles
+
+
+def print_report(profiles):
+    '''prints functions sorted by self time, for each hart'''
+    for hart, profile in sorted(profiles.items()):
+        print('# hart %d' % hart)
+        print('# function, calls, inclusive ticks, self ticks')
+        rows = sorted(profile.functions.items(),
+                      key=lambda item: item[1][2], reverse=True)
+        for funcaddr, (calls, inclusive, self_ticks) in rows:
+            print(symbol_name(funcaddr), calls, inclusive, self_ticks,
+                  sep=', ')
+
+
+def write_callgrind(profiles, filename: str):
+    '''writes a callgrind format profile, with one thread per hart'''
+    with open(filename, 'w') as f:
+        f.write('# callgrind format\n')
+        f.write('version: 1\n')
+        f.write('creator: gen-prof-report.py\n')
+        f.write('positions: line\n')
+        f.write('events: Cycles\n\n')
+
+        for hart, profile in sorted(profiles.items()):
+            f.write('part: %d\n' % (hart + 1))
+            f.write('thread: %d\n\n' % hart)
+            for funcaddr, (_, _, self_ticks) in profile.functions.items():
+                f.write('fn=%s\n' % symbol_name(funcaddr))
+                f.write('0 %d\n' % self_ticks)
+                for (caller, callee), (calls, inclusive) in \
+                        profile.edges.items():
+                    if caller == funcaddr:
+                        f.write('cfn=%s\n' % symbol_name(callee))
+                        f.write('calls=%d 0\n' % calls)
+                        f.write('0 %d\n' % inclusive)
+                f.write('\n')
+
+
+def write_folded(profiles, filename: str):
+    '''writes folded stacks for flamegraph.pl, one root frame per hart'''
+    with open(filename, 'w') as f:
+        for hart, profile in sorted(profiles.items()):
+            children = {}
+            callers = set()
+            for (caller, callee), (_, inclusive) in profile.edges.items():
+                children.setdefault(caller, []).append((callee, inclusive))
+                if caller != callee:
+                    callers.add(callee)
+
+            def walk(funcaddr, stack, share):
+                if funcaddr in stack:
+                    return  # recursion is already counted in the caller
+                stack = stack + [funcaddr]
+                self_ticks = profile.functions.get(
+                    funcaddr, (0, 0, 0))[2]
+                path = ';'.join(['hart%d' % hart] +
+                                [symbol_name(a) for a in stack])
+                if int(self_ticks * share):
+                    f.write('%s %d\n' % (path, int(self_ticks * share)))
+                for callee, edge_inclusive in children.get(funcaddr, []):
+                    callee_inclusive = profile.functions.get(
+                        callee, (0, 0, 0))[1]
+                    if callee_inclusive:
+                        walk(callee, stack, share *
+                             min(1.0, edge_inclusive / callee_inclusive))
+
+            for funcaddr in profile.functions:
+                if funcaddr not in callers:
+                    walk(funcaddr, [], 1.0)
 
 
 def main():
     '''main function'''
     parser = argparse.ArgumentParser(description='Generate Profile Report')
     parser.add_argument('--verbose', '-v', action='count', default=0)
+    parser.add_argument('--hart', type=int,
+                        help='only report on this hart')
+    parser.add_argument('--callgrind', metavar='FILE',
+                        help='write a callgrind format call graph')
+    parser.add_argument('--flamegraph', metavar='FILE',
+                        help='write folded stacks for flamegraph.pl')
     parser.add_argument('elffile')
     parser.add_argument('csvfile')
 
@@ -115,7 +209,14 @@ def main():
     args = parser.parse_args()
 
     build_symbol_cache(args.elffile)
-    process_csv(args.csvfile)
+    profiles = process_csv(args.csvfile)
+
+    if args.callgrind:
+        write_callgrind(profiles, args.callgrind)
+    if args.flamegraph:
+        write_folded(profiles, args.flamegraph)
+    if not args.callgrind and not args.flamegraph:
+        print_report(profiles)
 
 
 #
@@ -0,0 +1,169 @@
+#!/usr/bin/env python3
+
+"""
+MPFS HSS Generate Sampling Profile Report tool
+
+This script takes the output of the HSS console DEBUG SAMPLE DUMP command,
+which contains raw program counter and return address samples, symbolises
+them against an ELF file, and prints a histogram of samples per function.
+
+It can also histogram samples by caller->callee pair (using the sampled
+return address), and write folded stacks for flamegraph.pl. As only the
+return address is sampled, each folded stack is at most two frames deep,
+and the caller is only meaningful when the sample lands in a function
+that has not yet saved or overwritten ra.
+
+Samples from U54s running an OS will not symbolise against the HSS ELF,
+so use --hart to report on them separately, against the OS ELF.
+
+"""
+
+#
+#
+# MPFS HSS Generate Sampling Profile Report tool
+#
+# Copyright 2025 Microchip Corporation.
+#
+# SPDX-License-Identifier: MIT
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to
+# deal in the Software without restriction, including without limitation the
+# rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+# sell copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in
+# all copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+# FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+# IN THE SOFTWARE.
+#
+#
+#
+
+import argparse
+import bisect
+import csv
+import sys
+
+try:
+    from elftools.elf.elffile import ELFFile
+except ImportError:
+    print("Unable to import the pyelftools package, " +
+          "please check your Python installation", file=sys.stderr)
+    print("Ensure that pyelftools is installed", file=sys.stderr)
+    sys.exit(1)
+
+
+class SymbolTable:
+    '''maps addresses to the function containing them'''
+    def __init__(self, elf_filepath: str):
+        functions = []
+        with open(elf_filepath, 'rb') as f:
+            elf = ELFFile(f)
+            symtab = elf.get_section_by_name('.symtab')
+            for symbol in symtab.iter_symbols():
+                if symbol['st_info']['type'] == 'STT_FUNC':
+                    functions.append((symbol['st_value'],
+                                      symbol['st_value'] + symbol['st_size'],
+                                      symbol.name))
+        functions.sort()
+        self.starts = [start for start, _, _ in functions]
+        self.functions = functions
+
+    def lookup(self, address: int) -> str:
+        '''returns the function name for an address'''
+        index = bisect.bisect_right(self.starts, address) - 1
+        if index >= 0:
+            start, end, name = self.functions[index]
+            if start <= address < max(end, start + 1):
+                return name
+        return '0x%x' % address
+
+
+def load_samples(csvfile: str, hart):
+    '''loads (hart, pc, ra) samples from a console dump'''
+    samples = []
+    with open(csvfile, newline='') as f:
+        filtered = (line for line in f if line.startswith('S,'))
+        for row in csv.reader(filtered, skipinitialspace=True):
+            sample = (int(row[1]), int(row[2], 16), int(row[3], 16))
+            if hart is None or sample[0] == hart:
+                samples.append(sample)
+    return samples
+
+
+def count(keys):
+    '''returns (key, count) pairs, most frequent first'''
+    histogram = {}
+    for key in keys:
+        histogram[key] = histogram.get(key, 0) + 1
+    return sorted(histogram.items(), key=lambda item: item[1], reverse=True)
+
+
+def print_histogram(title: str, histogram, total: int, limit: int):
+    '''prints a histogram with percentages'''
+    print('# %s, samples, percent' % title)
+    for key, samples in histogram[:limit] if limit else histogram:
+        print('%s, %d, %.2f' % (key, samples, 100.0 * samples / total))
+
+
+def main():
+    '''main function'''
+    parser = argparse.ArgumentParser(
+        description='Generate Sampling Profile Report')
+    parser.add_argument('--hart', type=int,
+                        help='only report on this hart')
+    parser.add_argument('--callers', action='store_true',
+                        help='also report caller->function pairs')
+    parser.add_argument('--flamegraph', metavar='FILE',
+                        help='write folded stacks for flamegraph.pl')
+    parser.add_argument('--top', type=int, default=0,
+                        help='only print the TOP most frequent entries')
+    parser.add_argument('elffile')
+    parser.add_argument('dumpfile')
+
+    args = parser.parse_args()
+
+    symbols = SymbolTable(args.elffile)
+    samples = load_samples(args.dumpfile, args.hart)
+    if not samples:
+        print('No samples found', file=sys.stderr)
+        sys.exit(1)
+
+    functions = [symbols.lookup(pc) for _, pc, _ in samples]
+    print('# %d samples' % len(samples))
+    print_histogram('function', count(functions), len(samples), args.top)
+
+    if args.callers:
+        pairs = ['%s -> %s' % (symbols.lookup(ra) if ra else '?', function)
+                 for (_, _, ra), function in zip(samples, functions)]
+        print()
+        print_histogram('caller -> function', count(pairs), len(samples),
+                        args.top)
+
+    if args.flamegraph:
+        stacks = []
+        for (hart, _, ra), function in zip(samples, functions):
+            frames = ['hart%d' % hart]
+            if ra:
+                frames.append(symbols.lookup(ra))
+            frames.append(function)
+            stacks.append(';'.join(frames))
+        with open(args.flamegraph, 'w') as f:
+            for stack, samples in count(stacks):
+                f.write('%s %d\n' % (stack, samples))
+
+
+#
+#
+#
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,256 @@
+#!/usr/bin/env python3
+
+"""
+MPFS HSS Telemetry Reader
+
+This script reads the HSS shared-memory telemetry page, either live from
+/dev/mem on the target or from a binary dump of the page, and decodes it.
+
+On the target, the page address is returned by the SBI_EXT_HSS_TELEMETRY
+vendor ecall, and is CONFIG_SERVICE_TELEMETRY_BASE_ADDR in the HSS
+configuration.
+
+"""
+
+#
+#
+# MPFS HSS Telemetry Reader
+#
+# Copyright 2025 Microchip Corporation.
+#
+# SPDX-License-Identifier: MIT
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to
+# deal in the Software without restriction, including without limitation the
+# rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+# sell copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in
+# all copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+# FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+# IN THE SOFTWARE.
+#
+#
+#
+
+import argparse
+import mmap
+import os
+import struct
+import sys
+import time
+
+# must match services/telemetry/telemetry_service.h
+TELEMETRY_MAGIC = 0x4D454C4554535348  # "HSSTELEM"
+TELEMETRY_VERSION = 1
+PAGE_SIZE = 4096
+
+MAX_EVENTS = 16
+MAX_BEU_CAUSES = 8
+MAX_HARTS = 5
+MAX_MONITORS = 32
+MONITOR_NAME_LEN = 24
+
+HEADER = struct.Struct('<QHHIIIQQ')
+BOOT = struct.Struct('<Q%dQ' % MAX_EVENTS)
+BEU = struct.Struct('<%dQ%dQ' % (MAX_BEU_CAUSES, MAX_HARTS))
+IPI = struct.Struct('<5Q')
+SCRUB = struct.Struct('<5Q')
+HEALTHMON = struct.Struct('<II')
+MONITOR = struct.Struct('<%ds4I2Q' % MONITOR_NAME_LEN)
+
+SEQUENCE_OFFSET = 16
+
+# must match enum HSS_Event in include/hss_trigger.h
+EVENT_NAMES = [
+    'OpenSBI Initialized',
+    'IPI Initialized',
+    'DDR Trained',
+    'Startup Complete',
+    'USBDMSC Requested',
+    'USBDMSC Finished',
+    'Post Boot',
+    'Boot Started',
+    'Boot Complete',
+    'Hart State Changed',
+    'Healthmon Event',
+]
+
+# must match enum BEU_event_cause in mss_beu_def.h
+BEU_CAUSE_NAMES = [
+    None,
+    None,
+    'ITIM correctable ECC error',
+    'ITIM uncorrectable ECC error',
+    None,
+    'Load or store TileLink bus error',
+    'Data cache correctable ECC error',
+    'Data cache uncorrectable ECC error',
+]
+
+HART_NAMES = ['E51', 'U54_1', 'U54_2', 'U54_3', 'U54_4']
+
+
+def read_page_consistent(read_fn, retries: int):
+    '''copies the page, retrying while the HSS is part-way through an
+    update (sequence odd, or changed during the copy)'''
+    for _ in range(retries):
+        before = struct.unpack_from('<I', read_fn(SEQUENCE_OFFSET, 4))[0]
+        if before & 1:
+            continue
+        data = read_fn(0, PAGE_SIZE)
+        after = struct.unpack_from('<I', read_fn(SEQUENCE_OFFSET, 4))[0]
+        if before == after:
+            return data
+    raise RuntimeError('unable to get a consistent copy of the telemetry page')
+
+
+def decode(data: bytes):
+    '''decodes a telemetry page into a dictionary'''
+    (magic, version, _, size, sequence, _, ticks_per_sec,
+     last_update) = HEADER.unpack_from(data, 0)
+    if magic != TELEMETRY_MAGIC:
+        raise ValueError('bad telemetry magic 0x%x' % magic)
+    if version != TELEMETRY_VERSION:
+        raise ValueError('unsupported telemetry version %d' % version)
+
+    offset = HEADER.size
+    boot = BOOT.unpack_from(data, offset)
+    offset += BOOT.size
+    beu = BEU.unpack_from(data, offset)
+    offset += BEU.size
+    ipi = []
+    for _ in range(MAX_HARTS):
+        ipi.append(IPI.unpack_from(data, offset))
+        offset += IPI.size
+    scrub = SCRUB.unpack_from(data, offset)
+    offset += SCRUB.size
+    monitor_count, _ = HEALTHMON.unpack_from(data, offset)
+    offset += HEALTHMON.size
+    monitors = []
+    for i in range(MAX_MONITORS):
+        name, last, low, high, _, fires, samples = \
+            MONITOR.unpack_from(data, offset)
+        offset += MONITOR.size
+        if i < monitor_count:
+            monitors.append({
+                'name': name.split(b'\0', 1)[0].decode('ascii', 'replace'),
+                'last': last, 'min': low, 'max': high,
+                'fires': fires, 'samples': samples})
+
+    if offset != size:
+        print('warning: page size %d, decoded %d bytes' % (size, offset),
+              file=sys.stderr)
+
+    return {
+        'sequence': sequence,
+        'ticks_per_sec': ticks_per_sec,
+        'last_update': last_update,
+        'events': boot[0],
+        'first_notify': boot[1:],
+        'beu_causes': beu[:MAX_BEU_CAUSES],
+        'beu_harts': beu[MAX_BEU_CAUSES:],
+        'ipi': ipi,
+        'scrub': dict(zip(('region', 'offset', 'passes', 'cpu_bytes',
+                           'pdma_bytes'), scrub)),
+        'monitors': monitors,
+    }
+
+
+def ticks_to_ms(ticks: int, ticks_per_sec: int) -> str:
+    '''formats a tick count as milliseconds'''
+    return '%.3f ms' % (ticks * 1000.0 / ticks_per_sec)
+
+
+def print_report(telemetry):
+    '''prints a decoded telemetry page'''
+    tps = telemetry['ticks_per_sec'] or 1
+
+    print('Sequence %d, last updated at %s' %
+          (telemetry['sequence'], ticks_to_ms(telemetry['last_update'], tps)))
+
+    print('\nBoot events:')
+    for i, name in enumerate(EVENT_NAMES):
+        first = telemetry['first_notify'][i]
+        state = 'Y' if telemetry['events'] & (1 << i) else 'N'
+        when = ticks_to_ms(first, tps) if first else '-'
+        print('  %-20s %s  %s' % (name, state, when))
+
+    print('\nBus Error Unit:')
+    for i, name in enumerate(BEU_CAUSE_NAMES):
+        if name:
+            print('  %-36s %d' % (name, telemetry['beu_causes'][i]))
+    for i, name in enumerate(HART_NAMES):
+        print('  %-36s %d' % (name + ' events', telemetry['beu_harts'][i]))
+
+    print('\nIPI:')
+    print('  %-6s %10s %10s %10s %10s %10s' %
+          ('hart', 'allocs', 'delivers', 'frees', 'intents', 'sends'))
+    for i, name in enumerate(HART_NAMES):
+        print('  %-6s %10d %10d %10d %10d %10d' %
+              ((name,) + tuple(telemetry['ipi'][i])))
+
+    scrub = telemetry['scrub']
+    print('\nScrub:')
+    print('  region %d, offset 0x%x, %d region passes' %
+          (scrub['region'], scrub['offset'], scrub['passes']))
+    print('  %d bytes by cpu, %d bytes by pdma' %
+          (scrub['cpu_bytes'], scrub['pdma_bytes']))
+
+    print('\nHealth monitors:')
+    for monitor in telemetry['monitors']:
+        print('  %-24s last 0x%x, min 0x%x, max 0x%x, fired %d, %d samples' %
+              (monitor['name'], monitor['last'], monitor['min'],
+               monitor['max'], monitor['fires'], monitor['samples']))
+
+
+def main():
+    '''main function'''
+    parser = argparse.ArgumentParser(description='Read HSS Telemetry')
+    source = parser.add_mutually_exclusive_group(required=True)
+    source.add_argument('--address', '-a', type=lambda x: int(x, 0),
+                        help='physical address of the telemetry page')
+    source.add_argument('--file', '-f',
+                        help='binary dump of the telemetry page')
+    parser.add_argument('--watch', '-w', type=float, default=0.0,
+                        help='re-read every WATCH seconds')
+    parser.add_argument('--retries', type=int, default=1000)
+
+    args = parser.parse_args()
+
+    if args.file:
+        with open(args.file, 'rb') as f:
+            data = f.read(PAGE_SIZE).ljust(PAGE_SIZE, b'\0')
+
+        def read_fn(offset, length):
+            return data[offset:offset + length]
+    else:
+        fd = os.open('/dev/mem', os.O_RDONLY | os.O_SYNC)
+        page = mmap.mmap(fd, PAGE_SIZE, mmap.MAP_SHARED, mmap.PROT_READ,
+                         offset=args.address)
+
+        def read_fn(offset, length):
+            return page[offset:offset + length]
+
+    while True:
+        print_report(decode(read_page_consistent(read_fn, args.retries)))
+        if not args.watch or args.file:
+            break
+        time.sleep(args.watch)
+        print()
+
+
+#
+#
+#
+
+if __name__ == "__main__":
+    main()